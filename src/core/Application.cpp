@@ -1,6 +1,10 @@
 #include "pch.hpp"
 
+#include <algorithm>
+#include <filesystem>
+
 #include "Application.hpp"
+#include "core/JsonWriter.hpp"
 #include "core/Logger.hpp"
 #include "graphics/GraphicsSystem.hpp"
 #include "physics/PhysicsSystem.hpp"
@@ -16,25 +20,78 @@ Application::~Application()
 {
 }
 
-bool Application::Init()
+bool Application::Init(const LaunchOptions& options)
 {
 	ZoneScoped;
 
 	Logger::Init();
+	m_Options = options;
 
-	if (!m_Window->Initialize())
-		return false;
+	if (!m_Options.logFilePath.empty())
+	{
+		Logger::SetLogFile(m_Options.logFilePath);
+	}
+	if (!m_Options.binaryLogPath.empty())
+	{
+		Logger::SetBinaryLog(m_Options.binaryLogPath);
+	}
 
-	if (!m_Graphics->Initialize(m_Window->GetWindow()))
+	// Workers come first: graphics hands texture transcodes to them
+	if (!m_TaskScheduling->Initialize())
 		return false;
 
+	m_Graphics->SetPreferDescriptorBuffer(!m_Options.descriptorSets);
+	m_Graphics->SetDemoInstanceCount(m_Options.instanceCount);
+	m_Graphics->SetTaskScheduler(m_TaskScheduling->GetScheduler());
+	m_Graphics->GetTextureStreamer().SetBudget(static_cast<VkDeviceSize>(m_Options.textureBudgetMiB) * 1024 * 1024);
+
+	if (!m_Options.latencyMode.empty())
+	{
+		LatencyMode latencyMode = LatencyMode::LowLatency;
+		if (ParseLatencyMode(m_Options.latencyMode.c_str(), latencyMode))
+			m_Graphics->SetLatencyMode(latencyMode);
+		else
+			WOVEN_LOG_WARNING("Invalid value for --latency: %s", m_Options.latencyMode.c_str());
+	}
+
+	if (m_Options.headless)
+	{
+		if (!m_Window->InitializeHeadless())
+			return false;
+
+		if (!m_Graphics->InitializeHeadless(m_Options.width, m_Options.height))
+			return false;
+	}
+	else
+	{
+		if (!m_Window->Initialize())
+			return false;
+
+		if (!m_Graphics->Initialize(m_Window->GetWindow()))
+			return false;
+	}
+
 	if (!m_Physics->Initialize())
 		return false;
 
-	if (!m_TaskScheduling->Initialize())
-		return false;
+	if (!m_Options.textureDir.empty())
+	{
+		LoadTextures(m_Options.textureDir);
+	}
+
+	if (!m_Options.vmaStatsPath.empty())
+	{
+		m_Graphics->GetMemoryStats().SetPeriodicDump(m_Options.vmaStatsPath, m_Options.vmaStatsInterval);
+	}
+
+	if (m_Options.frameCount > 0)
+	{
+		m_FrameStats.Reset(m_Graphics->GetFrameNumber());
+		m_Graphics->SetGpuTimingCapture(true);
+		WOVEN_LOG_INFO("Timed run: %u frames", m_Options.frameCount);
+	}
 
-	Logger::Info("Application initialized successfully!");
+	WOVEN_LOG_INFO("Application initialized successfully!");
 	return true;
 }
 
@@ -57,8 +114,110 @@ void Application::Update()
 	// Update graphics profiler
 	m_Graphics->UpdateProfiler();
 
-	const float timeSeconds = SDL_GetTicks() * 0.001f;
+	// Headless runs use a fixed timestep so every run renders identical frames
+	const float timeSeconds = m_Options.headless ? static_cast<float>(m_FramesRendered) / 60.0f : SDL_GetTicks() * 0.001f;
+
+	if (!m_Options.frameCapturePath.empty() && m_FramesRendered + 1 >= std::max(m_Options.frameCount, 1u))
+	{
+		m_Graphics->RequestFrameCapture(m_Options.frameCapturePath);
+		m_Options.frameCapturePath.clear();
+	}
+
+	const uint64_t frameNumber = m_Graphics->GetFrameNumber();
+	const uint64_t cpuStart = SDL_GetPerformanceCounter();
 	m_Graphics->RenderFrame(timeSeconds);
+	const uint64_t cpuEnd = SDL_GetPerformanceCounter();
+
+	if (m_Options.frameCount == 0)
+		return;
+
+	const double cpuMs = static_cast<double>(cpuEnd - cpuStart) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	m_FrameStats.RecordCpuTime(frameNumber, cpuMs);
+	for (const GpuFrameTiming& timing: m_Graphics->ConsumeGpuTimings())
+	{
+		m_FrameStats.RecordGpuTime(timing.frameNumber, timing.gpuMs);
+	}
+	for (const PresentTiming& timing: m_Graphics->ConsumePresentTimings())
+	{
+		m_FrameStats.RecordDisplayLatency(timing.frameNumber, timing.presentMs, timing.frameMs);
+	}
+
+	if (++m_FramesRendered >= m_Options.frameCount)
+	{
+		FinishTimedRun();
+	}
+}
+
+void Application::FinishTimedRun()
+{
+	ZoneScoped;
+
+	// Drain in-flight frames so the last GPU timings are available
+	m_Graphics->WaitIdle();
+	for (const GpuFrameTiming& timing: m_Graphics->ConsumeGpuTimings())
+	{
+		m_FrameStats.RecordGpuTime(timing.frameNumber, timing.gpuMs);
+	}
+	for (const PresentTiming& timing: m_Graphics->ConsumePresentTimings())
+	{
+		m_FrameStats.RecordDisplayLatency(timing.frameNumber, timing.presentMs, timing.frameMs);
+	}
+
+	m_FrameStats.LogSummary();
+
+	if (!m_Options.timingReportPath.empty())
+	{
+		JsonWriter writer;
+		writer.BeginObject();
+		writer.Field("device", m_Graphics->GetDeviceName());
+		writer.Field("headless", m_Options.headless);
+		writer.Field("latencyMode", GetLatencyModeName(m_Graphics->GetLatencyMode()));
+		writer.Field("width", m_Graphics->GetSwapchainExtent().width);
+		writer.Field("height", m_Graphics->GetSwapchainExtent().height);
+		writer.Field("frames", m_FramesRendered);
+		m_FrameStats.WriteJson(writer);
+		writer.EndObject();
+
+		if (writer.WriteToFile(m_Options.timingReportPath))
+			WOVEN_LOG_INFO("Wrote timing report to %s", m_Options.timingReportPath.string().c_str());
+		else
+			WOVEN_LOG_ERROR("Failed to write timing report %s", m_Options.timingReportPath.string().c_str());
+	}
+
+	if (!m_Options.captureImagePath.empty())
+	{
+		m_Graphics->SaveLastFrameImage(m_Options.captureImagePath);
+	}
+
+	RequestClose();
+}
+
+void Application::LoadTextures(const std::filesystem::path& directory)
+{
+	ZoneScoped;
+
+	std::error_code error;
+	std::vector<std::filesystem::path> paths;
+	for (const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator(directory, error))
+	{
+		const std::filesystem::path extension = entry.path().extension();
+		if (entry.is_regular_file() && (extension == ".ktx2" || extension == ".wtex"))
+		{
+			paths.push_back(entry.path());
+		}
+	}
+	if (error)
+	{
+		WOVEN_LOG_ERROR("Cannot read texture directory %s: %s", directory.string().c_str(), error.message().c_str());
+		return;
+	}
+
+	std::sort(paths.begin(), paths.end());
+	for (const std::filesystem::path& path: paths)
+	{
+		m_Graphics->GetTextureStreamer().Load(path);
+	}
+	WOVEN_LOG_INFO("Streaming %zu textures from %s", paths.size(), directory.string().c_str());
 }
 
 void Application::Shutdown()
@@ -82,6 +241,20 @@ void Application::HandleEvent(const SDL_Event& event)
 	{
 		m_Window->ProcessEvent(event);
 	}
+
+	switch (event.type)
+	{
+		case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+		case SDL_EVENT_WINDOW_MINIMIZED:
+		case SDL_EVENT_WINDOW_RESTORED:
+			if (m_Graphics && !m_Options.headless)
+			{
+				m_Graphics->HandleResize(GetWindow());
+			}
+			break;
+		default:
+			break;
+	}
 }
 
 SDL_Window* Application::GetWindow() const
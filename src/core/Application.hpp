@@ -2,6 +2,9 @@
 
 #include "pch.hpp"
 
+#include "core/FrameStatistics.hpp"
+#include "core/LaunchOptions.hpp"
+
 // Forward declarations
 class WindowSystem;
 class GraphicsSystem;
@@ -15,7 +18,7 @@ public:
 	~Application();
 
 	// Lifecycle methods
-	bool Init();
+	bool Init(const LaunchOptions& options = {});
 	void Update();
 	void Shutdown();
 	void HandleEvent(const SDL_Event& event);
@@ -53,11 +56,22 @@ public:
 		m_ShouldClose = true;
 	}
 
+private:
+	// Frame budget reached: write reports and request shutdown
+	void FinishTimedRun();
+
+	// Queues every .ktx2 and cooked .wtex file in the directory for streaming (sorted, so texture ids are stable)
+	void LoadTextures(const std::filesystem::path& directory);
+
 private:
 	std::unique_ptr<WindowSystem> m_Window;
 	std::unique_ptr<GraphicsSystem> m_Graphics;
 	std::unique_ptr<PhysicsSystem> m_Physics;
 	std::unique_ptr<TaskSchedulingSystem> m_TaskScheduling;
 
+	LaunchOptions m_Options;
+	FrameStatistics m_FrameStats;
+	uint32_t m_FramesRendered = 0;
+
 	bool m_ShouldClose = false;
 };
@@ -0,0 +1,232 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#include "core/BinaryLog.hpp"
+
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	// Keeps a rotation from happening every few messages
+	constexpr size_t kMinSegmentBytes = 1 << 20;
+
+	uint32_t GetRecordSize(size_t payloadBytes)
+	{
+		return static_cast<uint32_t>((sizeof(BinaryLogRecord) + payloadBytes + 7) & ~size_t(7));
+	}
+
+	// <stem>.<digits><extension>
+	bool IsSegmentOf(const std::string& fileName, const std::string& stem, const std::string& extension)
+	{
+		if (fileName.size() <= stem.size() + 1 + extension.size() || fileName.compare(0, stem.size(), stem) != 0 || fileName[stem.size()] != '.' || !fileName.ends_with(extension))
+			return false;
+		const auto first = fileName.begin() + static_cast<ptrdiff_t>(stem.size() + 1);
+		const auto last = fileName.end() - static_cast<ptrdiff_t>(extension.size());
+		return std::all_of(first, last, [](char c) { return c >= '0' && c <= '9'; });
+	}
+} // namespace
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+	Close();
+}
+
+bool BinaryLogWriter::Open(const std::filesystem::path& path, size_t segmentBytes, uint32_t segmentCount)
+{
+	Close();
+
+	m_Path = path;
+	m_SegmentBytes = std::max(segmentBytes, kMinSegmentBytes) & ~size_t(7);
+	m_SegmentCount = std::max(segmentCount, 1u);
+	m_SegmentIndex = 0;
+
+	// Segments left by an earlier run would decode as part of this one
+	const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::current_path();
+	const std::string stem = path.stem().string();
+	const std::string extension = GetSegmentPath(0).extension().string();
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+	for (const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator(directory, ec))
+	{
+		if (entry.is_regular_file() && IsSegmentOf(entry.path().filename().string(), stem, extension))
+		{
+			std::filesystem::remove(entry.path(), ec);
+		}
+	}
+
+	return OpenSegment();
+}
+
+void BinaryLogWriter::Close()
+{
+	CloseSegment();
+}
+
+void BinaryLogWriter::Write(LogLevel level, const char* format, uint64_t timestampNs, const uint8_t* args, uint32_t argBytes)
+{
+	if (m_Data == nullptr)
+		return;
+
+	const uint32_t messageBytes = GetRecordSize(argBytes);
+	std::unordered_map<const char*, uint32_t>::const_iterator known = m_FormatIds.find(format);
+	size_t formatLength = known == m_FormatIds.end() ? std::strlen(format) : 0;
+	uint32_t formatBytes = known == m_FormatIds.end() ? GetRecordSize(formatLength) : 0;
+
+	if (m_Used + formatBytes + messageBytes > m_SegmentBytes)
+	{
+		CloseSegment();
+		++m_SegmentIndex;
+		if (m_SegmentIndex >= m_SegmentCount)
+		{
+			std::error_code ec;
+			std::filesystem::remove(GetSegmentPath(m_SegmentIndex - m_SegmentCount), ec);
+		}
+		if (!OpenSegment())
+			return;
+
+		// The new segment starts with an empty format table
+		known = m_FormatIds.end();
+		formatLength = std::strlen(format);
+		formatBytes = GetRecordSize(formatLength);
+		if (m_Used + formatBytes + messageBytes > m_SegmentBytes)
+			return;
+	}
+
+	uint32_t formatId = 0;
+	if (known == m_FormatIds.end())
+	{
+		formatId = static_cast<uint32_t>(m_FormatIds.size());
+		m_FormatIds.emplace(format, formatId);
+		Append(BinaryLogRecordType::Format, level, formatId, 0, format, static_cast<uint32_t>(formatLength));
+	}
+	else
+	{
+		formatId = known->second;
+	}
+	Append(BinaryLogRecordType::Message, level, formatId, timestampNs, args, argBytes);
+}
+
+void BinaryLogWriter::Commit()
+{
+	if (m_Data == nullptr)
+		return;
+
+	const uint64_t usedBytes = m_Used;
+	std::memcpy(m_Data + offsetof(BinaryLogHeader, usedBytes), &usedBytes, sizeof(usedBytes));
+}
+
+bool BinaryLogWriter::OpenSegment()
+{
+	const std::filesystem::path path = GetSegmentPath(m_SegmentIndex);
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	// Sizing the mapping grows the file to the full segment
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(m_SegmentBytes) >> 32), static_cast<DWORD>(m_SegmentBytes), nullptr);
+	void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, m_SegmentBytes) : nullptr;
+	if (data == nullptr)
+	{
+		if (mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	m_File = file;
+	m_Mapping = mapping;
+#else
+	const int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return false;
+
+	void* data = ftruncate(file, static_cast<off_t>(m_SegmentBytes)) == 0 ? mmap(nullptr, m_SegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+	if (data == MAP_FAILED)
+	{
+		close(file);
+		return false;
+	}
+	m_File = file;
+#endif
+
+	m_Data = static_cast<uint8_t*>(data);
+	m_Used = sizeof(BinaryLogHeader);
+	m_FormatIds.clear();
+
+	BinaryLogHeader header;
+	header.segmentIndex = m_SegmentIndex;
+	header.usedBytes = m_Used;
+	header.startTimestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	header.startUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	std::memcpy(m_Data, &header, sizeof(header));
+	return true;
+}
+
+void BinaryLogWriter::CloseSegment()
+{
+	if (m_Data == nullptr)
+		return;
+
+	Commit();
+
+	// The unused tail of the mapping is cut off, so a quiet run leaves a small file
+#ifdef _WIN32
+	UnmapViewOfFile(m_Data);
+	CloseHandle(m_Mapping);
+	LARGE_INTEGER size;
+	size.QuadPart = static_cast<LONGLONG>(m_Used);
+	if (SetFilePointerEx(m_File, size, nullptr, FILE_BEGIN))
+		SetEndOfFile(m_File);
+	CloseHandle(m_File);
+	m_File = nullptr;
+	m_Mapping = nullptr;
+#else
+	munmap(m_Data, m_SegmentBytes);
+	[[maybe_unused]] const int truncated = ftruncate(m_File, static_cast<off_t>(m_Used));
+	close(m_File);
+	m_File = -1;
+#endif
+
+	m_Data = nullptr;
+	m_Used = 0;
+	m_FormatIds.clear();
+}
+
+std::filesystem::path BinaryLogWriter::GetSegmentPath(uint32_t index) const
+{
+	const std::string extension = m_Path.has_extension() ? m_Path.extension().string() : std::string(".wlog");
+	return m_Path.parent_path() / (m_Path.stem().string() + "." + std::to_string(index) + extension);
+}
+
+void BinaryLogWriter::Append(BinaryLogRecordType type, LogLevel level, uint32_t formatId, uint64_t timestampNs, const void* payload, uint32_t payloadBytes)
+{
+	BinaryLogRecord record{};
+	record.size = GetRecordSize(payloadBytes);
+	record.type = type;
+	record.level = static_cast<uint16_t>(level);
+	record.formatId = formatId;
+	record.payloadBytes = payloadBytes;
+	record.timestampNs = timestampNs;
+
+	uint8_t* destination = m_Data + m_Used;
+	std::memcpy(destination, &record, sizeof(record));
+	if (payloadBytes > 0)
+	{
+		std::memcpy(destination + sizeof(record), payload, payloadBytes);
+	}
+	m_Used += record.size;
+}
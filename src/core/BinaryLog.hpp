@@ -0,0 +1,92 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+#include <unordered_map>
+
+#include "core/Logger.hpp"
+
+// Binary log segments (.wlog), written by Logger::SetBinaryLog and turned back into text by WovenLogDecode.
+// Format strings are interned: the first message to use one in a segment writes the string under an id, and every
+// message stores only that id, a timestamp and its LogFormat-encoded arguments. Each segment has its own format
+// table, so any segment decodes on its own.
+// Layout: BinaryLogHeader, then 8-byte aligned BinaryLogRecords up to usedBytes.
+constexpr uint32_t BINARY_LOG_MAGIC = 0x474F4C57; // "WLOG"
+constexpr uint32_t BINARY_LOG_VERSION = 1;
+
+struct BinaryLogHeader
+{
+	uint32_t magic = BINARY_LOG_MAGIC;
+	uint32_t version = BINARY_LOG_VERSION;
+	uint32_t segmentIndex = 0;
+	uint32_t reserved = 0;
+	uint64_t usedBytes = 0;        // Header included. Updated after every drain pass, so a crashed run still decodes.
+	uint64_t startTimestampNs = 0; // Steady clock when the segment was opened
+	int64_t startUnixNs = 0;       // Wall clock at the same moment
+	uint64_t reserved2[3] = {};
+};
+
+static_assert(sizeof(BinaryLogHeader) == 64, "Binary log header is part of the file format");
+
+enum class BinaryLogRecordType : uint16_t
+{
+	Format = 1,  // Payload: the format string, no terminator
+	Message = 2, // Payload: the encoded arguments
+};
+
+struct BinaryLogRecord
+{
+	uint32_t size; // Record plus payload, rounded up to 8 bytes
+	BinaryLogRecordType type;
+	uint16_t level; // LogLevel, messages only
+	uint32_t formatId;
+	uint32_t payloadBytes;
+	uint64_t timestampNs; // Steady clock, messages only
+};
+
+static_assert(sizeof(BinaryLogRecord) == 24, "Binary log record is part of the file format");
+
+// Writes segments through a memory mapping of fixed size; a full segment is truncated to what it used and the next
+// one starts. Not thread-safe: Logger calls it with its sink lock held.
+class BinaryLogWriter
+{
+public:
+	~BinaryLogWriter();
+
+	// Segments are <stem>.<index><extension> next to path. Only the newest segmentCount are kept.
+	bool Open(const std::filesystem::path& path, size_t segmentBytes, uint32_t segmentCount);
+	void Close();
+	bool IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	void Write(LogLevel level, const char* format, uint64_t timestampNs, const uint8_t* args, uint32_t argBytes);
+	// Publishes usedBytes in the header for readers of a live or crashed log
+	void Commit();
+
+private:
+	bool OpenSegment();
+	void CloseSegment();
+	std::filesystem::path GetSegmentPath(uint32_t index) const;
+	void Append(BinaryLogRecordType type, LogLevel level, uint32_t formatId, uint64_t timestampNs, const void* payload, uint32_t payloadBytes);
+
+private:
+	std::filesystem::path m_Path;
+	size_t m_SegmentBytes = 0;
+	uint32_t m_SegmentCount = 0;
+	uint32_t m_SegmentIndex = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#else
+	int m_File = -1;
+#endif
+	uint8_t* m_Data = nullptr;
+	size_t m_Used = 0;
+
+	// Format pointer to id in the current segment
+	std::unordered_map<const char*, uint32_t> m_FormatIds;
+};
@@ -0,0 +1,220 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/FrameStatistics.hpp"
+#include "core/JsonWriter.hpp"
+#include "core/Logger.hpp"
+
+namespace
+{
+	// Nearest-rank percentile on a sorted sample set
+	double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+		const double rank = std::ceil(percentile / 100.0 * static_cast<double>(sorted.size()));
+		const size_t index = static_cast<size_t>(std::clamp(rank, 1.0, static_cast<double>(sorted.size()))) - 1;
+		return sorted[index];
+	}
+} // namespace
+
+void FrameStatistics::Reset(uint64_t firstFrame)
+{
+	m_FirstFrame = firstFrame;
+	m_Frames.clear();
+}
+
+void FrameStatistics::RecordCpuTime(uint64_t frameNumber, double milliseconds)
+{
+	if (FrameSample* sample = GetSample(frameNumber))
+	{
+		sample->cpuMs = milliseconds;
+	}
+}
+
+void FrameStatistics::RecordGpuTime(uint64_t frameNumber, double milliseconds)
+{
+	if (FrameSample* sample = GetSample(frameNumber))
+	{
+		sample->gpuMs = milliseconds;
+	}
+}
+
+void FrameStatistics::RecordDisplayLatency(uint64_t frameNumber, double presentMs, double frameMs)
+{
+	if (FrameSample* sample = GetSample(frameNumber))
+	{
+		sample->presentMs = presentMs;
+		sample->frameLatencyMs = frameMs;
+	}
+}
+
+FrameStatistics::FrameSample* FrameStatistics::GetSample(uint64_t frameNumber)
+{
+	if (frameNumber < m_FirstFrame)
+	{
+		return nullptr;
+	}
+
+	const size_t index = static_cast<size_t>(frameNumber - m_FirstFrame);
+	if (index >= m_Frames.size())
+	{
+		m_Frames.resize(index + 1);
+	}
+	return &m_Frames[index];
+}
+
+FrameStatistics::Summary FrameStatistics::SummarizeField(double FrameSample::* field) const
+{
+	std::vector<double> values;
+	values.reserve(m_Frames.size());
+	for (const FrameSample& sample: m_Frames)
+	{
+		if (sample.*field >= 0.0)
+			values.push_back(sample.*field);
+	}
+	return Summarize(std::move(values));
+}
+
+FrameStatistics::Summary FrameStatistics::SummarizeCpu() const
+{
+	return SummarizeField(&FrameSample::cpuMs);
+}
+
+FrameStatistics::Summary FrameStatistics::SummarizeGpu() const
+{
+	return SummarizeField(&FrameSample::gpuMs);
+}
+
+FrameStatistics::Summary FrameStatistics::SummarizePresentLatency() const
+{
+	return SummarizeField(&FrameSample::presentMs);
+}
+
+FrameStatistics::Summary FrameStatistics::SummarizeFrameLatency() const
+{
+	return SummarizeField(&FrameSample::frameLatencyMs);
+}
+
+FrameStatistics::Summary FrameStatistics::Summarize(std::vector<double> values)
+{
+	Summary summary;
+	if (values.empty())
+	{
+		return summary;
+	}
+
+	std::sort(values.begin(), values.end());
+	summary.count = values.size();
+	summary.min = values.front();
+	summary.max = values.back();
+
+	double sum = 0.0;
+	for (double value: values)
+	{
+		sum += value;
+	}
+	summary.mean = sum / static_cast<double>(values.size());
+
+	double variance = 0.0;
+	for (double value: values)
+	{
+		const double diff = value - summary.mean;
+		variance += diff * diff;
+	}
+	summary.stdDev = std::sqrt(variance / static_cast<double>(values.size()));
+
+	summary.p50 = Percentile(values, 50.0);
+	summary.p90 = Percentile(values, 90.0);
+	summary.p95 = Percentile(values, 95.0);
+	summary.p99 = Percentile(values, 99.0);
+	return summary;
+}
+
+void FrameStatistics::LogSummary() const
+{
+	const Summary cpu = SummarizeCpu();
+	const Summary gpu = SummarizeGpu();
+	WOVEN_LOG_INFO("Frames: %zu", m_Frames.size());
+	WOVEN_LOG_INFO("CPU ms: mean %.3f | p50 %.3f | p95 %.3f | p99 %.3f | max %.3f", cpu.mean, cpu.p50, cpu.p95, cpu.p99, cpu.max);
+	if (gpu.count > 0)
+	{
+		WOVEN_LOG_INFO("GPU ms: mean %.3f | p50 %.3f | p95 %.3f | p99 %.3f | max %.3f", gpu.mean, gpu.p50, gpu.p95, gpu.p99, gpu.max);
+	}
+	else
+	{
+		WOVEN_LOG_INFO("GPU ms: no timestamp data");
+	}
+
+	// Only windowed runs with VK_KHR_present_wait see their frames reach the screen
+	const Summary display = SummarizeFrameLatency();
+	if (display.count > 0)
+	{
+		const Summary present = SummarizePresentLatency();
+		WOVEN_LOG_INFO("Frame start to display ms: mean %.3f | p50 %.3f | p95 %.3f | p99 %.3f | max %.3f", display.mean, display.p50, display.p95, display.p99, display.max);
+		WOVEN_LOG_INFO("Present to display ms: mean %.3f | p50 %.3f | p95 %.3f | p99 %.3f | max %.3f", present.mean, present.p50, present.p95, present.p99, present.max);
+	}
+}
+
+void FrameStatistics::WriteSummaryJson(JsonWriter& writer, const Summary& summary)
+{
+	writer.BeginObject();
+	writer.Field("count", static_cast<uint64_t>(summary.count));
+	writer.Field("min", summary.min);
+	writer.Field("max", summary.max);
+	writer.Field("mean", summary.mean);
+	writer.Field("stdDev", summary.stdDev);
+	writer.Field("p50", summary.p50);
+	writer.Field("p90", summary.p90);
+	writer.Field("p95", summary.p95);
+	writer.Field("p99", summary.p99);
+	writer.EndObject();
+}
+
+void FrameStatistics::WriteJson(JsonWriter& writer) const
+{
+	writer.Key("cpu");
+	WriteSummaryJson(writer, SummarizeCpu());
+	writer.Key("gpu");
+	WriteSummaryJson(writer, SummarizeGpu());
+
+	const Summary frameLatency = SummarizeFrameLatency();
+	if (frameLatency.count > 0)
+	{
+		writer.Key("frameLatency");
+		WriteSummaryJson(writer, frameLatency);
+		writer.Key("presentLatency");
+		WriteSummaryJson(writer, SummarizePresentLatency());
+	}
+
+	// Raw samples so regressions can be re-analyzed offline (-1 = missing)
+	writer.Key("samples");
+	writer.BeginArray();
+	for (const FrameSample& sample: m_Frames)
+	{
+		writer.BeginArray();
+		writer.Value(sample.cpuMs);
+		writer.Value(sample.gpuMs);
+		writer.EndArray();
+	}
+	writer.EndArray();
+
+	// Same layout for display latency: [frameMs, presentMs] per frame
+	if (frameLatency.count > 0)
+	{
+		writer.Key("latencySamples");
+		writer.BeginArray();
+		for (const FrameSample& sample: m_Frames)
+		{
+			writer.BeginArray();
+			writer.Value(sample.frameLatencyMs);
+			writer.Value(sample.presentMs);
+			writer.EndArray();
+		}
+		writer.EndArray();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "pch.hpp"
+
+class JsonWriter;
+
+// Collects per-frame CPU/GPU timings and display latency for offline performance runs.
+// Samples are keyed by frame number because GPU timings and display latency resolve a few frames late.
+class FrameStatistics
+{
+public:
+	struct Summary
+	{
+		size_t count = 0;
+		double min = 0.0;
+		double max = 0.0;
+		double mean = 0.0;
+		double stdDev = 0.0;
+		double p50 = 0.0;
+		double p90 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+	};
+
+	// Discards all samples; frames before firstFrame are ignored from now on
+	void Reset(uint64_t firstFrame = 0);
+
+	void RecordCpuTime(uint64_t frameNumber, double milliseconds);
+	void RecordGpuTime(uint64_t frameNumber, double milliseconds);
+	// presentMs: present call to on screen, frameMs: start of the frame's CPU work to on screen
+	void RecordDisplayLatency(uint64_t frameNumber, double presentMs, double frameMs);
+
+	Summary SummarizeCpu() const;
+	Summary SummarizeGpu() const;
+	Summary SummarizePresentLatency() const;
+	Summary SummarizeFrameLatency() const;
+
+	size_t GetFrameCount() const
+	{
+		return m_Frames.size();
+	}
+
+	static Summary Summarize(std::vector<double> values);
+
+	void LogSummary() const;
+	void WriteJson(JsonWriter& writer) const;
+	static void WriteSummaryJson(JsonWriter& writer, const Summary& summary);
+
+private:
+	struct FrameSample
+	{
+		double cpuMs = -1.0;
+		double gpuMs = -1.0;
+		double presentMs = -1.0;
+		double frameLatencyMs = -1.0;
+	};
+
+	FrameSample* GetSample(uint64_t frameNumber);
+	// Every sample with the field recorded
+	Summary SummarizeField(double FrameSample::* field) const;
+
+private:
+	uint64_t m_FirstFrame = 0;
+	std::vector<FrameSample> m_Frames;
+};
@@ -0,0 +1,175 @@
+#include "pch.hpp"
+
+#include <cinttypes>
+#include <cmath>
+#include <fstream>
+
+#include "core/JsonWriter.hpp"
+
+void JsonWriter::BeginObject()
+{
+	BeginValue();
+	m_Buffer += '{';
+	m_ScopeHasItems.push_back(false);
+}
+
+void JsonWriter::EndObject()
+{
+	m_ScopeHasItems.pop_back();
+	m_Buffer += '}';
+}
+
+void JsonWriter::BeginArray()
+{
+	BeginValue();
+	m_Buffer += '[';
+	m_ScopeHasItems.push_back(false);
+}
+
+void JsonWriter::EndArray()
+{
+	m_ScopeHasItems.pop_back();
+	m_Buffer += ']';
+}
+
+void JsonWriter::Key(std::string_view key)
+{
+	BeginValue();
+	WriteEscaped(key);
+	m_Buffer += ':';
+	m_AfterKey = true;
+}
+
+void JsonWriter::Value(std::string_view value)
+{
+	BeginValue();
+	WriteEscaped(value);
+}
+
+void JsonWriter::Value(const char* value)
+{
+	Value(std::string_view(value ? value : ""));
+}
+
+void JsonWriter::Value(double value)
+{
+	BeginValue();
+
+	// JSON has no representation for NaN/Inf
+	if (!std::isfinite(value))
+	{
+		m_Buffer += "null";
+		return;
+	}
+
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+	m_Buffer += buffer;
+}
+
+void JsonWriter::Value(int32_t value)
+{
+	Value(static_cast<int64_t>(value));
+}
+
+void JsonWriter::Value(uint32_t value)
+{
+	Value(static_cast<uint64_t>(value));
+}
+
+void JsonWriter::Value(int64_t value)
+{
+	BeginValue();
+	char buffer[24];
+	std::snprintf(buffer, sizeof(buffer), "%" PRId64, value);
+	m_Buffer += buffer;
+}
+
+void JsonWriter::Value(uint64_t value)
+{
+	BeginValue();
+	char buffer[24];
+	std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+	m_Buffer += buffer;
+}
+
+void JsonWriter::Value(bool value)
+{
+	BeginValue();
+	m_Buffer += value ? "true" : "false";
+}
+
+bool JsonWriter::WriteToFile(const std::filesystem::path& path) const
+{
+	std::error_code ec;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), ec);
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	file.write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+	file.put('\n');
+	return file.good();
+}
+
+void JsonWriter::BeginValue()
+{
+	// Values directly after a key never take a separator
+	if (m_AfterKey)
+	{
+		m_AfterKey = false;
+		return;
+	}
+
+	if (!m_ScopeHasItems.empty())
+	{
+		if (m_ScopeHasItems.back())
+		{
+			m_Buffer += ',';
+		}
+		m_ScopeHasItems.back() = true;
+	}
+}
+
+void JsonWriter::WriteEscaped(std::string_view text)
+{
+	m_Buffer += '"';
+	for (char c: text)
+	{
+		switch (c)
+		{
+			case '"':
+				m_Buffer += "\\\"";
+				break;
+			case '\\':
+				m_Buffer += "\\\\";
+				break;
+			case '\n':
+				m_Buffer += "\\n";
+				break;
+			case '\r':
+				m_Buffer += "\\r";
+				break;
+			case '\t':
+				m_Buffer += "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char buffer[8];
+					std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+					m_Buffer += buffer;
+				}
+				else
+				{
+					m_Buffer += c;
+				}
+		}
+	}
+	m_Buffer += '"';
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+#include <string_view>
+
+// Minimal streaming JSON writer for machine-readable reports
+class JsonWriter
+{
+public:
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	void Key(std::string_view key);
+
+	void Value(std::string_view value);
+	void Value(const char* value);
+	void Value(double value);
+	void Value(int32_t value);
+	void Value(uint32_t value);
+	void Value(int64_t value);
+	void Value(uint64_t value);
+	void Value(bool value);
+
+	// Key + value in one call
+	template<typename T>
+	void Field(std::string_view key, const T& value)
+	{
+		Key(key);
+		Value(value);
+	}
+
+	const std::string& GetString() const
+	{
+		return m_Buffer;
+	}
+
+	bool WriteToFile(const std::filesystem::path& path) const;
+
+private:
+	void BeginValue();
+	void WriteEscaped(std::string_view text);
+
+private:
+	std::string m_Buffer;
+	std::vector<bool> m_ScopeHasItems;
+	bool m_AfterKey = false;
+};
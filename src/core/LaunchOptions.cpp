@@ -0,0 +1,150 @@
+#include "pch.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/LaunchOptions.hpp"
+#include "core/Logger.hpp"
+
+bool LaunchOptions::ParseUInt(const char* text, uint32_t& outValue)
+{
+	// strtoull skips whitespace and negates a leading '-', so "-1" would come back as a huge value
+	if (text[0] < '0' || text[0] > '9')
+	{
+		return false;
+	}
+
+	char* end = nullptr;
+	errno = 0;
+	const unsigned long long value = std::strtoull(text, &end, 10);
+	if (*end != '\0' || errno == ERANGE || value > UINT32_MAX)
+	{
+		return false;
+	}
+	outValue = static_cast<uint32_t>(value);
+	return true;
+}
+
+LaunchOptions LaunchOptions::Parse(int argc, char* argv[])
+{
+	LaunchOptions options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		if (std::strcmp(arg, "--headless") == 0)
+		{
+			options.headless = true;
+		}
+		else if (std::strcmp(arg, "--frames") == 0 && next)
+		{
+			if (!ParseUInt(next, options.frameCount))
+				WOVEN_LOG_WARNING("Invalid value for --frames: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--width") == 0 && next)
+		{
+			uint32_t width = 0;
+			if (ParseUInt(next, width) && width > 0)
+				options.width = width;
+			else
+				WOVEN_LOG_WARNING("Invalid value for --width: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--height") == 0 && next)
+		{
+			uint32_t height = 0;
+			if (ParseUInt(next, height) && height > 0)
+				options.height = height;
+			else
+				WOVEN_LOG_WARNING("Invalid value for --height: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--timing") == 0 && next)
+		{
+			options.timingReportPath = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--capture") == 0 && next)
+		{
+			options.captureImagePath = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--capture-frame") == 0 && next)
+		{
+			options.frameCapturePath = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--vma-stats") == 0 && next)
+		{
+			options.vmaStatsPath = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--vma-stats-interval") == 0 && next)
+		{
+			uint32_t interval = 0;
+			if (ParseUInt(next, interval) && interval > 0)
+				options.vmaStatsInterval = interval;
+			else
+				WOVEN_LOG_WARNING("Invalid value for --vma-stats-interval: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--instances") == 0 && next)
+		{
+			uint32_t count = 0;
+			if (ParseUInt(next, count) && count > 0)
+				options.instanceCount = count;
+			else
+				WOVEN_LOG_WARNING("Invalid value for --instances: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--descriptor-sets") == 0)
+		{
+			options.descriptorSets = true;
+		}
+		else if (std::strcmp(arg, "--textures") == 0 && next)
+		{
+			options.textureDir = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--texture-budget") == 0 && next)
+		{
+			uint32_t budget = 0;
+			if (ParseUInt(next, budget) && budget > 0)
+				options.textureBudgetMiB = budget;
+			else
+				WOVEN_LOG_WARNING("Invalid value for --texture-budget: %s", next);
+			++i;
+		}
+		else if (std::strcmp(arg, "--latency") == 0 && next)
+		{
+			options.latencyMode = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--log-file") == 0 && next)
+		{
+			options.logFilePath = next;
+			++i;
+		}
+		else if (std::strcmp(arg, "--log-binary") == 0 && next)
+		{
+			options.binaryLogPath = next;
+			++i;
+		}
+		else
+		{
+			WOVEN_LOG_WARNING("Ignoring unknown argument: %s", arg);
+		}
+	}
+
+	// A headless run without a frame budget would never finish
+	if (options.headless && options.frameCount == 0)
+	{
+		options.frameCount = 300;
+	}
+
+	return options;
+}
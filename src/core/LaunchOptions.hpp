@@ -0,0 +1,51 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+
+// Command line options that change how the application boots
+struct LaunchOptions
+{
+	// Headless mode renders into offscreen images (no window, no swapchain)
+	bool headless = false;
+	uint32_t width = 1920;
+	uint32_t height = 1080;
+
+	// Number of frames to render before exiting (0 = run until closed)
+	uint32_t frameCount = 0;
+
+	// Optional outputs written once frameCount frames have been rendered
+	std::filesystem::path timingReportPath;
+	std::filesystem::path captureImagePath;
+
+	// Frame capture (.wcap) of the last timed frame, or of the first frame when frameCount is 0
+	std::filesystem::path frameCapturePath;
+
+	// Periodic VMA statistics dump (overwritten every vmaStatsInterval frames)
+	std::filesystem::path vmaStatsPath;
+	uint32_t vmaStatsInterval = 600;
+
+	// Demo instances fed through GPU culling (1 = the single triangle at the origin)
+	uint32_t instanceCount = 1;
+
+	// Forces the bindless descriptor set path even when VK_EXT_descriptor_buffer is available
+	bool descriptorSets = false;
+
+	// Every .ktx2 / .wtex file in this directory is streamed and mapped onto the demo materials
+	std::filesystem::path textureDir;
+	uint32_t textureBudgetMiB = 256;
+
+	// vsync, low-latency or uncapped (empty keeps the renderer's default)
+	std::string latencyMode;
+
+	// Log lines are also written here, without colors
+	std::filesystem::path logFilePath;
+	// Binary log segments (.wlog); below warnings, messages then skip the text sinks
+	std::filesystem::path binaryLogPath;
+
+	static LaunchOptions Parse(int argc, char* argv[]);
+
+	// Whole decimal string that fits in 32 bits; no sign, whitespace or trailing characters
+	static bool ParseUInt(const char* text, uint32_t& outValue);
+};
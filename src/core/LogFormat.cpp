@@ -0,0 +1,437 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "core/LogFormat.hpp"
+
+namespace
+{
+	enum class Length : uint8_t
+	{
+		None,
+		Char,      // hh
+		Short,     // h
+		Long,      // l
+		LongLong,  // ll
+		IntMax,    // j
+		Size,      // z
+		PtrDiff,   // t
+		LongDouble // L
+	};
+
+	struct Spec
+	{
+		char flags[8] = {};
+		int width = -1;
+		int precision = -1;
+		bool widthFromArgs = false;
+		bool precisionFromArgs = false;
+		Length length = Length::None;
+		char conversion = 0;
+	};
+
+	// p points just past the '%'. Returns the character after the conversion, or nullptr for a spec we cannot type.
+	const char* ParseSpec(const char* p, Spec& spec)
+	{
+		size_t flagCount = 0;
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'')
+		{
+			if (flagCount + 1 < sizeof(spec.flags))
+				spec.flags[flagCount++] = *p;
+			++p;
+		}
+
+		if (*p == '*')
+		{
+			spec.widthFromArgs = true;
+			++p;
+		}
+		else
+		{
+			for (; *p >= '0' && *p <= '9'; ++p)
+				spec.width = (spec.width < 0 ? 0 : spec.width * 10) + (*p - '0');
+		}
+
+		if (*p == '.')
+		{
+			++p;
+			if (*p == '*')
+			{
+				spec.precisionFromArgs = true;
+				++p;
+			}
+			else
+			{
+				spec.precision = 0;
+				for (; *p >= '0' && *p <= '9'; ++p)
+					spec.precision = spec.precision * 10 + (*p - '0');
+			}
+		}
+
+		switch (*p)
+		{
+			case 'h':
+				spec.length = p[1] == 'h' ? Length::Char : Length::Short;
+				p += p[1] == 'h' ? 2 : 1;
+				break;
+			case 'l':
+				spec.length = p[1] == 'l' ? Length::LongLong : Length::Long;
+				p += p[1] == 'l' ? 2 : 1;
+				break;
+			case 'j':
+				spec.length = Length::IntMax;
+				++p;
+				break;
+			case 'z':
+				spec.length = Length::Size;
+				++p;
+				break;
+			case 't':
+				spec.length = Length::PtrDiff;
+				++p;
+				break;
+			case 'L':
+				spec.length = Length::LongDouble;
+				++p;
+				break;
+			default:
+				break;
+		}
+
+		switch (*p)
+		{
+			case 'd':
+			case 'i':
+			case 'o':
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+			case 'c':
+			case 's':
+			case 'p':
+			case 'n':
+			case '%':
+				spec.conversion = *p;
+				return p + 1;
+			default:
+				return nullptr;
+		}
+	}
+
+	void PutU64(std::vector<uint8_t>& out, uint64_t value)
+	{
+		const size_t offset = out.size();
+		out.resize(offset + sizeof(value));
+		std::memcpy(out.data() + offset, &value, sizeof(value));
+	}
+
+	void PutString(std::vector<uint8_t>& out, const char* text, size_t length)
+	{
+		const uint32_t length32 = static_cast<uint32_t>(length);
+		const size_t offset = out.size();
+		out.resize(offset + sizeof(length32) + length);
+		std::memcpy(out.data() + offset, &length32, sizeof(length32));
+		std::memcpy(out.data() + offset + sizeof(length32), text, length);
+	}
+
+	// Takes a real va_list object (not a parameter, which may have decayed to a pointer)
+	int64_t ReadSigned(Length length, va_list& args)
+	{
+		switch (length)
+		{
+			case Length::Char:
+				return static_cast<signed char>(va_arg(args, int));
+			case Length::Short:
+				return static_cast<short>(va_arg(args, int));
+			case Length::Long:
+				return va_arg(args, long);
+			case Length::LongLong:
+			case Length::LongDouble:
+				return va_arg(args, long long);
+			case Length::IntMax:
+				return va_arg(args, intmax_t);
+			case Length::Size:
+				return va_arg(args, std::make_signed_t<size_t>);
+			case Length::PtrDiff:
+				return va_arg(args, ptrdiff_t);
+			default:
+				return va_arg(args, int);
+		}
+	}
+
+	uint64_t ReadUnsigned(Length length, va_list& args)
+	{
+		switch (length)
+		{
+			case Length::Char:
+				return static_cast<unsigned char>(va_arg(args, unsigned int));
+			case Length::Short:
+				return static_cast<unsigned short>(va_arg(args, unsigned int));
+			case Length::Long:
+				return va_arg(args, unsigned long);
+			case Length::LongLong:
+			case Length::LongDouble:
+				return va_arg(args, unsigned long long);
+			case Length::IntMax:
+				return va_arg(args, uintmax_t);
+			case Length::Size:
+				return va_arg(args, size_t);
+			case Length::PtrDiff:
+				return va_arg(args, std::make_unsigned_t<ptrdiff_t>);
+			default:
+				return va_arg(args, unsigned int);
+		}
+	}
+
+	class ArgReader
+	{
+	public:
+		ArgReader(const uint8_t* data, size_t size)
+		      : m_Data(data), m_Size(size)
+		{
+		}
+
+		bool ReadU64(uint64_t& outValue)
+		{
+			if (m_Size - m_Offset < sizeof(outValue))
+				return false;
+			std::memcpy(&outValue, m_Data + m_Offset, sizeof(outValue));
+			m_Offset += sizeof(outValue);
+			return true;
+		}
+
+		bool ReadString(const char*& outText, uint32_t& outLength)
+		{
+			if (m_Size - m_Offset < sizeof(outLength))
+				return false;
+			std::memcpy(&outLength, m_Data + m_Offset, sizeof(outLength));
+			if (m_Size - m_Offset - sizeof(outLength) < outLength)
+				return false;
+			outText = reinterpret_cast<const char*>(m_Data + m_Offset + sizeof(outLength));
+			m_Offset += sizeof(outLength) + outLength;
+			return true;
+		}
+
+	private:
+		const uint8_t* m_Data;
+		size_t m_Size;
+		size_t m_Offset = 0;
+	};
+
+	void AppendFormatted(std::string& out, const char* spec, ...)
+	{
+		va_list args;
+		va_start(args, spec);
+		va_list sizing;
+		va_copy(sizing, args);
+		const int length = vsnprintf(nullptr, 0, spec, sizing);
+		va_end(sizing);
+		if (length > 0)
+		{
+			const size_t offset = out.size();
+			out.resize(offset + static_cast<size_t>(length));
+			vsnprintf(out.data() + offset, static_cast<size_t>(length) + 1, spec, args);
+		}
+		va_end(args);
+	}
+
+	// Rebuilds a single-argument spec with width and precision resolved. lengthModifier matches what was stored:
+	// "ll" for integers, nothing for doubles, ".*" for strings (which pass their stored length as the precision).
+	void BuildSpec(char* outSpec, size_t capacity, const Spec& spec, int width, int precision, const char* lengthModifier, char conversion)
+	{
+		char widthText[16] = {};
+		char precisionText[16] = {};
+		if (width >= 0 || spec.widthFromArgs)
+			snprintf(widthText, sizeof(widthText), "%d", width);
+		if (precision >= 0)
+			snprintf(precisionText, sizeof(precisionText), ".%d", precision);
+		snprintf(outSpec, capacity, "%%%s%s%s%s%c", spec.flags, widthText, precisionText, lengthModifier, conversion);
+	}
+} // namespace
+
+namespace LogFormat
+{
+	void EncodeArgs(const char* format, va_list args, std::vector<uint8_t>& outArgs, size_t maxStringBytes)
+	{
+		va_list local;
+		va_copy(local, args);
+
+		for (const char* p = std::strchr(format, '%'); p != nullptr; p = std::strchr(p, '%'))
+		{
+			Spec spec;
+			p = ParseSpec(p + 1, spec);
+			if (p == nullptr)
+				break;
+			if (spec.conversion == '%')
+				continue;
+
+			if (spec.widthFromArgs)
+				PutU64(outArgs, static_cast<uint64_t>(static_cast<int64_t>(va_arg(local, int))));
+			if (spec.precisionFromArgs)
+			{
+				spec.precision = va_arg(local, int);
+				PutU64(outArgs, static_cast<uint64_t>(static_cast<int64_t>(spec.precision)));
+			}
+
+			switch (spec.conversion)
+			{
+				case 'd':
+				case 'i':
+					PutU64(outArgs, static_cast<uint64_t>(ReadSigned(spec.length, local)));
+					break;
+				case 'o':
+				case 'u':
+				case 'x':
+				case 'X':
+					PutU64(outArgs, ReadUnsigned(spec.length, local));
+					break;
+				case 'c':
+					PutU64(outArgs, static_cast<uint64_t>(va_arg(local, int)));
+					break;
+				case 'p':
+					PutU64(outArgs, reinterpret_cast<uintptr_t>(va_arg(local, void*)));
+					break;
+				case 'n':
+					// Nothing is written back from a deferred format
+					va_arg(local, void*);
+					break;
+				case 's':
+				{
+					const char* text = "(unsupported wide string)";
+					if (spec.length == Length::Long)
+						va_arg(local, const wchar_t*);
+					else
+						text = va_arg(local, const char*);
+					if (text == nullptr)
+						text = "(null)";
+
+					// Precision bounds the read too: %.*s is often used on strings that are not NUL-terminated
+					size_t length = spec.precision >= 0 ? strnlen(text, static_cast<size_t>(spec.precision)) : std::strlen(text);
+					length = std::min(length, maxStringBytes);
+					maxStringBytes -= length;
+					PutString(outArgs, text, length);
+					break;
+				}
+				default:
+				{
+					const double value = spec.length == Length::LongDouble ? static_cast<double>(va_arg(local, long double)) : va_arg(local, double);
+					uint64_t bits = 0;
+					std::memcpy(&bits, &value, sizeof(bits));
+					PutU64(outArgs, bits);
+					break;
+				}
+			}
+		}
+
+		va_end(local);
+	}
+
+	bool FormatArgs(const char* format, const uint8_t* args, size_t argBytes, std::string& outText)
+	{
+		ArgReader reader(args, argBytes);
+		char specText[64];
+
+		const char* literal = format;
+		for (const char* p = format; *p != '\0'; ++p)
+		{
+			if (*p != '%')
+				continue;
+
+			Spec spec;
+			const char* end = ParseSpec(p + 1, spec);
+			if (end == nullptr)
+				break;
+
+			outText.append(literal, p);
+			literal = end;
+			p = end - 1;
+			if (spec.conversion == '%')
+			{
+				outText.push_back('%');
+				continue;
+			}
+
+			uint64_t value = 0;
+			if (spec.widthFromArgs)
+			{
+				if (!reader.ReadU64(value))
+					return false;
+				spec.width = static_cast<int>(static_cast<int64_t>(value));
+			}
+			if (spec.precisionFromArgs)
+			{
+				if (!reader.ReadU64(value))
+					return false;
+				spec.precision = static_cast<int>(static_cast<int64_t>(value));
+			}
+
+			switch (spec.conversion)
+			{
+				case 'n':
+					break;
+				case 's':
+				{
+					const char* text = nullptr;
+					uint32_t length = 0;
+					if (!reader.ReadString(text, length))
+						return false;
+					BuildSpec(specText, sizeof(specText), spec, spec.width, -1, ".*", 's');
+					AppendFormatted(outText, specText, static_cast<int>(length), text);
+					break;
+				}
+				case 'c':
+				case 'p':
+				case 'd':
+				case 'i':
+				case 'o':
+				case 'u':
+				case 'x':
+				case 'X':
+					if (!reader.ReadU64(value))
+						return false;
+					if (spec.conversion == 'c')
+					{
+						BuildSpec(specText, sizeof(specText), spec, spec.width, -1, "", 'c');
+						AppendFormatted(outText, specText, static_cast<int>(value));
+					}
+					else if (spec.conversion == 'p')
+					{
+						BuildSpec(specText, sizeof(specText), spec, spec.width, -1, "", 'p');
+						AppendFormatted(outText, specText, reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+					}
+					else
+					{
+						BuildSpec(specText, sizeof(specText), spec, spec.width, spec.precision, "ll", spec.conversion);
+						if (spec.conversion == 'd' || spec.conversion == 'i')
+							AppendFormatted(outText, specText, static_cast<long long>(value));
+						else
+							AppendFormatted(outText, specText, static_cast<unsigned long long>(value));
+					}
+					break;
+				default:
+				{
+					if (!reader.ReadU64(value))
+						return false;
+					double number = 0.0;
+					std::memcpy(&number, &value, sizeof(number));
+					BuildSpec(specText, sizeof(specText), spec, spec.width, spec.precision, "", spec.conversion);
+					AppendFormatted(outText, specText, number);
+					break;
+				}
+			}
+		}
+
+		outText.append(literal);
+		return true;
+	}
+} // namespace LogFormat
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <cstdarg>
+
+// Printf arguments captured at the call site so the text can be built later, on the log drain thread.
+// Encoding walks the format string once and copies each argument: integers widened to 8 bytes, floating point as
+// double, pointers as 8 bytes, strings inline (32-bit length, then the bytes, cut to their precision). Formatting
+// walks the same format string over those bytes, so the two must see the same pointer-stable format literal.
+namespace LogFormat
+{
+	// Appends the encoded arguments to outArgs. Strings share a budget of maxStringBytes; past it they are cut.
+	void EncodeArgs(const char* format, va_list args, std::vector<uint8_t>& outArgs, size_t maxStringBytes);
+
+	// Appends the formatted text to outText. Returns false (keeping what was formatted) if the bytes run out.
+	bool FormatArgs(const char* format, const uint8_t* args, size_t argBytes, std::string& outText);
+} // namespace LogFormat
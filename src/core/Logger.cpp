@@ -1,9 +1,18 @@
 #include "pch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <thread>
 
 #include "Logger.hpp"
+#include "core/BinaryLog.hpp"
+#include "core/LogFormat.hpp"
 
 #ifdef _WIN32
 #	include <Windows.h>
@@ -17,7 +26,6 @@ namespace Color
 	constexpr const char* Cyan = "\033[96m";
 	constexpr const char* Yellow = "\033[93m";
 	constexpr const char* Red = "\033[91m";
-	constexpr const char* Blue = "\033[94m";
 } // namespace Color
 
 // Fast string matching helpers
@@ -26,6 +34,354 @@ static inline bool contains(const char* str, const char* substr)
 	return strstr(str, substr) != nullptr;
 }
 
+namespace
+{
+	// Per-thread ring, allocated on a thread's first log call. A thread that fills it waits for the drain.
+	constexpr size_t kRingBytes = 1 << 20;
+	// Strings in one message share this budget; past it they are cut
+	constexpr size_t kMaxStringBytes = 64 * 1024;
+	// An idle drain polls this often. Errors and rings past half full wake it at once.
+	constexpr auto kDrainInterval = std::chrono::milliseconds(2);
+	// Binary mode keeps the newest kBinarySegmentCount segments of this size
+	constexpr size_t kBinarySegmentBytes = 64 << 20;
+	constexpr uint32_t kBinarySegmentCount = 4;
+
+	struct LevelStyle
+	{
+		const char* color;
+		const char* prefix;
+		uint32_t tracyColor;
+	};
+
+	constexpr LevelStyle kLevelStyles[] = {
+		{ Color::Gray, "[DEBUG]", 0x808080 },
+		{ Color::Cyan, "[INFO] ", 0x55FFFF },
+		{ Color::Yellow, "[WARN] ", 0xFFFF55 },
+		{ Color::Red, "[ERROR]", 0xFF5555 },
+	};
+
+	// One message in a ring, followed by its encoded arguments (LogFormat). A null format marks padding to the
+	// end of the ring; when fewer bytes than a header are left there, the reader skips them without one.
+	struct RecordHeader
+	{
+		uint32_t size; // Header plus arguments, rounded up to 8 bytes
+		uint32_t argBytes;
+		uint64_t timestamp; // Steady clock ns; orders messages across threads
+		const char* format;
+		LogLevel level;
+	};
+
+	// Single producer (the owning thread), single consumer (the drain thread)
+	struct ThreadRing
+	{
+		std::unique_ptr<uint8_t[]> data = std::make_unique<uint8_t[]>(kRingBytes);
+		alignas(64) std::atomic<uint64_t> head{ 0 };
+		alignas(64) std::atomic<uint64_t> tail{ 0 };
+		std::atomic<bool> retired{ false }; // The owning thread has exited; freed once drained
+	};
+
+	struct RingOwner
+	{
+		ThreadRing* ring = nullptr;
+
+		~RingOwner()
+		{
+			if (ring != nullptr)
+			{
+				ring->retired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	struct PendingRecord
+	{
+		RecordHeader header;
+		const uint8_t* args;
+	};
+
+	FILE* s_Output = stdout;
+	FILE* s_LogFile = nullptr;
+	BinaryLogWriter s_BinaryLog;
+	std::mutex s_SinkMutex;
+
+	std::mutex s_RingsMutex;
+	std::vector<std::unique_ptr<ThreadRing>> s_Rings;
+
+	std::atomic<bool> s_Running{ false };
+	std::thread s_DrainThread;
+	std::mutex s_DrainMutex;
+	std::mutex s_DrainPassMutex; // One DrainRings at a time: the drain thread, Shutdown or a producer racing it
+	std::condition_variable s_DrainWake;
+	std::condition_variable s_FlushDone;
+	bool s_StopRequested = false;
+	bool s_WakeRequested = false;
+	bool s_DrainExited = true;
+	uint64_t s_FlushRequested = 0;
+	uint64_t s_FlushCompleted = 0;
+	bool s_ExitHookRegistered = false;
+
+	thread_local RingOwner t_Ring;
+	thread_local std::vector<uint8_t> t_Args;
+
+	uint64_t GetTimestamp()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	ThreadRing& GetThreadRing()
+	{
+		if (t_Ring.ring == nullptr)
+		{
+			std::unique_ptr<ThreadRing> ring = std::make_unique<ThreadRing>();
+			t_Ring.ring = ring.get();
+			std::lock_guard<std::mutex> lock(s_RingsMutex);
+			s_Rings.push_back(std::move(ring));
+		}
+		return *t_Ring.ring;
+	}
+
+	void WakeDrain()
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_DrainMutex);
+			s_WakeRequested = true;
+		}
+		s_DrainWake.notify_one();
+	}
+
+	void DrainOnce();
+
+	// False if the message cannot go through the ring (too large, or the drain stopped while waiting for space)
+	bool Push(LogLevel level, const char* format, const std::vector<uint8_t>& args)
+	{
+		const size_t size = (sizeof(RecordHeader) + args.size() + 7) & ~size_t(7);
+		if (size > kRingBytes / 4)
+			return false;
+
+		ThreadRing& ring = GetThreadRing();
+		const uint64_t head = ring.head.load(std::memory_order_relaxed);
+		const size_t offset = head & (kRingBytes - 1);
+		const size_t contiguous = kRingBytes - offset;
+		const size_t padding = contiguous < size ? contiguous : 0;
+		const uint64_t newHead = head + padding + size;
+
+		uint64_t tail = ring.tail.load(std::memory_order_acquire);
+		while (newHead - tail > kRingBytes)
+		{
+			if (!s_Running.load(std::memory_order_acquire))
+				return false;
+			WakeDrain();
+			std::this_thread::yield();
+			tail = ring.tail.load(std::memory_order_acquire);
+		}
+
+		if (padding >= sizeof(RecordHeader))
+		{
+			RecordHeader marker{};
+			marker.size = static_cast<uint32_t>(padding);
+			std::memcpy(ring.data.get() + offset, &marker, sizeof(marker));
+		}
+
+		RecordHeader header{};
+		header.size = static_cast<uint32_t>(size);
+		header.argBytes = static_cast<uint32_t>(args.size());
+		header.timestamp = GetTimestamp();
+		header.format = format;
+		header.level = level;
+		uint8_t* record = ring.data.get() + ((head + padding) & (kRingBytes - 1));
+		std::memcpy(record, &header, sizeof(header));
+		if (!args.empty())
+		{
+			std::memcpy(record + sizeof(header), args.data(), args.size());
+		}
+		ring.head.store(newHead, std::memory_order_release);
+
+		// Shutdown may have made its final pass between the caller's s_Running check and the store above. This
+		// fence pairs with the one in Shutdown: either that pass sees the record, or this thread sees s_Running
+		// cleared and writes the record itself.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!s_Running.load(std::memory_order_relaxed))
+		{
+			DrainOnce();
+			return true;
+		}
+
+		if (level == LogLevel::Error || newHead - tail > kRingBytes / 2)
+		{
+			WakeDrain();
+		}
+		return true;
+	}
+
+	// Caller holds s_SinkMutex
+	void Emit(LogLevel level, const std::string& text)
+	{
+		const LevelStyle& style = kLevelStyles[static_cast<size_t>(level)];
+		fprintf(s_Output, "%s%s%s %s\n", style.color, style.prefix, Color::Reset, text.c_str());
+		if (s_LogFile != nullptr)
+		{
+			fprintf(s_LogFile, "%s %s\n", style.prefix, text.c_str());
+		}
+		TracyMessageC(text.data(), text.size(), style.tracyColor);
+	}
+
+	// Caller holds s_SinkMutex. Returns true if the message still needs formatting for the text sinks.
+	bool WriteBinary(LogLevel level, const char* format, uint64_t timestamp, const uint8_t* args, uint32_t argBytes)
+	{
+		if (!s_BinaryLog.IsOpen())
+			return true;
+
+		s_BinaryLog.Write(level, format, timestamp, args, argBytes);
+		if (!s_BinaryLog.IsOpen())
+		{
+			// The next segment could not be created; everything goes back to the text sinks
+			Emit(LogLevel::Error, "Binary log stopped: could not open its next segment");
+			return true;
+		}
+		return level >= LogLevel::Warning;
+	}
+
+	void FlushSinks()
+	{
+		fflush(s_Output);
+		if (s_LogFile != nullptr)
+		{
+			fflush(s_LogFile);
+		}
+	}
+
+	void DrainRings(std::vector<ThreadRing*>& rings, std::vector<uint64_t>& heads, std::vector<PendingRecord>& pending, std::string& text)
+	{
+		std::lock_guard<std::mutex> passLock(s_DrainPassMutex);
+		rings.clear();
+		{
+			std::lock_guard<std::mutex> lock(s_RingsMutex);
+			std::erase_if(s_Rings, [](const std::unique_ptr<ThreadRing>& ring)
+			{
+				return ring->retired.load(std::memory_order_acquire) && ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed);
+			});
+			for (const std::unique_ptr<ThreadRing>& ring: s_Rings)
+			{
+				rings.push_back(ring.get());
+			}
+		}
+
+		// Records stay in place until they are written, then each ring's tail jumps to the head read here
+		heads.clear();
+		pending.clear();
+		for (ThreadRing* ring: rings)
+		{
+			const uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t position = ring->tail.load(std::memory_order_relaxed);
+			while (position < head)
+			{
+				const size_t offset = position & (kRingBytes - 1);
+				if (kRingBytes - offset < sizeof(RecordHeader))
+				{
+					position += kRingBytes - offset;
+					continue;
+				}
+
+				PendingRecord record;
+				std::memcpy(&record.header, ring->data.get() + offset, sizeof(RecordHeader));
+				record.args = ring->data.get() + offset + sizeof(RecordHeader);
+				position += record.header.size;
+				if (record.header.format != nullptr)
+				{
+					pending.push_back(record);
+				}
+			}
+			heads.push_back(head);
+		}
+
+		if (!pending.empty())
+		{
+			ZoneScopedN("Logger::Drain");
+
+			// Each ring is already in order; merging by timestamp interleaves threads the way they logged
+			std::stable_sort(pending.begin(), pending.end(), [](const PendingRecord& a, const PendingRecord& b)
+			{
+				return a.header.timestamp < b.header.timestamp;
+			});
+
+			std::lock_guard<std::mutex> lock(s_SinkMutex);
+			for (const PendingRecord& record: pending)
+			{
+				if (!WriteBinary(record.header.level, record.header.format, record.header.timestamp, record.args, record.header.argBytes))
+					continue;
+
+				text.clear();
+				if (!LogFormat::FormatArgs(record.header.format, record.args, record.header.argBytes, text))
+				{
+					text += " [bad log arguments]";
+				}
+				Emit(record.header.level, text);
+			}
+			s_BinaryLog.Commit();
+			FlushSinks();
+		}
+
+		for (size_t i = 0; i < rings.size(); ++i)
+		{
+			rings[i]->tail.store(heads[i], std::memory_order_release);
+		}
+	}
+
+	// One pass on the calling thread, once the drain thread is gone
+	void DrainOnce()
+	{
+		std::vector<ThreadRing*> rings;
+		std::vector<uint64_t> heads;
+		std::vector<PendingRecord> pending;
+		std::string text;
+		DrainRings(rings, heads, pending, text);
+	}
+
+	// A tool returning from main without Logger::Shutdown would otherwise destroy a joinable std::thread during
+	// static destruction (std::terminate) and lose the queued lines explaining the exit. Registered after the
+	// statics above and Tracy's profiler are constructed, so it runs before they are destroyed.
+	void ShutdownAtExit()
+	{
+		if (s_DrainThread.joinable())
+		{
+			Logger::Shutdown();
+		}
+	}
+
+	void DrainLoop()
+	{
+		tracy::SetThreadName("Log Drain");
+
+		std::vector<ThreadRing*> rings;
+		std::vector<uint64_t> heads;
+		std::vector<PendingRecord> pending;
+		std::string text;
+
+		std::unique_lock<std::mutex> lock(s_DrainMutex);
+		while (true)
+		{
+			// Everything logged before these were read is in the rings, so one pass covers it
+			const uint64_t flushTicket = s_FlushRequested;
+			const bool stop = s_StopRequested;
+			s_WakeRequested = false;
+			lock.unlock();
+
+			DrainRings(rings, heads, pending, text);
+
+			lock.lock();
+			s_FlushCompleted = flushTicket;
+			if (stop)
+			{
+				s_DrainExited = true;
+				s_FlushDone.notify_all();
+				return;
+			}
+			s_FlushDone.notify_all();
+			s_DrainWake.wait_for(lock, kDrainInterval, [] { return s_StopRequested || s_WakeRequested || s_FlushRequested != s_FlushCompleted; });
+		}
+	}
+} // namespace
+
 void Logger::Init()
 {
 	// Enable ANSI color codes on Windows
@@ -43,86 +399,175 @@ void Logger::Init()
 	}
 #endif
 
-	printf("%s=== Woven Core ===%s\n\n", Color::Cyan, Color::Reset);
-	fflush(stdout);
+	fprintf(s_Output, "%s=== Woven Core ===%s\n\n", Color::Cyan, Color::Reset);
+	fflush(s_Output);
+
+	if (!s_ExitHookRegistered)
+	{
+		std::atexit(ShutdownAtExit);
+		s_ExitHookRegistered = true;
+	}
+
+	if (s_DrainThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_DrainMutex);
+		s_StopRequested = false;
+		s_DrainExited = false;
+	}
+	s_Running.store(true, std::memory_order_release);
+	s_DrainThread = std::thread(DrainLoop);
 }
 
 void Logger::Shutdown()
 {
-	printf("\n%s=== Shutdown Complete ===%s\n", Color::Gray, Color::Reset);
+	// Later calls format on the caller; the drain's last pass writes whatever is still queued
+	s_Running.store(false, std::memory_order_seq_cst);
+	if (s_DrainThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_DrainMutex);
+			s_StopRequested = true;
+		}
+		s_DrainWake.notify_one();
+		s_DrainThread.join();
+	}
+
+	// Records published after the drain's last pass by callers that saw s_Running before it was cleared (see Push)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	DrainOnce();
+
+	std::lock_guard<std::mutex> lock(s_SinkMutex);
+	fprintf(s_Output, "\n%s=== Shutdown Complete ===%s\n", Color::Gray, Color::Reset);
+	FlushSinks();
+	if (s_LogFile != nullptr)
+	{
+		fclose(s_LogFile);
+		s_LogFile = nullptr;
+	}
+	s_BinaryLog.Close();
 }
 
-void Logger::LogFormatted(LogLevel level, const char* format, va_list args)
+void Logger::Flush()
 {
-	const char* color;
-	const char* prefix;
-
-	switch (level)
-	{
-		case LogLevel::Debug:
-			color = Color::Gray;
-			prefix = "[DEBUG]";
-			break;
-		case LogLevel::Info:
-			color = Color::Cyan;
-			prefix = "[INFO] ";
-			break;
-		case LogLevel::Warning:
-			color = Color::Yellow;
-			prefix = "[WARN] ";
-			break;
-		case LogLevel::Error:
-			color = Color::Red;
-			prefix = "[ERROR]";
-			break;
-	}
-
-	printf("%s%s%s ", color, prefix, Color::Reset);
-	vprintf(format, args);
-	putchar('\n');
+	if (s_Running.load(std::memory_order_acquire))
+	{
+		std::unique_lock<std::mutex> lock(s_DrainMutex);
+		const uint64_t ticket = ++s_FlushRequested;
+		s_DrainWake.notify_one();
+		s_FlushDone.wait(lock, [ticket] { return s_FlushCompleted >= ticket || s_DrainExited; });
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_SinkMutex);
+	FlushSinks();
 }
 
-void Logger::Debug(const char* format, ...)
+void Logger::SetOutputStream(FILE* stream)
 {
-#ifndef NDEBUG
-	va_list args;
-	va_start(args, format);
-	LogFormatted(LogLevel::Debug, format, args);
-	va_end(args);
-#endif
+	Flush();
+	std::lock_guard<std::mutex> lock(s_SinkMutex);
+	s_Output = stream ? stream : stdout;
 }
 
-void Logger::Info(const char* format, ...)
+bool Logger::SetLogFile(const std::filesystem::path& path)
 {
-	va_list args;
-	va_start(args, format);
-	LogFormatted(LogLevel::Info, format, args);
-	va_end(args);
+	Flush();
+	FILE* file = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(s_SinkMutex);
+		if (s_LogFile != nullptr)
+		{
+			fclose(s_LogFile);
+			s_LogFile = nullptr;
+		}
+		if (path.empty())
+			return true;
+
+		file = fopen(path.string().c_str(), "w");
+		s_LogFile = file;
+	}
+
+	if (file == nullptr)
+	{
+		Error("Failed to open log file: %s", path.string().c_str());
+		return false;
+	}
+	return true;
 }
 
-void Logger::Warning(const char* format, ...)
+bool Logger::SetBinaryLog(const std::filesystem::path& path)
 {
-	va_list args;
-	va_start(args, format);
-	LogFormatted(LogLevel::Warning, format, args);
-	va_end(args);
+	Flush();
+	bool opened = true;
+	{
+		std::lock_guard<std::mutex> lock(s_SinkMutex);
+		s_BinaryLog.Close();
+		if (!path.empty())
+			opened = s_BinaryLog.Open(path, kBinarySegmentBytes, kBinarySegmentCount);
+	}
+
+	if (!opened)
+	{
+		Error("Failed to open binary log: %s", path.string().c_str());
+		return false;
+	}
+	return true;
 }
 
-void Logger::Error(const char* format, ...)
+void Logger::Log(LogLevel level, const char* format, ...)
 {
 	va_list args;
 	va_start(args, format);
-	LogFormatted(LogLevel::Error, format, args);
+	LogFormatted(level, format, args);
 	va_end(args);
 }
 
+void Logger::LogFormatted(LogLevel level, const char* format, va_list args)
+{
+	std::vector<uint8_t>& encoded = t_Args;
+	encoded.clear();
+	LogFormat::EncodeArgs(format, args, encoded, kMaxStringBytes);
+
+	if (s_Running.load(std::memory_order_acquire))
+	{
+		if (Push(level, format, encoded))
+			return;
+
+		// Keeps the order with what is already queued
+		Flush();
+	}
+
+	std::lock_guard<std::mutex> lock(s_SinkMutex);
+	if (!WriteBinary(level, format, GetTimestamp(), encoded.data(), static_cast<uint32_t>(encoded.size())))
+	{
+		s_BinaryLog.Commit();
+		return;
+	}
+
+	// EncodeArgs worked on a copy, so args is still unread here
+	va_list sizing;
+	va_copy(sizing, args);
+	const int length = vsnprintf(nullptr, 0, format, sizing);
+	va_end(sizing);
+
+	std::string text(length > 0 ? static_cast<size_t>(length) : 0, '\0');
+	if (length > 0)
+	{
+		vsnprintf(text.data(), text.size() + 1, format, args);
+	}
+	Emit(level, text);
+}
+
 void Logger::VulkanError(const char* message)
 {
-	printf("%s[ERROR] Vulkan%s\n  %s\n\n", Color::Red, Color::Reset, message);
+	Log(LogLevel::Error, "Vulkan\n  %s\n", message);
 }
 
-void Logger::VulkanWarning(const char* message)
+void Logger::VulkanWarning([[maybe_unused]] const char* message)
 {
+#if WOVEN_LOG_LEVEL <= 2
 	// Fast filter: check first character for common patterns
 	char first = message[0];
 
@@ -136,16 +581,19 @@ void Logger::VulkanWarning(const char* message)
 	if (first == 'v' && contains(message, "validation is adjusting settings"))
 		return;
 
-	printf("%s[WARN]  Vulkan%s\n  %s\n\n", Color::Yellow, Color::Reset, message);
+	Log(LogLevel::Warning, "Vulkan\n  %s\n", message);
+#endif
 }
 
-void Logger::VulkanInfo(const char* message)
+void Logger::VulkanInfo([[maybe_unused]] const char* message)
 {
+#if WOVEN_LOG_LEVEL <= 1
 	// Only show shader debugPrintfEXT() output
 	// Fast check: DEBUG-PRINTF starts with 'D'
 	if (message[0] == 'D' && contains(message, "DEBUG-PRINTF"))
 	{
-		printf("%s[INFO]  Vulkan DebugPrintf%s\n  %s\n\n", Color::Blue, Color::Reset, message);
+		Log(LogLevel::Info, "Vulkan DebugPrintf\n  %s\n", message);
 	}
 	// Suppress all loader spam
+#endif
 }
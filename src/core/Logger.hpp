@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdarg>
+#include <cstdio>
+#include <filesystem>
 
 enum class LogLevel
 {
@@ -10,6 +12,15 @@ enum class LogLevel
 	Error
 };
 
+// WOVEN_LOG_* calls below this level compile to nothing (0 = Debug ... 3 = Error). Override with -DWOVEN_LOG_LEVEL=N.
+#ifndef WOVEN_LOG_LEVEL
+#	ifdef NDEBUG
+#		define WOVEN_LOG_LEVEL 1
+#	else
+#		define WOVEN_LOG_LEVEL 0
+#	endif
+#endif
+
 // Format checking attributes (compiler-specific)
 #if defined(__GNUC__) || defined(__clang__)
 #	define LOGGER_PRINTF_FORMAT(fmt_idx, arg_idx) __attribute__((format(printf, fmt_idx, arg_idx)))
@@ -17,23 +28,95 @@ enum class LogLevel
 #	define LOGGER_PRINTF_FORMAT(fmt_idx, arg_idx)
 #endif
 
+// Asynchronous logger. A call copies its format pointer and arguments into the calling thread's ring buffer and
+// returns; a drain thread formats the text and writes it to the sinks (console, optional file, Tracy messages),
+// or in binary mode copies the raw arguments to a log file.
+// Format strings must be literals (or otherwise outlive the drain), since only the pointer is queued.
+// Before Init and after Shutdown every call formats and writes synchronously.
 class Logger
 {
 public:
 	static void Init();
 	static void Shutdown();
 
-	// Variadic logging (handles both plain strings and formatted output)
+	// Blocks until everything logged before the call has reached the sinks
+	static void Flush();
+
+	// Redirects console output (defaults to stdout). Flushes first.
+	static void SetOutputStream(FILE* stream);
+	// Also writes plain (uncolored) lines to this file; an empty path closes it
+	static bool SetLogFile(const std::filesystem::path& path);
+	// Binary mode: every message goes unformatted to rotating .wlog segments (BinaryLog, decoded by WovenLogDecode),
+	// and only warnings and errors are still formatted for the other sinks. An empty path returns to text.
+	static bool SetBinaryLog(const std::filesystem::path& path);
+
+	// Variadic logging (handles both plain strings and formatted output). Call these through the WOVEN_LOG_*
+	// macros below, which apply WOVEN_LOG_LEVEL.
 	static void Debug(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
 	static void Info(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
 	static void Warning(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
 	static void Error(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
 
-	// Vulkan-specific
+	// Vulkan-specific; warnings and info follow WOVEN_LOG_LEVEL too
 	static void VulkanError(const char* message);
 	static void VulkanWarning(const char* message);
 	static void VulkanInfo(const char* message);
 
 private:
+	static void Log(LogLevel level, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
 	static void LogFormatted(LogLevel level, const char* format, va_list args);
 };
+
+// Defined here so a call goes straight to LogFormatted
+inline void Logger::Debug(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogFormatted(LogLevel::Debug, format, args);
+	va_end(args);
+}
+
+inline void Logger::Info(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogFormatted(LogLevel::Info, format, args);
+	va_end(args);
+}
+
+inline void Logger::Warning(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogFormatted(LogLevel::Warning, format, args);
+	va_end(args);
+}
+
+inline void Logger::Error(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogFormatted(LogLevel::Error, format, args);
+	va_end(args);
+}
+
+// A filtered call is discarded whole, so its arguments are never evaluated; the format is still checked.
+#define WOVEN_LOG_DEBUG(...) \
+	do \
+	{ \
+		if constexpr (WOVEN_LOG_LEVEL <= 0) \
+			Logger::Debug(__VA_ARGS__); \
+	} while (0)
+#define WOVEN_LOG_INFO(...) \
+	do \
+	{ \
+		if constexpr (WOVEN_LOG_LEVEL <= 1) \
+			Logger::Info(__VA_ARGS__); \
+	} while (0)
+#define WOVEN_LOG_WARNING(...) \
+	do \
+	{ \
+		if constexpr (WOVEN_LOG_LEVEL <= 2) \
+			Logger::Warning(__VA_ARGS__); \
+	} while (0)
+#define WOVEN_LOG_ERROR(...) Logger::Error(__VA_ARGS__)
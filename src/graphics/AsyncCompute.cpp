@@ -0,0 +1,230 @@
+#include "pch.hpp"
+
+#include <iterator>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/AsyncCompute.hpp"
+
+namespace
+{
+	void RecordBufferBarriers(VkCommandBuffer cmd, const VkBuffer* buffers, uint32_t count, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer)
+	{
+		VkBufferMemoryBarrier2 barriers[4] = {};
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.pBufferMemoryBarriers = barriers;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			VkBufferMemoryBarrier2& barrier = barriers[depInfo.bufferMemoryBarrierCount];
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+			barrier.srcStageMask = srcStage;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = dstStage;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = transfer.srcFamily;
+			barrier.dstQueueFamilyIndex = transfer.dstFamily;
+			barrier.buffer = buffers[i];
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+
+			if (++depInfo.bufferMemoryBarrierCount == std::size(barriers) || i + 1 == count)
+			{
+				vkCmdPipelineBarrier2(cmd, &depInfo);
+				depInfo.bufferMemoryBarrierCount = 0;
+			}
+		}
+	}
+
+	void RecordImageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = transfer.srcFamily;
+		barrier.dstQueueFamilyIndex = transfer.dstFamily;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.imageMemoryBarrierCount = 1;
+		depInfo.pImageMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(cmd, &depInfo);
+	}
+} // namespace
+
+bool AsyncCompute::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, uint32_t framesInFlight)
+{
+	ZoneScopedN("AsyncCompute::Initialize");
+
+	m_Device = device;
+	m_Queue = queue;
+	m_QueueFamily = queueFamily;
+	m_GraphicsFamily = graphicsFamily;
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+	m_SupportsTimestamps = queueFamily < familyCount && families[queueFamily].timestampValidBits != 0;
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	m_Frames.resize(framesInFlight);
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		if (vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_Frames[i].commandPool) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to create async compute command pool for frame %u", i);
+			Shutdown();
+			return false;
+		}
+
+		allocInfo.commandPool = m_Frames[i].commandPool;
+		if (vkAllocateCommandBuffers(m_Device, &allocInfo, &m_Frames[i].commandBuffer) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to allocate async compute command buffer for frame %u", i);
+			Shutdown();
+			return false;
+		}
+	}
+
+	VkSemaphoreTypeCreateInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &timelineInfo;
+
+	if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Timeline) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create async compute timeline semaphore");
+		m_Timeline = VK_NULL_HANDLE;
+		Shutdown();
+		return false;
+	}
+	m_TimelineValue = 0;
+
+	WOVEN_LOG_INFO("Async compute queue ready (family %u, timestamps %s)", queueFamily, m_SupportsTimestamps ? "on" : "off");
+	return true;
+}
+
+void AsyncCompute::Shutdown()
+{
+	if (m_Timeline != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+		m_Timeline = VK_NULL_HANDLE;
+	}
+	for (Frame& frame: m_Frames)
+	{
+		if (frame.commandPool != VK_NULL_HANDLE)
+		{
+			vkDestroyCommandPool(m_Device, frame.commandPool, nullptr);
+		}
+	}
+	m_Frames.clear();
+	m_Queue = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer AsyncCompute::Begin(uint32_t frameIndex)
+{
+	VkCommandBuffer cmd = m_Frames[frameIndex].commandBuffer;
+	vkResetCommandBuffer(cmd, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to begin async compute command buffer");
+		return VK_NULL_HANDLE;
+	}
+	return cmd;
+}
+
+uint64_t AsyncCompute::Submit(uint32_t frameIndex, VkSemaphore graphicsTimeline, uint64_t waitValue)
+{
+	ZoneScopedN("AsyncCompute::Submit");
+
+	VkCommandBuffer cmd = m_Frames[frameIndex].commandBuffer;
+	if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to end async compute command buffer");
+		return 0;
+	}
+
+	const uint64_t signalValue = m_TimelineValue + 1;
+
+	VkSemaphoreSubmitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	waitInfo.semaphore = graphicsTimeline;
+	waitInfo.value = waitValue;
+	waitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkSemaphoreSubmitInfo signalInfo{};
+	signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	signalInfo.semaphore = m_Timeline;
+	signalInfo.value = signalValue;
+	signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkCommandBufferSubmitInfo cmdInfo{};
+	cmdInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	cmdInfo.commandBuffer = cmd;
+
+	VkSubmitInfo2 submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submitInfo.waitSemaphoreInfoCount = 1;
+	submitInfo.pWaitSemaphoreInfos = &waitInfo;
+	submitInfo.commandBufferInfoCount = 1;
+	submitInfo.pCommandBufferInfos = &cmdInfo;
+	submitInfo.signalSemaphoreInfoCount = 1;
+	submitInfo.pSignalSemaphoreInfos = &signalInfo;
+
+	if (vkQueueSubmit2(m_Queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to submit async compute command buffer");
+		return 0;
+	}
+
+	m_TimelineValue = signalValue;
+	return signalValue;
+}
+
+void AsyncCompute::RecordBufferRelease(VkCommandBuffer cmd, const VkBuffer* buffers, uint32_t count, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, const QueueTransfer& transfer)
+{
+	RecordBufferBarriers(cmd, buffers, count, srcStage, srcAccess, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, transfer);
+}
+
+void AsyncCompute::RecordBufferAcquire(VkCommandBuffer cmd, const VkBuffer* buffers, uint32_t count, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer)
+{
+	RecordBufferBarriers(cmd, buffers, count, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, dstStage, dstAccess, transfer);
+}
+
+void AsyncCompute::RecordImageRelease(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, const QueueTransfer& transfer)
+{
+	RecordImageBarrier(cmd, image, oldLayout, newLayout, srcStage, srcAccess, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, transfer);
+}
+
+void AsyncCompute::RecordImageAcquire(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer)
+{
+	RecordImageBarrier(cmd, image, oldLayout, newLayout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, dstStage, dstAccess, transfer);
+}
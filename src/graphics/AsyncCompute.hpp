@@ -0,0 +1,97 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vector>
+#include <volk.h>
+
+// Queue families a pass hands its outputs between. Both are the same when everything runs on one queue,
+// in which case no ownership transfer is recorded.
+struct QueueTransfer
+{
+	uint32_t srcFamily = VK_QUEUE_FAMILY_IGNORED; // Queue the pass records on
+	uint32_t dstFamily = VK_QUEUE_FAMILY_IGNORED; // Queue reading its outputs
+
+	bool IsTransfer() const
+	{
+		return srcFamily != dstFamily;
+	}
+
+	QueueTransfer Reversed() const
+	{
+		return { dstFamily, srcFamily };
+	}
+};
+
+// Dedicated compute queue that runs compute passes alongside the raster work of the same frame.
+// The graphics queue signals its timeline once the work the compute passes read is done, the compute
+// submission waits for it and signals its own timeline, and the graphics submission consuming the results
+// waits on that. Resources written on one family and read on the other move with release/acquire barriers
+// (the Record* helpers); host-written transients use concurrent sharing instead (GpuMemoryPools).
+// Without a compute-only queue family IsAvailable() is false and every pass stays on the graphics queue.
+class AsyncCompute
+{
+public:
+	bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, uint32_t framesInFlight);
+	void Shutdown();
+
+	bool IsAvailable() const
+	{
+		return m_Timeline != VK_NULL_HANDLE;
+	}
+
+	uint32_t GetQueueFamily() const
+	{
+		return m_QueueFamily;
+	}
+
+	// Some compute-only families cannot write timestamps; passes recorded there go untimed
+	bool SupportsTimestamps() const
+	{
+		return m_SupportsTimestamps;
+	}
+
+	// Passes recorded on the compute queue hand their outputs to graphics
+	QueueTransfer GetTransfer() const
+	{
+		return { m_QueueFamily, m_GraphicsFamily };
+	}
+
+	// After the frame slot's fence wait (the last submission of the slot waited on this one): resets and
+	// begins the slot's command buffer
+	VkCommandBuffer Begin(uint32_t frameIndex);
+
+	// Ends and submits the slot's command buffer once graphicsTimeline reaches waitValue.
+	// Returns the compute timeline value the graphics queue waits for, 0 on failure.
+	uint64_t Submit(uint32_t frameIndex, VkSemaphore graphicsTimeline, uint64_t waitValue);
+
+	VkSemaphore GetTimeline() const
+	{
+		return m_Timeline;
+	}
+
+	// Queue family ownership transfer: the release goes on the queue giving the resource up, the acquire with
+	// the same layouts on the one taking it, ordered by a semaphore between the two submissions
+	static void RecordBufferRelease(VkCommandBuffer cmd, const VkBuffer* buffers, uint32_t count, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, const QueueTransfer& transfer);
+	static void RecordBufferAcquire(VkCommandBuffer cmd, const VkBuffer* buffers, uint32_t count, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer);
+	static void RecordImageRelease(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, const QueueTransfer& transfer);
+	static void RecordImageAcquire(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const QueueTransfer& transfer);
+
+private:
+	struct Frame
+	{
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	};
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VkQueue m_Queue = VK_NULL_HANDLE;
+	uint32_t m_QueueFamily = VK_QUEUE_FAMILY_IGNORED;
+	uint32_t m_GraphicsFamily = VK_QUEUE_FAMILY_IGNORED;
+	bool m_SupportsTimestamps = false;
+
+	std::vector<Frame> m_Frames;
+	VkSemaphore m_Timeline = VK_NULL_HANDLE;
+	uint64_t m_TimelineValue = 0;
+};
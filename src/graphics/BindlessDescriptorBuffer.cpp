@@ -0,0 +1,174 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/BindlessDescriptorBuffer.hpp"
+
+bool BindlessDescriptorBuffer::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VmaAllocator allocator, VkDescriptorSetLayout layout, const std::vector<uint32_t>& queueFamilies)
+{
+	ZoneScopedN("BindlessDescriptorBuffer::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+
+	m_Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &m_Properties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	vkGetDescriptorSetLayoutSizeEXT(m_Device, layout, &m_Size);
+	for (uint32_t binding = 0; binding < static_cast<uint32_t>(BindlessType::Count); ++binding)
+	{
+		vkGetDescriptorSetLayoutBindingOffsetEXT(m_Device, layout, binding, &m_BindingOffsets[binding]);
+	}
+
+	// One buffer carries samplers and resources; host-visible so slot writes are plain CPU stores
+	const bool concurrent = queueFamilies.size() > 1;
+	const VkBufferCreateInfo bufferInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = m_Size,
+		.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilies.size()) : 0u,
+		.pQueueFamilyIndices = concurrent ? queueFamilies.data() : nullptr,
+	};
+	const VmaAllocationCreateInfo allocInfo{
+		.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+		.usage = VMA_MEMORY_USAGE_AUTO,
+	};
+
+	VmaAllocationInfo info{};
+	if (vmaCreateBufferWithAlignment(m_Allocator, &bufferInfo, &allocInfo, m_Properties.descriptorBufferOffsetAlignment, &m_Buffer, &m_Allocation, &info) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create bindless descriptor buffer (%llu bytes)", static_cast<unsigned long long>(m_Size));
+		return false;
+	}
+	vmaSetAllocationName(m_Allocator, m_Allocation, "Bindless Descriptor Buffer");
+
+	m_Mapped = static_cast<uint8_t*>(info.pMappedData);
+	std::fill_n(m_Mapped, m_Size, uint8_t(0));
+	m_DirtyBegin = 0;
+	m_DirtyEnd = m_Size;
+
+	const VkBufferDeviceAddressInfo addressInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer = m_Buffer,
+	};
+	m_Address = vkGetBufferDeviceAddress(m_Device, &addressInfo);
+
+	WOVEN_LOG_INFO("Bindless descriptor buffer: %.1f KiB (image %zu B, sampler %zu B, storage buffer %zu B)", static_cast<double>(m_Size) / 1024.0, m_Properties.sampledImageDescriptorSize, m_Properties.samplerDescriptorSize, m_Properties.storageBufferDescriptorSize);
+	return true;
+}
+
+void BindlessDescriptorBuffer::Shutdown()
+{
+	if (m_Buffer != VK_NULL_HANDLE)
+	{
+		vmaDestroyBuffer(m_Allocator, m_Buffer, m_Allocation);
+		m_Buffer = VK_NULL_HANDLE;
+		m_Allocation = VK_NULL_HANDLE;
+	}
+	m_Mapped = nullptr;
+	m_Address = 0;
+}
+
+uint8_t* BindlessDescriptorBuffer::GetSlot(BindlessType type, uint32_t index, size_t descriptorSize)
+{
+	const VkDeviceSize offset = m_BindingOffsets[static_cast<size_t>(type)] + static_cast<VkDeviceSize>(index) * descriptorSize;
+	m_DirtyBegin = std::min(m_DirtyBegin, offset);
+	m_DirtyEnd = std::max(m_DirtyEnd, offset + descriptorSize);
+	return m_Mapped + offset;
+}
+
+void BindlessDescriptorBuffer::WriteImage(BindlessType type, uint32_t index, const VkDescriptorImageInfo& image)
+{
+	VkDescriptorGetInfoEXT getInfo{};
+	getInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+
+	size_t descriptorSize = 0;
+	switch (type)
+	{
+		case BindlessType::SampledImage:
+			getInfo.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			getInfo.data.pSampledImage = &image;
+			descriptorSize = m_Properties.sampledImageDescriptorSize;
+			break;
+		case BindlessType::Sampler:
+			getInfo.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+			getInfo.data.pSampler = &image.sampler;
+			descriptorSize = m_Properties.samplerDescriptorSize;
+			break;
+		case BindlessType::StorageImage:
+			getInfo.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			getInfo.data.pStorageImage = &image;
+			descriptorSize = m_Properties.storageImageDescriptorSize;
+			break;
+		default:
+			WOVEN_LOG_ERROR("%s is not an image descriptor type", GetBindlessTypeName(type));
+			return;
+	}
+
+	vkGetDescriptorEXT(m_Device, &getInfo, descriptorSize, GetSlot(type, index, descriptorSize));
+}
+
+void BindlessDescriptorBuffer::WriteBuffer(BindlessType type, uint32_t index, VkDeviceAddress address, VkDeviceSize range)
+{
+	const VkDescriptorAddressInfoEXT addressInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+		.address = address,
+		.range = range,
+		.format = VK_FORMAT_UNDEFINED,
+	};
+
+	VkDescriptorGetInfoEXT getInfo{};
+	getInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+
+	size_t descriptorSize = 0;
+	switch (type)
+	{
+		case BindlessType::StorageBuffer:
+			getInfo.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			getInfo.data.pStorageBuffer = &addressInfo;
+			descriptorSize = m_Properties.storageBufferDescriptorSize;
+			break;
+		case BindlessType::UniformBuffer:
+			getInfo.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			getInfo.data.pUniformBuffer = &addressInfo;
+			descriptorSize = m_Properties.uniformBufferDescriptorSize;
+			break;
+		default:
+			WOVEN_LOG_ERROR("%s is not a buffer descriptor type", GetBindlessTypeName(type));
+			return;
+	}
+
+	vkGetDescriptorEXT(m_Device, &getInfo, descriptorSize, GetSlot(type, index, descriptorSize));
+}
+
+void BindlessDescriptorBuffer::Flush()
+{
+	if (m_DirtyEnd <= m_DirtyBegin)
+	{
+		return;
+	}
+
+	vmaFlushAllocation(m_Allocator, m_Allocation, m_DirtyBegin, m_DirtyEnd - m_DirtyBegin);
+	m_DirtyBegin = ~0ull;
+	m_DirtyEnd = 0;
+}
+
+void BindlessDescriptorBuffer::Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const
+{
+	const VkDescriptorBufferBindingInfoEXT bindingInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+		.address = m_Address,
+		.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT,
+	};
+	vkCmdBindDescriptorBuffersEXT(cmd, 1, &bindingInfo);
+
+	const uint32_t bufferIndex = 0;
+	const VkDeviceSize offset = 0;
+	vkCmdSetDescriptorBufferOffsetsEXT(cmd, bindPoint, layout, 0, 1, &bufferIndex, &offset);
+}
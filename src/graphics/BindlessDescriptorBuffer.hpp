@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+#include "graphics/BindlessRegistry.hpp"
+
+// VK_EXT_descriptor_buffer backend for the bindless set.
+// Descriptors live in one host-visible buffer laid out as the set layout dictates;
+// writing a slot is a vkGetDescriptorEXT straight into mapped memory, no descriptor pool or set.
+class BindlessDescriptorBuffer
+{
+public:
+	// layout must have been created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT.
+	// queueFamilies lists every family binding the buffer; more than one makes it concurrent.
+	bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VmaAllocator allocator, VkDescriptorSetLayout layout, const std::vector<uint32_t>& queueFamilies);
+	void Shutdown();
+
+	void WriteImage(BindlessType type, uint32_t index, const VkDescriptorImageInfo& image);
+	void WriteBuffer(BindlessType type, uint32_t index, VkDeviceAddress address, VkDeviceSize range);
+
+	// Makes host writes visible on non-coherent memory (no-op on coherent heaps)
+	void Flush();
+
+	// Replaces vkCmdBindDescriptorSets for set 0
+	void Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const;
+
+	VkDeviceSize GetSize() const
+	{
+		return m_Size;
+	}
+
+private:
+	uint8_t* GetSlot(BindlessType type, uint32_t index, size_t descriptorSize);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+
+	VkBuffer m_Buffer = VK_NULL_HANDLE;
+	VmaAllocation m_Allocation = VK_NULL_HANDLE;
+	uint8_t* m_Mapped = nullptr;
+	VkDeviceAddress m_Address = 0;
+	VkDeviceSize m_Size = 0;
+
+	VkPhysicalDeviceDescriptorBufferPropertiesEXT m_Properties = {};
+	VkDeviceSize m_BindingOffsets[static_cast<size_t>(BindlessType::Count)] = {};
+
+	// Dirty byte range since the last Flush
+	VkDeviceSize m_DirtyBegin = ~0ull;
+	VkDeviceSize m_DirtyEnd = 0;
+};
@@ -0,0 +1,327 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/BindlessDescriptorBuffer.hpp"
+#include "graphics/BindlessRegistry.hpp"
+
+namespace
+{
+	VkDescriptorType GetDescriptorType(BindlessType type)
+	{
+		switch (type)
+		{
+			case BindlessType::SampledImage:
+				return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			case BindlessType::Sampler:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+			case BindlessType::StorageBuffer:
+				return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			case BindlessType::UniformBuffer:
+				return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			case BindlessType::StorageImage:
+				return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			default:
+				return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+	}
+
+	bool IsBufferType(BindlessType type)
+	{
+		return type == BindlessType::StorageBuffer || type == BindlessType::UniformBuffer;
+	}
+} // namespace
+
+const char* GetBindlessTypeName(BindlessType type)
+{
+	switch (type)
+	{
+		case BindlessType::SampledImage:
+			return "Sampled Images";
+		case BindlessType::Sampler:
+			return "Samplers";
+		case BindlessType::StorageBuffer:
+			return "Storage Buffers";
+		case BindlessType::UniformBuffer:
+			return "Uniform Buffers";
+		case BindlessType::StorageImage:
+			return "Storage Images";
+		default:
+			return "Unknown";
+	}
+}
+
+uint32_t GetBindlessCapacity(BindlessType type)
+{
+	switch (type)
+	{
+		case BindlessType::SampledImage:
+			return MAX_BINDLESS_SAMPLED_IMAGES;
+		case BindlessType::Sampler:
+			return MAX_BINDLESS_SAMPLERS;
+		case BindlessType::StorageBuffer:
+			return MAX_BINDLESS_STORAGE_BUFFERS;
+		case BindlessType::UniformBuffer:
+			return MAX_BINDLESS_UNIFORM_BUFFERS;
+		case BindlessType::StorageImage:
+			return MAX_BINDLESS_STORAGE_IMAGES;
+		default:
+			return 0;
+	}
+}
+
+void BindlessRegistry::Initialize(VkDevice device, VkDescriptorSet descriptorSet, BindlessDescriptorBuffer* descriptorBuffer, uint32_t framesInFlight)
+{
+	m_Device = device;
+	m_DescriptorSet = descriptorSet;
+	m_DescriptorBuffer = descriptorBuffer;
+	m_FramesInFlight = framesInFlight;
+
+	for (size_t i = 0; i < m_Slots.size(); ++i)
+	{
+		m_Slots[i].live.assign(GetBindlessCapacity(static_cast<BindlessType>(i)), false);
+	}
+}
+
+void BindlessRegistry::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (size_t i = 0; i < m_Slots.size(); ++i)
+	{
+		if (m_Slots[i].liveCount > 0)
+		{
+			WOVEN_LOG_DEBUG("%u bindless %s still registered at shutdown", m_Slots[i].liveCount, GetBindlessTypeName(static_cast<BindlessType>(i)));
+		}
+		m_Slots[i] = {};
+	}
+	m_PendingWrites.clear();
+	m_PendingReleases.clear();
+	m_DescriptorSet = VK_NULL_HANDLE;
+	m_DescriptorBuffer = nullptr;
+	m_Device = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessRegistry::Allocate(BindlessType type)
+{
+	SlotAllocator& slots = m_Slots[static_cast<size_t>(type)];
+
+	uint32_t index = INVALID_BINDLESS_INDEX;
+	if (!slots.freeList.empty())
+	{
+		index = slots.freeList.back();
+		slots.freeList.pop_back();
+	}
+	else if (slots.next < GetBindlessCapacity(type))
+	{
+		index = slots.next++;
+	}
+	else
+	{
+		WOVEN_LOG_ERROR("Bindless %s exhausted (%u slots)", GetBindlessTypeName(type), GetBindlessCapacity(type));
+		return INVALID_BINDLESS_INDEX;
+	}
+
+	slots.live[index] = true;
+	++slots.liveCount;
+	return index;
+}
+
+uint32_t BindlessRegistry::Register(BindlessType type, const VkDescriptorImageInfo* image, const VkDescriptorBufferInfo* buffer)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (m_DescriptorBuffer && buffer && buffer->range == VK_WHOLE_SIZE)
+	{
+		WOVEN_LOG_ERROR("Bindless %s needs an explicit range with descriptor buffers", GetBindlessTypeName(type));
+		return INVALID_BINDLESS_INDEX;
+	}
+
+	const uint32_t index = Allocate(type);
+	if (index == INVALID_BINDLESS_INDEX)
+	{
+		return INVALID_BINDLESS_INDEX;
+	}
+
+	// Fresh slots are not read by any in-flight frame, so the descriptor buffer can be written immediately
+	if (m_DescriptorBuffer)
+	{
+		if (image)
+		{
+			m_DescriptorBuffer->WriteImage(type, index, *image);
+		}
+		else if (buffer)
+		{
+			const VkBufferDeviceAddressInfo addressInfo{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+				.buffer = buffer->buffer,
+			};
+			m_DescriptorBuffer->WriteBuffer(type, index, vkGetBufferDeviceAddress(m_Device, &addressInfo) + buffer->offset, buffer->range);
+		}
+		return index;
+	}
+
+	PendingWrite write{ .type = type, .index = index };
+	if (image)
+		write.image = *image;
+	if (buffer)
+		write.buffer = *buffer;
+	m_PendingWrites.push_back(write);
+	return index;
+}
+
+uint32_t BindlessRegistry::RegisterSampledImage(VkImageView view, VkImageLayout layout)
+{
+	const VkDescriptorImageInfo image{ VK_NULL_HANDLE, view, layout };
+	return Register(BindlessType::SampledImage, &image, nullptr);
+}
+
+uint32_t BindlessRegistry::RegisterSampler(VkSampler sampler)
+{
+	const VkDescriptorImageInfo image{ sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED };
+	return Register(BindlessType::Sampler, &image, nullptr);
+}
+
+uint32_t BindlessRegistry::RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	const VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+	return Register(BindlessType::StorageBuffer, nullptr, &bufferInfo);
+}
+
+uint32_t BindlessRegistry::RegisterUniformBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	const VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+	return Register(BindlessType::UniformBuffer, nullptr, &bufferInfo);
+}
+
+uint32_t BindlessRegistry::RegisterStorageImage(VkImageView view)
+{
+	const VkDescriptorImageInfo image{ VK_NULL_HANDLE, view, VK_IMAGE_LAYOUT_GENERAL };
+	return Register(BindlessType::StorageImage, &image, nullptr);
+}
+
+void BindlessRegistry::Release(BindlessType type, uint32_t index)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	SlotAllocator& slots = m_Slots[static_cast<size_t>(type)];
+	if (index >= slots.live.size() || !slots.live[index])
+	{
+		WOVEN_LOG_WARNING("Releasing bindless %s slot %u that is not registered", GetBindlessTypeName(type), index);
+		return;
+	}
+
+	slots.live[index] = false;
+	--slots.liveCount;
+	m_PendingReleases.push_back({ type, index, m_FrameNumber });
+}
+
+void BindlessRegistry::BeginFrame(uint64_t frameNumber)
+{
+	ZoneScopedN("BindlessRegistry::BeginFrame");
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	m_FrameNumber = frameNumber;
+
+	// Releases are appended in frame order, so the retired ones form a prefix
+	size_t retired = 0;
+	while (retired < m_PendingReleases.size() && m_PendingReleases[retired].frameNumber + m_FramesInFlight <= frameNumber)
+	{
+		const PendingRelease& release = m_PendingReleases[retired];
+		m_Slots[static_cast<size_t>(release.type)].freeList.push_back(release.index);
+		++retired;
+	}
+	m_PendingReleases.erase(m_PendingReleases.begin(), m_PendingReleases.begin() + static_cast<std::ptrdiff_t>(retired));
+}
+
+void BindlessRegistry::Flush()
+{
+	ZoneScopedN("BindlessRegistry::Flush");
+
+	if (m_DescriptorBuffer)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_DescriptorBuffer->Flush();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_PendingWrites.empty())
+		{
+			return;
+		}
+		m_FlushWrites.swap(m_PendingWrites);
+	}
+
+	// Sort so consecutive slots of one binding collapse into a single write
+	std::stable_sort(m_FlushWrites.begin(), m_FlushWrites.end(), [](const PendingWrite& a, const PendingWrite& b) {
+		return a.type != b.type ? a.type < b.type : a.index < b.index;
+	});
+
+	m_Writes.clear();
+	m_ImageInfos.clear();
+	m_BufferInfos.clear();
+	m_ImageInfos.reserve(m_FlushWrites.size());
+	m_BufferInfos.reserve(m_FlushWrites.size());
+
+	for (size_t i = 0; i < m_FlushWrites.size(); ++i)
+	{
+		const PendingWrite& pending = m_FlushWrites[i];
+
+		// A slot written twice in one batch keeps the last write (stable sort preserves order)
+		if (i + 1 < m_FlushWrites.size() && m_FlushWrites[i + 1].type == pending.type && m_FlushWrites[i + 1].index == pending.index)
+		{
+			continue;
+		}
+
+		const bool isBuffer = IsBufferType(pending.type);
+		VkWriteDescriptorSet* previous = m_Writes.empty() ? nullptr : &m_Writes.back();
+		const bool extends = previous && previous->dstBinding == static_cast<uint32_t>(pending.type) && previous->dstArrayElement + previous->descriptorCount == pending.index;
+
+		if (isBuffer)
+			m_BufferInfos.push_back(pending.buffer);
+		else
+			m_ImageInfos.push_back(pending.image);
+
+		if (extends)
+		{
+			++previous->descriptorCount;
+			continue;
+		}
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = m_DescriptorSet;
+		write.dstBinding = static_cast<uint32_t>(pending.type);
+		write.dstArrayElement = pending.index;
+		write.descriptorCount = 1;
+		write.descriptorType = GetDescriptorType(pending.type);
+		// Info arrays are reserved up front, so these pointers stay valid while appending
+		if (isBuffer)
+			write.pBufferInfo = &m_BufferInfos.back();
+		else
+			write.pImageInfo = &m_ImageInfos.back();
+		m_Writes.push_back(write);
+	}
+
+	vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(m_Writes.size()), m_Writes.data(), 0, nullptr);
+	m_FlushWrites.clear();
+}
+
+BindlessRegistry::Usage BindlessRegistry::GetUsage(BindlessType type) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	Usage usage;
+	const SlotAllocator& slots = m_Slots[static_cast<size_t>(type)];
+	usage.live = slots.liveCount;
+	usage.highWater = slots.next;
+	for (const PendingRelease& release: m_PendingReleases)
+	{
+		if (release.type == type)
+			++usage.pendingRelease;
+	}
+	return usage;
+}
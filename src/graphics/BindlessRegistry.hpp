@@ -0,0 +1,122 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <array>
+#include <mutex>
+#include <volk.h>
+
+class BindlessDescriptorBuffer;
+
+// Capacity of each binding of the global bindless set (binding index = BindlessType)
+constexpr uint32_t MAX_BINDLESS_SAMPLED_IMAGES = 16384;
+constexpr uint32_t MAX_BINDLESS_SAMPLERS = 128;
+constexpr uint32_t MAX_BINDLESS_STORAGE_BUFFERS = 1024;
+constexpr uint32_t MAX_BINDLESS_UNIFORM_BUFFERS = 256;
+constexpr uint32_t MAX_BINDLESS_STORAGE_IMAGES = 512;
+
+constexpr uint32_t INVALID_BINDLESS_INDEX = UINT32_MAX;
+
+enum class BindlessType : uint8_t
+{
+	SampledImage,
+	Sampler,
+	StorageBuffer,
+	UniformBuffer,
+	StorageImage,
+	Count
+};
+
+const char* GetBindlessTypeName(BindlessType type);
+uint32_t GetBindlessCapacity(BindlessType type);
+
+// Hands out stable slot indices in the global bindless set.
+// Descriptor set backend: writes are queued and flushed in one vkUpdateDescriptorSets call per frame
+// (before submit, which update-after-bind allows).
+// Descriptor buffer backend: writes go straight into the mapped descriptor buffer.
+// Released slots go back to their free list only once every frame that could still reference them has retired on the GPU.
+class BindlessRegistry
+{
+public:
+	struct Usage
+	{
+		uint32_t live = 0;
+		uint32_t pendingRelease = 0;
+		uint32_t highWater = 0;
+	};
+
+	// Exactly one of descriptorSet / descriptorBuffer is used
+	void Initialize(VkDevice device, VkDescriptorSet descriptorSet, BindlessDescriptorBuffer* descriptorBuffer, uint32_t framesInFlight);
+	void Shutdown();
+
+	// Returned indices go straight into push constants / GPU buffers.
+	// With the descriptor buffer backend, buffers need SHADER_DEVICE_ADDRESS usage and an explicit range
+	// (descriptors address them directly); VK_WHOLE_SIZE is rejected there.
+	uint32_t RegisterSampledImage(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	uint32_t RegisterSampler(VkSampler sampler);
+	uint32_t RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+	uint32_t RegisterUniformBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+	uint32_t RegisterStorageImage(VkImageView view);
+
+	// Slot may still be read by in-flight frames; it is recycled after they retire
+	void Release(BindlessType type, uint32_t index);
+
+	// After the frame slot's fence wait: recycles slots released framesInFlight frames ago
+	void BeginFrame(uint64_t frameNumber);
+
+	// Writes all queued descriptors; called once per frame right before submit
+	void Flush();
+
+	bool UsesDescriptorBuffer() const
+	{
+		return m_DescriptorBuffer != nullptr;
+	}
+
+	Usage GetUsage(BindlessType type) const;
+
+private:
+	struct PendingWrite
+	{
+		BindlessType type = BindlessType::SampledImage;
+		uint32_t index = 0;
+		VkDescriptorImageInfo image = {};
+		VkDescriptorBufferInfo buffer = {};
+	};
+
+	struct PendingRelease
+	{
+		BindlessType type = BindlessType::SampledImage;
+		uint32_t index = 0;
+		uint64_t frameNumber = 0;
+	};
+
+	struct SlotAllocator
+	{
+		std::vector<uint32_t> freeList;
+		std::vector<bool> live;
+		uint32_t next = 0; // Slots at and above this have never been handed out
+		uint32_t liveCount = 0;
+	};
+
+	uint32_t Allocate(BindlessType type);
+	uint32_t Register(BindlessType type, const VkDescriptorImageInfo* image, const VkDescriptorBufferInfo* buffer);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+	BindlessDescriptorBuffer* m_DescriptorBuffer = nullptr;
+	uint32_t m_FramesInFlight = 0;
+	uint64_t m_FrameNumber = 0;
+
+	// Loader threads register textures too
+	mutable std::mutex m_Mutex;
+	std::array<SlotAllocator, static_cast<size_t>(BindlessType::Count)> m_Slots;
+	std::vector<PendingWrite> m_PendingWrites;
+	std::vector<PendingRelease> m_PendingReleases;
+
+	// Scratch for Flush, kept to avoid per-frame allocations
+	std::vector<PendingWrite> m_FlushWrites;
+	std::vector<VkWriteDescriptorSet> m_Writes;
+	std::vector<VkDescriptorImageInfo> m_ImageInfos;
+	std::vector<VkDescriptorBufferInfo> m_BufferInfos;
+};
@@ -0,0 +1,176 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <glm/gtc/constants.hpp>
+
+#include "core/FileSystem.hpp"
+#include "core/Logger.hpp"
+#include "graphics/Camera.hpp"
+#include "graphics/CameraPath.hpp"
+
+namespace
+{
+	glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+	{
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+		return 0.5f * ((2.0f * p1) + (-p0 + p2) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+	}
+} // namespace
+
+bool CameraPath::LoadFromFile(const std::filesystem::path& path)
+{
+	ZoneScopedN("CameraPath::LoadFromFile");
+
+	const std::vector<uint8_t> data = FileSystem::LoadFile(path);
+	if (data.empty())
+	{
+		WOVEN_LOG_ERROR("Failed to read camera path: %s", path.string().c_str());
+		return false;
+	}
+
+	Clear();
+
+	const std::string text(data.begin(), data.end());
+	size_t lineStart = 0;
+	uint32_t lineNumber = 0;
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = text.size();
+
+		std::string line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		++lineNumber;
+
+		const size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.resize(comment);
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+
+		Keyframe key;
+		if (std::sscanf(line.c_str(), "%f %f %f %f %f %f %f", &key.time, &key.position.x, &key.position.y, &key.position.z, &key.target.x, &key.target.y, &key.target.z) != 7)
+		{
+			WOVEN_LOG_ERROR("Camera path %s:%u: expected 'time px py pz tx ty tz'", path.string().c_str(), lineNumber);
+			return false;
+		}
+
+		if (!m_Keyframes.empty() && key.time < m_Keyframes.back().time)
+		{
+			WOVEN_LOG_ERROR("Camera path %s:%u: keyframes must be sorted by time", path.string().c_str(), lineNumber);
+			return false;
+		}
+
+		m_Keyframes.push_back(key);
+	}
+
+	if (m_Keyframes.empty())
+	{
+		WOVEN_LOG_ERROR("Camera path has no keyframes: %s", path.string().c_str());
+		return false;
+	}
+
+	WOVEN_LOG_INFO("Loaded camera path %s (%zu keys, %.2f s)", path.string().c_str(), m_Keyframes.size(), GetDuration());
+	return true;
+}
+
+bool CameraPath::SaveToFile(const std::filesystem::path& path) const
+{
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		WOVEN_LOG_ERROR("Failed to write camera path: %s", path.string().c_str());
+		return false;
+	}
+
+	file << "# time posX posY posZ targetX targetY targetZ\n";
+	for (const Keyframe& key: m_Keyframes)
+	{
+		char line[256];
+		std::snprintf(line, sizeof(line), "%.4f %.4f %.4f %.4f %.4f %.4f %.4f\n", key.time, key.position.x, key.position.y, key.position.z, key.target.x, key.target.y, key.target.z);
+		file << line;
+	}
+	return file.good();
+}
+
+void CameraPath::AddKeyframe(float time, const glm::vec3& position, const glm::vec3& target)
+{
+	m_Keyframes.push_back({ time, position, target });
+}
+
+void CameraPath::Clear()
+{
+	m_Keyframes.clear();
+}
+
+CameraPath CameraPath::CreateOrbit(float radius, float height, float duration, uint32_t keyCount)
+{
+	CameraPath path;
+	keyCount = std::max(keyCount, 2u);
+	for (uint32_t i = 0; i < keyCount; ++i)
+	{
+		const float t = static_cast<float>(i) / static_cast<float>(keyCount - 1);
+		const float angle = t * glm::two_pi<float>();
+		const glm::vec3 position(std::sin(angle) * radius, height, -std::cos(angle) * radius);
+		path.AddKeyframe(t * duration, position, glm::vec3(0.0f));
+	}
+	return path;
+}
+
+void CameraPath::Sample(float time, glm::vec3& outPosition, glm::vec3& outTarget) const
+{
+	if (m_Keyframes.empty())
+	{
+		return;
+	}
+
+	const size_t count = m_Keyframes.size();
+	if (count == 1)
+	{
+		outPosition = m_Keyframes[0].position;
+		outTarget = m_Keyframes[0].target;
+		return;
+	}
+
+	const float startTime = m_Keyframes.front().time;
+	const float duration = GetDuration();
+	float localTime = time - startTime;
+	if (m_Looping && duration > 0.0f)
+	{
+		localTime = std::fmod(localTime, duration);
+		if (localTime < 0.0f)
+			localTime += duration;
+	}
+	localTime = std::clamp(localTime, 0.0f, duration) + startTime;
+
+	// First key whose time is past the sample point ends the segment
+	const auto upper = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), localTime, [](float value, const Keyframe& key) { return value < key.time; });
+	const size_t i2 = std::clamp<size_t>(static_cast<size_t>(upper - m_Keyframes.begin()), 1, count - 1);
+	const size_t i1 = i2 - 1;
+	const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+	const size_t i3 = std::min(i2 + 1, count - 1);
+
+	const float span = m_Keyframes[i2].time - m_Keyframes[i1].time;
+	const float t = span > 0.0f ? std::clamp((localTime - m_Keyframes[i1].time) / span, 0.0f, 1.0f) : 1.0f;
+
+	outPosition = CatmullRom(m_Keyframes[i0].position, m_Keyframes[i1].position, m_Keyframes[i2].position, m_Keyframes[i3].position, t);
+	outTarget = CatmullRom(m_Keyframes[i0].target, m_Keyframes[i1].target, m_Keyframes[i2].target, m_Keyframes[i3].target, t);
+}
+
+void CameraPath::Apply(Camera& camera, float time) const
+{
+	if (m_Keyframes.empty())
+	{
+		return;
+	}
+
+	glm::vec3 position;
+	glm::vec3 target;
+	Sample(time, position, target);
+	camera.SetPosition(position);
+	camera.SetTarget(target);
+}
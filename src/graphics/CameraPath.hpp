@@ -0,0 +1,59 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+#include <glm/vec3.hpp>
+
+class Camera;
+
+// Keyframed camera track, used to replay identical views across benchmark runs.
+// Text format, one keyframe per line: time posX posY posZ targetX targetY targetZ ('#' starts a comment)
+class CameraPath
+{
+public:
+	struct Keyframe
+	{
+		float time = 0.0f;
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 target = glm::vec3(0.0f);
+	};
+
+	bool LoadFromFile(const std::filesystem::path& path);
+	bool SaveToFile(const std::filesystem::path& path) const;
+
+	// Keys must be added in increasing time order
+	void AddKeyframe(float time, const glm::vec3& position, const glm::vec3& target);
+	void Clear();
+
+	// Default path when no file is given: a full orbit around the origin
+	static CameraPath CreateOrbit(float radius, float height, float duration, uint32_t keyCount = 16);
+
+	// Catmull-Rom interpolation; time is clamped to the path (or wrapped when looping)
+	void Sample(float time, glm::vec3& outPosition, glm::vec3& outTarget) const;
+	void Apply(Camera& camera, float time) const;
+
+	void SetLooping(bool looping)
+	{
+		m_Looping = looping;
+	}
+
+	bool IsEmpty() const
+	{
+		return m_Keyframes.empty();
+	}
+
+	size_t GetKeyframeCount() const
+	{
+		return m_Keyframes.size();
+	}
+
+	float GetDuration() const
+	{
+		return m_Keyframes.empty() ? 0.0f : m_Keyframes.back().time - m_Keyframes.front().time;
+	}
+
+private:
+	std::vector<Keyframe> m_Keyframes;
+	bool m_Looping = false;
+};
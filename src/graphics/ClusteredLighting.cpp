@@ -0,0 +1,169 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/ClusteredLighting.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/ShaderSystem.hpp"
+
+bool ClusteredLighting::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, uint32_t framesInFlight)
+{
+	ZoneScopedN("ClusteredLighting::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+
+	ShaderCompileDesc cullDesc{};
+	cullDesc.filePath = "shaders/lightcull.slang";
+	cullDesc.entryPoint = "cullLightsMain";
+	cullDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	if (!m_ShaderSystem->CreateShaderObject(cullDesc, m_CullShader))
+	{
+		return false;
+	}
+
+	// Lists are rebuilt every frame, so one set serves all frames in flight (ordered by barriers)
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, LIGHT_CLUSTER_COUNT * sizeof(uint32_t) * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GpuBufferAccess::Device, "Light Clusters", m_Clusters))
+		return false;
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, (1 + static_cast<VkDeviceSize>(LIGHT_INDEX_CAPACITY)) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Light Indices", m_LightIndices))
+		return false;
+
+	m_CounterReadback.resize(framesInFlight);
+	for (GpuBuffer& readback: m_CounterReadback)
+	{
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::HostReadback, "Light Index Readback", readback))
+			return false;
+		std::memset(readback.mapped, 0, sizeof(uint32_t));
+	}
+
+	WOVEN_LOG_INFO("Clustered lighting initialized: %ux%ux%u clusters, %u indices", LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z, LIGHT_INDEX_CAPACITY);
+	return true;
+}
+
+void ClusteredLighting::Shutdown()
+{
+	for (GpuBuffer& readback: m_CounterReadback)
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, readback);
+	}
+	m_CounterReadback.clear();
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_LightIndices);
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_Clusters);
+
+	if (m_ShaderSystem)
+	{
+		m_ShaderSystem->DestroyShader(m_CullShader);
+	}
+	m_CullShader = VK_NULL_HANDLE;
+	m_ShaderSystem = nullptr;
+	m_RequestedIndices = 0;
+	m_LightCount = 0;
+}
+
+glm::vec4 ClusteredLighting::GetCullSphere(const GpuLight& light)
+{
+	if (light.type == LIGHT_TYPE_AREA)
+	{
+		// Falloff is measured from the closest point of the rectangle
+		return glm::vec4(light.position, light.range + glm::length(light.areaRight + light.areaUp));
+	}
+
+	const float cosAngle = light.spotCosOuter;
+	if (light.type != LIGHT_TYPE_SPOT || cosAngle <= 0.0f)
+	{
+		return glm::vec4(light.position, light.range);
+	}
+
+	// Tightest sphere around the cone: narrow cones touch the apex, wide ones are bounded by the cap's rim
+	if (cosAngle >= std::sqrt(0.5f))
+	{
+		const float radius = light.range / (2.0f * cosAngle);
+		return glm::vec4(light.position + light.direction * radius, radius);
+	}
+	const float sinAngle = std::sqrt(1.0f - cosAngle * cosAngle);
+	return glm::vec4(light.position + light.direction * (light.range * cosAngle), light.range * sinAngle);
+}
+
+void ClusteredLighting::RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, const std::vector<GpuLight>& lights, const View& view, VkPipelineLayout layout, PushConstants& push, const QueueTransfer& transfer)
+{
+	ZoneScopedN("ClusteredLighting::RecordCull");
+
+	// Index count the light cull asked for the last time this slot ran
+	GpuBuffer& readback = m_CounterReadback[frameIndex];
+	vmaInvalidateAllocation(m_Allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+	std::memcpy(&m_RequestedIndices, readback.mapped, sizeof(uint32_t));
+
+	m_LightCount = static_cast<uint32_t>(std::min<size_t>(lights.size(), MAX_LIGHTS));
+	if (lights.size() > MAX_LIGHTS && !m_LimitWarned)
+	{
+		WOVEN_LOG_WARNING("Culling only %u of %zu lights (MAX_LIGHTS)", MAX_LIGHTS, lights.size());
+		m_LimitWarned = true;
+	}
+
+	const TransientBuffer lightBuffer = pools.AllocateTransient(std::max(m_LightCount, 1u) * sizeof(GpuLight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	const TransientBuffer dataBuffer = pools.AllocateTransient(sizeof(GpuLightingData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	if (lightBuffer.buffer == VK_NULL_HANDLE || dataBuffer.buffer == VK_NULL_HANDLE)
+	{
+		push.lighting = 0;
+		return;
+	}
+
+	GpuLight* uploaded = static_cast<GpuLight*>(lightBuffer.mapped);
+	for (uint32_t i = 0; i < m_LightCount; ++i)
+	{
+		uploaded[i] = lights[i];
+		uploaded[i].cullSphere = GetCullSphere(lights[i]);
+	}
+
+	GpuLightingData data{};
+	data.view = view.view;
+	data.lights = lightBuffer.deviceAddress;
+	data.clusters = m_Clusters.address;
+	data.lightIndices = m_LightIndices.address;
+	data.lightCount = m_LightCount;
+	data.indexCapacity = LIGHT_INDEX_CAPACITY;
+	data.projectionScale = glm::vec2(view.projection[0][0], view.projection[1][1]);
+	data.nearPlane = view.nearPlane;
+	data.sliceScale = static_cast<float>(LIGHT_CLUSTER_Z) / std::log(view.farPlane / view.nearPlane);
+	std::memcpy(dataBuffer.mapped, &data, sizeof(data));
+	push.lighting = dataBuffer.deviceAddress;
+
+	// The previous frame's shading and counter copy are done with the lists before the counter resets. On the
+	// compute queue the wait on the graphics timeline already covers the shading, and fragment stages do not exist.
+	const bool asyncCompute = transfer.IsTransfer();
+	const VkPipelineStageFlags2 readStages = asyncCompute ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT : VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT;
+	RecordMemoryBarrier(cmd, readStages, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	vkCmdFillBuffer(cmd, m_LightIndices.buffer, 0, sizeof(uint32_t), 0);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+	// Every cluster is written, empty or not, so nothing else needs clearing
+	const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &m_CullShader);
+	vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+	vkCmdDispatch(cmd, LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z);
+
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, readStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT);
+	const VkBufferCopy region{ 0, 0, sizeof(uint32_t) };
+	vkCmdCopyBuffer(cmd, m_LightIndices.buffer, readback.buffer, 1, &region);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+
+	if (asyncCompute)
+	{
+		const VkBuffer lists[] = { m_Clusters.buffer, m_LightIndices.buffer };
+		AsyncCompute::RecordBufferRelease(cmd, lists, 2, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, transfer);
+	}
+}
+
+void ClusteredLighting::RecordAcquire(VkCommandBuffer cmd, const QueueTransfer& transfer) const
+{
+	// The index list is read by the forward and resolve fragment shaders and the material pass
+	const VkBuffer lists[] = { m_Clusters.buffer, m_LightIndices.buffer };
+	AsyncCompute::RecordBufferAcquire(cmd, lists, 2, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, transfer);
+}
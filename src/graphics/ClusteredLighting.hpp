@@ -0,0 +1,77 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+#include "graphics/AsyncCompute.hpp"
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/RenderConstants.hpp"
+
+class GpuMemoryPools;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// Clustered forward+ light culling (shaders/lightcull.slang, shaders/lighting.slang).
+// A compute pass bins the frame's point, spot and area lights into a LIGHT_CLUSTER_X x Y x Z froxel grid
+// (screen tiles by exponential depth slices) and writes one compact index list per cluster. Shading then
+// loops only over the list of the cluster a pixel falls into, so thousands of lights cost what the few
+// overlapping each pixel cost.
+class ClusteredLighting
+{
+public:
+	// Camera the grid is built from; must match the view-projection the frame draws with
+	struct View
+	{
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 projection = glm::mat4(1.0f);
+		float nearPlane = 0.1f;
+		float farPlane = 1000.0f;
+	};
+
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, uint32_t framesInFlight);
+	void Shutdown();
+
+	bool IsInitialized() const
+	{
+		return m_CullShader != VK_NULL_HANDLE;
+	}
+
+	// World-space sphere bounding everything a light reaches (GpuLight::cullSphere)
+	static glm::vec4 GetCullSphere(const GpuLight& light);
+
+	// Outside rendering, before the draws. Uploads the lights (cull spheres filled in here), bins them and
+	// fills push.lighting. Also reads back the index count this frame slot copied last time.
+	// On the async compute queue (transfer.IsTransfer()) the lists are released to the graphics queue, which
+	// calls RecordAcquire before shading with them.
+	void RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, const std::vector<GpuLight>& lights, const View& view, VkPipelineLayout layout, PushConstants& push, const QueueTransfer& transfer);
+	void RecordAcquire(VkCommandBuffer cmd, const QueueTransfer& transfer) const;
+
+	// Lights uploaded by the last RecordCull (at most MAX_LIGHTS)
+	uint32_t GetLightCount() const
+	{
+		return m_LightCount;
+	}
+
+	// Indices the clusters asked for, framesInFlight frames old; above LIGHT_INDEX_CAPACITY lists were truncated
+	uint32_t GetRequestedIndexCount() const
+	{
+		return m_RequestedIndices;
+	}
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	VkShaderEXT m_CullShader = VK_NULL_HANDLE;
+
+	GpuBuffer m_Clusters;     // uvec2 (first index, count) per cluster
+	GpuBuffer m_LightIndices; // Allocation counter, then LIGHT_INDEX_CAPACITY indices
+
+	// One readback of the allocation counter per frame slot, read once that slot's fence has been waited on
+	std::vector<GpuBuffer> m_CounterReadback;
+	uint32_t m_RequestedIndices = 0;
+	uint32_t m_LightCount = 0;
+	bool m_LimitWarned = false;
+};
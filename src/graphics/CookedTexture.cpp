@@ -0,0 +1,100 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/Logger.hpp"
+#include "graphics/CookedTexture.hpp"
+
+namespace CookedTexture
+{
+	bool IsCooked(const uint8_t* data, size_t size)
+	{
+		uint32_t magic = 0;
+		if (size < sizeof(magic))
+		{
+			return false;
+		}
+		std::memcpy(&magic, data, sizeof(magic));
+		return magic == COOKED_TEXTURE_MAGIC;
+	}
+
+	bool Parse(const uint8_t* data, size_t size, CookedTextureHeader& outHeader, const CookedTextureMip*& outMips)
+	{
+		if (size < sizeof(CookedTextureHeader))
+		{
+			WOVEN_LOG_ERROR("Cooked texture truncated (%zu bytes)", size);
+			return false;
+		}
+
+		std::memcpy(&outHeader, data, sizeof(outHeader));
+		if (outHeader.magic != COOKED_TEXTURE_MAGIC || outHeader.version != COOKED_TEXTURE_VERSION)
+		{
+			WOVEN_LOG_ERROR("Unsupported cooked texture (magic 0x%08x, version %u)", outHeader.magic, outHeader.version);
+			return false;
+		}
+		if (outHeader.width == 0 || outHeader.height == 0 || outHeader.mipCount == 0 || outHeader.mipCount > COOKED_TEXTURE_MAX_MIPS)
+		{
+			WOVEN_LOG_ERROR("Cooked texture has invalid dimensions (%ux%u, %u mips)", outHeader.width, outHeader.height, outHeader.mipCount);
+			return false;
+		}
+
+		const VkFormat format = static_cast<VkFormat>(outHeader.format);
+		if (GetBlockBytes(format) == 0)
+		{
+			WOVEN_LOG_ERROR("Cooked texture has unsupported format %u", outHeader.format);
+			return false;
+		}
+
+		const size_t tableEnd = sizeof(CookedTextureHeader) + outHeader.mipCount * sizeof(CookedTextureMip);
+		if (size < tableEnd)
+		{
+			WOVEN_LOG_ERROR("Cooked texture mip table truncated");
+			return false;
+		}
+
+		// The table is 16-byte aligned in the file; SDL_LoadFile buffers are malloc-aligned
+		outMips = reinterpret_cast<const CookedTextureMip*>(data + sizeof(CookedTextureHeader));
+		for (uint32_t mip = 0; mip < outHeader.mipCount; ++mip)
+		{
+			const CookedTextureMip& entry = outMips[mip];
+			if (entry.size != GetMipBytes(format, outHeader.width, outHeader.height, mip) || entry.offset % COOKED_TEXTURE_ALIGNMENT != 0 || entry.offset < tableEnd || entry.offset + entry.size > size)
+			{
+				WOVEN_LOG_ERROR("Cooked texture mip %u is out of bounds or mis-sized", mip);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t GetBlockBytes(VkFormat format)
+	{
+		switch (format)
+		{
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return 8;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return 16;
+			default:
+				return 0;
+		}
+	}
+
+	VkDeviceSize GetMipBytes(VkFormat format, uint32_t width, uint32_t height, uint32_t mip)
+	{
+		const VkDeviceSize w = std::max(1u, width >> mip);
+		const VkDeviceSize h = std::max(1u, height >> mip);
+		const uint32_t blockBytes = GetBlockBytes(format);
+		if (blockBytes != 0)
+		{
+			return ((w + 3) / 4) * ((h + 3) / 4) * blockBytes;
+		}
+		return w * h * 4;
+	}
+} // namespace CookedTexture
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <volk.h>
+
+// GPU-ready texture container written by WovenCook (.wtex).
+// Layout: CookedTextureHeader, mipCount CookedTextureMip entries, then the block-compressed mips
+// finest first, each at an aligned offset. Every mip is uploaded with one buffer-to-image copy straight
+// from the file bytes, so loading is I/O plus one memcpy into staging.
+constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58455457; // "WTEX"
+constexpr uint32_t COOKED_TEXTURE_VERSION = 1;
+constexpr uint32_t COOKED_TEXTURE_ALIGNMENT = 16; // Satisfies bufferOffset rules for every block format
+constexpr uint32_t COOKED_TEXTURE_MAX_MIPS = 16;
+
+struct CookedTextureHeader
+{
+	uint32_t magic = COOKED_TEXTURE_MAGIC;
+	uint32_t version = COOKED_TEXTURE_VERSION;
+	uint32_t format = 0; // VkFormat
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t mipCount = 0;
+	uint32_t flags = 0;
+	uint32_t cookSettings = 0; // Usage and quality WovenCook was run with, for its up-to-date check; 0 if unknown
+};
+
+struct CookedTextureMip
+{
+	uint64_t offset = 0; // From the start of the file
+	uint64_t size = 0;
+};
+
+static_assert(sizeof(CookedTextureHeader) == 32 && sizeof(CookedTextureMip) == 16, "Cooked texture layout is part of the file format");
+
+namespace CookedTexture
+{
+	bool IsCooked(const uint8_t* data, size_t size);
+
+	// Validates the header and the mip table against the file size; outMips points into data
+	bool Parse(const uint8_t* data, size_t size, CookedTextureHeader& outHeader, const CookedTextureMip*& outMips);
+
+	// Bytes per 4x4 block for BC formats, 0 otherwise
+	uint32_t GetBlockBytes(VkFormat format);
+
+	// Tightly packed size of one mip (RGBA8 when not block compressed)
+	VkDeviceSize GetMipBytes(VkFormat format, uint32_t width, uint32_t height, uint32_t mip);
+} // namespace CookedTexture
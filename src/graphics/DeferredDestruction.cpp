@@ -0,0 +1,209 @@
+#include "pch.hpp"
+
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+
+namespace
+{
+	// Bounds each timeline wait so the sweep thread notices Shutdown even if the device is lost
+	constexpr uint64_t kWaitTimeoutNs = 100'000'000;
+} // namespace
+
+bool DeferredDestruction::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, VkSemaphore timeline)
+{
+	ZoneScopedN("DeferredDestruction::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_Timeline = timeline;
+	m_Stop = false;
+	m_Thread = std::thread(&DeferredDestruction::Sweep, this);
+	return true;
+}
+
+void DeferredDestruction::Shutdown()
+{
+	ZoneScopedN("DeferredDestruction::Shutdown");
+
+	if (m_Thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Wake.notify_one();
+		m_Thread.join();
+	}
+
+	// The device is idle, so whatever the sweep had not reached yet can go now
+	for (const Batch& batch: m_Batches)
+	{
+		for (const Object& object: batch.objects)
+		{
+			Destroy(object);
+		}
+	}
+	for (const Object& object: m_Recording)
+	{
+		Destroy(object);
+	}
+	m_Batches.clear();
+	m_Recording.clear();
+	m_SubmittedCount = 0;
+}
+
+void DeferredDestruction::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation)
+{
+	if (buffer != VK_NULL_HANDLE)
+	{
+		Queue({ .buffer = buffer, .allocation = allocation });
+	}
+}
+
+void DeferredDestruction::DestroyImage(VkImage image, VmaAllocation allocation)
+{
+	if (image != VK_NULL_HANDLE)
+	{
+		Queue({ .image = image, .allocation = allocation });
+	}
+}
+
+void DeferredDestruction::DestroyImageView(VkImageView view)
+{
+	if (view != VK_NULL_HANDLE)
+	{
+		Queue({ .view = view });
+	}
+}
+
+void DeferredDestruction::DestroyShader(VkShaderEXT shader)
+{
+	if (shader != VK_NULL_HANDLE)
+	{
+		Queue({ .shader = shader });
+	}
+}
+
+void DeferredDestruction::DestroySwapchain(VkSwapchainKHR swapchain)
+{
+	if (swapchain != VK_NULL_HANDLE)
+	{
+		Queue({ .swapchain = swapchain });
+	}
+}
+
+void DeferredDestruction::Queue(const Object& object)
+{
+	// Before Initialize (or after Shutdown) nothing can be in flight
+	if (!m_Thread.joinable())
+	{
+		Destroy(object);
+		return;
+	}
+	m_Recording.push_back(object);
+}
+
+void DeferredDestruction::Submit(uint64_t timelineValue)
+{
+	if (m_Recording.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SubmittedCount += m_Recording.size();
+		m_Batches.push_back({ std::move(m_Recording), timelineValue });
+	}
+	m_Recording.clear();
+	m_Wake.notify_one();
+}
+
+size_t DeferredDestruction::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_SubmittedCount + m_Recording.size();
+}
+
+void DeferredDestruction::Sweep()
+{
+	tracy::SetThreadName("Deferred Destruction");
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_Wake.wait(lock, [this] { return m_Stop || !m_Batches.empty(); });
+		if (m_Stop)
+		{
+			return;
+		}
+
+		// Only this thread pops, so the front batch stays put while the lock is released for the wait
+		const uint64_t timelineValue = m_Batches.front().timelineValue;
+		lock.unlock();
+
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_Timeline;
+		waitInfo.pValues = &timelineValue;
+		const VkResult result = vkWaitSemaphores(m_Device, &waitInfo, kWaitTimeoutNs);
+
+		lock.lock();
+		if (result == VK_TIMEOUT)
+		{
+			continue;
+		}
+		if (result != VK_SUCCESS)
+		{
+			// Leave the rest to Shutdown
+			WOVEN_LOG_ERROR("Deferred destruction stopped: timeline wait failed (%d)", result);
+			return;
+		}
+
+		Batch batch = std::move(m_Batches.front());
+		m_Batches.pop_front();
+		lock.unlock();
+
+		{
+			ZoneScopedN("DeferredDestruction::Sweep");
+			for (const Object& object: batch.objects)
+			{
+				Destroy(object);
+			}
+		}
+
+		lock.lock();
+		m_SubmittedCount -= batch.objects.size();
+	}
+}
+
+void DeferredDestruction::Destroy(const Object& object)
+{
+	if (object.view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(m_Device, object.view, nullptr);
+	}
+	if (object.image != VK_NULL_HANDLE)
+	{
+		m_MemoryStats->Untrack(object.allocation);
+		vmaDestroyImage(m_Allocator, object.image, object.allocation);
+	}
+	if (object.buffer != VK_NULL_HANDLE)
+	{
+		m_MemoryStats->Untrack(object.allocation);
+		vmaDestroyBuffer(m_Allocator, object.buffer, object.allocation);
+	}
+	if (object.shader != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderEXT(m_Device, object.shader, nullptr);
+	}
+	if (object.swapchain != VK_NULL_HANDLE)
+	{
+		vkDestroySwapchainKHR(m_Device, object.swapchain, nullptr);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vk_mem_alloc.h>
+
+class GpuMemoryStats;
+
+// Destruction of GPU objects that submitted work may still use.
+// The render thread queues objects as it replaces them. Submit stamps everything queued since the last call with
+// the graphics timeline value of the frame's last submission, which every earlier use of those objects precedes
+// on the queue. A sweep thread waits on the timeline and destroys each batch once the GPU has passed it, so
+// replacing a resource never needs a device idle and the render thread never pays for the destroy calls.
+// Bindless slots are not queued here: the registry recycles them on its own frame-keyed list.
+class DeferredDestruction
+{
+public:
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, VkSemaphore timeline);
+	// Device idle: stops the sweep thread and destroys everything still queued
+	void Shutdown();
+
+	// Render thread. Allocations are untracked from GpuMemoryStats when they are destroyed.
+	void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
+	void DestroyImage(VkImage image, VmaAllocation allocation);
+	void DestroyImageView(VkImageView view);
+	void DestroyShader(VkShaderEXT shader);
+	void DestroySwapchain(VkSwapchainKHR swapchain);
+
+	// After the frame's last submission, which signals timelineValue on the graphics timeline
+	void Submit(uint64_t timelineValue);
+
+	// Objects queued or waiting for the GPU
+	size_t GetPendingCount() const;
+
+private:
+	// One handle set per entry; the sweep destroys whichever is not null
+	struct Object
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		VkShaderEXT shader = VK_NULL_HANDLE;
+		VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+	};
+
+	struct Batch
+	{
+		std::vector<Object> objects;
+		uint64_t timelineValue = 0;
+	};
+
+	void Queue(const Object& object);
+	void Sweep();
+	void Destroy(const Object& object);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	VkSemaphore m_Timeline = VK_NULL_HANDLE;
+
+	// Queued since the last Submit (render thread only)
+	std::vector<Object> m_Recording;
+
+	// Submitted batches in timeline order, handed to the sweep thread
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::deque<Batch> m_Batches;
+	size_t m_SubmittedCount = 0;
+	bool m_Stop = false;
+	std::thread m_Thread;
+};
@@ -0,0 +1,124 @@
+#include "pch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <glm/mat4x3.hpp>
+
+#include "core/FileSystem.hpp"
+#include "core/Logger.hpp"
+#include "graphics/FrameCapture.hpp"
+
+namespace
+{
+	size_t GetPayloadBytes(const FrameCaptureHeader& header)
+	{
+		const size_t perSlot = sizeof(glm::mat4x3) + sizeof(glm::vec4) + sizeof(uint32_t) * 2;
+		return static_cast<size_t>(header.slotCount) * perSlot + static_cast<size_t>(header.lightCount) * sizeof(GpuLight);
+	}
+
+	template<typename T>
+	void Read(const uint8_t*& cursor, std::vector<T>& outValues, uint32_t count)
+	{
+		outValues.resize(count);
+		std::memcpy(outValues.data(), cursor, sizeof(T) * count);
+		cursor += sizeof(T) * count;
+	}
+
+	template<typename T>
+	void Write(std::ofstream& file, const std::vector<T>& values)
+	{
+		file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(sizeof(T) * values.size()));
+	}
+} // namespace
+
+bool FrameCapture::LoadFromFile(const std::filesystem::path& path)
+{
+	ZoneScopedN("FrameCapture::LoadFromFile");
+
+	const std::vector<uint8_t> data = FileSystem::LoadFile(path);
+	if (data.size() < sizeof(FrameCaptureHeader))
+	{
+		WOVEN_LOG_ERROR("Failed to read frame capture: %s", path.string().c_str());
+		return false;
+	}
+
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != FRAME_CAPTURE_MAGIC || header.version != FRAME_CAPTURE_VERSION)
+	{
+		WOVEN_LOG_ERROR("Unsupported frame capture %s (magic 0x%08x, version %u)", path.string().c_str(), header.magic, header.version);
+		return false;
+	}
+	if (header.width == 0 || header.height == 0 || data.size() != sizeof(FrameCaptureHeader) + GetPayloadBytes(header))
+	{
+		WOVEN_LOG_ERROR("Frame capture %s is truncated or has invalid dimensions", path.string().c_str());
+		return false;
+	}
+
+	const uint8_t* cursor = data.data() + sizeof(FrameCaptureHeader);
+	std::vector<glm::mat4x3> affine;
+	Read(cursor, affine, header.slotCount);
+	Read(cursor, bounds, header.slotCount);
+	Read(cursor, materials, header.slotCount);
+	Read(cursor, meshes, header.slotCount);
+	Read(cursor, lights, header.lightCount);
+
+	transforms.resize(header.slotCount);
+	for (uint32_t i = 0; i < header.slotCount; ++i)
+	{
+		if (bounds[i].w >= 0.0f && meshes[i] >= header.meshCount)
+		{
+			WOVEN_LOG_ERROR("Frame capture %s: slot %u references mesh %u of %u", path.string().c_str(), i, meshes[i], header.meshCount);
+			return false;
+		}
+		transforms[i] = glm::mat4(affine[i]);
+	}
+
+	WOVEN_LOG_INFO("Loaded frame capture %s (%ux%u, %u scene slots, %u lights)", path.string().c_str(), header.width, header.height, header.slotCount, header.lightCount);
+	return true;
+}
+
+bool FrameCapture::SaveToFile(const std::filesystem::path& path) const
+{
+	ZoneScopedN("FrameCapture::SaveToFile");
+
+	if (transforms.size() != header.slotCount || bounds.size() != header.slotCount || materials.size() != header.slotCount || meshes.size() != header.slotCount || lights.size() != header.lightCount)
+	{
+		WOVEN_LOG_ERROR("Frame capture streams do not match the header");
+		return false;
+	}
+
+	std::error_code ec;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), ec);
+	}
+
+	// Scene transforms are affine, so the constant last row is dropped
+	std::vector<glm::mat4x3> affine(transforms.size());
+	for (size_t i = 0; i < transforms.size(); ++i)
+	{
+		affine[i] = glm::mat4x3(transforms[i]);
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		WOVEN_LOG_ERROR("Failed to write frame capture: %s", path.string().c_str());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	Write(file, affine);
+	Write(file, bounds);
+	Write(file, materials);
+	Write(file, meshes);
+	Write(file, lights);
+	if (!file.good())
+	{
+		WOVEN_LOG_ERROR("Failed to write frame capture: %s", path.string().c_str());
+		return false;
+	}
+
+	WOVEN_LOG_INFO("Wrote frame capture %s (%u scene slots, %u lights, %zu bytes)", path.string().c_str(), header.slotCount, header.lightCount, sizeof(header) + GetPayloadBytes(header));
+	return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+
+#include "graphics/RenderConstants.hpp"
+
+// One frame's render inputs, written by GraphicsSystem::RequestFrameCapture and replayed by WovenBench --replay (.wcap).
+// Draw lists are built on the GPU by culling the scene against the view, so the capture holds those inputs rather than
+// recorded commands: the same build replaying them rebuilds the same draws. Device addresses and bindless slots differ
+// per run and are recreated on replay; geometry is the build's demo meshes, referenced by index.
+// Layout: FrameCaptureHeader, then slotCount entries of each instance stream (affine transforms as mat4x3, object-space
+// bounds, materials, meshes), then lightCount GpuLight.
+constexpr uint32_t FRAME_CAPTURE_MAGIC = 0x50414357; // "WCAP"
+constexpr uint32_t FRAME_CAPTURE_VERSION = 1;
+
+// Render toggles that change which passes run
+enum FrameCaptureFlags : uint32_t
+{
+	FrameCaptureWireframe = 1 << 0,
+	FrameCaptureCullBackFace = 1 << 1,
+	FrameCaptureVisibilityBuffer = 1 << 2,
+	FrameCaptureSoftwareRaster = 1 << 3,
+	FrameCaptureShadows = 1 << 4,
+	FrameCaptureCacheShadowCascades = 1 << 5,
+	FrameCaptureVariableRateShading = 1 << 6,
+	FrameCaptureAsyncCompute = 1 << 7,
+};
+
+struct FrameCaptureHeader
+{
+	uint32_t magic = FRAME_CAPTURE_MAGIC;
+	uint32_t version = FRAME_CAPTURE_VERSION;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint64_t frameNumber = 0; // In the capturing run, for reference
+	float time = 0.0f;
+	uint32_t flags = 0; // FrameCaptureFlags
+	glm::vec3 cameraPosition = {};
+	float fovDegrees = 0.0f;
+	glm::vec3 cameraTarget = {};
+	float nearPlane = 0.0f;
+	glm::vec3 cameraUp = {};
+	float farPlane = 0.0f;
+	glm::vec4 clearColor = {};
+	float lodErrorPixels = 0.0f;
+	float softwareRasterPixels = 0.0f;
+	float shadingRateThreshold = 0.0f;
+	uint32_t meshCount = 0; // Meshes the capturing build had; replay refuses fewer
+	uint32_t slotCount = 0; // Scene slots, removed ones included (negative bounds radius)
+	uint32_t lightCount = 0;
+	uint32_t reserved[2] = {};
+};
+
+static_assert(sizeof(FrameCaptureHeader) == 128, "Frame capture header is part of the file format");
+
+struct FrameCapture
+{
+	FrameCaptureHeader header;
+	std::vector<glm::mat4> transforms;
+	std::vector<glm::vec4> bounds;
+	std::vector<uint32_t> materials;
+	std::vector<uint32_t> meshes;
+	std::vector<GpuLight> lights;
+
+	bool LoadFromFile(const std::filesystem::path& path);
+	bool SaveToFile(const std::filesystem::path& path) const;
+};
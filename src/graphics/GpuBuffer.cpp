@@ -0,0 +1,73 @@
+#include "pch.hpp"
+
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+
+bool CreateGpuBuffer(VkDevice device, VmaAllocator allocator, GpuMemoryStats* memoryStats, VkDeviceSize size, VkBufferUsageFlags usage, GpuBufferAccess access, const char* name, GpuBuffer& outBuffer)
+{
+	const bool readback = access == GpuBufferAccess::HostReadback;
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = readback ? usage : usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = readback ? VMA_MEMORY_USAGE_AUTO : VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+	if (readback)
+	{
+		allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	}
+
+	GpuBuffer buffer;
+	VmaAllocationInfo info{};
+	if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer.buffer, &buffer.allocation, &info) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create %s buffer (%llu bytes)", name, static_cast<unsigned long long>(size));
+		outBuffer = {};
+		return false;
+	}
+	memoryStats->Track(buffer.allocation, readback ? GpuMemoryCategory::Staging : GpuMemoryCategory::Buffer, name);
+	buffer.mapped = info.pMappedData;
+	buffer.size = size;
+
+	if (!readback)
+	{
+		VkBufferDeviceAddressInfo addressInfo{};
+		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		addressInfo.buffer = buffer.buffer;
+		buffer.address = vkGetBufferDeviceAddress(device, &addressInfo);
+	}
+	outBuffer = buffer;
+	return true;
+}
+
+void DestroyGpuBuffer(VmaAllocator allocator, GpuMemoryStats* memoryStats, GpuBuffer& buffer)
+{
+	if (buffer.buffer != VK_NULL_HANDLE)
+	{
+		memoryStats->Untrack(buffer.allocation);
+		vmaDestroyBuffer(allocator, buffer.buffer, buffer.allocation);
+	}
+	buffer = {};
+}
+
+void RecordMemoryBarrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+{
+	VkMemoryBarrier2 barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	barrier.srcStageMask = srcStage;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstStageMask = dstStage;
+	barrier.dstAccessMask = dstAccess;
+
+	VkDependencyInfo depInfo{};
+	depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	depInfo.memoryBarrierCount = 1;
+	depInfo.pMemoryBarriers = &barrier;
+	vkCmdPipelineBarrier2(cmd, &depInfo);
+}
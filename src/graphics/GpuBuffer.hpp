@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+class GpuMemoryStats;
+
+// A buffer owned by one of the GPU-driven subsystems. Device buffers carry their device address
+// (shaders reach them through push constants); readback buffers stay persistently mapped.
+struct GpuBuffer
+{
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	VkDeviceAddress address = 0;
+	void* mapped = nullptr;
+	VkDeviceSize size = 0; // Bytes
+};
+
+enum class GpuBufferAccess : uint8_t
+{
+	Device,      // Device local, SHADER_DEVICE_ADDRESS added to the usage
+	HostReadback // Host cached and mapped, tracked as staging
+};
+
+// Logs and leaves outBuffer empty on failure
+bool CreateGpuBuffer(VkDevice device, VmaAllocator allocator, GpuMemoryStats* memoryStats, VkDeviceSize size, VkBufferUsageFlags usage, GpuBufferAccess access, const char* name, GpuBuffer& outBuffer);
+
+// Immediate destroy; buffers that in-flight frames may still read go through DeferredDestruction instead
+void DestroyGpuBuffer(VmaAllocator allocator, GpuMemoryStats* memoryStats, GpuBuffer& buffer);
+
+// Global memory barrier between two stage/access scopes
+void RecordMemoryBarrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess);
@@ -0,0 +1,198 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuCulling.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/ShaderSystem.hpp"
+
+namespace
+{
+	constexpr uint32_t kCullGroupSize = 64; // Matches numthreads in shaders/cull.slang
+} // namespace
+
+bool GpuCulling::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, DeferredDestruction& destruction, uint32_t framesInFlight, uint32_t maxInstances)
+{
+	ZoneScopedN("GpuCulling::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+	m_Destruction = &destruction;
+
+	ShaderCompileDesc cullDesc{};
+	cullDesc.filePath = "shaders/cull.slang";
+	cullDesc.entryPoint = "cullMain";
+	cullDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	if (!m_ShaderSystem->CreateShaderObject(cullDesc, m_CullShader))
+	{
+		return false;
+	}
+
+	if (!Reserve(std::max(maxInstances, 1u)))
+		return false;
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, DRAW_COUNTER_COUNT * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Draw Counts", m_DrawCounts))
+		return false;
+
+	m_CountReadback.resize(framesInFlight);
+	for (GpuBuffer& readback: m_CountReadback)
+	{
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, DRAW_COUNTER_COUNT * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::HostReadback, "Draw Count Readback", readback))
+			return false;
+		std::memset(readback.mapped, 0, DRAW_COUNTER_COUNT * sizeof(uint32_t));
+	}
+
+	WOVEN_LOG_INFO("GPU culling initialized: %u instances, %u buckets", m_Capacity, MATERIAL_BUCKET_COUNT);
+	return true;
+}
+
+void GpuCulling::Shutdown()
+{
+	for (GpuBuffer& readback: m_CountReadback)
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, readback);
+	}
+	m_CountReadback.clear();
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_DrawCounts);
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_DrawCommands);
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_VisibleInstances);
+
+	if (m_ShaderSystem)
+	{
+		m_ShaderSystem->DestroyShader(m_CullShader);
+	}
+	m_CullShader = VK_NULL_HANDLE;
+	m_ShaderSystem = nullptr;
+	m_Destruction = nullptr;
+	m_Capacity = 0;
+	m_HasCounters = false;
+}
+
+bool GpuCulling::Reserve(uint32_t capacity)
+{
+	if (capacity <= m_Capacity)
+	{
+		return true;
+	}
+
+	// Every bucket can hold every instance, so the cull shader never has to bounds-check its append
+	const VkDeviceSize drawSlots = static_cast<VkDeviceSize>(capacity) * MATERIAL_BUCKET_COUNT;
+	GpuBuffer visibleInstances;
+	GpuBuffer drawCommands;
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, drawSlots * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, GpuBufferAccess::Device, "Visible Instances", visibleInstances) ||
+	    !CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, drawSlots * sizeof(VkDrawMeshTasksIndirectCommandEXT), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, GpuBufferAccess::Device, "Draw Commands", drawCommands))
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, visibleInstances);
+		return false;
+	}
+
+	// Frames in flight may still draw from the old lists; they go once those frames retire
+	m_Destruction->DestroyBuffer(m_VisibleInstances.buffer, m_VisibleInstances.allocation);
+	m_Destruction->DestroyBuffer(m_DrawCommands.buffer, m_DrawCommands.allocation);
+	m_VisibleInstances = visibleInstances;
+	m_DrawCommands = drawCommands;
+	m_Capacity = capacity;
+	return true;
+}
+
+void GpuCulling::RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, const Instances& instances, const Geometry& geometry, const View& view, const Raster& raster, const MaterialPass& materialPass, VkPipelineLayout layout, PushConstants& push)
+{
+	ZoneScopedN("GpuCulling::RecordCull");
+
+	// Draw counters from the last frame recorded in this slot, shown as the cull stats
+	GpuBuffer& readback = m_CountReadback[frameIndex];
+	vmaInvalidateAllocation(m_Allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+	std::memcpy(m_Counters.data(), readback.mapped, sizeof(uint32_t) * DRAW_COUNTER_COUNT);
+
+	// Only after a failed Reserve, which already logged: culling into the smaller lists would write past their end
+	if (instances.count > m_Capacity)
+	{
+		push.drawData = 0;
+		return;
+	}
+
+	const TransientBuffer drawDataBuffer = pools.AllocateTransient(sizeof(GpuDrawData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	if (drawDataBuffer.buffer == VK_NULL_HANDLE)
+	{
+		push.drawData = 0;
+		return;
+	}
+
+	GpuDrawData drawData{};
+	drawData.transforms = instances.transforms;
+	drawData.bounds = instances.bounds;
+	drawData.materials = instances.materials;
+	drawData.meshes = instances.meshes;
+	drawData.visibleInstances = m_VisibleInstances.address;
+	drawData.drawCommands = m_DrawCommands.address;
+	drawData.drawCounts = m_DrawCounts.address;
+	drawData.meshTable = geometry.meshTable;
+	drawData.meshlets = geometry.meshlets;
+	drawData.vertices = geometry.vertices;
+	drawData.triangles = geometry.triangles;
+	drawData.instanceCount = instances.count;
+	drawData.bucketCapacity = m_Capacity;
+	drawData.cameraPosition = view.cameraPosition;
+	drawData.lodScale = view.lodScale;
+	drawData.visibility = raster.visibility;
+	drawData.softwareDispatch = raster.dispatch;
+	drawData.softwareClusters = raster.clusters;
+	drawData.softwareCapacity = raster.capacity;
+	drawData.softwareScale = raster.scale;
+	drawData.materialDispatch = materialPass.dispatch;
+	drawData.materialTiles = materialPass.tiles;
+	drawData.visibilityImage = materialPass.visibilityImage;
+	drawData.colorImage = materialPass.colorImage;
+	drawData.tileCapacity = materialPass.tileCapacity;
+	drawData.backgroundColor = materialPass.backgroundColor;
+	std::memcpy(drawDataBuffer.mapped, &drawData, sizeof(drawData));
+	push.drawData = drawDataBuffer.deviceAddress;
+
+	// The counters still hold the previous frame's results (bucket counts from its cull, LOD counters
+	// from its task shaders); snapshot them for this slot's readback, then clear
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	if (m_HasCounters) // Never written before the first clear
+	{
+		const VkBufferCopy region{ 0, 0, DRAW_COUNTER_COUNT * sizeof(uint32_t) };
+		vkCmdCopyBuffer(cmd, m_DrawCounts.buffer, readback.buffer, 1, &region);
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	}
+	m_HasCounters = true;
+	vkCmdFillBuffer(cmd, m_DrawCounts.buffer, 0, VK_WHOLE_SIZE, 0);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+	if (instances.count > 0)
+	{
+		const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		vkCmdBindShadersEXT(cmd, 1, &stage, &m_CullShader);
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+		vkCmdDispatch(cmd, (instances.count + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+	}
+
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+void GpuCulling::RecordDraws(VkCommandBuffer cmd, VkPipelineLayout layout, PushConstants push) const
+{
+	ZoneScopedN("GpuCulling::RecordDraws");
+
+	if (push.drawData == 0)
+	{
+		return;
+	}
+
+	const VkDeviceSize bucketStride = static_cast<VkDeviceSize>(m_Capacity) * sizeof(VkDrawMeshTasksIndirectCommandEXT);
+	for (uint32_t bucket = 0; bucket < MATERIAL_BUCKET_COUNT; ++bucket)
+	{
+		// Empty buckets cost a near-free indirect call; the CPU never learns which ones are empty
+		push.drawBucket = bucket;
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+		vkCmdDrawMeshTasksIndirectCountEXT(cmd, m_DrawCommands.buffer, bucket * bucketStride, m_DrawCounts.buffer, bucket * sizeof(uint32_t), m_Capacity, sizeof(VkDrawMeshTasksIndirectCommandEXT));
+	}
+}
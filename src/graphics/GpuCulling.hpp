@@ -0,0 +1,144 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vk_mem_alloc.h>
+
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/RenderConstants.hpp"
+
+class DeferredDestruction;
+class GpuMemoryPools;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// GPU-driven instance culling.
+// A compute pass tests every instance's bounding sphere against the frustum and appends the visible
+// ones to per-bucket VkDrawMeshTasksIndirectCommandEXT lists plus a count. Drawing is then one
+// vkCmdDrawMeshTasksIndirectCountEXT per material bucket, so CPU cost does not grow with instance count.
+// The task shaders then pick each visible instance's clusters from the LOD cut (shaders/geometry.slang).
+class GpuCulling
+{
+public:
+	// Per-instance arrays, addressed through buffer device address
+	struct Instances
+	{
+		VkDeviceAddress transforms = 0;
+		VkDeviceAddress bounds = 0;
+		VkDeviceAddress materials = 0;
+		VkDeviceAddress meshes = 0;
+		uint32_t count = 0;
+	};
+
+	// Baked mesh data the draws decode (GpuGeometry)
+	struct Geometry
+	{
+		VkDeviceAddress meshTable = 0;
+		VkDeviceAddress meshlets = 0;
+		VkDeviceAddress vertices = 0;
+		VkDeviceAddress triangles = 0;
+	};
+
+	// Software raster targets (SoftwareRaster); scale 0 keeps every cluster on the mesh shader path
+	struct Raster
+	{
+		VkDeviceAddress visibility = 0;
+		VkDeviceAddress dispatch = 0;
+		VkDeviceAddress clusters = 0;
+		uint32_t capacity = 0;
+		float scale = 0.0f; // GetLodScale with the largest cluster diameter to rasterize in compute
+	};
+
+	// Visibility buffer mode targets (VisibilityBuffer); left empty by the forward path
+	struct MaterialPass
+	{
+		VkDeviceAddress dispatch = 0;
+		VkDeviceAddress tiles = 0;
+		uint32_t visibilityImage = 0; // Bindless storage image indices
+		uint32_t colorImage = 0;
+		uint32_t tileCapacity = 0;
+		glm::vec4 backgroundColor = {};
+	};
+
+	// Camera for the LOD cut the task shaders select
+	struct View
+	{
+		glm::vec3 cameraPosition = {};
+		float lodScale = 0.0f; // See GetLodScale
+	};
+
+	// Pixels covered by one object-space unit at distance 1, over a threshold in pixels
+	static float GetLodScale(const glm::mat4& projection, float viewportHeight, float errorThresholdPixels)
+	{
+		// abs: the projection may be Y-flipped (Camera)
+		return std::abs(projection[1][1]) * 0.5f * viewportHeight / std::max(errorThresholdPixels, 0.01f);
+	}
+
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, DeferredDestruction& destruction, uint32_t framesInFlight, uint32_t maxInstances);
+	void Shutdown();
+
+	// Grows the draw lists to hold capacity instances (GpuScene::GetCapacity); the old lists go through
+	// deferred destruction. On failure the old lists stay and RecordCull skips scenes that do not fit.
+	bool Reserve(uint32_t capacity);
+
+	// Outside rendering. Clears the counts, dispatches the cull and fills push.drawData for the draws.
+	// Also reads back the counters this frame slot snapshotted last time.
+	void RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, const Instances& instances, const Geometry& geometry, const View& view, const Raster& raster, const MaterialPass& materialPass, VkPipelineLayout layout, PushConstants& push);
+
+	// Inside rendering with the task/mesh/fragment shaders bound; push.drawBucket is set per bucket
+	void RecordDraws(VkCommandBuffer cmd, VkPipelineLayout layout, PushConstants push) const;
+
+	uint32_t GetCapacity() const
+	{
+		return m_Capacity;
+	}
+
+	// Visible instances per bucket, framesInFlight + 1 frames old
+	uint32_t GetVisibleCount(uint32_t bucket) const
+	{
+		return m_Counters[bucket];
+	}
+
+	// Clusters and triangles in the LOD cut, as old as GetVisibleCount
+	uint32_t GetDrawnClusterCount() const
+	{
+		return m_Counters[DRAW_COUNTER_CLUSTERS];
+	}
+
+	uint32_t GetDrawnTriangleCount() const
+	{
+		return m_Counters[DRAW_COUNTER_TRIANGLES];
+	}
+
+	// The part of the cut the software rasterizer took
+	uint32_t GetSoftwareClusterCount() const
+	{
+		return m_Counters[DRAW_COUNTER_SOFTWARE_CLUSTERS];
+	}
+
+	uint32_t GetSoftwareTriangleCount() const
+	{
+		return m_Counters[DRAW_COUNTER_SOFTWARE_TRIANGLES];
+	}
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+	VkShaderEXT m_CullShader = VK_NULL_HANDLE;
+
+	uint32_t m_Capacity = 0;
+	GpuBuffer m_VisibleInstances;
+	GpuBuffer m_DrawCommands;
+	GpuBuffer m_DrawCounts;
+
+	// One readback per frame slot, read once that slot's fence has been waited on
+	std::vector<GpuBuffer> m_CountReadback;
+	std::array<uint32_t, DRAW_COUNTER_COUNT> m_Counters = {};
+	bool m_HasCounters = false;
+};
@@ -0,0 +1,195 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/GpuGeometry.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+
+namespace
+{
+	// Stages that read geometry: the cull pass (mesh table), the task/mesh shaders of the draws and the
+	// software raster (compute) and its resolve (fragment)
+	constexpr VkPipelineStageFlags2 kGeometryReadStages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+
+	constexpr const char* kStreamNames[] = { "Geometry Meshes", "Geometry Meshlets", "Geometry Vertices", "Geometry Triangles" };
+
+	constexpr VkDeviceSize kMinBufferSize = 64 * 1024;
+} // namespace
+
+bool GpuGeometry::Initialize(GpuMemoryPools& pools)
+{
+	m_Pools = &pools;
+	return true;
+}
+
+void GpuGeometry::Shutdown()
+{
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		if (m_Pools)
+		{
+			m_Pools->ReleaseStreaming(m_Streams[stream]);
+		}
+		m_Streams[stream] = nullptr;
+		m_UploadedBytes[stream] = 0;
+	}
+	m_Pools = nullptr;
+
+	m_Meshes.clear();
+	m_Bounds.clear();
+	m_Meshlets.clear();
+	m_Vertices.clear();
+	m_Triangles.clear();
+	m_Stats = {};
+}
+
+uint32_t GpuGeometry::AddMesh(const BakedMesh& mesh)
+{
+	if (mesh.meshlets.empty())
+	{
+		WOVEN_LOG_ERROR("Cannot add a mesh without meshlets");
+		return INVALID_MESH;
+	}
+
+	const uint32_t vertexBase = static_cast<uint32_t>(m_Vertices.size());
+	const uint32_t triangleBase = static_cast<uint32_t>(m_Triangles.size());
+
+	GpuMesh entry;
+	entry.meshletOffset = static_cast<uint32_t>(m_Meshlets.size());
+	entry.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+	for (GpuMeshlet meshlet: mesh.meshlets)
+	{
+		meshlet.vertexOffset += vertexBase;
+		meshlet.triangleOffset += triangleBase;
+		m_Meshlets.push_back(meshlet);
+	}
+	m_Vertices.insert(m_Vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+	m_Triangles.insert(m_Triangles.end(), mesh.triangles.begin(), mesh.triangles.end());
+	m_Meshes.push_back(entry);
+	m_Bounds.push_back(mesh.bounds);
+
+	m_Stats.meshCount = static_cast<uint32_t>(m_Meshes.size());
+	m_Stats.meshletCount = static_cast<uint32_t>(m_Meshlets.size());
+	m_Stats.vertexCount = static_cast<uint32_t>(m_Vertices.size());
+	m_Stats.triangleCount = static_cast<uint32_t>(m_Triangles.size());
+	m_Stats.bakedBytes += mesh.bakedBytes;
+	m_Stats.sourceBytes += mesh.sourceBytes;
+	return static_cast<uint32_t>(m_Meshes.size() - 1);
+}
+
+const void* GpuGeometry::GetStreamData(Stream stream) const
+{
+	switch (stream)
+	{
+		case StreamMeshes:
+			return m_Meshes.data();
+		case StreamMeshlets:
+			return m_Meshlets.data();
+		case StreamVertices:
+			return m_Vertices.data();
+		case StreamTriangles:
+			return m_Triangles.data();
+		default:
+			return nullptr;
+	}
+}
+
+VkDeviceSize GpuGeometry::GetStreamBytes(Stream stream) const
+{
+	switch (stream)
+	{
+		case StreamMeshes:
+			return m_Meshes.size() * sizeof(GpuMesh);
+		case StreamMeshlets:
+			return m_Meshlets.size() * sizeof(GpuMeshlet);
+		case StreamVertices:
+			return m_Vertices.size() * sizeof(GpuQuantizedVertex);
+		case StreamTriangles:
+			return m_Triangles.size() * sizeof(uint32_t);
+		default:
+			return 0;
+	}
+}
+
+void GpuGeometry::RecordUpload(VkCommandBuffer cmd)
+{
+	VkDeviceSize stagingSize = 0;
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		stagingSize += GetStreamBytes(static_cast<Stream>(stream)) - m_UploadedBytes[stream];
+	}
+	if (stagingSize == 0)
+	{
+		return;
+	}
+
+	ZoneScopedN("GpuGeometry::RecordUpload");
+
+	// Grow first: a new buffer starts empty, so its whole stream goes up again
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		const VkDeviceSize bytes = GetStreamBytes(static_cast<Stream>(stream));
+		const VkDeviceSize capacity = m_Streams[stream] ? m_Streams[stream]->bufferInfo.size : 0;
+		if (bytes <= capacity)
+		{
+			continue;
+		}
+
+		StreamingResource* grown = m_Pools->CreateStreamingBuffer(std::max({ bytes, capacity * 2, kMinBufferSize }), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, kStreamNames[stream]);
+		if (!grown)
+		{
+			return;
+		}
+		// The pool keeps it alive while frames in flight may still read it
+		m_Pools->ReleaseStreaming(m_Streams[stream]);
+		m_Streams[stream] = grown;
+		stagingSize += m_UploadedBytes[stream];
+		m_UploadedBytes[stream] = 0;
+	}
+
+	const TransientBuffer staging = m_Pools->AllocateTransient(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (staging.buffer == VK_NULL_HANDLE)
+	{
+		// Nothing is marked uploaded, the copy is retried next frame
+		return;
+	}
+
+	// Appends never overwrite data an earlier frame reads, so only the copy -> read dependency is needed
+	VkDeviceSize stagingOffset = 0;
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		const VkDeviceSize bytes = GetStreamBytes(static_cast<Stream>(stream));
+		const VkDeviceSize uploaded = m_UploadedBytes[stream];
+		if (bytes == uploaded)
+		{
+			continue;
+		}
+
+		std::memcpy(static_cast<uint8_t*>(staging.mapped) + stagingOffset, static_cast<const uint8_t*>(GetStreamData(static_cast<Stream>(stream))) + uploaded, bytes - uploaded);
+		const VkBufferCopy region{ stagingOffset, uploaded, bytes - uploaded };
+		vkCmdCopyBuffer(cmd, staging.buffer, m_Streams[stream]->buffer, 1, &region);
+		stagingOffset += bytes - uploaded;
+		m_UploadedBytes[stream] = bytes;
+	}
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, kGeometryReadStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+	WOVEN_LOG_INFO("Uploaded %.1f KiB of geometry (%u meshes, %u meshlets)", static_cast<double>(stagingSize) / 1024.0, m_Stats.meshCount, m_Stats.meshletCount);
+}
+
+GpuCulling::Geometry GpuGeometry::GetGeometry() const
+{
+	const auto address = [this](Stream stream) -> VkDeviceAddress
+	{
+		return m_Streams[stream] ? m_Streams[stream]->deviceAddress : 0;
+	};
+
+	GpuCulling::Geometry geometry{};
+	geometry.meshTable = address(StreamMeshes);
+	geometry.meshlets = address(StreamMeshlets);
+	geometry.vertices = address(StreamVertices);
+	geometry.triangles = address(StreamTriangles);
+	return geometry;
+}
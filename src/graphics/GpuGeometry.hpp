@@ -0,0 +1,80 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/GpuCulling.hpp"
+#include "graphics/MeshBaker.hpp"
+
+class GpuMemoryPools;
+struct StreamingResource;
+
+constexpr uint32_t INVALID_MESH = UINT32_MAX;
+
+// Baked meshes on the GPU: mesh table, meshlets, quantized vertices and packed triangles in
+// streaming pool buffers (read through buffer device address by the task/mesh shaders).
+// Defragmentation may move a stream, so the addresses are fetched from GetGeometry every frame.
+// Meshes are append-only; AddMesh only fills the CPU mirror and RecordUpload copies the new tail.
+// Not thread-safe: add from the render thread only.
+class GpuGeometry
+{
+public:
+	struct Stats
+	{
+		uint32_t meshCount = 0;
+		uint32_t meshletCount = 0;
+		uint32_t vertexCount = 0;
+		uint32_t triangleCount = 0;
+		VkDeviceSize bakedBytes = 0;  // What the GPU holds
+		VkDeviceSize sourceBytes = 0; // Same meshes as float attributes + 32-bit indices
+	};
+
+	bool Initialize(GpuMemoryPools& pools);
+	void Shutdown();
+
+	// Returns the mesh index to store per instance (GpuScene), or INVALID_MESH
+	uint32_t AddMesh(const BakedMesh& mesh);
+
+	// Object-space bounding sphere, for the instances using the mesh
+	const glm::vec4& GetBounds(uint32_t mesh) const
+	{
+		return m_Bounds[mesh];
+	}
+
+	// Outside rendering, before the draws of this frame
+	void RecordUpload(VkCommandBuffer cmd);
+
+	GpuCulling::Geometry GetGeometry() const;
+
+	const Stats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+private:
+	enum Stream : uint32_t
+	{
+		StreamMeshes,
+		StreamMeshlets,
+		StreamVertices,
+		StreamTriangles,
+		StreamCount
+	};
+
+	const void* GetStreamData(Stream stream) const;
+	VkDeviceSize GetStreamBytes(Stream stream) const;
+
+private:
+	GpuMemoryPools* m_Pools = nullptr;
+
+	// CPU mirror, kept so a grown buffer can be refilled
+	std::vector<GpuMesh> m_Meshes;
+	std::vector<glm::vec4> m_Bounds;
+	std::vector<GpuMeshlet> m_Meshlets;
+	std::vector<GpuQuantizedVertex> m_Vertices;
+	std::vector<uint32_t> m_Triangles;
+
+	StreamingResource* m_Streams[StreamCount] = {};
+	VkDeviceSize m_UploadedBytes[StreamCount] = {};
+	Stats m_Stats;
+};
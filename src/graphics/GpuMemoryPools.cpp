@@ -0,0 +1,818 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+
+namespace
+{
+	// One ring shared by all frames in flight (uniforms, instance data, indirect args)
+	constexpr VkDeviceSize kTransientPoolSize = 32ull * 1024 * 1024;
+	constexpr VkDeviceSize kStreamingBlockSize = 64ull * 1024 * 1024;
+
+	// Fragmentation is checked every N frames; a pass is only worth it if at least a block could be returned
+	constexpr uint64_t kDefragCheckInterval = 120;
+
+	constexpr VkBufferUsageFlags kTransientUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+	constexpr VkBufferUsageFlags kStreamingBufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	double ToMiB(VkDeviceSize bytes)
+	{
+		return static_cast<double>(bytes) / (1024.0 * 1024.0);
+	}
+} // namespace
+
+const char* GpuMemoryPools::GetPoolName(StreamingPool pool)
+{
+	switch (pool)
+	{
+		case StreamingPool::Buffers:
+			return "Streaming Buffers";
+		case StreamingPool::Images:
+			return "Streaming Images";
+		default:
+			return "Unknown";
+	}
+}
+
+bool GpuMemoryPools::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, uint32_t framesInFlight)
+{
+	ZoneScopedN("GpuMemoryPools::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_FramesInFlight = framesInFlight;
+	m_Transients.resize(framesInFlight);
+	m_StreamingBlockSize = kStreamingBlockSize;
+
+	// Transient ring: host-visible, device-local when the heap allows it (ReBAR/UMA)
+	const VkBufferCreateInfo transientInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = 64 * 1024,
+		.usage = kTransientUsage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+	};
+	const VmaAllocationCreateInfo transientAlloc{
+		.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+		.usage = VMA_MEMORY_USAGE_AUTO,
+	};
+
+	uint32_t memoryTypeIndex = 0;
+	if (vmaFindMemoryTypeIndexForBufferInfo(m_Allocator, &transientInfo, &transientAlloc, &memoryTypeIndex) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("No memory type for transient pool");
+		return false;
+	}
+
+	// A single block is required for VMA's ring-buffer behaviour
+	if (!CreatePool(m_TransientPool, memoryTypeIndex, VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT, kTransientPoolSize, 1, "Transient Ring"))
+		return false;
+
+	// Streaming buffers (mesh data)
+	const VkBufferCreateInfo bufferInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = 64 * 1024,
+		.usage = kStreamingBufferUsage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+	};
+	const VmaAllocationCreateInfo deviceAlloc{
+		.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+	};
+
+	if (vmaFindMemoryTypeIndexForBufferInfo(m_Allocator, &bufferInfo, &deviceAlloc, &memoryTypeIndex) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("No memory type for streaming buffer pool");
+		return false;
+	}
+
+	if (!CreatePool(m_StreamingPools[static_cast<size_t>(StreamingPool::Buffers)], memoryTypeIndex, 0, kStreamingBlockSize, 0, GetPoolName(StreamingPool::Buffers)))
+		return false;
+
+	// Streaming images (textures); optimal tiling only, so no buffer/image granularity waste
+	const VkImageCreateInfo imageInfo{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.imageType = VK_IMAGE_TYPE_2D,
+		.format = VK_FORMAT_R8G8B8A8_UNORM,
+		.extent = { 256, 256, 1 },
+		.mipLevels = 1,
+		.arrayLayers = 1,
+		.samples = VK_SAMPLE_COUNT_1_BIT,
+		.tiling = VK_IMAGE_TILING_OPTIMAL,
+		.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	if (vmaFindMemoryTypeIndexForImageInfo(m_Allocator, &imageInfo, &deviceAlloc, &memoryTypeIndex) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("No memory type for streaming image pool");
+		return false;
+	}
+
+	if (!CreatePool(m_StreamingPools[static_cast<size_t>(StreamingPool::Images)], memoryTypeIndex, 0, kStreamingBlockSize, 0, GetPoolName(StreamingPool::Images)))
+		return false;
+
+	WOVEN_LOG_INFO("GPU memory pools initialized (transient %.0f MiB ring, %.0f MiB streaming blocks)", ToMiB(kTransientPoolSize), ToMiB(kStreamingBlockSize));
+	return true;
+}
+
+void GpuMemoryPools::Shutdown()
+{
+	ZoneScopedN("GpuMemoryPools::Shutdown");
+	if (m_Allocator == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	// Caller has waited for the device, so an outstanding pass can be completed right away
+	if (m_DefragPassInFlight)
+	{
+		FinishDefragmentationPass();
+	}
+	if (m_DefragContext != VK_NULL_HANDLE)
+	{
+		EndDefragmentation();
+	}
+
+	for (uint32_t i = 0; i < m_FramesInFlight; ++i)
+	{
+		FreeTransients(i);
+	}
+
+	while (!m_Resources.empty())
+	{
+		DestroyStreaming(m_Resources.back().get());
+	}
+	m_Released.clear();
+
+	for (VmaPool& pool: m_StreamingPools)
+	{
+		if (pool != VK_NULL_HANDLE)
+		{
+			vmaDestroyPool(m_Allocator, pool);
+			pool = VK_NULL_HANDLE;
+		}
+	}
+
+	if (m_TransientPool != VK_NULL_HANDLE)
+	{
+		vmaDestroyPool(m_Allocator, m_TransientPool);
+		m_TransientPool = VK_NULL_HANDLE;
+	}
+
+	m_Allocator = VK_NULL_HANDLE;
+	m_Device = VK_NULL_HANDLE;
+}
+
+bool GpuMemoryPools::CreatePool(VmaPool& outPool, uint32_t memoryTypeIndex, VmaPoolCreateFlags flags, VkDeviceSize blockSize, size_t maxBlockCount, const char* name)
+{
+	VmaPoolCreateInfo poolInfo{};
+	poolInfo.memoryTypeIndex = memoryTypeIndex;
+	poolInfo.flags = flags;
+	poolInfo.blockSize = blockSize;
+	poolInfo.maxBlockCount = maxBlockCount;
+
+	if (vmaCreatePool(m_Allocator, &poolInfo, &outPool) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create VMA pool '%s'", name);
+		return false;
+	}
+
+	vmaSetPoolName(m_Allocator, outPool, name);
+	return true;
+}
+
+void GpuMemoryPools::BeginFrame(uint32_t frameIndex, uint64_t frameNumber)
+{
+	ZoneScopedN("GpuMemoryPools::BeginFrame");
+
+	m_FrameIndex = frameIndex;
+	m_FrameNumber = frameNumber;
+
+	// This slot's previous frame has retired, so its transients are free again (oldest first keeps the ring intact)
+	FreeTransients(frameIndex);
+
+	// Everything recorded up to frameNumber - framesInFlight has executed
+	if (m_DefragPassInFlight && m_DefragPassFrame + m_FramesInFlight <= frameNumber)
+	{
+		FinishDefragmentationPass();
+	}
+
+	for (size_t i = 0; i < m_Released.size();)
+	{
+		StreamingResource* resource = m_Released[i];
+		if (!resource->moving && resource->releaseFrame + m_FramesInFlight <= frameNumber)
+		{
+			DestroyStreaming(resource);
+			m_Released[i] = m_Released.back();
+			m_Released.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (m_DefragContext != VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	const bool periodicCheck = frameNumber % kDefragCheckInterval == 0;
+	if (m_DefragRequestMask == 0 && !periodicCheck)
+	{
+		return;
+	}
+
+	// Round-robin so one busy pool cannot starve the other
+	constexpr uint32_t poolCount = static_cast<uint32_t>(StreamingPool::Count);
+	for (uint32_t i = 0; i < poolCount; ++i)
+	{
+		const uint32_t poolIndex = (m_NextDefragPool + i) % poolCount;
+		const StreamingPool pool = static_cast<StreamingPool>(poolIndex);
+		const bool requested = (m_DefragRequestMask & (1u << poolIndex)) != 0;
+		if (requested || (periodicCheck && ShouldDefragment(pool)))
+		{
+			m_DefragRequestMask &= ~(1u << poolIndex);
+			m_NextDefragPool = (poolIndex + 1) % poolCount;
+			BeginDefragmentation(pool);
+			break;
+		}
+	}
+}
+
+TransientBuffer GpuMemoryPools::AllocateTransient(VkDeviceSize size, VkBufferUsageFlags usage)
+{
+	ZoneScopedN("GpuMemoryPools::AllocateTransient");
+
+	const bool concurrent = m_QueueFamilies.size() > 1;
+	const VkBufferCreateInfo bufferInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = size,
+		.usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(m_QueueFamilies.size()) : 0u,
+		.pQueueFamilyIndices = concurrent ? m_QueueFamilies.data() : nullptr,
+	};
+	VmaAllocationCreateInfo allocInfo{
+		.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+		.usage = VMA_MEMORY_USAGE_AUTO,
+		.pool = m_TransientPool,
+	};
+
+	TransientAllocation transient;
+	VmaAllocationInfo info{};
+	VkResult result = vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &transient.buffer, &transient.allocation, &info);
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+	{
+		// Ring is full: fall back to a regular allocation rather than stalling the frame
+		if (!m_TransientOverflowWarned)
+		{
+			WOVEN_LOG_WARNING("Transient ring exhausted (%.0f MiB), falling back to dedicated allocations", ToMiB(kTransientPoolSize));
+			m_TransientOverflowWarned = true;
+		}
+		allocInfo.pool = VK_NULL_HANDLE;
+		result = vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &transient.buffer, &transient.allocation, &info);
+	}
+
+	if (result != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to allocate %llu byte transient buffer", static_cast<unsigned long long>(size));
+		return {};
+	}
+
+	m_Transients[m_FrameIndex].push_back(transient);
+
+	const VkBufferDeviceAddressInfo addressInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer = transient.buffer,
+	};
+
+	return TransientBuffer{
+		.buffer = transient.buffer,
+		.size = size,
+		.mapped = info.pMappedData,
+		.deviceAddress = vkGetBufferDeviceAddress(m_Device, &addressInfo),
+	};
+}
+
+void GpuMemoryPools::FreeTransients(uint32_t frameIndex)
+{
+	for (const TransientAllocation& transient: m_Transients[frameIndex])
+	{
+		vmaDestroyBuffer(m_Allocator, transient.buffer, transient.allocation);
+	}
+	m_Transients[frameIndex].clear();
+}
+
+StreamingResource* GpuMemoryPools::CreateStreamingBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const char* name)
+{
+	ZoneScopedN("GpuMemoryPools::CreateStreamingBuffer");
+
+	auto resource = std::make_unique<StreamingResource>();
+	resource->pool = StreamingPool::Buffers;
+	resource->bufferInfo = VkBufferCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = size,
+		// Defragmentation copies buffers on the GPU
+		.usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+	};
+
+	// Oversized resources get their own memory; they cannot fragment a block anyway
+	const VmaAllocationCreateInfo allocInfo{
+		.flags = size > m_StreamingBlockSize / 2 ? VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT : VmaAllocationCreateFlags(0),
+		.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+		.pool = m_StreamingPools[static_cast<size_t>(StreamingPool::Buffers)],
+		.pUserData = resource.get(),
+	};
+
+	if (vmaCreateBuffer(m_Allocator, &resource->bufferInfo, &allocInfo, &resource->buffer, &resource->allocation, nullptr) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create streaming buffer '%s' (%.2f MiB)", name ? name : "", ToMiB(size));
+		return nullptr;
+	}
+
+	if (resource->bufferInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+	{
+		const VkBufferDeviceAddressInfo addressInfo{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+			.buffer = resource->buffer,
+		};
+		resource->deviceAddress = vkGetBufferDeviceAddress(m_Device, &addressInfo);
+	}
+
+	m_MemoryStats->Track(resource->allocation, GpuMemoryCategory::Buffer, name);
+
+	resource->index = static_cast<uint32_t>(m_Resources.size());
+	m_Resources.push_back(std::move(resource));
+	return m_Resources.back().get();
+}
+
+StreamingResource* GpuMemoryPools::CreateStreamingImage(const VkImageCreateInfo& imageInfo, VkImageViewType viewType, VkImageAspectFlags aspectMask, const char* name)
+{
+	ZoneScopedN("GpuMemoryPools::CreateStreamingImage");
+
+	auto resource = std::make_unique<StreamingResource>();
+	resource->pool = StreamingPool::Images;
+	resource->imageInfo = imageInfo;
+	resource->imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	resource->imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	resource->viewType = viewType;
+	resource->aspectMask = aspectMask;
+
+	const VmaAllocationCreateInfo allocInfo{
+		.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+		.pool = m_StreamingPools[static_cast<size_t>(StreamingPool::Images)],
+		.pUserData = resource.get(),
+	};
+
+	if (vmaCreateImage(m_Allocator, &resource->imageInfo, &allocInfo, &resource->image, &resource->allocation, nullptr) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create streaming image '%s' (%ux%u)", name ? name : "", imageInfo.extent.width, imageInfo.extent.height);
+		return nullptr;
+	}
+
+	resource->view = CreateView(*resource, resource->image);
+	if (resource->view == VK_NULL_HANDLE)
+	{
+		vmaDestroyImage(m_Allocator, resource->image, resource->allocation);
+		return nullptr;
+	}
+
+	m_MemoryStats->Track(resource->allocation, GpuMemoryCategory::Texture, name);
+
+	resource->index = static_cast<uint32_t>(m_Resources.size());
+	m_Resources.push_back(std::move(resource));
+	return m_Resources.back().get();
+}
+
+VkImageView GpuMemoryPools::CreateView(const StreamingResource& resource, VkImage image) const
+{
+	const VkImageViewCreateInfo viewInfo{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.image = image,
+		.viewType = resource.viewType,
+		.format = resource.imageInfo.format,
+		.subresourceRange = {
+			.aspectMask = resource.aspectMask,
+			.baseMipLevel = 0,
+			.levelCount = resource.imageInfo.mipLevels,
+			.baseArrayLayer = 0,
+			.layerCount = resource.imageInfo.arrayLayers,
+		},
+	};
+
+	VkImageView view = VK_NULL_HANDLE;
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create streaming image view");
+		return VK_NULL_HANDLE;
+	}
+	return view;
+}
+
+void GpuMemoryPools::ReleaseStreaming(StreamingResource* resource)
+{
+	if (!resource || resource->released)
+	{
+		return;
+	}
+
+	resource->released = true;
+	resource->releaseFrame = m_FrameNumber;
+	m_Released.push_back(resource);
+}
+
+void GpuMemoryPools::DestroyStreaming(StreamingResource* resource)
+{
+	m_MemoryStats->Untrack(resource->allocation);
+
+	if (resource->view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(m_Device, resource->view, nullptr);
+	}
+	if (resource->image != VK_NULL_HANDLE)
+	{
+		vmaDestroyImage(m_Allocator, resource->image, resource->allocation);
+	}
+	else
+	{
+		vmaDestroyBuffer(m_Allocator, resource->buffer, resource->allocation);
+	}
+
+	// Swap-remove keeps the owning list dense
+	const uint32_t index = resource->index;
+	if (index + 1 != m_Resources.size())
+	{
+		m_Resources[index] = std::move(m_Resources.back());
+		m_Resources[index]->index = index;
+	}
+	m_Resources.pop_back();
+}
+
+bool GpuMemoryPools::ShouldDefragment(StreamingPool pool) const
+{
+	VmaStatistics stats{};
+	vmaGetPoolStatistics(m_Allocator, m_StreamingPools[static_cast<size_t>(pool)], &stats);
+	if (stats.blockCount < 2)
+	{
+		return false;
+	}
+
+	// Compaction only returns memory once a whole block drains; near the budget, denser packing is worth it earlier
+	const VkDeviceSize wasted = stats.blockBytes - stats.allocationBytes;
+	const VkDeviceSize threshold = m_MemoryStats->IsNearBudget() ? m_StreamingBlockSize / 4 : m_StreamingBlockSize;
+	return wasted >= threshold;
+}
+
+void GpuMemoryPools::BeginDefragmentation(StreamingPool pool)
+{
+	ZoneScopedN("GpuMemoryPools::BeginDefragmentation");
+
+	VmaDefragmentationInfo defragInfo{};
+	defragInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+	defragInfo.pool = m_StreamingPools[static_cast<size_t>(pool)];
+	defragInfo.maxBytesPerPass = m_MaxBytesPerPass;
+	defragInfo.maxAllocationsPerPass = m_MaxMovesPerPass;
+
+	if (vmaBeginDefragmentation(m_Allocator, &defragInfo, &m_DefragContext) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to begin defragmentation of %s", GetPoolName(pool));
+		m_DefragContext = VK_NULL_HANDLE;
+		return;
+	}
+
+	m_DefragPool = pool;
+	WOVEN_LOG_DEBUG("Defragmenting %s (%.1f MiB per pass)", GetPoolName(pool), ToMiB(m_MaxBytesPerPass));
+}
+
+void GpuMemoryPools::RecordDefragmentation(VkCommandBuffer cmd)
+{
+	if (m_DefragContext == VK_NULL_HANDLE || m_DefragPassInFlight)
+	{
+		return;
+	}
+
+	ZoneScopedN("GpuMemoryPools::RecordDefragmentation");
+
+	const VkResult result = vmaBeginDefragmentationPass(m_Allocator, m_DefragContext, &m_DefragPass);
+	if (result == VK_SUCCESS)
+	{
+		// Nothing left to move
+		EndDefragmentation();
+		return;
+	}
+	if (result != VK_INCOMPLETE)
+	{
+		WOVEN_LOG_ERROR("vmaBeginDefragmentationPass failed: %d", result);
+		EndDefragmentation();
+		return;
+	}
+
+	// Earlier frames may have written the sources
+	const VkMemoryBarrier2 preBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+		.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+	};
+	const VkDependencyInfo preDependency{
+		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount = 1,
+		.pMemoryBarriers = &preBarrier,
+	};
+	vkCmdPipelineBarrier2(cmd, &preDependency);
+
+	m_PendingMoves.reserve(m_DefragPass.moveCount);
+	for (uint32_t i = 0; i < m_DefragPass.moveCount; ++i)
+	{
+		VmaDefragmentationMove& move = m_DefragPass.pMoves[i];
+		if (!RecordMove(cmd, move))
+		{
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		}
+	}
+
+	// Copies must land before this frame's passes read the new locations
+	const VkMemoryBarrier2 postBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+	};
+	const VkDependencyInfo postDependency{
+		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount = 1,
+		.pMemoryBarriers = &postBarrier,
+	};
+	vkCmdPipelineBarrier2(cmd, &postDependency);
+
+	m_DefragPassFrame = m_FrameNumber;
+	m_DefragPassInFlight = true;
+}
+
+bool GpuMemoryPools::RecordMove(VkCommandBuffer cmd, VmaDefragmentationMove& move)
+{
+	VmaAllocationInfo allocInfo{};
+	vmaGetAllocationInfo(m_Allocator, move.srcAllocation, &allocInfo);
+	StreamingResource* resource = static_cast<StreamingResource*>(allocInfo.pUserData);
+
+	// Kept alive until the pass ends even when moving is skipped: VMA reads the source at vmaEndDefragmentationPass
+	resource->moving = true;
+	PendingMove pending{ .resource = resource };
+
+	// Released resources are about to die, copying them is wasted bandwidth
+	if (resource->released)
+	{
+		m_PendingMoves.push_back(pending);
+		return false;
+	}
+
+	if (resource->pool == StreamingPool::Buffers)
+	{
+		VkBuffer newBuffer = VK_NULL_HANDLE;
+		if (vkCreateBuffer(m_Device, &resource->bufferInfo, nullptr, &newBuffer) != VK_SUCCESS)
+		{
+			m_PendingMoves.push_back(pending);
+			return false;
+		}
+		if (vmaBindBufferMemory(m_Allocator, move.dstTmpAllocation, newBuffer) != VK_SUCCESS)
+		{
+			vkDestroyBuffer(m_Device, newBuffer, nullptr);
+			m_PendingMoves.push_back(pending);
+			return false;
+		}
+
+		const VkBufferCopy2 region{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+			.srcOffset = 0,
+			.dstOffset = 0,
+			.size = resource->bufferInfo.size,
+		};
+		const VkCopyBufferInfo2 copyInfo{
+			.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+			.srcBuffer = resource->buffer,
+			.dstBuffer = newBuffer,
+			.regionCount = 1,
+			.pRegions = &region,
+		};
+		vkCmdCopyBuffer2(cmd, &copyInfo);
+
+		pending.oldBuffer = resource->buffer;
+		resource->buffer = newBuffer;
+		if (resource->deviceAddress != 0)
+		{
+			const VkBufferDeviceAddressInfo addressInfo{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+				.buffer = newBuffer,
+			};
+			resource->deviceAddress = vkGetBufferDeviceAddress(m_Device, &addressInfo);
+		}
+	}
+	else
+	{
+		VkImage newImage = VK_NULL_HANDLE;
+		if (vkCreateImage(m_Device, &resource->imageInfo, nullptr, &newImage) != VK_SUCCESS)
+		{
+			m_PendingMoves.push_back(pending);
+			return false;
+		}
+		if (vmaBindImageMemory(m_Allocator, move.dstTmpAllocation, newImage) != VK_SUCCESS)
+		{
+			vkDestroyImage(m_Device, newImage, nullptr);
+			m_PendingMoves.push_back(pending);
+			return false;
+		}
+
+		const VkImageView newView = CreateView(*resource, newImage);
+		if (newView == VK_NULL_HANDLE)
+		{
+			vkDestroyImage(m_Device, newImage, nullptr);
+			m_PendingMoves.push_back(pending);
+			return false;
+		}
+
+		// Images that never received data have nothing worth copying
+		if (resource->layout != VK_IMAGE_LAYOUT_UNDEFINED)
+		{
+			const VkImageSubresourceRange range{ resource->aspectMask, 0, resource->imageInfo.mipLevels, 0, resource->imageInfo.arrayLayers };
+			const VkImageMemoryBarrier2 toCopy[2] = {
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+					.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+					.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+					.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+					.oldLayout = resource->layout,
+					.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = resource->image,
+					.subresourceRange = range,
+				},
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+					.srcAccessMask = VK_ACCESS_2_NONE,
+					.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+					.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = newImage,
+					.subresourceRange = range,
+				},
+			};
+			const VkDependencyInfo toCopyDependency{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.imageMemoryBarrierCount = 2,
+				.pImageMemoryBarriers = toCopy,
+			};
+			vkCmdPipelineBarrier2(cmd, &toCopyDependency);
+
+			std::vector<VkImageCopy2> regions(resource->imageInfo.mipLevels);
+			for (uint32_t mip = 0; mip < resource->imageInfo.mipLevels; ++mip)
+			{
+				const VkImageSubresourceLayers layers{ resource->aspectMask, mip, 0, resource->imageInfo.arrayLayers };
+				regions[mip] = VkImageCopy2{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2,
+					.srcSubresource = layers,
+					.srcOffset = { 0, 0, 0 },
+					.dstSubresource = layers,
+					.dstOffset = { 0, 0, 0 },
+					.extent = {
+						std::max(1u, resource->imageInfo.extent.width >> mip),
+						std::max(1u, resource->imageInfo.extent.height >> mip),
+						std::max(1u, resource->imageInfo.extent.depth >> mip),
+					},
+				};
+			}
+
+			const VkCopyImageInfo2 copyInfo{
+				.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2,
+				.srcImage = resource->image,
+				.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				.dstImage = newImage,
+				.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.regionCount = static_cast<uint32_t>(regions.size()),
+				.pRegions = regions.data(),
+			};
+			vkCmdCopyImage2(cmd, &copyInfo);
+
+			// Hand the new image back in the layout its owner expects
+			const VkImageMemoryBarrier2 toOwner{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.newLayout = resource->layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = newImage,
+				.subresourceRange = range,
+			};
+			const VkDependencyInfo toOwnerDependency{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.imageMemoryBarrierCount = 1,
+				.pImageMemoryBarriers = &toOwner,
+			};
+			vkCmdPipelineBarrier2(cmd, &toOwnerDependency);
+		}
+
+		pending.oldImage = resource->image;
+		pending.oldView = resource->view;
+		resource->image = newImage;
+		resource->view = newView;
+	}
+
+	// Later frames use the new handles; in-flight frames keep reading the old ones until the pass retires
+	++resource->generation;
+	m_PendingMoves.push_back(pending);
+	if (m_OnMoved)
+	{
+		m_OnMoved(*resource);
+	}
+	return true;
+}
+
+void GpuMemoryPools::FinishDefragmentationPass()
+{
+	ZoneScopedN("GpuMemoryPools::FinishDefragmentationPass");
+
+	// Old handles are bound to the memory VMA is about to reclaim
+	for (const PendingMove& pending: m_PendingMoves)
+	{
+		if (pending.oldView != VK_NULL_HANDLE)
+			vkDestroyImageView(m_Device, pending.oldView, nullptr);
+		if (pending.oldImage != VK_NULL_HANDLE)
+			vkDestroyImage(m_Device, pending.oldImage, nullptr);
+		if (pending.oldBuffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(m_Device, pending.oldBuffer, nullptr);
+		pending.resource->moving = false;
+	}
+	m_PendingMoves.clear();
+	m_DefragPassInFlight = false;
+
+	const VkResult result = vmaEndDefragmentationPass(m_Allocator, m_DefragContext, &m_DefragPass);
+	if (result != VK_INCOMPLETE)
+	{
+		EndDefragmentation();
+	}
+}
+
+void GpuMemoryPools::EndDefragmentation()
+{
+	vmaEndDefragmentation(m_Allocator, m_DefragContext, &m_LastDefragStats);
+	m_DefragContext = VK_NULL_HANDLE;
+	m_DefragPass = {};
+
+	if (m_LastDefragStats.allocationsMoved > 0 || m_LastDefragStats.deviceMemoryBlocksFreed > 0)
+	{
+		WOVEN_LOG_INFO("Defragmented %s: moved %u allocations (%.1f MiB), freed %u blocks (%.1f MiB)", GetPoolName(m_DefragPool), m_LastDefragStats.allocationsMoved, ToMiB(m_LastDefragStats.bytesMoved), m_LastDefragStats.deviceMemoryBlocksFreed, ToMiB(m_LastDefragStats.bytesFreed));
+	}
+}
+
+GpuMemoryPools::PoolStats GpuMemoryPools::GetTransientStats() const
+{
+	PoolStats result;
+	if (m_TransientPool == VK_NULL_HANDLE)
+	{
+		return result;
+	}
+
+	VmaStatistics stats{};
+	vmaGetPoolStatistics(m_Allocator, m_TransientPool, &stats);
+	result.blockCount = stats.blockCount;
+	result.allocationCount = stats.allocationCount;
+	result.blockBytes = stats.blockBytes;
+	result.allocationBytes = stats.allocationBytes;
+	return result;
+}
+
+GpuMemoryPools::PoolStats GpuMemoryPools::GetStreamingStats(StreamingPool pool) const
+{
+	PoolStats result;
+	const VmaPool vmaPool = m_StreamingPools[static_cast<size_t>(pool)];
+	if (vmaPool == VK_NULL_HANDLE)
+	{
+		return result;
+	}
+
+	VmaStatistics stats{};
+	vmaGetPoolStatistics(m_Allocator, vmaPool, &stats);
+	result.blockCount = stats.blockCount;
+	result.allocationCount = stats.allocationCount;
+	result.blockBytes = stats.blockBytes;
+	result.allocationBytes = stats.allocationBytes;
+	return result;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vk_mem_alloc.h>
+
+class GpuMemoryStats;
+
+enum class StreamingPool : uint8_t
+{
+	Buffers,
+	Images,
+	Count
+};
+
+// Pooled long-lived resource (meshes, textures). Defragmentation may move it,
+// in which case the handles below are replaced and generation is bumped.
+// A moved buffer also gets a new deviceAddress; GpuGeometry re-reads it every frame instead of caching it.
+struct StreamingResource
+{
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	StreamingPool pool = StreamingPool::Buffers;
+	uint32_t generation = 0;
+
+	// Buffers
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkBufferCreateInfo bufferInfo = {};
+	VkDeviceAddress deviceAddress = 0;
+
+	// Images (one view over all mips/layers)
+	VkImage image = VK_NULL_HANDLE;
+	VkImageView view = VK_NULL_HANDLE;
+	VkImageCreateInfo imageInfo = {};
+	VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
+	VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED; // Layout the owner keeps the image in between frames
+
+private:
+	friend class GpuMemoryPools;
+	uint32_t index = 0;
+	uint64_t releaseFrame = 0;
+	bool released = false;
+	bool moving = false;
+};
+
+// Per-frame scratch buffer, valid until the same frame slot comes around again
+struct TransientBuffer
+{
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+	void* mapped = nullptr;
+	VkDeviceAddress deviceAddress = 0;
+};
+
+// Custom VMA pools per resource class plus incremental defragmentation.
+// - Transient: linear pool with a single block, used as a ring buffer (frames free in submission order)
+// - Streaming buffers/images: TLSF pools with fixed block size, compacted over several frames
+class GpuMemoryPools
+{
+public:
+	struct PoolStats
+	{
+		uint32_t blockCount = 0;
+		uint32_t allocationCount = 0;
+		VkDeviceSize blockBytes = 0;
+		VkDeviceSize allocationBytes = 0;
+	};
+
+	// framesInFlight = how many frames the GPU may still be reading after the CPU moved on
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, uint32_t framesInFlight);
+	void Shutdown();
+
+	// After the frame slot's fence wait: frees that slot's transients, retires released resources
+	// and finishes a defragmentation pass once its copies have executed
+	void BeginFrame(uint32_t frameIndex, uint64_t frameNumber);
+
+	// Records at most one defragmentation pass (bounded by the per-pass budget). Call before any draw.
+	void RecordDefragmentation(VkCommandBuffer cmd);
+
+	TransientBuffer AllocateTransient(VkDeviceSize size, VkBufferUsageFlags usage);
+
+	// Queue families that read transients; with more than one (async compute) they are created concurrent,
+	// so passes on either queue read the host writes without ownership transfers
+	void SetQueueFamilies(const std::vector<uint32_t>& queueFamilies)
+	{
+		m_QueueFamilies = queueFamilies;
+	}
+
+	StreamingResource* CreateStreamingBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const char* name);
+	StreamingResource* CreateStreamingImage(const VkImageCreateInfo& imageInfo, VkImageViewType viewType, VkImageAspectFlags aspectMask, const char* name);
+
+	// Destruction is deferred until the GPU has finished the current frame
+	void ReleaseStreaming(StreamingResource* resource);
+
+	// Called after a resource got new handles (descriptors pointing at it must be rewritten)
+	void SetMoveCallback(std::function<void(const StreamingResource&)> callback)
+	{
+		m_OnMoved = std::move(callback);
+	}
+
+	// Defragments every streaming pool, regardless of the fragmentation heuristic
+	void RequestDefragmentation()
+	{
+		m_DefragRequestMask = (1u << static_cast<uint32_t>(StreamingPool::Count)) - 1;
+	}
+
+	void SetDefragmentationBudget(VkDeviceSize maxBytesPerPass, uint32_t maxMovesPerPass)
+	{
+		m_MaxBytesPerPass = maxBytesPerPass;
+		m_MaxMovesPerPass = maxMovesPerPass;
+	}
+
+	bool IsDefragmenting() const
+	{
+		return m_DefragContext != VK_NULL_HANDLE;
+	}
+
+	StreamingPool GetDefragmentingPool() const
+	{
+		return m_DefragPool;
+	}
+
+	static const char* GetPoolName(StreamingPool pool);
+
+	PoolStats GetTransientStats() const;
+	PoolStats GetStreamingStats(StreamingPool pool) const;
+
+	const VmaDefragmentationStats& GetLastDefragmentationStats() const
+	{
+		return m_LastDefragStats;
+	}
+
+private:
+	struct TransientAllocation
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+	};
+
+	struct PendingMove
+	{
+		StreamingResource* resource = nullptr;
+		VkBuffer oldBuffer = VK_NULL_HANDLE;
+		VkImage oldImage = VK_NULL_HANDLE;
+		VkImageView oldView = VK_NULL_HANDLE;
+	};
+
+	bool CreatePool(VmaPool& outPool, uint32_t memoryTypeIndex, VmaPoolCreateFlags flags, VkDeviceSize blockSize, size_t maxBlockCount, const char* name);
+	VkImageView CreateView(const StreamingResource& resource, VkImage image) const;
+	void DestroyStreaming(StreamingResource* resource);
+	void FreeTransients(uint32_t frameIndex);
+
+	bool ShouldDefragment(StreamingPool pool) const;
+	void BeginDefragmentation(StreamingPool pool);
+	void FinishDefragmentationPass();
+	void EndDefragmentation();
+	bool RecordMove(VkCommandBuffer cmd, VmaDefragmentationMove& move);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+
+	VmaPool m_TransientPool = VK_NULL_HANDLE;
+	std::array<VmaPool, static_cast<size_t>(StreamingPool::Count)> m_StreamingPools = {};
+	VkDeviceSize m_StreamingBlockSize = 0;
+
+	uint32_t m_FramesInFlight = 0;
+	uint32_t m_FrameIndex = 0;
+	uint64_t m_FrameNumber = 0;
+	std::vector<std::vector<TransientAllocation>> m_Transients;
+	std::vector<uint32_t> m_QueueFamilies;
+	bool m_TransientOverflowWarned = false;
+
+	std::vector<std::unique_ptr<StreamingResource>> m_Resources;
+	std::vector<StreamingResource*> m_Released;
+	std::function<void(const StreamingResource&)> m_OnMoved;
+
+	// Incremental defragmentation: one pool at a time, one pass in flight at a time
+	VmaDefragmentationContext m_DefragContext = VK_NULL_HANDLE;
+	VmaDefragmentationPassMoveInfo m_DefragPass = {};
+	std::vector<PendingMove> m_PendingMoves;
+	uint64_t m_DefragPassFrame = 0;
+	bool m_DefragPassInFlight = false;
+	uint32_t m_DefragRequestMask = 0;
+	uint32_t m_NextDefragPool = 0;
+	StreamingPool m_DefragPool = StreamingPool::Buffers;
+	VkDeviceSize m_MaxBytesPerPass = 8ull * 1024 * 1024;
+	uint32_t m_MaxMovesPerPass = 64;
+	VmaDefragmentationStats m_LastDefragStats = {};
+};
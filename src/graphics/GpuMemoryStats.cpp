@@ -0,0 +1,242 @@
+#include "pch.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "core/JsonWriter.hpp"
+#include "core/Logger.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+
+namespace
+{
+	// Warnings re-arm once usage falls this far below the threshold, so a heap hovering at the limit does not spam
+	constexpr float kWarningHysteresis = 0.05f;
+
+	double ToMiB(uint64_t bytes)
+	{
+		return static_cast<double>(bytes) / (1024.0 * 1024.0);
+	}
+} // namespace
+
+const char* GetGpuMemoryCategoryName(GpuMemoryCategory category)
+{
+	switch (category)
+	{
+		case GpuMemoryCategory::RenderTarget:
+			return "Render Targets";
+		case GpuMemoryCategory::Buffer:
+			return "Buffers";
+		case GpuMemoryCategory::Staging:
+			return "Staging";
+		case GpuMemoryCategory::Texture:
+			return "Textures";
+		default:
+			return "Other";
+	}
+}
+
+void GpuMemoryStats::Initialize(VmaAllocator allocator, bool budgetExtension)
+{
+	m_Allocator = allocator;
+	m_BudgetExtension = budgetExtension;
+
+	const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+	vmaGetMemoryProperties(m_Allocator, &memoryProperties);
+	m_HeapCount = memoryProperties->memoryHeapCount;
+
+	vmaGetHeapBudgets(m_Allocator, m_Budgets);
+
+	if (!m_BudgetExtension)
+	{
+		WOVEN_LOG_WARNING("VK_EXT_memory_budget unavailable: budgets are estimated from heap sizes");
+	}
+}
+
+void GpuMemoryStats::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_Allocations.empty())
+	{
+		WOVEN_LOG_WARNING("%zu tracked GPU allocations still alive at shutdown", m_Allocations.size());
+	}
+	m_Allocations.clear();
+	m_Allocator = VK_NULL_HANDLE;
+}
+
+void GpuMemoryStats::Track(VmaAllocation allocation, GpuMemoryCategory category, const char* name)
+{
+	if (allocation == VK_NULL_HANDLE || m_Allocator == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	if (name)
+	{
+		vmaSetAllocationName(m_Allocator, allocation, name);
+	}
+
+	VmaAllocationInfo info{};
+	vmaGetAllocationInfo(m_Allocator, allocation, &info);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto [it, inserted] = m_Allocations.try_emplace(allocation, TrackedAllocation{ category, info.size });
+	if (!inserted)
+	{
+		return;
+	}
+
+	CategoryUsage& usage = m_Categories[static_cast<size_t>(category)];
+	usage.bytes += info.size;
+	++usage.allocationCount;
+}
+
+void GpuMemoryStats::Untrack(VmaAllocation allocation)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Allocations.find(allocation);
+	if (it == m_Allocations.end())
+	{
+		return;
+	}
+
+	CategoryUsage& usage = m_Categories[static_cast<size_t>(it->second.category)];
+	usage.bytes -= it->second.size;
+	--usage.allocationCount;
+	m_Allocations.erase(it);
+}
+
+void GpuMemoryStats::Update(uint64_t frameNumber)
+{
+	ZoneScopedN("GpuMemoryStats::Update");
+	if (m_Allocator == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	// VMA refreshes driver budgets when the frame index advances
+	vmaSetCurrentFrameIndex(m_Allocator, static_cast<uint32_t>(frameNumber));
+	vmaGetHeapBudgets(m_Allocator, m_Budgets);
+	CheckBudgets();
+
+	if (m_DumpInterval > 0 && frameNumber > 0 && frameNumber % m_DumpInterval == 0)
+	{
+		WriteStatsJson(m_DumpPath);
+	}
+
+	uint64_t deviceLocalUsage = 0;
+	for (uint32_t heap = 0; heap < m_HeapCount; ++heap)
+	{
+		if (GetHeapFlags(heap) & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			deviceLocalUsage += m_Budgets[heap].usage;
+	}
+	TracyPlot("GPU Memory Usage (MiB)", ToMiB(deviceLocalUsage));
+}
+
+void GpuMemoryStats::CheckBudgets()
+{
+	for (uint32_t heap = 0; heap < m_HeapCount; ++heap)
+	{
+		const VmaBudget& budget = m_Budgets[heap];
+		if (budget.budget == 0)
+		{
+			continue;
+		}
+
+		const float fraction = static_cast<float>(static_cast<double>(budget.usage) / static_cast<double>(budget.budget));
+		const uint32_t heapBit = 1u << heap;
+		if (fraction >= m_WarningThreshold && (m_NearBudgetMask & heapBit) == 0)
+		{
+			m_NearBudgetMask |= heapBit;
+			WOVEN_LOG_WARNING("GPU heap %u near budget: %.1f / %.1f MiB (%.0f%%)", heap, ToMiB(budget.usage), ToMiB(budget.budget), fraction * 100.0f);
+		}
+		else if (fraction < m_WarningThreshold - kWarningHysteresis && (m_NearBudgetMask & heapBit) != 0)
+		{
+			m_NearBudgetMask &= ~heapBit;
+			WOVEN_LOG_INFO("GPU heap %u back under budget: %.1f / %.1f MiB", heap, ToMiB(budget.usage), ToMiB(budget.budget));
+		}
+	}
+}
+
+bool GpuMemoryStats::WriteStatsJson(const std::filesystem::path& path) const
+{
+	ZoneScopedN("GpuMemoryStats::WriteStatsJson");
+	if (m_Allocator == VK_NULL_HANDLE || path.empty())
+	{
+		return false;
+	}
+
+	char* statsString = nullptr;
+	vmaBuildStatsString(m_Allocator, &statsString, VK_TRUE);
+
+	std::error_code ec;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), ec);
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	const bool written = file.is_open() && statsString && file.write(statsString, static_cast<std::streamsize>(std::strlen(statsString))).good();
+	vmaFreeStatsString(m_Allocator, statsString);
+
+	if (written)
+		WOVEN_LOG_INFO("Wrote VMA stats to %s", path.string().c_str());
+	else
+		WOVEN_LOG_ERROR("Failed to write VMA stats to %s", path.string().c_str());
+	return written;
+}
+
+void GpuMemoryStats::SetPeriodicDump(const std::filesystem::path& path, uint32_t intervalFrames)
+{
+	m_DumpPath = path;
+	m_DumpInterval = path.empty() ? 0 : intervalFrames;
+}
+
+VkMemoryHeapFlags GpuMemoryStats::GetHeapFlags(uint32_t heapIndex) const
+{
+	const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+	vmaGetMemoryProperties(m_Allocator, &memoryProperties);
+	return memoryProperties->memoryHeaps[heapIndex].flags;
+}
+
+GpuMemoryStats::CategoryUsage GpuMemoryStats::GetCategoryUsage(GpuMemoryCategory category) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Categories[static_cast<size_t>(category)];
+}
+
+void GpuMemoryStats::WriteJson(JsonWriter& writer) const
+{
+	writer.BeginObject();
+	writer.Field("budgetExtension", m_BudgetExtension);
+
+	writer.Key("heaps");
+	writer.BeginArray();
+	for (uint32_t heap = 0; heap < m_HeapCount; ++heap)
+	{
+		const VmaBudget& budget = m_Budgets[heap];
+		writer.BeginObject();
+		writer.Field("deviceLocal", (GetHeapFlags(heap) & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+		writer.Field("usageBytes", static_cast<uint64_t>(budget.usage));
+		writer.Field("budgetBytes", static_cast<uint64_t>(budget.budget));
+		writer.Field("blockBytes", static_cast<uint64_t>(budget.statistics.blockBytes));
+		writer.Field("allocationBytes", static_cast<uint64_t>(budget.statistics.allocationBytes));
+		writer.Field("allocationCount", budget.statistics.allocationCount);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.Key("categories");
+	writer.BeginObject();
+	for (size_t i = 0; i < static_cast<size_t>(GpuMemoryCategory::Count); ++i)
+	{
+		const CategoryUsage usage = GetCategoryUsage(static_cast<GpuMemoryCategory>(i));
+		writer.Key(GetGpuMemoryCategoryName(static_cast<GpuMemoryCategory>(i)));
+		writer.BeginObject();
+		writer.Field("bytes", usage.bytes);
+		writer.Field("allocationCount", usage.allocationCount);
+		writer.EndObject();
+	}
+	writer.EndObject();
+
+	writer.EndObject();
+}
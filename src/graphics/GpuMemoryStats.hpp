@@ -0,0 +1,120 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <vk_mem_alloc.h>
+
+class JsonWriter;
+
+enum class GpuMemoryCategory : uint8_t
+{
+	RenderTarget,
+	Buffer,
+	Staging,
+	Texture,
+	Other,
+	Count
+};
+
+const char* GetGpuMemoryCategoryName(GpuMemoryCategory category);
+
+// Budget/usage tracking on top of VMA.
+// Heap numbers come from vmaGetHeapBudgets (driver-reported with VK_EXT_memory_budget),
+// category numbers from allocations registered through Track/Untrack.
+class GpuMemoryStats
+{
+public:
+	struct CategoryUsage
+	{
+		uint64_t bytes = 0;
+		uint32_t allocationCount = 0;
+	};
+
+	void Initialize(VmaAllocator allocator, bool budgetExtension);
+	void Shutdown();
+
+	// Registers an allocation under a category and names it for VMA dumps
+	void Track(VmaAllocation allocation, GpuMemoryCategory category, const char* name);
+	void Untrack(VmaAllocation allocation);
+
+	// Once per frame: refreshes budgets, warns near budget and writes the periodic dump
+	void Update(uint64_t frameNumber);
+
+	// Full vmaBuildStatsString dump (detailed map included)
+	bool WriteStatsJson(const std::filesystem::path& path) const;
+
+	// Periodic dump every intervalFrames frames (0 disables)
+	void SetPeriodicDump(const std::filesystem::path& path, uint32_t intervalFrames);
+
+	// Heaps above this fraction of their budget raise a warning
+	void SetWarningThreshold(float fraction)
+	{
+		m_WarningThreshold = fraction;
+	}
+
+	float GetWarningThreshold() const
+	{
+		return m_WarningThreshold;
+	}
+
+	bool HasBudgetExtension() const
+	{
+		return m_BudgetExtension;
+	}
+
+	uint32_t GetHeapCount() const
+	{
+		return m_HeapCount;
+	}
+
+	const VmaBudget& GetHeapBudget(uint32_t heapIndex) const
+	{
+		return m_Budgets[heapIndex];
+	}
+
+	VkMemoryHeapFlags GetHeapFlags(uint32_t heapIndex) const;
+
+	bool IsHeapNearBudget(uint32_t heapIndex) const
+	{
+		return (m_NearBudgetMask & (1u << heapIndex)) != 0;
+	}
+
+	bool IsNearBudget() const
+	{
+		return m_NearBudgetMask != 0;
+	}
+
+	CategoryUsage GetCategoryUsage(GpuMemoryCategory category) const;
+
+	// Compact summary (heaps + categories) for reports
+	void WriteJson(JsonWriter& writer) const;
+
+private:
+	struct TrackedAllocation
+	{
+		GpuMemoryCategory category = GpuMemoryCategory::Other;
+		uint64_t size = 0;
+	};
+
+	void CheckBudgets();
+
+private:
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	bool m_BudgetExtension = false;
+
+	uint32_t m_HeapCount = 0;
+	VmaBudget m_Budgets[VK_MAX_MEMORY_HEAPS] = {};
+	uint32_t m_NearBudgetMask = 0;
+	float m_WarningThreshold = 0.9f;
+
+	// Streaming threads allocate too, so category bookkeeping is locked
+	mutable std::mutex m_Mutex;
+	std::unordered_map<VmaAllocation, TrackedAllocation> m_Allocations;
+	CategoryUsage m_Categories[static_cast<size_t>(GpuMemoryCategory::Count)] = {};
+
+	std::filesystem::path m_DumpPath;
+	uint32_t m_DumpInterval = 0;
+};
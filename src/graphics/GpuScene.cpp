@@ -0,0 +1,316 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuScene.hpp"
+
+namespace
+{
+	// Stages that read scene data: the cull pass, the task/mesh shaders of the draws and the passes that
+	// rebuild surfaces from ids (software raster resolve, visibility buffer material pass)
+	constexpr VkPipelineStageFlags2 kSceneReadStages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_MESH_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+
+	constexpr const char* kStreamNames[] = { "Scene Transforms", "Scene Bounds", "Scene Materials", "Scene Meshes" };
+} // namespace
+
+VkDeviceSize GpuScene::GetElementSize(Stream stream)
+{
+	switch (stream)
+	{
+		case StreamTransforms:
+			return sizeof(glm::mat4);
+		case StreamBounds:
+			return sizeof(glm::vec4);
+		case StreamMaterials:
+		case StreamMeshes:
+			return sizeof(uint32_t);
+		default:
+			return 0;
+	}
+}
+
+bool GpuScene::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, DeferredDestruction& destruction, uint32_t initialCapacity)
+{
+	ZoneScopedN("GpuScene::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_Destruction = &destruction;
+
+	if (!CreateBuffers(std::max(initialCapacity, 64u)))
+	{
+		return false;
+	}
+
+	WOVEN_LOG_INFO("GPU scene initialized: capacity %u instances", m_Capacity);
+	return true;
+}
+
+void GpuScene::Shutdown()
+{
+	for (GpuBuffer& buffer: m_Buffers)
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, buffer);
+	}
+
+	m_Transforms.clear();
+	m_Bounds.clear();
+	m_Materials.clear();
+	m_Meshes.clear();
+	m_FreeSlots.clear();
+	m_DirtyBits.clear();
+	m_DirtySlots.clear();
+	m_SlotCount = 0;
+	m_LiveCount = 0;
+	m_Capacity = 0;
+}
+
+bool GpuScene::CreateBuffers(uint32_t capacity)
+{
+	GpuBuffer buffers[StreamCount];
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		const VkDeviceSize size = GetElementSize(static_cast<Stream>(stream)) * capacity;
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, kStreamNames[stream], buffers[stream]))
+		{
+			for (GpuBuffer& created: buffers)
+			{
+				DestroyGpuBuffer(m_Allocator, m_MemoryStats, created);
+			}
+			return false;
+		}
+	}
+
+	// Frames in flight may still read the old buffers; they go once those frames retire
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		m_Destruction->DestroyBuffer(m_Buffers[stream].buffer, m_Buffers[stream].allocation);
+		m_Buffers[stream] = buffers[stream];
+	}
+	m_Capacity = capacity;
+
+	m_Transforms.resize(capacity, glm::mat4(1.0f));
+	m_Bounds.resize(capacity, glm::vec4(0.0f, 0.0f, 0.0f, -1.0f));
+	m_Materials.resize(capacity, 0);
+	m_Meshes.resize(capacity, 0);
+	m_DirtyBits.resize(capacity, 0);
+
+	// The new buffers start out empty, so every used slot goes up again
+	for (uint32_t slot = 0; slot < m_SlotCount; ++slot)
+	{
+		MarkDirty(slot, DirtyTransform | DirtyBounds | DirtyMaterial | DirtyMesh);
+	}
+	return true;
+}
+
+bool GpuScene::IsValid(uint32_t instance) const
+{
+	return instance < m_SlotCount && m_Bounds[instance].w >= 0.0f;
+}
+
+void GpuScene::MarkDirty(uint32_t instance, uint8_t bits)
+{
+	if (m_DirtyBits[instance] == 0)
+	{
+		m_DirtySlots.push_back(instance);
+	}
+	m_DirtyBits[instance] |= bits;
+}
+
+glm::vec4 GpuScene::GetWorldBounds(uint32_t instance) const
+{
+	// Largest axis scale keeps the sphere conservative, like the cull pass
+	const glm::mat4& transform = m_Transforms[instance];
+	const glm::vec4& bounds = m_Bounds[instance];
+	const float scale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+	return glm::vec4(glm::vec3(transform * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale);
+}
+
+void GpuScene::RecordPreviousBounds(uint32_t instance)
+{
+	// Only the first edit since the last upload knows where the instance was
+	if (m_DirtyBits[instance] == 0)
+	{
+		m_PreviousBounds.push_back(GetWorldBounds(instance));
+	}
+}
+
+uint32_t GpuScene::AddInstance(const glm::mat4& transform, const glm::vec4& bounds, uint32_t material, uint32_t mesh)
+{
+	uint32_t instance = INVALID_SCENE_INSTANCE;
+	if (!m_FreeSlots.empty())
+	{
+		instance = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		if (m_SlotCount == m_Capacity && !CreateBuffers(m_Capacity * 2))
+		{
+			return INVALID_SCENE_INSTANCE;
+		}
+		instance = m_SlotCount++;
+	}
+
+	m_Transforms[instance] = transform;
+	m_Bounds[instance] = glm::vec4(glm::vec3(bounds), std::max(bounds.w, 0.0f));
+	m_Materials[instance] = material;
+	m_Meshes[instance] = mesh;
+	MarkDirty(instance, DirtyTransform | DirtyBounds | DirtyMaterial | DirtyMesh);
+	++m_LiveCount;
+	return instance;
+}
+
+void GpuScene::RemoveInstance(uint32_t instance)
+{
+	if (!IsValid(instance))
+	{
+		WOVEN_LOG_WARNING("Removing scene instance %u that does not exist", instance);
+		return;
+	}
+
+	// A negative radius makes the cull pass skip the slot until it is reused
+	RecordPreviousBounds(instance);
+	m_Bounds[instance].w = -1.0f;
+	MarkDirty(instance, DirtyBounds);
+	m_FreeSlots.push_back(instance);
+	--m_LiveCount;
+}
+
+void GpuScene::SetTransform(uint32_t instance, const glm::mat4& transform)
+{
+	if (!IsValid(instance))
+		return;
+	RecordPreviousBounds(instance);
+	m_Transforms[instance] = transform;
+	MarkDirty(instance, DirtyTransform);
+}
+
+void GpuScene::SetBounds(uint32_t instance, const glm::vec4& bounds)
+{
+	if (!IsValid(instance))
+		return;
+	RecordPreviousBounds(instance);
+	m_Bounds[instance] = glm::vec4(glm::vec3(bounds), std::max(bounds.w, 0.0f));
+	MarkDirty(instance, DirtyBounds);
+}
+
+void GpuScene::SetMaterial(uint32_t instance, uint32_t material)
+{
+	if (!IsValid(instance))
+		return;
+	m_Materials[instance] = material;
+	MarkDirty(instance, DirtyMaterial);
+}
+
+void GpuScene::SetMesh(uint32_t instance, uint32_t mesh)
+{
+	if (!IsValid(instance))
+		return;
+	RecordPreviousBounds(instance);
+	m_Meshes[instance] = mesh;
+	MarkDirty(instance, DirtyMesh);
+}
+
+void GpuScene::RecordUpload(VkCommandBuffer cmd, GpuMemoryPools& pools)
+{
+	ZoneScopedN("GpuScene::RecordUpload");
+
+	m_LastUpload = {};
+	m_ChangedBounds.clear();
+	if (m_DirtySlots.empty())
+	{
+		TracyPlot("Scene Upload (KiB)", 0.0);
+		return;
+	}
+
+	// Sorted slots turn into contiguous runs, one copy region per run and stream
+	std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+
+	VkDeviceSize stagingSize = 0;
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		const uint8_t bit = static_cast<uint8_t>(1u << stream);
+		const VkDeviceSize elementSize = GetElementSize(static_cast<Stream>(stream));
+		std::vector<VkBufferCopy>& regions = m_Regions[stream];
+		regions.clear();
+
+		for (uint32_t slot: m_DirtySlots)
+		{
+			if ((m_DirtyBits[slot] & bit) == 0)
+				continue;
+
+			VkBufferCopy* previous = regions.empty() ? nullptr : &regions.back();
+			if (previous && previous->dstOffset + previous->size == slot * elementSize)
+			{
+				previous->size += elementSize;
+			}
+			else
+			{
+				regions.push_back({ stagingSize, slot * elementSize, elementSize });
+			}
+			stagingSize += elementSize;
+		}
+	}
+
+	const TransientBuffer staging = pools.AllocateTransient(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (staging.buffer == VK_NULL_HANDLE)
+	{
+		// Dirty state is kept, the upload is retried next frame
+		return;
+	}
+
+	const void* sources[StreamCount] = { m_Transforms.data(), m_Bounds.data(), m_Materials.data(), m_Meshes.data() };
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		for (const VkBufferCopy& region: m_Regions[stream])
+		{
+			std::memcpy(static_cast<uint8_t*>(staging.mapped) + region.srcOffset, static_cast<const uint8_t*>(sources[stream]) + region.dstOffset, region.size);
+		}
+		m_LastUpload.regions += static_cast<uint32_t>(m_Regions[stream].size());
+	}
+
+	// Earlier frames' reads must finish before their data is overwritten
+	RecordMemoryBarrier(cmd, kSceneReadStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	for (uint32_t stream = 0; stream < StreamCount; ++stream)
+	{
+		if (!m_Regions[stream].empty())
+		{
+			vkCmdCopyBuffer(cmd, staging.buffer, m_Buffers[stream].buffer, static_cast<uint32_t>(m_Regions[stream].size()), m_Regions[stream].data());
+		}
+	}
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, kSceneReadStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+	m_ChangedBounds.swap(m_PreviousBounds);
+	for (uint32_t slot: m_DirtySlots)
+	{
+		if (m_Bounds[slot].w >= 0.0f)
+		{
+			m_ChangedBounds.push_back(GetWorldBounds(slot));
+		}
+		m_DirtyBits[slot] = 0;
+	}
+	m_LastUpload.instances = static_cast<uint32_t>(m_DirtySlots.size());
+	m_LastUpload.bytes = stagingSize;
+	m_DirtySlots.clear();
+
+	TracyPlot("Scene Upload (KiB)", static_cast<double>(stagingSize) / 1024.0);
+}
+
+GpuCulling::Instances GpuScene::GetInstances() const
+{
+	GpuCulling::Instances instances{};
+	instances.transforms = m_Buffers[StreamTransforms].address;
+	instances.bounds = m_Buffers[StreamBounds].address;
+	instances.materials = m_Buffers[StreamMaterials].address;
+	instances.meshes = m_Buffers[StreamMeshes].address;
+	instances.count = m_SlotCount;
+	return instances;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/GpuCulling.hpp"
+
+class DeferredDestruction;
+class GpuMemoryPools;
+class GpuMemoryStats;
+
+constexpr uint32_t INVALID_SCENE_INSTANCE = UINT32_MAX;
+
+// Persistent scene data on the GPU: per-instance transforms, bounds, material and mesh indices in
+// device-local storage buffers (read through buffer device address).
+// The CPU keeps a mirror; edits only mark instances dirty and RecordUpload copies the dirty ranges
+// through a transient staging buffer, so upload bandwidth follows the change rate, not the scene size.
+// Not thread-safe: edit from the render thread only.
+class GpuScene
+{
+public:
+	struct UploadStats
+	{
+		uint64_t bytes = 0;
+		uint32_t regions = 0;
+		uint32_t instances = 0;
+	};
+
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, DeferredDestruction& destruction, uint32_t initialCapacity);
+	void Shutdown();
+
+	// bounds: object-space sphere (xyz center, w radius); mesh: GpuGeometry index
+	uint32_t AddInstance(const glm::mat4& transform, const glm::vec4& bounds, uint32_t material, uint32_t mesh);
+	void RemoveInstance(uint32_t instance);
+
+	void SetTransform(uint32_t instance, const glm::mat4& transform);
+	void SetBounds(uint32_t instance, const glm::vec4& bounds);
+	void SetMaterial(uint32_t instance, uint32_t material);
+	void SetMesh(uint32_t instance, uint32_t mesh);
+
+	const glm::mat4& GetTransform(uint32_t instance) const
+	{
+		return m_Transforms[instance];
+	}
+
+	// Negative radius for removed slots
+	const glm::vec4& GetBounds(uint32_t instance) const
+	{
+		return m_Bounds[instance];
+	}
+
+	uint32_t GetMaterial(uint32_t instance) const
+	{
+		return m_Materials[instance];
+	}
+
+	uint32_t GetMesh(uint32_t instance) const
+	{
+		return m_Meshes[instance];
+	}
+
+	// Outside rendering, before anything reads the scene this frame
+	void RecordUpload(VkCommandBuffer cmd, GpuMemoryPools& pools);
+
+	// Slot range the culling pass walks (removed slots carry a negative radius and are skipped)
+	GpuCulling::Instances GetInstances() const;
+
+	uint32_t GetInstanceCount() const
+	{
+		return m_LiveCount;
+	}
+
+	uint32_t GetCapacity() const
+	{
+		return m_Capacity;
+	}
+
+	// Slots handed out so far, removed ones included
+	uint32_t GetSlotCount() const
+	{
+		return m_SlotCount;
+	}
+
+	const UploadStats& GetLastUploadStats() const
+	{
+		return m_LastUpload;
+	}
+
+	// World-space spheres touched by the edits the last RecordUpload sent, before and after each change.
+	// Lets cached views (ShadowCascades) tell whether anything they show has moved.
+	const std::vector<glm::vec4>& GetChangedBounds() const
+	{
+		return m_ChangedBounds;
+	}
+
+private:
+	enum DirtyBits : uint8_t
+	{
+		DirtyTransform = 1 << 0,
+		DirtyBounds = 1 << 1,
+		DirtyMaterial = 1 << 2,
+		DirtyMesh = 1 << 3,
+	};
+
+	enum Stream : uint32_t
+	{
+		StreamTransforms,
+		StreamBounds,
+		StreamMaterials,
+		StreamMeshes,
+		StreamCount
+	};
+
+	bool CreateBuffers(uint32_t capacity);
+	void MarkDirty(uint32_t instance, uint8_t bits);
+	void RecordPreviousBounds(uint32_t instance);
+	glm::vec4 GetWorldBounds(uint32_t instance) const;
+	bool IsValid(uint32_t instance) const;
+
+	static VkDeviceSize GetElementSize(Stream stream);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+
+	// CPU mirror, indexed by instance slot
+	std::vector<glm::mat4> m_Transforms;
+	std::vector<glm::vec4> m_Bounds;
+	std::vector<uint32_t> m_Materials;
+	std::vector<uint32_t> m_Meshes;
+	std::vector<uint32_t> m_FreeSlots;
+	uint32_t m_SlotCount = 0; // High water mark of used slots
+	uint32_t m_LiveCount = 0;
+
+	// Dirty tracking: per-slot bits plus the list of slots to visit at upload
+	std::vector<uint8_t> m_DirtyBits;
+	std::vector<uint32_t> m_DirtySlots;
+
+	// Where edited instances were before their edit, then (after upload) everything the upload changed
+	std::vector<glm::vec4> m_PreviousBounds;
+	std::vector<glm::vec4> m_ChangedBounds;
+
+	uint32_t m_Capacity = 0;
+	GpuBuffer m_Buffers[StreamCount];
+
+	// Scratch for RecordUpload
+	std::vector<VkBufferCopy> m_Regions[StreamCount];
+	UploadStats m_LastUpload;
+};
@@ -9,6 +9,7 @@
 #include <backends/imgui_impl_vulkan.h>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <imgui.h>
 #include <SDL3/SDL_vulkan.h>
@@ -18,6 +19,9 @@
 
 #include "core/FileSystem.hpp"
 #include "core/Logger.hpp"
+#include "graphics/FrameCapture.hpp"
+#include "graphics/MeshBaker.hpp"
+#include "graphics/ProceduralMeshes.hpp"
 #include "graphics/RenderConstants.hpp"
 #include "graphics/ShaderSystem.hpp"
 #include "GraphicsSystem.hpp"
@@ -30,6 +34,9 @@ GraphicsSystem::GraphicsSystem()
 	m_DebugState.clearColorB = 0.04f;
 	m_DebugState.clearColorA = 1.0f;
 	m_DebugState.frameTimings.reserve(300); // Pre-allocate for smooth operation
+
+	// Left-handed: start behind the origin looking down +Z
+	m_Camera.SetPosition(glm::vec3(0.0f, 0.0f, -3.0f));
 }
 
 GraphicsSystem::~GraphicsSystem()
@@ -124,31 +131,105 @@ namespace
 
 		ImGuiIO& io = ImGui::GetIO();
 		const std::filesystem::path fontPath = FileSystem::GetFontPath("JetBrainsMono-Regular.ttf");
-		Logger::Info("Loading ImGui font from: %s", fontPath.string().c_str());
+		WOVEN_LOG_INFO("Loading ImGui font from: %s", fontPath.string().c_str());
 		if (std::filesystem::exists(fontPath))
 		{
 			io.Fonts->AddFontFromFileTTF(fontPath.string().c_str(), 16.0f);
 		}
 	}
+
+	const char* GetPresentModeName(VkPresentModeKHR mode)
+	{
+		switch (mode)
+		{
+			case VK_PRESENT_MODE_FIFO_KHR:
+				return "FIFO";
+			case VK_PRESENT_MODE_MAILBOX_KHR:
+				return "MAILBOX";
+			case VK_PRESENT_MODE_IMMEDIATE_KHR:
+				return "IMMEDIATE";
+			default:
+				return "OTHER";
+		}
+	}
+
+	// Low latency gives up on a present that takes longer (occluded window, compositor stall) and starts the frame
+	constexpr uint64_t kPresentWaitTimeoutNs = 50'000'000;
+
+	// Presents that never show up on screen (an occluded window) are dropped unmeasured past this many
+	constexpr size_t kMaxPendingPresents = 8;
 } // namespace
 
+const char* GetLatencyModeName(LatencyMode mode)
+{
+	switch (mode)
+	{
+		case LatencyMode::Vsync:
+			return "Vsync";
+		case LatencyMode::LowLatency:
+			return "Low latency";
+		case LatencyMode::Uncapped:
+			return "Uncapped";
+		default:
+			return "Unknown";
+	}
+}
+
+bool ParseLatencyMode(const char* name, LatencyMode& outMode)
+{
+	if (std::strcmp(name, "vsync") == 0)
+		outMode = LatencyMode::Vsync;
+	else if (std::strcmp(name, "low-latency") == 0)
+		outMode = LatencyMode::LowLatency;
+	else if (std::strcmp(name, "uncapped") == 0)
+		outMode = LatencyMode::Uncapped;
+	else
+		return false;
+	return true;
+}
+
 bool GraphicsSystem::Initialize(SDL_Window* window)
 {
 	ZoneScopedN("GraphicsSystem::Initialize");
 
 	m_Window = window;
+	m_Headless = false;
+	m_PresentLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	return InitializeDevice(window);
+}
+
+bool GraphicsSystem::InitializeHeadless(uint32_t width, uint32_t height)
+{
+	ZoneScopedN("GraphicsSystem::InitializeHeadless");
+
+	m_Window = nullptr;
+	m_Headless = true;
+	m_SwapchainExtent = { width, height };
 
+	// Offscreen images end the frame ready for readback instead of presentation
+	m_PresentLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+	// Benchmarks want raw throughput, never the debug frame limiter
+	m_DebugState.enableFpsCap = false;
+
+	WOVEN_LOG_INFO("Headless rendering: %ux%u offscreen", width, height);
+	return InitializeDevice(nullptr);
+}
+
+bool GraphicsSystem::InitializeDevice(SDL_Window* window)
+{
 	// Initialize Volk
 	if (volkInitialize() != VK_SUCCESS)
 	{
-		Logger::Error("Failed to initialize Volk. Is Vulkan installed?");
+		WOVEN_LOG_ERROR("Failed to initialize Volk. Is Vulkan installed?");
 		return false;
 	}
 
 	if (!CreateVulkanInstance(window))
 		return false;
 
-	if (!CreateSurface(window))
+	if (!m_Headless && !CreateSurface(window))
 		return false;
 
 	if (!SelectPhysicalDevice())
@@ -166,9 +247,10 @@ bool GraphicsSystem::Initialize(SDL_Window* window)
 	if (!CreateTracyContext())
 		return false;
 
-	if (!CreateSwapchain(window))
+	if (m_Headless ? !CreateOffscreenTargets() : !CreateSwapchain(window))
 		return false;
 
+	m_RenderTargetExtent = m_SwapchainExtent;
 	if (!CreateDepthResources())
 		return false;
 
@@ -181,13 +263,26 @@ bool GraphicsSystem::Initialize(SDL_Window* window)
 	if (!CreateSyncPrimitives())
 		return false;
 
+	if (!m_DeferredDestruction.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, m_TimelineSemaphore))
+		return false;
+
+	// Optional: without it every compute pass runs on the graphics queue
+	if (m_ComputeQueue != VK_NULL_HANDLE && !m_AsyncCompute.Initialize(m_VkbDevice.device, m_VkbPhysicalDevice.physical_device, m_ComputeQueue, m_ComputeQueueFamily, m_GraphicsQueueFamily, MAX_FRAMES_IN_FLIGHT))
+	{
+		WOVEN_LOG_WARNING("Async compute unavailable, compute passes stay on the graphics queue");
+	}
+
+	if (!CreateTimestampQueries())
+		return false;
+
 	if (!CreateBindlessDescriptors())
 		return false;
 
 	if (!CreatePipelineInfrastructure())
 		return false;
 
-	if (!InitializeImGui(window))
+	// ImGui needs an SDL window for input and sizing
+	if (!m_Headless && !InitializeImGui(window))
 		return false;
 
 	m_ShaderSystem = std::make_unique<ShaderSystem>();
@@ -198,6 +293,42 @@ bool GraphicsSystem::Initialize(SDL_Window* window)
 	if (!CreateShaders())
 		return false;
 
+	if (!CreateDemoInstances())
+		return false;
+
+	if (!m_Culling.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, m_DeferredDestruction, MAX_FRAMES_IN_FLIGHT, m_Scene.GetCapacity()))
+		return false;
+
+	// Optional: without it every cluster is drawn by the mesh shaders
+	if (m_SupportsInt64Atomics && !m_SoftwareRaster.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, m_DeferredDestruction))
+	{
+		WOVEN_LOG_WARNING("Software raster unavailable, small clusters stay on the mesh shader path");
+	}
+
+	if (!m_VisibilityBuffer.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, m_BindlessRegistry, m_DeferredDestruction))
+	{
+		WOVEN_LOG_WARNING("Visibility buffer mode unavailable, rendering stays forward");
+	}
+
+	if (!m_Lighting.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, MAX_FRAMES_IN_FLIGHT))
+	{
+		WOVEN_LOG_WARNING("Clustered lighting unavailable, shading keeps only the key light");
+	}
+
+	if (!m_Shadows.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, m_BindlessRegistry, m_DeferredDestruction, m_DefaultSamplerIndex, MAX_FRAMES_IN_FLIGHT, m_Scene.GetCapacity()))
+	{
+		WOVEN_LOG_WARNING("Shadow cascades unavailable, the key light casts no shadows");
+	}
+
+	// Optional: everything is shaded at full rate without it
+	if (m_SupportsFragmentShadingRate && !m_ShadingRate.Initialize(m_VkbPhysicalDevice.physical_device, m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, *m_ShaderSystem, m_BindlessRegistry, m_DeferredDestruction, MAX_FRAMES_IN_FLIGHT))
+	{
+		WOVEN_LOG_WARNING("Variable rate shading unavailable, everything is shaded at full rate");
+	}
+
+	if (!m_TextureStreamer.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, m_MemoryPools, m_BindlessRegistry, m_TaskScheduler, MAX_FRAMES_IN_FLIGHT, m_DefaultSamplerIndex, m_SupportsTextureCompressionBC))
+		return false;
+
 	return true;
 }
 
@@ -205,7 +336,22 @@ void GraphicsSystem::Shutdown()
 {
 	ZoneScopedN("GraphicsSystem::Shutdown");
 
+	// In-flight frames still read the scene, culling and texture resources released below
+	if (m_VkbDevice.device != VK_NULL_HANDLE)
+	{
+		vkDeviceWaitIdle(m_VkbDevice.device);
+	}
+
 	DestroyShaders();
+	m_TextureStreamer.Shutdown();
+	m_ShadingRate.Shutdown();
+	m_Shadows.Shutdown();
+	m_Lighting.Shutdown();
+	m_VisibilityBuffer.Shutdown();
+	m_SoftwareRaster.Shutdown();
+	m_Culling.Shutdown();
+	m_Scene.Shutdown();
+	m_Geometry.Shutdown();
 	ShutdownImGui();
 
 	if (m_ShaderSystem)
@@ -216,6 +362,102 @@ void GraphicsSystem::Shutdown()
 	CleanupVulkan();
 }
 
+void GraphicsSystem::WaitIdle()
+{
+	ZoneScopedN("GraphicsSystem::WaitIdle");
+	if (m_VkbDevice.device == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	vkDeviceWaitIdle(m_VkbDevice.device);
+
+	// Everything has retired, so every outstanding timestamp pair is readable
+	for (FrameData& frame: m_Frames)
+	{
+		ResolveFrameTimestamps(frame);
+	}
+}
+
+std::vector<GpuFrameTiming> GraphicsSystem::ConsumeGpuTimings()
+{
+	std::vector<GpuFrameTiming> timings;
+	timings.swap(m_GpuTimings);
+	return timings;
+}
+
+std::vector<PresentTiming> GraphicsSystem::ConsumePresentTimings()
+{
+	std::vector<PresentTiming> timings;
+	timings.swap(m_PresentTimings);
+	return timings;
+}
+
+void GraphicsSystem::SetLatencyMode(LatencyMode mode)
+{
+	if (mode == m_LatencyMode)
+	{
+		return;
+	}
+
+	m_LatencyMode = mode;
+	// The present mode is fixed per swapchain; BeginFrame recreates it without waiting for the device
+	if (!m_Headless)
+	{
+		m_SwapchainOutOfDate = true;
+	}
+	WOVEN_LOG_INFO("Latency mode: %s", GetLatencyModeName(mode));
+}
+
+void GraphicsSystem::ResolvePresents(bool waitForLatest)
+{
+	ZoneScopedN("GraphicsSystem::ResolvePresents");
+
+	if (m_PendingPresents.empty() || m_Swapchain == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	// Present ids complete in order, so once the newest is on screen every older one is resolved too
+	if (waitForLatest)
+	{
+		const VkResult result = vkWaitForPresentKHR(m_VkbDevice.device, m_Swapchain, m_PendingPresents.back().presentId, kPresentWaitTimeoutNs);
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_TIMEOUT)
+		{
+			// Out of date or lost: the recreation path handles it, these presents are never measured
+			m_PendingPresents.clear();
+			return;
+		}
+	}
+
+	// A frame replaced in the mailbox (or torn over) resolves with the next one that reached the screen
+	while (!m_PendingPresents.empty())
+	{
+		const PendingPresent& present = m_PendingPresents.front();
+		const VkResult result = vkWaitForPresentKHR(m_VkbDevice.device, m_Swapchain, present.presentId, 0);
+		if (result == VK_TIMEOUT)
+		{
+			break;
+		}
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			m_PendingPresents.clear();
+			return;
+		}
+
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		m_LastPresentLatencyMs = std::chrono::duration<double, std::milli>(now - present.presented).count();
+		m_LastFrameLatencyMs = std::chrono::duration<double, std::milli>(now - present.frameStart).count();
+		TracyPlot("Present Latency (ms)", m_LastPresentLatencyMs);
+		TracyPlot("Frame Latency (ms)", m_LastFrameLatencyMs);
+		if (m_CaptureGpuTimings)
+		{
+			m_PresentTimings.push_back({ present.frameNumber, m_LastPresentLatencyMs, m_LastFrameLatencyMs });
+		}
+		m_PendingPresents.pop_front();
+	}
+}
+
 void GraphicsSystem::UpdateProfiler()
 {
 	ZoneScopedN("GraphicsSystem::UpdateProfiler");
@@ -229,8 +471,23 @@ bool GraphicsSystem::RenderFrame(float timeSeconds)
 {
 	ZoneScopedN("GraphicsSystem::RenderFrame");
 
+	// Nothing to present to while minimized. Skip the frame rather than blocking the loop; the short sleep keeps
+	// the idle app off a full core until a resize event brings the window back.
+	if (m_WindowMinimized)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		return true;
+	}
+
+	// Low latency: start the frame only once the previous one is on screen, so at most one frame waits for
+	// display and the input it sampled is as fresh as the vblank allows. Other modes just collect what was shown.
+	if (m_SupportsPresentWait)
+	{
+		ResolvePresents(m_LatencyMode == LatencyMode::LowLatency);
+	}
+
 	// Frame pacing - cap FPS if enabled
-	if (m_DebugState.enableFpsCap || m_DebugState.enableVsync)
+	if (m_DebugState.enableFpsCap)
 	{
 		using Clock = std::chrono::high_resolution_clock;
 		static auto frameStartTime = Clock::now();
@@ -253,6 +510,7 @@ bool GraphicsSystem::RenderFrame(float timeSeconds)
 		}
 		frameStartTime = Clock::now();
 	}
+	m_FrameStartTime = std::chrono::steady_clock::now();
 
 	if (m_ImGuiInitialized)
 	{
@@ -268,7 +526,7 @@ bool GraphicsSystem::RenderFrame(float timeSeconds)
 	FrameData& frame = GetCurrentFrame();
 	if (frame.commandBuffer == VK_NULL_HANDLE)
 	{
-		Logger::Error("Invalid command buffer for frame %u", GetCurrentFrameIndex());
+		WOVEN_LOG_ERROR("Invalid command buffer for frame %u", GetCurrentFrameIndex());
 		EndFrame(imageIndex);
 		return false;
 	}
@@ -288,7 +546,7 @@ bool GraphicsSystem::InitializeImGui(SDL_Window* window)
 
 	if (!ImGui_ImplSDL3_InitForVulkan(window))
 	{
-		Logger::Error("Failed to initialize ImGui SDL3 backend");
+		WOVEN_LOG_ERROR("Failed to initialize ImGui SDL3 backend");
 		return false;
 	}
 
@@ -315,7 +573,7 @@ bool GraphicsSystem::InitializeImGui(SDL_Window* window)
 
 	if (vkCreateDescriptorPool(m_VkbDevice.device, &poolInfo, nullptr, &m_ImGuiDescriptorPool) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create ImGui descriptor pool");
+		WOVEN_LOG_ERROR("Failed to create ImGui descriptor pool");
 		return false;
 	}
 
@@ -344,7 +602,7 @@ bool GraphicsSystem::InitializeImGui(SDL_Window* window)
 
 	if (!ImGui_ImplVulkan_Init(&initInfo))
 	{
-		Logger::Error("Failed to initialize ImGui Vulkan backend");
+		WOVEN_LOG_ERROR("Failed to initialize ImGui Vulkan backend");
 		return false;
 	}
 
@@ -470,6 +728,7 @@ void GraphicsSystem::BeginImGuiFrame()
 
 			// === Detailed Frame Time Stats ===
 			ImGui::Text("Current:              %.3f ms", deltaTimeMs);
+			ImGui::Text("GPU Frame:            %.3f ms", m_LastGpuFrameTimeMs);
 			ImGui::Text("Average:              %.3f ms", avgFrameTime);
 			ImGui::Text("Min/Max:              %.3f / %.3f ms", minFrameTime, maxFrameTime);
 			ImGui::Text("Std Deviation:        %.3f ms", frameTimeStdDev);
@@ -521,11 +780,22 @@ void GraphicsSystem::BeginImGuiFrame()
 			ImGui::Spacing();
 			ImGui::SeparatorText("Frame Pacing Controls");
 
-			// VSync toggle
-			bool vsyncChanged = ImGui::Checkbox("Enable VSync", &m_DebugState.enableVsync);
-			if (vsyncChanged)
+			// Latency mode (present mode + present-wait pacing)
+			if (ImGui::BeginCombo("Latency Mode", GetLatencyModeName(m_LatencyMode)))
+			{
+				for (uint8_t i = 0; i < static_cast<uint8_t>(LatencyMode::Count); ++i)
+				{
+					const LatencyMode mode = static_cast<LatencyMode>(i);
+					if (ImGui::Selectable(GetLatencyModeName(mode), mode == m_LatencyMode))
+					{
+						SetLatencyMode(mode);
+					}
+				}
+				ImGui::EndCombo();
+			}
+			if (m_LatencyMode == LatencyMode::LowLatency && !m_SupportsPresentWait)
 			{
-				ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.2f, 1.0f), "✓ VSync %s", m_DebugState.enableVsync ? "Enabled" : "Disabled");
+				ImGui::TextDisabled("  VK_KHR_present_wait unavailable: MAILBOX only, no frame throttling");
 			}
 
 			// FPS Cap toggle
@@ -549,10 +819,19 @@ void GraphicsSystem::BeginImGuiFrame()
 			// Status indicators
 			ImGui::Spacing();
 			ImGui::SeparatorText("Status");
-			ImGui::Text("VSync:                %s", m_DebugState.enableVsync ? "Active" : "Inactive");
+			ImGui::Text("Present Mode:         %s", GetPresentModeName(m_PresentMode));
 			ImGui::Text("FPS Cap:              %s", m_DebugState.enableFpsCap ? "Active" : "Inactive");
+			if (m_SupportsPresentWait)
+			{
+				ImGui::Text("Present -> Display:   %.2f ms", m_LastPresentLatencyMs);
+				ImGui::Text("Frame Start -> Display: %.2f ms", m_LastFrameLatencyMs);
+			}
+			else
+			{
+				ImGui::TextDisabled("Display latency:      not measurable without VK_KHR_present_wait");
+			}
 
-			if (m_DebugState.enableVsync || m_DebugState.enableFpsCap)
+			if (m_DebugState.enableFpsCap)
 			{
 				ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.5f, 1.0f), "Frame pacing: %.1f FPS target", effectiveFps);
 			}
@@ -669,12 +948,82 @@ void GraphicsSystem::BeginImGuiFrame()
 		// === MEMORY TAB ===
 		if (ImGui::BeginTabItem("Memory"))
 		{
+			constexpr float bytesToMiB = 1.0f / (1024.0f * 1024.0f);
+
+			if (ImGui::CollapsingHeader("Heap Budgets", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				ImGui::Text("Budget Source:     %s", m_MemoryStats.HasBudgetExtension() ? "VK_EXT_memory_budget" : "Estimated (no budget extension)");
+
+				for (uint32_t heap = 0; heap < m_MemoryStats.GetHeapCount(); ++heap)
+				{
+					const VmaBudget& budget = m_MemoryStats.GetHeapBudget(heap);
+					const bool deviceLocal = (m_MemoryStats.GetHeapFlags(heap) & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+					const float fraction = budget.budget > 0 ? static_cast<float>(budget.usage) / static_cast<float>(budget.budget) : 0.0f;
+
+					char overlay[64];
+					snprintf(overlay, sizeof(overlay), "%.1f / %.1f MiB", budget.usage * bytesToMiB, budget.budget * bytesToMiB);
+
+					ImGui::Text("Heap %u (%s)", heap, deviceLocal ? "Device Local" : "Host");
+					const bool nearBudget = m_MemoryStats.IsHeapNearBudget(heap);
+					if (nearBudget)
+						ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
+					ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+					if (nearBudget)
+						ImGui::PopStyleColor();
+					ImGui::TextDisabled("Blocks: %u (%.1f MiB) | Allocations: %u (%.1f MiB)", budget.statistics.blockCount, budget.statistics.blockBytes * bytesToMiB, budget.statistics.allocationCount, budget.statistics.allocationBytes * bytesToMiB);
+				}
+
+				float warningThreshold = m_MemoryStats.GetWarningThreshold();
+				if (ImGui::SliderFloat("Warn Threshold", &warningThreshold, 0.5f, 1.0f, "%.2f"))
+				{
+					m_MemoryStats.SetWarningThreshold(warningThreshold);
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Allocations by Category", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				for (size_t i = 0; i < static_cast<size_t>(GpuMemoryCategory::Count); ++i)
+				{
+					const GpuMemoryCategory category = static_cast<GpuMemoryCategory>(i);
+					const GpuMemoryStats::CategoryUsage usage = m_MemoryStats.GetCategoryUsage(category);
+					ImGui::Text("%-16s %9.1f MiB  (%u)", GetGpuMemoryCategoryName(category), usage.bytes * bytesToMiB, usage.allocationCount);
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Pools", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				const GpuMemoryPools::PoolStats transient = m_MemoryPools.GetTransientStats();
+				ImGui::Text("%-18s %7.1f / %7.1f MiB  (%u allocs)", "Transient Ring", transient.allocationBytes * bytesToMiB, transient.blockBytes * bytesToMiB, transient.allocationCount);
+
+				for (size_t i = 0; i < static_cast<size_t>(StreamingPool::Count); ++i)
+				{
+					const StreamingPool pool = static_cast<StreamingPool>(i);
+					const GpuMemoryPools::PoolStats stats = m_MemoryPools.GetStreamingStats(pool);
+					const float unused = stats.blockBytes > 0 ? 1.0f - static_cast<float>(stats.allocationBytes) / static_cast<float>(stats.blockBytes) : 0.0f;
+					ImGui::Text("%-18s %7.1f / %7.1f MiB  (%u allocs, %u blocks, %.0f%% unused)", GpuMemoryPools::GetPoolName(pool), stats.allocationBytes * bytesToMiB, stats.blockBytes * bytesToMiB, stats.allocationCount, stats.blockCount, unused * 100.0f);
+				}
+
+				if (m_MemoryPools.IsDefragmenting())
+				{
+					ImGui::Text("Defragmenting:     %s", GpuMemoryPools::GetPoolName(m_MemoryPools.GetDefragmentingPool()));
+				}
+				else if (ImGui::Button("Defragment Now"))
+				{
+					m_MemoryPools.RequestDefragmentation();
+				}
+
+				const VmaDefragmentationStats& lastDefrag = m_MemoryPools.GetLastDefragmentationStats();
+				ImGui::TextDisabled("Last defrag: moved %u (%.1f MiB), freed %u blocks (%.1f MiB)", lastDefrag.allocationsMoved, lastDefrag.bytesMoved * bytesToMiB, lastDefrag.deviceMemoryBlocksFreed, lastDefrag.bytesFreed * bytesToMiB);
+			}
+
 			if (ImGui::CollapsingHeader("VMA Allocator", ImGuiTreeNodeFlags_DefaultOpen))
 			{
 				ImGui::Text("Allocator Handle:  0x%p", (void*) m_VmaAllocator);
 				ImGui::Text("Status:            %s", (m_VmaAllocator != VK_NULL_HANDLE) ? "Active" : "Inactive");
-				ImGui::Text("\nDetailed VMA stats require vmaCalculateStats()");
-				ImGui::Text("which may have performance impact.");
+				if (ImGui::Button("Dump VMA Stats (vma_stats.json)"))
+				{
+					m_MemoryStats.WriteStatsJson("vma_stats.json");
+				}
 			}
 
 			ImGui::EndTabItem();
@@ -697,6 +1046,22 @@ void GraphicsSystem::BeginImGuiFrame()
 				ImGui::Text("Status:           %s", (m_PresentQueue != VK_NULL_HANDLE) ? "Active" : "Inactive");
 			}
 
+			if (ImGui::CollapsingHeader("Compute Queue", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				if (m_AsyncCompute.IsAvailable())
+				{
+					// Light culling and the shading rate analysis; compare the frame time with this on and off
+					ImGui::Text("Queue Family:     %u", m_AsyncCompute.GetQueueFamily());
+					ImGui::Text("Queue Handle:     0x%p", (void*) m_ComputeQueue);
+					ImGui::Text("Timestamps:       %s", m_AsyncCompute.SupportsTimestamps() ? "Yes" : "No (compute passes untimed)");
+					ImGui::Checkbox("Enable Async Compute", &m_DebugState.enableAsyncCompute);
+				}
+				else
+				{
+					ImGui::TextDisabled("No separate compute queue, compute passes run on the graphics queue");
+				}
+			}
+
 			ImGui::EndTabItem();
 		}
 
@@ -706,7 +1071,7 @@ void GraphicsSystem::BeginImGuiFrame()
 			if (ImGui::CollapsingHeader("Extension Support", ImGuiTreeNodeFlags_DefaultOpen))
 			{
 				ImGui::Text("%s - %s", "Mesh Shaders", m_SupportsMeshShaders ? "Enabled" : "Disabled");
-				ImGui::Text("%s - %s", "Descriptor Buffer", m_SupportsDescriptorBuffer ? "Enabled" : "Disabled");
+				ImGui::Text("%s - %s", "Descriptor Buffer", m_UseDescriptorBuffer ? "Active" : (m_SupportsDescriptorBuffer ? "Available" : "Disabled"));
 				ImGui::Text("%s - %s", "Fragment Shading Rate", m_SupportsFragmentShadingRate ? "Enabled" : "Disabled");
 				ImGui::Text("%s - %s", "Push Descriptors", m_SupportsPushDescriptor ? "Enabled" : "Disabled");
 				ImGui::Text("%s - %s", "Shader Objects", m_SupportsShaderObjects ? "Enabled" : "Disabled");
@@ -729,6 +1094,19 @@ void GraphicsSystem::BeginImGuiFrame()
 				ImGui::SameLine();
 				ImGui::TextColored(m_DebugState.enableCullFaceBackFace ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f) : ImVec4(0.5f, 0.5f, 0.5f, 1.0f), m_DebugState.enableCullFaceBackFace ? "●" : "○");
 				ImGui::TextDisabled("(Applied in real-time)");
+
+				if (m_VisibilityBuffer.IsInitialized())
+				{
+					// Compare the Main + Material pass timings against forward with the same scene
+					ImGui::Checkbox("Visibility Buffer", &m_DebugState.enableVisibilityBuffer);
+					ImGui::SameLine();
+					ImGui::TextColored(m_DebugState.enableVisibilityBuffer ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f) : ImVec4(0.5f, 0.5f, 0.5f, 1.0f), m_DebugState.enableVisibilityBuffer ? "●" : "○");
+					ImGui::TextDisabled("(Ids in the raster pass, shading in a compute pass)");
+				}
+				else
+				{
+					ImGui::TextDisabled("Visibility Buffer: unavailable");
+				}
 			}
 
 			if (ImGui::CollapsingHeader("Clear Color", ImGuiTreeNodeFlags_DefaultOpen))
@@ -737,6 +1115,157 @@ void GraphicsSystem::BeginImGuiFrame()
 				ImGui::TextDisabled("(Changes applied in real-time)");
 			}
 
+			if (ImGui::CollapsingHeader("Frame Capture"))
+			{
+				if (ImGui::Button("Capture Next Frame"))
+				{
+					char fileName[64];
+					std::snprintf(fileName, sizeof(fileName), "frame_%llu.wcap", static_cast<unsigned long long>(m_FrameNumber));
+					RequestFrameCapture(std::filesystem::current_path() / "captures" / fileName);
+				}
+				ImGui::TextDisabled("(Replay with WovenBench --replay <file>)");
+				if (m_FrameReplay)
+				{
+					ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "Replaying a capture: scene and lights are frozen");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("GPU Culling"))
+			{
+				uint32_t visible = 0;
+				for (uint32_t bucket = 0; bucket < MATERIAL_BUCKET_COUNT; ++bucket)
+				{
+					visible += m_Culling.GetVisibleCount(bucket);
+				}
+				ImGui::Text("Instances: %u   Visible: %u", m_Scene.GetInstanceCount(), visible);
+				for (uint32_t bucket = 0; bucket < MATERIAL_BUCKET_COUNT; ++bucket)
+				{
+					ImGui::Text("Bucket %u: %u draws", bucket, m_Culling.GetVisibleCount(bucket));
+				}
+
+				// Should follow the resolution and the threshold, not the instance count or mesh density
+				ImGui::Text("LOD cut: %u clusters, %u triangles", m_Culling.GetDrawnClusterCount(), m_Culling.GetDrawnTriangleCount());
+				ImGui::SliderFloat("LOD Error (pixels)", &m_DebugState.lodErrorPixels, 0.25f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+
+				ImGui::Separator();
+				if (m_SoftwareRaster.IsInitialized())
+				{
+					// Compare the Main and Software Raster pass timings with this on and off
+					ImGui::Checkbox("Software Raster", &m_DebugState.enableSoftwareRaster);
+					ImGui::SliderFloat("Max Cluster Size (pixels)", &m_DebugState.softwareRasterPixels, 1.0f, 64.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+					ImGui::Text("Software raster: %u clusters, %u triangles", m_Culling.GetSoftwareClusterCount(), m_Culling.GetSoftwareTriangleCount());
+					if (m_DebugState.enableWireframe || !m_DebugState.enableCullFaceBackFace)
+					{
+						ImGui::TextDisabled("(off while wireframe or back-face culling is changed)");
+					}
+				}
+				else
+				{
+					ImGui::TextDisabled("Software raster: unavailable (needs shaderBufferInt64Atomics)");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Clustered Lighting"))
+			{
+				if (m_Lighting.IsInitialized())
+				{
+					// Compare the Light Culling and Main pass timings as the count grows
+					ImGui::SliderInt("Lights", &m_DebugState.demoLightCount, 0, static_cast<int>(MAX_LIGHTS));
+					ImGui::Text("Clusters: %ux%ux%u   Lights: %u", LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z, m_Lighting.GetLightCount());
+					const uint32_t requested = m_Lighting.GetRequestedIndexCount();
+					ImGui::Text("Light indices: %u / %u (%.1f per cluster)", requested, LIGHT_INDEX_CAPACITY, static_cast<double>(requested) / LIGHT_CLUSTER_COUNT);
+					if (requested > LIGHT_INDEX_CAPACITY)
+					{
+						ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Index lists truncated");
+					}
+				}
+				else
+				{
+					ImGui::TextDisabled("Clustered lighting: unavailable");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Shadows"))
+			{
+				if (m_Shadows.IsInitialized())
+				{
+					// With the camera at rest only the near cascades should keep counting up
+					ImGui::Checkbox("Enable Shadows", &m_DebugState.enableShadows);
+					ImGui::Checkbox("Cache Far Cascades", &m_DebugState.cacheShadowCascades);
+					for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+					{
+						ImGui::Text("Cascade %u: to %.1f, %s, drawn %llu times", cascade, static_cast<double>(m_Shadows.GetSplit(cascade)), m_Shadows.NeedsRender(cascade) ? "redrawn" : "cached", static_cast<unsigned long long>(m_Shadows.GetRenderCount(cascade)));
+					}
+				}
+				else
+				{
+					ImGui::TextDisabled("Shadows: unavailable");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Variable Rate Shading"))
+			{
+				if (m_ShadingRate.IsInitialized())
+				{
+					// Compare the Main pass timing with this on and off; higher thresholds trade edge quality for speed
+					ImGui::Checkbox("Enable Variable Rate Shading", &m_DebugState.enableVariableRateShading);
+					ImGui::SliderFloat("Threshold (quality - perf)", &m_DebugState.shadingRateThreshold, 0.0f, 0.1f, "%.3f", ImGuiSliderFlags_Logarithmic);
+					if (m_DebugState.enableVisibilityBuffer)
+					{
+						ImGui::TextDisabled("(off in visibility buffer mode, which shades in compute)");
+					}
+					else if (m_DebugState.enableVariableRateShading)
+					{
+						const VkExtent2D texelSize = m_ShadingRate.GetTexelSize();
+						const std::array<uint32_t, SHADING_RATE_CLASS_COUNT>& counts = m_ShadingRate.GetRateCounts();
+						ImGui::Text("Rate texels (%ux%u pixels): 1x1 %u, 1x2 %u, 2x1 %u, 2x2 %u", texelSize.width, texelSize.height, counts[0], counts[1], counts[2], counts[3]);
+						ImGui::Text("Fragments shaded: %.1f%% of pixels", static_cast<double>(m_ShadingRate.GetShadedFraction()) * 100.0);
+					}
+				}
+				else
+				{
+					ImGui::TextDisabled("Variable rate shading: unavailable");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("GPU Scene"))
+			{
+				const GpuScene::UploadStats& upload = m_Scene.GetLastUploadStats();
+				ImGui::Text("Capacity: %u instances", m_Scene.GetCapacity());
+				ImGui::Text("Last upload: %u instances, %u regions, %.1f KiB", upload.instances, upload.regions, static_cast<double>(upload.bytes) / 1024.0);
+				ImGui::SliderFloat("Animated Instances", &m_DebugState.animatedInstanceFraction, 0.0f, 1.0f, "%.2f");
+
+				const GpuGeometry::Stats& geometry = m_Geometry.GetStats();
+				ImGui::Text("Meshes: %u   Clusters: %u   Triangles: %u (all LOD levels)", geometry.meshCount, geometry.meshletCount, geometry.triangleCount);
+				ImGui::Text("Geometry: %.1f KiB quantized (%.1f KiB as floats)", static_cast<double>(geometry.bakedBytes) / 1024.0, static_cast<double>(geometry.sourceBytes) / 1024.0);
+			}
+
+			if (ImGui::CollapsingHeader("Texture Streaming"))
+			{
+				const TextureStreamer::Stats& streaming = m_TextureStreamer.GetStats();
+				ImGui::Text("Textures: %u   Jobs in flight: %u", streaming.textureCount, streaming.jobsInFlight);
+				ImGui::Text("Resident: %.1f / %.1f MiB", static_cast<double>(streaming.residentBytes) / (1024.0 * 1024.0), static_cast<double>(streaming.budgetBytes) / (1024.0 * 1024.0));
+				ImGui::Text("Uploaded last frame: %.1f KiB", static_cast<double>(streaming.uploadedBytes) / 1024.0);
+				ImGui::Text("Mips streamed in: %u   evicted: %u", streaming.mipsStreamedIn, streaming.mipsEvicted);
+
+				int budgetMiB = static_cast<int>(streaming.budgetBytes / (1024 * 1024));
+				if (ImGui::SliderInt("Budget (MiB)", &budgetMiB, 16, 4096))
+				{
+					m_TextureStreamer.SetBudget(static_cast<VkDeviceSize>(budgetMiB) * 1024 * 1024);
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Bindless Slots"))
+			{
+				for (size_t i = 0; i < static_cast<size_t>(BindlessType::Count); ++i)
+				{
+					const BindlessType type = static_cast<BindlessType>(i);
+					const BindlessRegistry::Usage usage = m_BindlessRegistry.GetUsage(type);
+					ImGui::Text("%-16s %5u / %5u  (pending release %u, high water %u)", GetBindlessTypeName(type), usage.live, GetBindlessCapacity(type), usage.pendingRelease, usage.highWater);
+				}
+				ImGui::Text("Deferred destroys pending: %zu", m_DeferredDestruction.GetPendingCount());
+			}
+
 			ImGui::EndTabItem();
 		}
 
@@ -824,21 +1353,29 @@ bool GraphicsSystem::CreateVulkanInstance(SDL_Window* window)
 {
 	ZoneScopedN("CreateVulkanInstance");
 
-	// Get SDL required extensions
-	Uint32 extCount = 0;
-	const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extCount);
-	if (!extensions)
-	{
-		Logger::Error("Failed to get Vulkan extensions from SDL");
-		return false;
-	}
-
 	// Build instance
 	vkb::InstanceBuilder builder;
 	builder.set_app_name("Woven Core");
 	builder.set_engine_name("Woven Engine");
 	builder.require_api_version(1, 4, 0);
-	builder.enable_extensions(extCount, extensions);
+
+	if (m_Headless)
+	{
+		// No surface extensions: lets the instance come up on display-less CI hosts (e.g. lavapipe)
+		builder.set_headless(true);
+	}
+	else
+	{
+		// Get SDL required extensions
+		Uint32 extCount = 0;
+		const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extCount);
+		if (!extensions)
+		{
+			WOVEN_LOG_ERROR("Failed to get Vulkan extensions from SDL");
+			return false;
+		}
+		builder.enable_extensions(extCount, extensions);
+	}
 
 #ifndef NDEBUG
 	builder.request_validation_layers(true);
@@ -854,16 +1391,22 @@ bool GraphicsSystem::CreateVulkanInstance(SDL_Window* window)
 			        Logger::VulkanInfo(data->pMessage);
 		        return VK_FALSE;
 	        });
-	builder.set_debug_messenger_severity(VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT);
+	// Levels the logger filters out are not requested from the layers at all
+	VkDebugUtilsMessageSeverityFlagsEXT messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	if constexpr (WOVEN_LOG_LEVEL <= 2)
+		messageSeverity |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+	if constexpr (WOVEN_LOG_LEVEL <= 1)
+		messageSeverity |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+	builder.set_debug_messenger_severity(messageSeverity);
 	builder.add_validation_feature_enable(VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT);
 	builder.add_validation_feature_enable(VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT);
 	builder.add_validation_feature_enable(VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT);
 	builder.add_validation_feature_enable(VK_VALIDATION_FEATURE_ENABLE_DEBUG_PRINTF_EXT);
 	builder.add_validation_feature_disable(VK_VALIDATION_FEATURE_DISABLE_CORE_CHECKS_EXT);
 
-	Logger::Info("Validation: GPU-Assisted + Sync + Best Practices + Debug Printf");
+	WOVEN_LOG_INFO("Validation: GPU-Assisted + Sync + Best Practices + Debug Printf");
 #else
-	Logger::Info("Validation layers disabled (Release build)");
+	WOVEN_LOG_INFO("Validation layers disabled (Release build)");
 #endif
 
 	if (auto instanceRet = builder.build())
@@ -873,7 +1416,7 @@ bool GraphicsSystem::CreateVulkanInstance(SDL_Window* window)
 	}
 	else
 	{
-		Logger::Error("Failed to create Vulkan Instance: %s", instanceRet.error().message().c_str());
+		WOVEN_LOG_ERROR("Failed to create Vulkan Instance: %s", instanceRet.error().message().c_str());
 		return false;
 	}
 
@@ -882,7 +1425,7 @@ bool GraphicsSystem::CreateVulkanInstance(SDL_Window* window)
 	uint32_t major = VK_VERSION_MAJOR(apiVersion);
 	uint32_t minor = VK_VERSION_MINOR(apiVersion);
 	uint32_t patch = VK_VERSION_PATCH(apiVersion);
-	Logger::Info("Vulkan Instance (API %u.%u.%u)", major, minor, patch);
+	WOVEN_LOG_INFO("Vulkan Instance (API %u.%u.%u)", major, minor, patch);
 
 	return true;
 }
@@ -894,7 +1437,7 @@ bool GraphicsSystem::CreateSurface(SDL_Window* window)
 	VkSurfaceKHR tempSurface = VK_NULL_HANDLE;
 	if (!SDL_Vulkan_CreateSurface(window, m_VkbInstance.instance, nullptr, &tempSurface))
 	{
-		Logger::Error("Failed to create Vulkan Surface: %s", SDL_GetError());
+		WOVEN_LOG_ERROR("Failed to create Vulkan Surface: %s", SDL_GetError());
 		return false;
 	}
 
@@ -906,12 +1449,18 @@ bool GraphicsSystem::SelectPhysicalDevice()
 {
 	ZoneScopedN("SelectPhysicalDevice");
 
+	// Indirect-count mesh draws and 64-bit device addresses in shaders
+	VkPhysicalDeviceFeatures requiredCore{};
+	requiredCore.multiDrawIndirect = VK_TRUE;
+	requiredCore.shaderInt64 = VK_TRUE;
+
 	VkPhysicalDeviceVulkan11Features required11{};
 	required11.shaderDrawParameters = VK_TRUE;
 	required11.multiview = VK_TRUE;
 
 	VkPhysicalDeviceVulkan12Features required12{};
 	required12.bufferDeviceAddress = VK_TRUE;
+	required12.drawIndirectCount = VK_TRUE;
 	required12.descriptorIndexing = VK_TRUE;
 	required12.runtimeDescriptorArray = VK_TRUE;
 	required12.descriptorBindingPartiallyBound = VK_TRUE;
@@ -945,8 +1494,16 @@ bool GraphicsSystem::SelectPhysicalDevice()
 	required13.inlineUniformBlock = VK_TRUE;
 
 	vkb::PhysicalDeviceSelector selector(m_VkbInstance);
-	selector.set_surface(m_Surface);
+	if (m_Headless)
+	{
+		selector.require_present(false);
+	}
+	else
+	{
+		selector.set_surface(m_Surface);
+	}
 	selector.set_minimum_version(1, 4);
+	selector.set_required_features(requiredCore);
 	selector.set_required_features_11(required11);
 	selector.set_required_features_12(required12);
 	selector.set_required_features_13(required13);
@@ -955,11 +1512,11 @@ bool GraphicsSystem::SelectPhysicalDevice()
 	if (auto physicalDeviceRet = selector.select())
 	{
 		m_VkbPhysicalDevice = std::move(physicalDeviceRet).value();
-		Logger::Info("Selected GPU: %s", m_VkbPhysicalDevice.properties.deviceName);
+		WOVEN_LOG_INFO("Selected GPU: %s", m_VkbPhysicalDevice.properties.deviceName);
 	}
 	else
 	{
-		Logger::Error("Failed to select Physical Device: %s", physicalDeviceRet.error().message().c_str());
+		WOVEN_LOG_ERROR("Failed to select Physical Device: %s", physicalDeviceRet.error().message().c_str());
 		return false;
 	}
 
@@ -978,16 +1535,16 @@ bool GraphicsSystem::SelectPhysicalDevice()
 
 	if (!m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_SHADER_OBJECT_EXTENSION_NAME))
 	{
-		Logger::Error("VK_EXT_shader_object is required for this renderer");
+		WOVEN_LOG_ERROR("VK_EXT_shader_object is required for this renderer");
 		return false;
 	}
 	if (!m_VkbPhysicalDevice.enable_extension_features_if_present(shaderObjectFeatures))
 	{
-		Logger::Error("VK_EXT_shader_object present but features unavailable");
+		WOVEN_LOG_ERROR("VK_EXT_shader_object present but features unavailable");
 		return false;
 	}
 	m_SupportsShaderObjects = true;
-	Logger::Info("Enabled VK_EXT_shader_object");
+	WOVEN_LOG_INFO("Enabled VK_EXT_shader_object");
 
 	// Enable Vertex Input Dynamic State (required for shader objects)
 	VkPhysicalDeviceVertexInputDynamicStateFeaturesEXT vertexInputFeatures{
@@ -997,15 +1554,15 @@ bool GraphicsSystem::SelectPhysicalDevice()
 
 	if (!m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME))
 	{
-		Logger::Error("VK_EXT_vertex_input_dynamic_state is required for shader objects");
+		WOVEN_LOG_ERROR("VK_EXT_vertex_input_dynamic_state is required for shader objects");
 		return false;
 	}
 	if (!m_VkbPhysicalDevice.enable_extension_features_if_present(vertexInputFeatures))
 	{
-		Logger::Error("VK_EXT_vertex_input_dynamic_state present but features unavailable");
+		WOVEN_LOG_ERROR("VK_EXT_vertex_input_dynamic_state present but features unavailable");
 		return false;
 	}
-	Logger::Info("Enabled VK_EXT_vertex_input_dynamic_state");
+	WOVEN_LOG_INFO("Enabled VK_EXT_vertex_input_dynamic_state");
 
 	// Enable Extended Dynamic State 2 + 3 (required for shader objects)
 	VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures{
@@ -1015,15 +1572,15 @@ bool GraphicsSystem::SelectPhysicalDevice()
 
 	if (!m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state is required for shader objects");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state is required for shader objects");
 		return false;
 	}
 	if (!m_VkbPhysicalDevice.enable_extension_features_if_present(dynamicStateFeatures))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state present but features unavailable");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state present but features unavailable");
 		return false;
 	}
-	Logger::Info("Enabled VK_EXT_extended_dynamic_state");
+	WOVEN_LOG_INFO("Enabled VK_EXT_extended_dynamic_state");
 
 	VkPhysicalDeviceExtendedDynamicState2FeaturesEXT dynamicState2Features{
 		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT,
@@ -1032,15 +1589,15 @@ bool GraphicsSystem::SelectPhysicalDevice()
 
 	if (!m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state2 is required for shader objects");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state2 is required for shader objects");
 		return false;
 	}
 	if (!m_VkbPhysicalDevice.enable_extension_features_if_present(dynamicState2Features))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state2 present but features unavailable");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state2 present but features unavailable");
 		return false;
 	}
-	Logger::Info("Enabled VK_EXT_extended_dynamic_state2");
+	WOVEN_LOG_INFO("Enabled VK_EXT_extended_dynamic_state2");
 
 	VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features{};
 	dynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
@@ -1053,53 +1610,76 @@ bool GraphicsSystem::SelectPhysicalDevice()
 
 	if (!m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state3 is required for shader objects");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state3 is required for shader objects");
 		return false;
 	}
 	if (!m_VkbPhysicalDevice.enable_extension_features_if_present(dynamicState3Features))
 	{
-		Logger::Error("VK_EXT_extended_dynamic_state3 present but features unavailable");
+		WOVEN_LOG_ERROR("VK_EXT_extended_dynamic_state3 present but features unavailable");
 		return false;
 	}
-	Logger::Info("Enabled VK_EXT_extended_dynamic_state3");
+	WOVEN_LOG_INFO("Enabled VK_EXT_extended_dynamic_state3");
 
 	if (m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_MESH_SHADER_EXTENSION_NAME))
 	{
 		if (m_VkbPhysicalDevice.enable_extension_features_if_present(meshShaderFeatures))
 		{
 			m_SupportsMeshShaders = true;
-			Logger::Info("Enabled VK_EXT_mesh_shader");
+			WOVEN_LOG_INFO("Enabled VK_EXT_mesh_shader");
 		}
 		else
 		{
-			Logger::Warning("VK_EXT_mesh_shader present but features unavailable");
+			WOVEN_LOG_WARNING("VK_EXT_mesh_shader present but features unavailable");
 		}
 	}
 	else
 	{
-		Logger::Debug("VK_EXT_mesh_shader not available");
+		WOVEN_LOG_DEBUG("VK_EXT_mesh_shader not available");
 	}
 
-	// Enable Descriptor Buffer (optional, next-gen bindless)
+	// Enable Descriptor Buffer (optional, replaces the bindless descriptor set when selected)
+	VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{};
+	descriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+	descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+
 	if (m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME))
 	{
-		m_SupportsDescriptorBuffer = true;
-		Logger::Info("Enabled VK_EXT_descriptor_buffer");
+		if (m_VkbPhysicalDevice.enable_extension_features_if_present(descriptorBufferFeatures))
+		{
+			m_SupportsDescriptorBuffer = true;
+			WOVEN_LOG_INFO("Enabled VK_EXT_descriptor_buffer");
+		}
+		else
+		{
+			WOVEN_LOG_WARNING("VK_EXT_descriptor_buffer present but features unavailable");
+		}
+	}
+	else
+	{
+		WOVEN_LOG_DEBUG("VK_EXT_descriptor_buffer not available");
+	}
+	m_UseDescriptorBuffer = m_SupportsDescriptorBuffer && m_PreferDescriptorBuffer;
+
+	// Enable Memory Budget (driver-reported per-heap budgets for VMA)
+	if (m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+	{
+		m_SupportsMemoryBudget = true;
+		WOVEN_LOG_INFO("Enabled VK_EXT_memory_budget");
 	}
 	else
 	{
-		Logger::Debug("VK_EXT_descriptor_buffer not available");
+		WOVEN_LOG_DEBUG("VK_EXT_memory_budget not available");
 	}
 
 	// Enable Push Descriptor (fast descriptor updates)
 	if (m_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
 	{
 		m_SupportsPushDescriptor = true;
-		Logger::Info("Enabled VK_KHR_push_descriptor");
+		WOVEN_LOG_INFO("Enabled VK_KHR_push_descriptor");
 	}
 	else
 	{
-		Logger::Debug("VK_KHR_push_descriptor not available");
+		WOVEN_LOG_DEBUG("VK_KHR_push_descriptor not available");
 	}
 
 	// Enable Graphics Pipeline Library (fast pipeline creation)
@@ -1124,21 +1704,67 @@ bool GraphicsSystem::SelectPhysicalDevice()
 		if (m_VkbPhysicalDevice.enable_extension_features_if_present(fragmentShadingRateFeatures))
 		{
 			m_SupportsFragmentShadingRate = true;
-			Logger::Info("Enabled VK_KHR_fragment_shading_rate");
+			WOVEN_LOG_INFO("Enabled VK_KHR_fragment_shading_rate");
 		}
 		else
 		{
-			Logger::Warning("VK_KHR_fragment_shading_rate present but features unavailable");
+			WOVEN_LOG_WARNING("VK_KHR_fragment_shading_rate present but features unavailable");
 		}
 	}
 	else
 	{
-		Logger::Debug("VK_KHR_fragment_shading_rate not available");
+		WOVEN_LOG_DEBUG("VK_KHR_fragment_shading_rate not available");
 	}
 #else
-	Logger::Debug("VK_KHR_fragment_shading_rate headers not available");
+	WOVEN_LOG_DEBUG("VK_KHR_fragment_shading_rate headers not available");
 #endif
 
+	// Present id + present wait: display latency metric and low-latency pacing (needs a swapchain)
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+		.presentId = VK_TRUE,
+	};
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+		.presentWait = VK_TRUE,
+	};
+
+	if (!m_Headless && m_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PRESENT_ID_EXTENSION_NAME) && m_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+	{
+		if (m_VkbPhysicalDevice.enable_extension_features_if_present(presentIdFeatures) && m_VkbPhysicalDevice.enable_extension_features_if_present(presentWaitFeatures))
+		{
+			m_SupportsPresentWait = true;
+			WOVEN_LOG_INFO("Enabled VK_KHR_present_wait");
+		}
+		else
+		{
+			WOVEN_LOG_WARNING("VK_KHR_present_wait present but features unavailable");
+		}
+	}
+	else if (!m_Headless)
+	{
+		WOVEN_LOG_DEBUG("VK_KHR_present_wait not available, display latency is not measured");
+	}
+
+	// BC formats for streamed textures (transcoded to RGBA8 without them)
+	VkPhysicalDeviceFeatures compressionFeatures{};
+	compressionFeatures.textureCompressionBC = VK_TRUE;
+	m_SupportsTextureCompressionBC = m_VkbPhysicalDevice.enable_features_if_present(compressionFeatures);
+	if (!m_SupportsTextureCompressionBC)
+	{
+		WOVEN_LOG_WARNING("BC texture compression not available, streamed textures use RGBA8");
+	}
+
+	// 64-bit storage buffer atomics for the software rasterizer's visibility buffer (mesh shaders draw everything without them)
+	VkPhysicalDeviceVulkan12Features int64AtomicFeatures{};
+	int64AtomicFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	int64AtomicFeatures.shaderBufferInt64Atomics = VK_TRUE;
+	m_SupportsInt64Atomics = m_VkbPhysicalDevice.enable_extension_features_if_present(int64AtomicFeatures);
+	if (!m_SupportsInt64Atomics)
+	{
+		WOVEN_LOG_WARNING("shaderBufferInt64Atomics not available, software rasterization disabled");
+	}
+
 	return true;
 }
 
@@ -1156,7 +1782,7 @@ bool GraphicsSystem::CreateLogicalDevice()
 	}
 	else
 	{
-		Logger::Error("Failed to create Vulkan Device: %s", deviceRet.error().message().c_str());
+		WOVEN_LOG_ERROR("Failed to create Vulkan Device: %s", deviceRet.error().message().c_str());
 		return false;
 	}
 }
@@ -1165,28 +1791,65 @@ bool GraphicsSystem::GetQueues()
 {
 	ZoneScopedN("GetQueues");
 
+	// Optional: a compute family without graphics lets compute passes overlap the raster work (vk-bootstrap
+	// creates one queue per family). Without it everything stays on the graphics queue.
+	if (auto graphicsQueueFamily = m_VkbDevice.get_queue_index(vkb::QueueType::graphics))
+	{
+		m_GraphicsQueueFamily = graphicsQueueFamily.value();
+	}
+	auto computeQueue = m_VkbDevice.get_queue(vkb::QueueType::compute);
+	auto computeQueueFamily = m_VkbDevice.get_queue_index(vkb::QueueType::compute);
+	if (computeQueue && computeQueueFamily && computeQueueFamily.value() != m_GraphicsQueueFamily)
+	{
+		m_ComputeQueue = computeQueue.value();
+		m_ComputeQueueFamily = computeQueueFamily.value();
+	}
+	else
+	{
+		WOVEN_LOG_INFO("No separate compute queue, compute passes stay on the graphics queue");
+	}
+
+	if (m_Headless)
+	{
+		if (auto graphicsQueue = m_VkbDevice.get_queue(vkb::QueueType::graphics))
+		{
+			m_GraphicsQueue = std::move(graphicsQueue).value();
+			WOVEN_LOG_INFO("Vulkan Device and Queues ready (headless)");
+			return true;
+		}
+		WOVEN_LOG_ERROR("Failed to get graphics queue");
+		return false;
+	}
+
 	if (auto graphicsQueue = m_VkbDevice.get_queue(vkb::QueueType::graphics))
 	{
 		if (auto presentQueue = m_VkbDevice.get_queue(vkb::QueueType::present))
 		{
 			m_GraphicsQueue = std::move(graphicsQueue).value();
 			m_PresentQueue = std::move(presentQueue).value();
-			Logger::Info("Vulkan Device and Queues ready");
+			WOVEN_LOG_INFO("Vulkan Device and Queues ready");
 			return true;
 		}
 		else
 		{
-			Logger::Error("Failed to get presentation queue");
+			WOVEN_LOG_ERROR("Failed to get presentation queue");
 			return false;
 		}
 	}
 	else
 	{
-		Logger::Error("Failed to get graphics queue");
+		WOVEN_LOG_ERROR("Failed to get graphics queue");
 		return false;
 	}
 }
 
+std::vector<uint32_t> GraphicsSystem::GetQueueFamilies() const
+{
+	if (m_ComputeQueue == VK_NULL_HANDLE)
+		return { m_GraphicsQueueFamily };
+	return { m_GraphicsQueueFamily, m_ComputeQueueFamily };
+}
+
 bool GraphicsSystem::InitializeVulkanMemoryAllocator()
 {
 	ZoneScopedN("InitializeVulkanMemoryAllocator");
@@ -1196,8 +1859,14 @@ bool GraphicsSystem::InitializeVulkanMemoryAllocator()
 		.vkGetDeviceProcAddr = vkGetDeviceProcAddr,
 	};
 
+	VmaAllocatorCreateFlags allocatorFlags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+	if (m_SupportsMemoryBudget)
+	{
+		allocatorFlags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+	}
+
 	const VmaAllocatorCreateInfo allocatorInfo{
-		.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+		.flags = allocatorFlags,
 		.physicalDevice = m_VkbPhysicalDevice.physical_device,
 		.device = m_VkbDevice.device,
 		.preferredLargeHeapBlockSize = 0,
@@ -1212,11 +1881,20 @@ bool GraphicsSystem::InitializeVulkanMemoryAllocator()
 
 	if (vmaCreateAllocator(&allocatorInfo, &m_VmaAllocator) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create VMA allocator");
+		WOVEN_LOG_ERROR("Failed to create VMA allocator");
+		return false;
+	}
+
+	m_MemoryStats.Initialize(m_VmaAllocator, m_SupportsMemoryBudget);
+
+	if (!m_MemoryPools.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, MAX_FRAMES_IN_FLIGHT))
+	{
+		WOVEN_LOG_ERROR("Failed to create GPU memory pools");
 		return false;
 	}
+	m_MemoryPools.SetQueueFamilies(GetQueueFamilies());
 
-	Logger::Info("Vulkan Memory Allocator initialized");
+	WOVEN_LOG_INFO("Vulkan Memory Allocator initialized");
 	return true;
 }
 
@@ -1232,7 +1910,7 @@ bool GraphicsSystem::CreateTracyContext()
 
 	if (vkCreateCommandPool(m_VkbDevice.device, &poolInfo, nullptr, &m_TracyCommandPool) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create Tracy command pool");
+		WOVEN_LOG_ERROR("Failed to create Tracy command pool");
 		return false;
 	}
 
@@ -1245,7 +1923,7 @@ bool GraphicsSystem::CreateTracyContext()
 
 	if (vkAllocateCommandBuffers(m_VkbDevice.device, &allocInfo, &m_TracyCommandBuffer) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to allocate Tracy command buffer");
+		WOVEN_LOG_ERROR("Failed to allocate Tracy command buffer");
 		return false;
 	}
 
@@ -1254,14 +1932,14 @@ bool GraphicsSystem::CreateTracyContext()
 
 	if (!m_TracyContext)
 	{
-		Logger::Error("Failed to create Tracy GPU context");
+		WOVEN_LOG_ERROR("Failed to create Tracy GPU context");
 		return false;
 	}
 
 	// Name the context for clarity in Tracy UI
 	TracyVkContextName(m_TracyContext, "Vulkan Main Context", 21);
 
-	Logger::Info("Tracy GPU profiling initialized");
+	WOVEN_LOG_INFO("Tracy GPU profiling initialized");
 	return true;
 }
 
@@ -1275,7 +1953,7 @@ bool GraphicsSystem::CreateSwapchain(SDL_Window* window)
 	VkSurfaceCapabilitiesKHR surfaceCapabilities;
 	if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_VkbPhysicalDevice.physical_device, m_Surface, &surfaceCapabilities) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to query surface capabilities");
+		WOVEN_LOG_ERROR("Failed to query surface capabilities");
 		return false;
 	}
 
@@ -1303,26 +1981,36 @@ bool GraphicsSystem::CreateSwapchain(SDL_Window* window)
 
 	m_SwapchainImageFormat = selectedFormat.format;
 
-	// Choose present mode (prefer MAILBOX for low latency, fallback to FIFO which is always available)
+	// Choose present mode from the latency mode, falling back to FIFO which is always available
 	uint32_t presentModeCount;
 	vkGetPhysicalDeviceSurfacePresentModesKHR(m_VkbPhysicalDevice.physical_device, m_Surface, &presentModeCount, nullptr);
 	std::vector<VkPresentModeKHR> presentModes(presentModeCount);
 	vkGetPhysicalDeviceSurfacePresentModesKHR(m_VkbPhysicalDevice.physical_device, m_Surface, &presentModeCount, presentModes.data());
 
+	const auto hasPresentMode = [&presentModes](VkPresentModeKHR mode)
+	{
+		return std::find(presentModes.begin(), presentModes.end(), mode) != presentModes.end();
+	};
+
 	VkPresentModeKHR selectedPresentMode = VK_PRESENT_MODE_FIFO_KHR; // Always available per spec
-	for (const auto& mode: presentModes)
+	switch (m_LatencyMode)
 	{
-		// MAILBOX: Low latency triple buffering
-		if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
-		{
-			selectedPresentMode = mode;
+		case LatencyMode::Vsync:
+			break;
+		case LatencyMode::LowLatency:
+			// MAILBOX: a frame finishing late still makes the next vblank instead of queueing behind one
+			if (hasPresentMode(VK_PRESENT_MODE_MAILBOX_KHR))
+				selectedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+			break;
+		case LatencyMode::Uncapped:
+			// IMMEDIATE: lowest latency but tears
+			if (hasPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR))
+				selectedPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			else if (hasPresentMode(VK_PRESENT_MODE_MAILBOX_KHR))
+				selectedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+			break;
+		default:
 			break;
-		}
-		// IMMEDIATE: Lowest latency but may tear (good for uncapped FPS)
-		if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-		{
-			selectedPresentMode = mode;
-		}
 	}
 
 	// Determine swapchain extent
@@ -1366,7 +2054,7 @@ bool GraphicsSystem::CreateSwapchain(SDL_Window* window)
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	createInfo.presentMode = selectedPresentMode;
 	createInfo.clipped = VK_TRUE;
-	createInfo.oldSwapchain = VK_NULL_HANDLE; // For recreation, could pass old swapchain
+	createInfo.oldSwapchain = m_Swapchain; // Null on first creation; on recreation the driver can reuse its resources
 
 	// Handle queue family ownership
 	uint32_t queueFamilyIndices[] = { m_VkbDevice.get_queue_index(vkb::QueueType::graphics).value(), m_VkbDevice.get_queue_index(vkb::QueueType::present).value() };
@@ -1382,9 +2070,11 @@ bool GraphicsSystem::CreateSwapchain(SDL_Window* window)
 		createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	}
 
+	// The old swapchain is retired by this call even when it fails; RecreateSwapchain still owns its destruction
 	if (vkCreateSwapchainKHR(m_VkbDevice.device, &createInfo, nullptr, &m_Swapchain) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create swapchain");
+		WOVEN_LOG_ERROR("Failed to create swapchain");
+		m_Swapchain = VK_NULL_HANDLE;
 		return false;
 	}
 
@@ -1416,14 +2106,13 @@ bool GraphicsSystem::CreateSwapchain(SDL_Window* window)
 
 		if (vkCreateImageView(m_VkbDevice.device, &viewInfo, nullptr, &m_SwapchainImageViews[i]) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to create image view for swapchain image %zu", i);
+			WOVEN_LOG_ERROR("Failed to create image view for swapchain image %zu", i);
 			return false;
 		}
 	}
 
-	const char* presentModeStr = selectedPresentMode == VK_PRESENT_MODE_MAILBOX_KHR ? "MAILBOX" : selectedPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR ? "IMMEDIATE" : selectedPresentMode == VK_PRESENT_MODE_FIFO_KHR ? "FIFO" : "OTHER";
-
-	Logger::Info("Swapchain created: %ux%u, %u images, %s mode", m_SwapchainExtent.width, m_SwapchainExtent.height, swapchainImageCount, presentModeStr);
+	m_PresentMode = selectedPresentMode;
+	WOVEN_LOG_INFO("Swapchain created: %ux%u, %u images, %s mode (%s)", m_SwapchainExtent.width, m_SwapchainExtent.height, swapchainImageCount, GetPresentModeName(selectedPresentMode), GetLatencyModeName(m_LatencyMode));
 
 	m_SwapchainOutOfDate = false;
 	return true;
@@ -1435,20 +2124,20 @@ bool GraphicsSystem::RecordSwapchainClear(VkCommandBuffer cmd, uint32_t imageInd
 
 	if (cmd == VK_NULL_HANDLE)
 	{
-		Logger::Error("Invalid command buffer for swapchain clear");
+		WOVEN_LOG_ERROR("Invalid command buffer for swapchain clear");
 		return false;
 	}
 
 	if (imageIndex >= m_SwapchainImages.size())
 	{
-		Logger::Error("Swapchain image index out of range: %u", imageIndex);
+		WOVEN_LOG_ERROR("Swapchain image index out of range: %u", imageIndex);
 		return false;
 	}
 
 	VkImage swapchainImage = m_SwapchainImages[imageIndex];
 	if (swapchainImage == VK_NULL_HANDLE)
 	{
-		Logger::Error("Swapchain image is null at index %u", imageIndex);
+		WOVEN_LOG_ERROR("Swapchain image is null at index %u", imageIndex);
 		return false;
 	}
 
@@ -1518,7 +2207,7 @@ VkFormat GraphicsSystem::FindDepthFormat()
 		}
 	}
 
-	Logger::Warning("No optimal depth format found, using D32_SFLOAT");
+	WOVEN_LOG_WARNING("No optimal depth format found, using D32_SFLOAT");
 	return VK_FORMAT_D32_SFLOAT;
 }
 
@@ -1533,8 +2222,8 @@ bool GraphicsSystem::CreateDepthResources()
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent.width = m_SwapchainExtent.width;
-	imageInfo.extent.height = m_SwapchainExtent.height;
+	imageInfo.extent.width = m_RenderTargetExtent.width;
+	imageInfo.extent.height = m_RenderTargetExtent.height;
 	imageInfo.extent.depth = 1;
 	imageInfo.mipLevels = 1;
 	imageInfo.arrayLayers = 1;
@@ -1551,9 +2240,10 @@ bool GraphicsSystem::CreateDepthResources()
 
 	if (vmaCreateImage(m_VmaAllocator, &imageInfo, &allocInfo, &m_DepthImage, &m_DepthImageAllocation, nullptr) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create depth image");
+		WOVEN_LOG_ERROR("Failed to create depth image");
 		return false;
 	}
+	m_MemoryStats.Track(m_DepthImageAllocation, GpuMemoryCategory::RenderTarget, "Depth Buffer");
 
 	// Create depth image view
 	VkImageViewCreateInfo viewInfo{};
@@ -1569,11 +2259,11 @@ bool GraphicsSystem::CreateDepthResources()
 
 	if (vkCreateImageView(m_VkbDevice.device, &viewInfo, nullptr, &m_DepthImageView) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create depth image view");
+		WOVEN_LOG_ERROR("Failed to create depth image view");
 		return false;
 	}
 
-	Logger::Info("Depth buffer created: %ux%u, format %d", m_SwapchainExtent.width, m_SwapchainExtent.height, m_DepthFormat);
+	WOVEN_LOG_INFO("Depth buffer created: %ux%u, format %d", m_RenderTargetExtent.width, m_RenderTargetExtent.height, m_DepthFormat);
 	m_DepthImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	return true;
 }
@@ -1593,6 +2283,7 @@ void GraphicsSystem::CleanupDepthResources()
 
 	if (m_DepthImage != VK_NULL_HANDLE)
 	{
+		m_MemoryStats.Untrack(m_DepthImageAllocation);
 		vmaDestroyImage(m_VmaAllocator, m_DepthImage, m_DepthImageAllocation);
 		m_DepthImage = VK_NULL_HANDLE;
 		m_DepthImageAllocation = VK_NULL_HANDLE;
@@ -1609,8 +2300,8 @@ bool GraphicsSystem::CreateHDRRenderTarget()
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent.width = m_SwapchainExtent.width;
-	imageInfo.extent.height = m_SwapchainExtent.height;
+	imageInfo.extent.width = m_RenderTargetExtent.width;
+	imageInfo.extent.height = m_RenderTargetExtent.height;
 	imageInfo.extent.depth = 1;
 	imageInfo.mipLevels = 1;
 	imageInfo.arrayLayers = 1;
@@ -1627,9 +2318,10 @@ bool GraphicsSystem::CreateHDRRenderTarget()
 
 	if (vmaCreateImage(m_VmaAllocator, &imageInfo, &allocInfo, &m_HDRRenderTarget, &m_HDRRenderTargetAllocation, nullptr) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create HDR render target");
+		WOVEN_LOG_ERROR("Failed to create HDR render target");
 		return false;
 	}
+	m_MemoryStats.Track(m_HDRRenderTargetAllocation, GpuMemoryCategory::RenderTarget, "HDR Target");
 
 	// Create HDR image view
 	VkImageViewCreateInfo viewInfo{};
@@ -1645,12 +2337,13 @@ bool GraphicsSystem::CreateHDRRenderTarget()
 
 	if (vkCreateImageView(m_VkbDevice.device, &viewInfo, nullptr, &m_HDRRenderTargetView) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create HDR render target view");
+		WOVEN_LOG_ERROR("Failed to create HDR render target view");
 		return false;
 	}
 
-	Logger::Info("HDR render target created: %ux%u, format R16G16B16A16_SFLOAT", m_SwapchainExtent.width, m_SwapchainExtent.height);
+	WOVEN_LOG_INFO("HDR render target created: %ux%u, format R16G16B16A16_SFLOAT", m_RenderTargetExtent.width, m_RenderTargetExtent.height);
 	m_HDRImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	m_HDRHistoryValid = false;
 	return true;
 }
 
@@ -1669,6 +2362,7 @@ void GraphicsSystem::CleanupHDRRenderTarget()
 
 	if (m_HDRRenderTarget != VK_NULL_HANDLE)
 	{
+		m_MemoryStats.Untrack(m_HDRRenderTargetAllocation);
 		vmaDestroyImage(m_VmaAllocator, m_HDRRenderTarget, m_HDRRenderTargetAllocation);
 		m_HDRRenderTarget = VK_NULL_HANDLE;
 		m_HDRRenderTargetAllocation = VK_NULL_HANDLE;
@@ -1681,36 +2375,68 @@ bool GraphicsSystem::RecreateSwapchain(SDL_Window* window)
 {
 	ZoneScopedN("RecreateSwapchain");
 
-	// Wait for device to be idle before recreating swapchain
-	vkDeviceWaitIdle(m_VkbDevice.device);
+	// Frames in flight keep rendering to and presenting from the old swapchain, so it is handed to the driver as
+	// oldSwapchain and goes through deferred destruction with its views instead of after a device idle. The batch
+	// is stamped by the next frame submitted, which queues behind every frame that used them.
+	for (VkImageView view: m_SwapchainImageViews)
+	{
+		m_DeferredDestruction.DestroyImageView(view);
+	}
+	m_DeferredDestruction.DestroySwapchain(m_Swapchain);
+	m_SwapchainImageViews.clear();
+	m_SwapchainImages.clear();
+	m_SwapchainImageLayouts.clear();
 
-	// Clean up old swapchain resources
-	CleanupSwapchain();
-	CleanupDepthResources();
-	CleanupHDRRenderTarget();
+	// Present waits are per swapchain; frames still queued on the old one go unmeasured
+	m_PendingPresents.clear();
 
-	// Create new swapchain and dependent resources
 	if (!CreateSwapchain(window))
 	{
-		Logger::Error("Failed to recreate swapchain");
+		WOVEN_LOG_ERROR("Failed to recreate swapchain");
 		return false;
 	}
 
-	if (!CreateDepthResources())
+	// Depth and HDR only follow the window when it outgrows them; shrinking and growing back within the
+	// allocation keeps the images (and their views, so bindless slots and layout tracking carry over)
+	if (m_SwapchainExtent.width > m_RenderTargetExtent.width || m_SwapchainExtent.height > m_RenderTargetExtent.height)
+	{
+		m_DeferredDestruction.DestroyImageView(m_DepthImageView);
+		m_DeferredDestruction.DestroyImage(m_DepthImage, m_DepthImageAllocation);
+		m_DeferredDestruction.DestroyImageView(m_HDRRenderTargetView);
+		m_DeferredDestruction.DestroyImage(m_HDRRenderTarget, m_HDRRenderTargetAllocation);
+		m_DepthImageView = VK_NULL_HANDLE;
+		m_DepthImage = VK_NULL_HANDLE;
+		m_DepthImageAllocation = VK_NULL_HANDLE;
+		m_HDRRenderTargetView = VK_NULL_HANDLE;
+		m_HDRRenderTarget = VK_NULL_HANDLE;
+		m_HDRRenderTargetAllocation = VK_NULL_HANDLE;
+
+		m_RenderTargetExtent.width = std::max(m_RenderTargetExtent.width, m_SwapchainExtent.width);
+		m_RenderTargetExtent.height = std::max(m_RenderTargetExtent.height, m_SwapchainExtent.height);
+	}
+	else
+	{
+		// Last frame's image no longer matches the frame size
+		m_HDRHistoryValid = false;
+	}
+
+	if (m_DepthImage == VK_NULL_HANDLE && !CreateDepthResources())
 	{
-		Logger::Error("Failed to recreate depth resources");
+		WOVEN_LOG_ERROR("Failed to recreate depth resources");
+		m_SwapchainOutOfDate = true; // Retry next frame rather than render without it
 		return false;
 	}
 
-	if (!CreateHDRRenderTarget())
+	if (m_HDRRenderTarget == VK_NULL_HANDLE && !CreateHDRRenderTarget())
 	{
-		Logger::Error("Failed to recreate HDR render target");
+		WOVEN_LOG_ERROR("Failed to recreate HDR render target");
+		m_SwapchainOutOfDate = true; // Retry next frame rather than render without it
 		return false;
 	}
 
 	m_SwapchainOutOfDate = false;
 	m_FramebufferResized = false;
-	Logger::Info("Swapchain recreated");
+	WOVEN_LOG_INFO("Swapchain recreated");
 	return true;
 }
 
@@ -1741,43 +2467,134 @@ void GraphicsSystem::CleanupSwapchain()
 	}
 }
 
+bool GraphicsSystem::CreateOffscreenTargets()
+{
+	ZoneScopedN("CreateOffscreenTargets");
+
+	// One image per frame in flight so a frame never overwrites one the GPU is still reading
+	m_SwapchainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+	m_SwapchainImages.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+	m_SwapchainImageViews.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+	m_SwapchainImageLayouts.assign(MAX_FRAMES_IN_FLIGHT, VK_IMAGE_LAYOUT_UNDEFINED);
+	m_OffscreenAllocations.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = m_SwapchainExtent.width;
+	imageInfo.extent.height = m_SwapchainExtent.height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = m_SwapchainImageFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // Same as swapchain + readback
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (vmaCreateImage(m_VmaAllocator, &imageInfo, &allocInfo, &m_SwapchainImages[i], &m_OffscreenAllocations[i], nullptr) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to create offscreen image %u", i);
+			return false;
+		}
+		m_MemoryStats.Track(m_OffscreenAllocations[i], GpuMemoryCategory::RenderTarget, "Offscreen Target");
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = m_SwapchainImages[i];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = m_SwapchainImageFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(m_VkbDevice.device, &viewInfo, nullptr, &m_SwapchainImageViews[i]) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to create offscreen image view %u", i);
+			return false;
+		}
+	}
+
+	WOVEN_LOG_INFO("Offscreen targets created: %ux%u, %u images", m_SwapchainExtent.width, m_SwapchainExtent.height, MAX_FRAMES_IN_FLIGHT);
+	return true;
+}
+
+void GraphicsSystem::CleanupOffscreenTargets()
+{
+	ZoneScopedN("CleanupOffscreenTargets");
+
+	if (m_VkbDevice.device == VK_NULL_HANDLE)
+		return;
+
+	for (auto imageView: m_SwapchainImageViews)
+	{
+		if (imageView != VK_NULL_HANDLE)
+		{
+			vkDestroyImageView(m_VkbDevice.device, imageView, nullptr);
+		}
+	}
+
+	for (size_t i = 0; i < m_SwapchainImages.size(); i++)
+	{
+		if (m_SwapchainImages[i] != VK_NULL_HANDLE)
+		{
+			m_MemoryStats.Untrack(m_OffscreenAllocations[i]);
+			vmaDestroyImage(m_VmaAllocator, m_SwapchainImages[i], m_OffscreenAllocations[i]);
+		}
+	}
+
+	m_SwapchainImageViews.clear();
+	m_SwapchainImages.clear();
+	m_SwapchainImageLayouts.clear();
+	m_OffscreenAllocations.clear();
+}
+
 bool GraphicsSystem::CreateCommandPools()
 {
 	ZoneScopedN("CreateCommandPools");
 
-	// Get graphics queue family index
-	uint32_t graphicsQueueFamily = m_VkbDevice.get_queue_index(vkb::QueueType::graphics).value();
-
-	// Create command pool and buffer for each frame in flight
+	// Create command pool and buffers for each frame in flight
 	VkCommandPoolCreateInfo poolInfo{};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Allow individual command buffer reset
-	poolInfo.queueFamilyIndex = graphicsQueueFamily;
+	poolInfo.queueFamilyIndex = m_GraphicsQueueFamily;
 
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = 1;
+	allocInfo.commandBufferCount = 3;
 
 	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 	{
 		// Create dedicated command pool per frame for lock-free recording
 		if (vkCreateCommandPool(m_VkbDevice.device, &poolInfo, nullptr, &m_Frames[i].commandPool) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to create command pool for frame %u", i);
+			WOVEN_LOG_ERROR("Failed to create command pool for frame %u", i);
 			return false;
 		}
 
-		// Allocate primary command buffer from this frame's pool
+		// Allocate primary command buffers from this frame's pool; the last two are only used with async compute
 		allocInfo.commandPool = m_Frames[i].commandPool;
-		if (vkAllocateCommandBuffers(m_VkbDevice.device, &allocInfo, &m_Frames[i].commandBuffer) != VK_SUCCESS)
+		VkCommandBuffer commandBuffers[3] = {};
+		if (vkAllocateCommandBuffers(m_VkbDevice.device, &allocInfo, commandBuffers) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to allocate command buffer for frame %u", i);
+			WOVEN_LOG_ERROR("Failed to allocate command buffer for frame %u", i);
 			return false;
 		}
+		m_Frames[i].commandBuffer = commandBuffers[0];
+		m_Frames[i].overlapCommandBuffer = commandBuffers[1];
+		m_Frames[i].finalCommandBuffer = commandBuffers[2];
 	}
 
-	Logger::Info("Command pools created: %u frame command buffers (bindless + push constants)", MAX_FRAMES_IN_FLIGHT);
+	WOVEN_LOG_INFO("Command pools created: %u frame command buffers (bindless + push constants)", MAX_FRAMES_IN_FLIGHT);
 	return true;
 }
 
@@ -1797,7 +2614,7 @@ bool GraphicsSystem::CreateSyncPrimitives()
 
 	if (vkCreateSemaphore(m_VkbDevice.device, &semaphoreInfo, nullptr, &m_TimelineSemaphore) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create timeline semaphore");
+		WOVEN_LOG_ERROR("Failed to create timeline semaphore");
 		return false;
 	}
 
@@ -1817,21 +2634,21 @@ bool GraphicsSystem::CreateSyncPrimitives()
 		// Create binary semaphore for swapchain image acquisition
 		if (vkCreateSemaphore(m_VkbDevice.device, &binarySemaphoreInfo, nullptr, &m_Frames[i].swapchainAcquireSemaphore) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to create swapchain acquire semaphore for frame %u", i);
+			WOVEN_LOG_ERROR("Failed to create swapchain acquire semaphore for frame %u", i);
 			return false;
 		}
 
 		// Create binary semaphore for render completion
 		if (vkCreateSemaphore(m_VkbDevice.device, &binarySemaphoreInfo, nullptr, &m_Frames[i].renderCompleteSemaphore) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to create render complete semaphore for frame %u", i);
+			WOVEN_LOG_ERROR("Failed to create render complete semaphore for frame %u", i);
 			return false;
 		}
 
 		// Create fence (optional fallback, timeline semaphores are preferred)
 		if (vkCreateFence(m_VkbDevice.device, &fenceInfo, nullptr, &m_Frames[i].renderFence) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to create render fence for frame %u", i);
+			WOVEN_LOG_ERROR("Failed to create render fence for frame %u", i);
 			return false;
 		}
 
@@ -1839,40 +2656,143 @@ bool GraphicsSystem::CreateSyncPrimitives()
 		m_Frames[i].timelineValue = 0;
 	}
 
-	Logger::Info("Synchronization primitives created (timeline + %u frame semaphores)", MAX_FRAMES_IN_FLIGHT);
+	WOVEN_LOG_INFO("Synchronization primitives created (timeline + %u frame semaphores)", MAX_FRAMES_IN_FLIGHT);
+	return true;
+}
+
+bool GraphicsSystem::CreateTimestampQueries()
+{
+	ZoneScopedN("CreateTimestampQueries");
+
+	const VkPhysicalDeviceLimits& limits = m_VkbPhysicalDevice.properties.limits;
+	const uint32_t graphicsQueueFamily = m_VkbDevice.get_queue_index(vkb::QueueType::graphics).value();
+	const uint32_t validBits = m_VkbPhysicalDevice.get_queue_families()[graphicsQueueFamily].timestampValidBits;
+
+	if (validBits == 0 || limits.timestampPeriod <= 0.0f)
+	{
+		// Not fatal: timing reports will just carry CPU numbers
+		WOVEN_LOG_WARNING("GPU timestamps not supported on graphics queue");
+		m_SupportsTimestamps = false;
+		return true;
+	}
+
+	m_TimestampPeriodNs = static_cast<double>(limits.timestampPeriod);
+	m_TimestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1ull);
+
+	VkQueryPoolCreateInfo queryInfo{};
+	queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryInfo.queryCount = 2 + MAX_GPU_PASSES * 2; // Frame begin/end + per-pass begin/end
+
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (vkCreateQueryPool(m_VkbDevice.device, &queryInfo, nullptr, &m_Frames[i].timestampQueryPool) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to create timestamp query pool for frame %u", i);
+			return false;
+		}
+	}
+
+	m_SupportsTimestamps = true;
+	WOVEN_LOG_INFO("GPU timestamps enabled (period %.3f ns, %u valid bits)", m_TimestampPeriodNs, validBits);
 	return true;
 }
 
+void GraphicsSystem::ResolveFrameTimestamps(FrameData& frame)
+{
+	if (!frame.timestampsWritten || frame.timestampQueryPool == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	// Only called once the frame's fence has signaled, so no WAIT flag is needed
+	uint64_t timestamps[2 + MAX_GPU_PASSES * 2] = {};
+	const uint32_t queryCount = 2 + frame.passCount * 2;
+	const VkResult result = vkGetQueryPoolResults(m_VkbDevice.device, frame.timestampQueryPool, 0, queryCount, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	frame.timestampsWritten = false;
+	if (result != VK_SUCCESS)
+	{
+		return;
+	}
+
+	const auto ticksToMs = [this](uint64_t begin, uint64_t end)
+	{
+		return static_cast<double>((end - begin) & m_TimestampMask) * m_TimestampPeriodNs / 1.0e6;
+	};
+
+	m_LastGpuFrameTimeMs = ticksToMs(timestamps[0], timestamps[1]);
+
+	if (m_CaptureGpuTimings)
+	{
+		GpuFrameTiming timing{ frame.frameNumber, m_LastGpuFrameTimeMs, {} };
+		timing.passes.reserve(frame.passCount);
+		for (uint32_t i = 0; i < frame.passCount; ++i)
+		{
+			timing.passes.push_back({ frame.passNames[i], ticksToMs(timestamps[2 + i * 2], timestamps[3 + i * 2]) });
+		}
+		m_GpuTimings.push_back(std::move(timing));
+	}
+}
+
+void GraphicsSystem::BeginGpuPass(VkCommandBuffer cmd, const char* name)
+{
+	FrameData& frame = GetCurrentFrame();
+	if (!m_SupportsTimestamps || frame.passOpen || frame.passCount >= MAX_GPU_PASSES)
+	{
+		return;
+	}
+	// Passes on a compute family without timestamp support go untimed
+	if (cmd == frame.computeCommandBuffer && !m_AsyncCompute.SupportsTimestamps())
+	{
+		return;
+	}
+
+	frame.passNames[frame.passCount] = name;
+	frame.passOpen = true;
+	vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.timestampQueryPool, 2 + frame.passCount * 2);
+}
+
+void GraphicsSystem::EndGpuPass(VkCommandBuffer cmd)
+{
+	FrameData& frame = GetCurrentFrame();
+	if (!frame.passOpen)
+	{
+		return;
+	}
+
+	vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, frame.timestampQueryPool, 3 + frame.passCount * 2);
+	frame.passOpen = false;
+	++frame.passCount;
+}
+
 bool GraphicsSystem::CreateBindlessDescriptors()
 {
 	ZoneScopedN("CreateBindlessDescriptors");
 
-	// Define descriptor pool sizes for bindless rendering
-	constexpr uint32_t MAX_BINDLESS_TEXTURES = 16384; // 16K textures
-	constexpr uint32_t MAX_BINDLESS_SAMPLERS = 128;   // Samplers
-	constexpr uint32_t MAX_STORAGE_BUFFERS = 1024;    // Storage buffers for GPU-driven
-	constexpr uint32_t MAX_UNIFORM_BUFFERS = 256;     // Uniform buffers
-
+	// Define descriptor pool sizes for bindless rendering (capacities shared with BindlessRegistry)
 	VkDescriptorPoolSize poolSizes[] = {
-		{  VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MAX_BINDLESS_TEXTURES },
-        {        VK_DESCRIPTOR_TYPE_SAMPLER, MAX_BINDLESS_SAMPLERS },
-        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,   MAX_STORAGE_BUFFERS },
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,   MAX_UNIFORM_BUFFERS },
-        {  VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,                   512 }  // For compute/HDR render targets
+		{  VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,  MAX_BINDLESS_SAMPLED_IMAGES },
+        {        VK_DESCRIPTOR_TYPE_SAMPLER,        MAX_BINDLESS_SAMPLERS },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_BINDLESS_STORAGE_BUFFERS },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_BINDLESS_UNIFORM_BUFFERS },
+        {  VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,  MAX_BINDLESS_STORAGE_IMAGES }  // For compute/HDR render targets
 	};
 
-	// Create descriptor pool with UPDATE_AFTER_BIND flag
-	VkDescriptorPoolCreateInfo poolInfo{};
-	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-	poolInfo.maxSets = 1; // Single global bindless set
-	poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
-	poolInfo.pPoolSizes = poolSizes;
-
-	if (vkCreateDescriptorPool(m_VkbDevice.device, &poolInfo, nullptr, &m_BindlessDescriptorPool) != VK_SUCCESS)
+	// Create descriptor pool with UPDATE_AFTER_BIND flag (descriptor buffers need no pool)
+	if (!m_UseDescriptorBuffer)
 	{
-		Logger::Error("Failed to create bindless descriptor pool");
-		return false;
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1; // Single global bindless set
+		poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+		poolInfo.pPoolSizes = poolSizes;
+
+		if (vkCreateDescriptorPool(m_VkbDevice.device, &poolInfo, nullptr, &m_BindlessDescriptorPool) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to create bindless descriptor pool");
+			return false;
+		}
 	}
 
 	// Create bindless descriptor set layout with UPDATE_AFTER_BIND flags
@@ -1881,7 +2801,7 @@ bool GraphicsSystem::CreateBindlessDescriptors()
 	// Binding 0: Large array of sampled images (textures)
 	bindings[0].binding = 0;
 	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-	bindings[0].descriptorCount = MAX_BINDLESS_TEXTURES;
+	bindings[0].descriptorCount = MAX_BINDLESS_SAMPLED_IMAGES;
 	bindings[0].stageFlags = VK_SHADER_STAGE_ALL; // Available to all shader stages
 	bindings[0].pImmutableSamplers = nullptr;
 
@@ -1895,32 +2815,30 @@ bool GraphicsSystem::CreateBindlessDescriptors()
 	// Binding 2: Storage buffers (for GPU-driven rendering, indirect draw data, etc.)
 	bindings[2].binding = 2;
 	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	bindings[2].descriptorCount = MAX_STORAGE_BUFFERS;
+	bindings[2].descriptorCount = MAX_BINDLESS_STORAGE_BUFFERS;
 	bindings[2].stageFlags = VK_SHADER_STAGE_ALL;
 	bindings[2].pImmutableSamplers = nullptr;
 
 	// Binding 3: Uniform buffers
 	bindings[3].binding = 3;
 	bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	bindings[3].descriptorCount = MAX_UNIFORM_BUFFERS;
+	bindings[3].descriptorCount = MAX_BINDLESS_UNIFORM_BUFFERS;
 	bindings[3].stageFlags = VK_SHADER_STAGE_ALL;
 	bindings[3].pImmutableSamplers = nullptr;
 
 	// Binding 4: Storage images (for compute shaders in forward+ light culling)
 	bindings[4].binding = 4;
 	bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-	bindings[4].descriptorCount = 512;
+	bindings[4].descriptorCount = MAX_BINDLESS_STORAGE_IMAGES;
 	bindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	bindings[4].pImmutableSamplers = nullptr;
 
-	// Set binding flags for UPDATE_AFTER_BIND and PARTIALLY_BOUND
-	VkDescriptorBindingFlags bindingFlags[5] = {
-		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT,
-		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
-		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
-		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
-		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
-	};
+	// Set binding flags for UPDATE_AFTER_BIND and PARTIALLY_BOUND.
+	// UNUSED_WHILE_PENDING lets the registry fill fresh slots while earlier frames are still executing.
+	// (Variable descriptor count is only valid on the highest binding, so every array has a fixed size.)
+	// Descriptor buffers are plain memory, so update-after-bind does not apply (and is not allowed) there.
+	const VkDescriptorBindingFlags bindlessFlags = m_UseDescriptorBuffer ? VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT : VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorBindingFlags bindingFlags[5] = { bindlessFlags, bindlessFlags, bindlessFlags, bindlessFlags, bindlessFlags };
 
 	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
 	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
@@ -1930,41 +2848,75 @@ bool GraphicsSystem::CreateBindlessDescriptors()
 	VkDescriptorSetLayoutCreateInfo layoutInfo{};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	layoutInfo.pNext = &bindingFlagsInfo;
-	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.flags = m_UseDescriptorBuffer ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
 	layoutInfo.bindingCount = static_cast<uint32_t>(std::size(bindings));
 	layoutInfo.pBindings = bindings;
 
 	if (vkCreateDescriptorSetLayout(m_VkbDevice.device, &layoutInfo, nullptr, &m_BindlessDescriptorSetLayout) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create bindless descriptor set layout");
+		WOVEN_LOG_ERROR("Failed to create bindless descriptor set layout");
 		return false;
 	}
 
-	// Allocate descriptor set with variable descriptor count
-	uint32_t variableDescriptorCount = MAX_BINDLESS_TEXTURES;
-	VkDescriptorSetVariableDescriptorCountAllocateInfo variableDescriptorCountInfo{};
-	variableDescriptorCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
-	variableDescriptorCountInfo.descriptorSetCount = 1;
-	variableDescriptorCountInfo.pDescriptorCounts = &variableDescriptorCount;
+	if (m_UseDescriptorBuffer)
+	{
+		if (!m_BindlessDescriptorBuffer.Initialize(m_VkbDevice.device, m_VkbPhysicalDevice.physical_device, m_VmaAllocator, m_BindlessDescriptorSetLayout, GetQueueFamilies()))
+			return false;
+
+		m_BindlessRegistry.Initialize(m_VkbDevice.device, VK_NULL_HANDLE, &m_BindlessDescriptorBuffer, MAX_FRAMES_IN_FLIGHT);
+	}
+	else
+	{
+		// Allocate the single global descriptor set
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_BindlessDescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &m_BindlessDescriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(m_VkbDevice.device, &allocInfo, &m_BindlessDescriptorSet) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to allocate bindless descriptor set");
+			return false;
+		}
 
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.pNext = &variableDescriptorCountInfo;
-	allocInfo.descriptorPool = m_BindlessDescriptorPool;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.pSetLayouts = &m_BindlessDescriptorSetLayout;
+		m_BindlessRegistry.Initialize(m_VkbDevice.device, m_BindlessDescriptorSet, nullptr, MAX_FRAMES_IN_FLIGHT);
+	}
 
-	if (vkAllocateDescriptorSets(m_VkbDevice.device, &allocInfo, &m_BindlessDescriptorSet) != VK_SUCCESS)
+	// Default sampler so materials without an explicit one still have something to index
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+	if (vkCreateSampler(m_VkbDevice.device, &samplerInfo, nullptr, &m_DefaultSampler) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to allocate bindless descriptor set");
+		WOVEN_LOG_ERROR("Failed to create default sampler");
 		return false;
 	}
+	m_DefaultSamplerIndex = m_BindlessRegistry.RegisterSampler(m_DefaultSampler);
 
-	Logger::Info("Bindless descriptors created: %u textures, %u samplers, %u storage buffers, %u uniform buffers", MAX_BINDLESS_TEXTURES, MAX_BINDLESS_SAMPLERS, MAX_STORAGE_BUFFERS, MAX_UNIFORM_BUFFERS);
+	WOVEN_LOG_INFO("Bindless descriptors created (%s): %u textures, %u samplers, %u storage buffers, %u uniform buffers", m_UseDescriptorBuffer ? "descriptor buffer" : "descriptor set", MAX_BINDLESS_SAMPLED_IMAGES, MAX_BINDLESS_SAMPLERS, MAX_BINDLESS_STORAGE_BUFFERS, MAX_BINDLESS_UNIFORM_BUFFERS);
 
 	return true;
 }
 
+void GraphicsSystem::BindBindless(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint) const
+{
+	if (m_UseDescriptorBuffer)
+	{
+		m_BindlessDescriptorBuffer.Bind(cmd, bindPoint, m_GlobalPipelineLayout);
+		return;
+	}
+
+	vkCmdBindDescriptorSets(cmd, bindPoint, m_GlobalPipelineLayout, 0, 1, &m_BindlessDescriptorSet, 0, nullptr);
+}
+
 bool GraphicsSystem::CreatePipelineInfrastructure()
 {
 	ZoneScopedN("CreatePipelineInfrastructure");
@@ -1984,7 +2936,7 @@ bool GraphicsSystem::CreatePipelineInfrastructure()
 
 	if (vkCreatePipelineLayout(m_VkbDevice.device, &layoutInfo, nullptr, &m_GlobalPipelineLayout) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create global pipeline layout");
+		WOVEN_LOG_ERROR("Failed to create global pipeline layout");
 		return false;
 	}
 
@@ -1996,11 +2948,11 @@ bool GraphicsSystem::CreatePipelineInfrastructure()
 
 	if (vkCreatePipelineCache(m_VkbDevice.device, &cacheInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create pipeline cache");
+		WOVEN_LOG_ERROR("Failed to create pipeline cache");
 		return false;
 	}
 
-	Logger::Info("Pipeline infrastructure created (bindless layout + push constants)");
+	WOVEN_LOG_INFO("Pipeline infrastructure created (bindless layout + push constants)");
 	return true;
 }
 
@@ -2010,8 +2962,8 @@ bool GraphicsSystem::BeginFrame(uint32_t& outImageIndex)
 {
 	ZoneScopedN("BeginFrame");
 
-	// Handle swapchain recreation if needed
-	if (m_SwapchainOutOfDate || m_FramebufferResized)
+	// Handle swapchain recreation if needed; frames in flight keep the old one until they retire
+	if (!m_Headless && (m_SwapchainOutOfDate || m_FramebufferResized))
 	{
 		if (!RecreateSwapchain(m_Window))
 		{
@@ -2028,35 +2980,52 @@ bool GraphicsSystem::BeginFrame(uint32_t& outImageIndex)
 	{
 		if (vkWaitForFences(m_VkbDevice.device, 1, &frame.renderFence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
 		{
-			Logger::Error("Failed to wait for render fence");
-			return false;
-		}
-		// Reset fence for next use
-		if (vkResetFences(m_VkbDevice.device, 1, &frame.renderFence) != VK_SUCCESS)
-		{
-			Logger::Error("Failed to reset render fence");
+			WOVEN_LOG_ERROR("Failed to wait for render fence");
 			return false;
 		}
 	}
 
-	// Acquire next swapchain image
-	VkResult result = vkAcquireNextImageKHR(m_VkbDevice.device, m_Swapchain, UINT64_MAX, frame.swapchainAcquireSemaphore, VK_NULL_HANDLE, &outImageIndex);
-
-	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	if (m_Headless)
 	{
-		m_SwapchainOutOfDate = true;
-		return false;
+		// Offscreen images are owned per frame slot, nothing to acquire
+		outImageIndex = m_CurrentFrameIndex;
 	}
-	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	else
+	{
+		// Acquire next swapchain image. Until it succeeds the fence stays signaled, so a frame given up here
+		// (out of date: recreated next frame) does not leave the slot waiting on a submission that never happened.
+		VkResult result = vkAcquireNextImageKHR(m_VkbDevice.device, m_Swapchain, UINT64_MAX, frame.swapchainAcquireSemaphore, VK_NULL_HANDLE, &outImageIndex);
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			m_SwapchainOutOfDate = true;
+			return false;
+		}
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			WOVEN_LOG_ERROR("Failed to acquire swapchain image");
+			return false;
+		}
+	}
+
+	// Reset fence for next use
+	if (frame.renderFence != VK_NULL_HANDLE && vkResetFences(m_VkbDevice.device, 1, &frame.renderFence) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to acquire swapchain image");
+		WOVEN_LOG_ERROR("Failed to reset render fence");
 		return false;
 	}
 
+	// The previous use of this frame slot has retired, so its timestamps are ready. The same holds for every
+	// per-slot readback buffer the subsystems index with m_CurrentFrameIndex: they read it without further sync.
+	ResolveFrameTimestamps(frame);
+	m_MemoryPools.BeginFrame(m_CurrentFrameIndex, m_FrameNumber);
+	m_BindlessRegistry.BeginFrame(m_FrameNumber);
+	m_MemoryStats.Update(m_FrameNumber);
+
 	// Reset and begin command buffer
 	if (frame.commandBuffer == VK_NULL_HANDLE)
 	{
-		Logger::Error("Invalid command buffer for frame %u", m_CurrentFrameIndex);
+		WOVEN_LOG_ERROR("Invalid command buffer for frame %u", m_CurrentFrameIndex);
 		return false;
 	}
 
@@ -2068,10 +3037,40 @@ bool GraphicsSystem::BeginFrame(uint32_t& outImageIndex)
 
 	if (vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to begin command buffer");
+		WOVEN_LOG_ERROR("Failed to begin command buffer");
 		return false;
 	}
 
+	// Async compute frames also record the compute queue's work and split the graphics work around it
+	frame.computeCommandBuffer = VK_NULL_HANDLE;
+	if (m_AsyncCompute.IsAvailable() && m_DebugState.enableAsyncCompute)
+	{
+		vkResetCommandBuffer(frame.overlapCommandBuffer, 0);
+		vkResetCommandBuffer(frame.finalCommandBuffer, 0);
+		if (vkBeginCommandBuffer(frame.overlapCommandBuffer, &beginInfo) != VK_SUCCESS || vkBeginCommandBuffer(frame.finalCommandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to begin command buffer");
+			return false;
+		}
+		frame.computeCommandBuffer = m_AsyncCompute.Begin(m_CurrentFrameIndex);
+		if (frame.computeCommandBuffer == VK_NULL_HANDLE)
+		{
+			return false;
+		}
+	}
+
+	frame.frameNumber = m_FrameNumber;
+	frame.passCount = 0;
+	frame.passOpen = false;
+	if (m_SupportsTimestamps)
+	{
+		vkCmdResetQueryPool(frame.commandBuffer, frame.timestampQueryPool, 0, 2 + MAX_GPU_PASSES * 2);
+		vkCmdWriteTimestamp2(frame.commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.timestampQueryPool, 0);
+	}
+
+	// Defragmentation copies go first so every pass of this frame sees the new locations
+	m_MemoryPools.RecordDefragmentation(frame.commandBuffer);
+
 	return true;
 }
 
@@ -2080,38 +3079,34 @@ bool GraphicsSystem::EndFrame(uint32_t imageIndex)
 	ZoneScopedN("EndFrame");
 
 	FrameData& frame = m_Frames[m_CurrentFrameIndex];
+	const bool asyncCompute = frame.computeCommandBuffer != VK_NULL_HANDLE;
+	VkCommandBuffer lastCmd = asyncCompute ? frame.finalCommandBuffer : frame.commandBuffer;
 
-	// End command buffer recording
-	if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS)
+	if (m_SupportsTimestamps)
 	{
-		Logger::Error("Failed to end command buffer");
-		return false;
+		EndGpuPass(lastCmd);
+		vkCmdWriteTimestamp2(lastCmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, frame.timestampQueryPool, 1);
 	}
 
-	// Classical Vulkan synchronization: semaphore for presentation, fence for CPU-GPU sync
-	// Standard VkSubmitInfo (compatible with all drivers)
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	// Update-after-bind: descriptors registered while recording only need to be written before submit
+	m_BindlessRegistry.Flush();
 
-	// Wait for swapchain image to be acquired
-	VkPipelineStageFlags waitStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = &frame.swapchainAcquireSemaphore;
-	submitInfo.pWaitDstStageMask = &waitStages;
+	if (asyncCompute ? !SubmitAsyncComputeFrame(frame) : !SubmitFrame(frame))
+	{
+		return false;
+	}
 
-	// Submit command buffer
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &frame.commandBuffer;
+	// Everything replaced while building this frame goes once it has executed
+	m_DeferredDestruction.Submit(frame.timelineValue);
 
-	// Signal when rendering is complete (for presentation)
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = &frame.renderCompleteSemaphore;
+	frame.timestampsWritten = m_SupportsTimestamps;
+	m_LastRenderedImageIndex = imageIndex;
+	++m_FrameNumber;
 
-	// Submit with fence for CPU-GPU synchronization
-	if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, frame.renderFence) != VK_SUCCESS)
+	if (m_Headless)
 	{
-		Logger::Error("Failed to submit command buffer");
-		return false;
+		m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+		return true;
 	}
 
 	// Present to screen (wait for rendering to complete)
@@ -2123,15 +3118,35 @@ bool GraphicsSystem::EndFrame(uint32_t imageIndex)
 	presentInfo.pSwapchains = &m_Swapchain;
 	presentInfo.pImageIndices = &imageIndex;
 
+	// Tag the present so ResolvePresents can wait for it to reach the screen
+	VkPresentIdKHR presentId{};
+	presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	presentId.swapchainCount = 1;
+	presentId.pPresentIds = &m_PresentId;
+	if (m_SupportsPresentWait)
+	{
+		++m_PresentId;
+		presentInfo.pNext = &presentId;
+	}
+
 	VkResult result = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
 
+	if (m_SupportsPresentWait && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR))
+	{
+		if (m_PendingPresents.size() >= kMaxPendingPresents)
+		{
+			m_PendingPresents.pop_front();
+		}
+		m_PendingPresents.push_back({ m_PresentId, frame.frameNumber, m_FrameStartTime, std::chrono::steady_clock::now() });
+	}
+
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_FramebufferResized)
 	{
 		m_SwapchainOutOfDate = true;
 	}
 	else if (result != VK_SUCCESS)
 	{
-		Logger::Error("Failed to present swapchain image: %d", result);
+		WOVEN_LOG_ERROR("Failed to present swapchain image: %d", result);
 		return false;
 	}
 
@@ -2141,25 +3156,287 @@ bool GraphicsSystem::EndFrame(uint32_t imageIndex)
 	return true;
 }
 
+bool GraphicsSystem::SubmitFrame(FrameData& frame)
+{
+	// End command buffer recording
+	if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to end command buffer");
+		return false;
+	}
+
+	// Classical Vulkan synchronization: semaphore for presentation, fence for CPU-GPU sync
+	// Standard VkSubmitInfo (compatible with all drivers)
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+	// Wait for swapchain image to be acquired (headless has no acquire/present semaphores)
+	VkPipelineStageFlags waitStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+	if (!m_Headless)
+	{
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &frame.swapchainAcquireSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStages;
+	}
+
+	// Submit command buffer
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &frame.commandBuffer;
+
+	// Signal the graphics timeline (deferred destruction) and, for presentation, that rendering is complete.
+	// The binary semaphore ignores its value.
+	const uint64_t frameDone = m_TimelineValue + 1;
+	const VkSemaphore signalSemaphores[] = { m_TimelineSemaphore, frame.renderCompleteSemaphore };
+	const uint64_t signalValues[] = { frameDone, 0 };
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = m_Headless ? 1 : 2;
+	timelineInfo.pSignalSemaphoreValues = signalValues;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
+	submitInfo.pSignalSemaphores = signalSemaphores;
+
+	// Submit with fence for CPU-GPU synchronization
+	if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, frame.renderFence) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to submit command buffer");
+		return false;
+	}
+	m_TimelineValue = frameDone;
+	frame.timelineValue = frameDone;
+	return true;
+}
+
+bool GraphicsSystem::SubmitAsyncComputeFrame(FrameData& frame)
+{
+	ZoneScopedN("SubmitAsyncComputeFrame");
+
+	const VkCommandBuffer graphicsCmds[] = { frame.commandBuffer, frame.overlapCommandBuffer, frame.finalCommandBuffer };
+	for (VkCommandBuffer cmd: graphicsCmds)
+	{
+		if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+		{
+			WOVEN_LOG_ERROR("Failed to end command buffer");
+			return false;
+		}
+	}
+
+	// 1. Uploads, streaming and culling; the graphics timeline tells the compute queue its inputs are ready
+	const uint64_t uploadsDone = ++m_TimelineValue;
+	VkSemaphoreSubmitInfo uploadsSignal{};
+	uploadsSignal.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	uploadsSignal.semaphore = m_TimelineSemaphore;
+	uploadsSignal.value = uploadsDone;
+	uploadsSignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkCommandBufferSubmitInfo cmdInfos[3] = {};
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		cmdInfos[i].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+		cmdInfos[i].commandBuffer = graphicsCmds[i];
+	}
+
+	VkSubmitInfo2 uploadsSubmit{};
+	uploadsSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	uploadsSubmit.commandBufferInfoCount = 1;
+	uploadsSubmit.pCommandBufferInfos = &cmdInfos[0];
+	uploadsSubmit.signalSemaphoreInfoCount = 1;
+	uploadsSubmit.pSignalSemaphoreInfos = &uploadsSignal;
+	if (vkQueueSubmit2(m_GraphicsQueue, 1, &uploadsSubmit, VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to submit command buffer");
+		return false;
+	}
+
+	// 2. Compute passes on the compute queue
+	const uint64_t computeDone = m_AsyncCompute.Submit(m_CurrentFrameIndex, m_TimelineSemaphore, uploadsDone);
+	if (computeDone == 0)
+	{
+		return false;
+	}
+
+	// 3. Work that does not read the compute results runs alongside them; 4. the rest waits for them and for
+	// the swapchain image (headless has no acquire/present semaphores)
+	VkSemaphoreSubmitInfo finalWaits[2] = {};
+	finalWaits[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	finalWaits[0].semaphore = m_AsyncCompute.GetTimeline();
+	finalWaits[0].value = computeDone;
+	finalWaits[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	finalWaits[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	finalWaits[1].semaphore = frame.swapchainAcquireSemaphore;
+	finalWaits[1].stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+
+	const uint64_t frameDone = m_TimelineValue + 1;
+	VkSemaphoreSubmitInfo finalSignals[2] = {};
+	finalSignals[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	finalSignals[0].semaphore = m_TimelineSemaphore;
+	finalSignals[0].value = frameDone;
+	finalSignals[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	finalSignals[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	finalSignals[1].semaphore = frame.renderCompleteSemaphore;
+	finalSignals[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkSubmitInfo2 submits[2] = {};
+	submits[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submits[0].commandBufferInfoCount = 1;
+	submits[0].pCommandBufferInfos = &cmdInfos[1];
+	submits[1].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submits[1].waitSemaphoreInfoCount = m_Headless ? 1 : 2;
+	submits[1].pWaitSemaphoreInfos = finalWaits;
+	submits[1].commandBufferInfoCount = 1;
+	submits[1].pCommandBufferInfos = &cmdInfos[2];
+	submits[1].signalSemaphoreInfoCount = m_Headless ? 1 : 2;
+	submits[1].pSignalSemaphoreInfos = finalSignals;
+
+	// The fence covers all four: the last submission waited on the compute one
+	if (vkQueueSubmit2(m_GraphicsQueue, 2, submits, frame.renderFence) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to submit command buffer");
+		return false;
+	}
+	m_TimelineValue = frameDone;
+	frame.timelineValue = frameDone;
+	return true;
+}
+
 void GraphicsSystem::HandleResize(SDL_Window* window)
 {
 	ZoneScopedN("HandleResize");
 
-	// Check if window is minimized
+	// A minimized window has no area to present to; RenderFrame skips frames until it has one again
 	int width = 0, height = 0;
-	SDL_GetWindowSize(window, &width, &height);
-
-	// Wait while window is minimized
-	while (width == 0 || height == 0)
+	SDL_GetWindowSizeInPixels(window, &width, &height);
+	m_WindowMinimized = width == 0 || height == 0 || (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) != 0;
+	if (m_WindowMinimized)
 	{
-		SDL_GetWindowSize(window, &width, &height);
-		SDL_WaitEvent(nullptr);
+		return;
 	}
 
 	m_FramebufferResized = true;
 	m_SwapchainOutOfDate = true;
 
-	Logger::Info("Window resized to %dx%d", width, height);
+	WOVEN_LOG_INFO("Window resized to %dx%d", width, height);
+}
+
+bool GraphicsSystem::SaveLastFrameImage(const std::filesystem::path& path)
+{
+	ZoneScopedN("SaveLastFrameImage");
+
+	if (!m_Headless)
+	{
+		WOVEN_LOG_ERROR("Frame image capture is only available in headless mode");
+		return false;
+	}
+
+	if (m_LastRenderedImageIndex >= m_SwapchainImages.size())
+	{
+		WOVEN_LOG_ERROR("No frame has been rendered yet");
+		return false;
+	}
+
+	WaitIdle();
+
+	const uint32_t width = m_SwapchainExtent.width;
+	const uint32_t height = m_SwapchainExtent.height;
+	const VkDeviceSize byteSize = static_cast<VkDeviceSize>(width) * height * 4;
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = byteSize;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VkBuffer readbackBuffer = VK_NULL_HANDLE;
+	VmaAllocation readbackAllocation = VK_NULL_HANDLE;
+	VmaAllocationInfo readbackInfo{};
+	if (vmaCreateBuffer(m_VmaAllocator, &bufferInfo, &allocInfo, &readbackBuffer, &readbackAllocation, &readbackInfo) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create readback buffer");
+		return false;
+	}
+	m_MemoryStats.Track(readbackAllocation, GpuMemoryCategory::Staging, "Frame Readback");
+
+	// Device is idle, so the current frame's command buffer is free for a one-shot copy
+	VkCommandBuffer cmd = GetCurrentFrame().commandBuffer;
+	vkResetCommandBuffer(cmd, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(cmd, &beginInfo);
+
+	VkBufferImageCopy2 region{};
+	region.sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { width, height, 1 };
+
+	VkCopyImageToBufferInfo2 copyInfo{};
+	copyInfo.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_BUFFER_INFO_2;
+	copyInfo.srcImage = m_SwapchainImages[m_LastRenderedImageIndex];
+	copyInfo.srcImageLayout = m_PresentLayout;
+	copyInfo.dstBuffer = readbackBuffer;
+	copyInfo.regionCount = 1;
+	copyInfo.pRegions = &region;
+	vkCmdCopyImageToBuffer2(cmd, &copyInfo);
+
+	VkMemoryBarrier2 hostBarrier{};
+	hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	hostBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+	hostBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	hostBarrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+	hostBarrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+	VkDependencyInfo depInfo{};
+	depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	depInfo.memoryBarrierCount = 1;
+	depInfo.pMemoryBarriers = &hostBarrier;
+	vkCmdPipelineBarrier2(cmd, &depInfo);
+
+	vkEndCommandBuffer(cmd);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &cmd;
+
+	bool saved = false;
+	if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS && vkQueueWaitIdle(m_GraphicsQueue) == VK_SUCCESS)
+	{
+		vmaInvalidateAllocation(m_VmaAllocator, readbackAllocation, 0, VK_WHOLE_SIZE);
+
+		std::error_code ec;
+		if (path.has_parent_path())
+		{
+			std::filesystem::create_directories(path.parent_path(), ec);
+		}
+
+		// R8G8B8A8 memory order matches SDL's RGBA32 alias on every platform
+		SDL_Surface* surface = SDL_CreateSurfaceFrom(static_cast<int>(width), static_cast<int>(height), SDL_PIXELFORMAT_RGBA32, readbackInfo.pMappedData, static_cast<int>(width * 4));
+		if (surface)
+		{
+			saved = SDL_SaveBMP(surface, path.string().c_str());
+			SDL_DestroySurface(surface);
+		}
+
+		if (saved)
+			WOVEN_LOG_INFO("Saved frame image to %s", path.string().c_str());
+		else
+			WOVEN_LOG_ERROR("Failed to save frame image %s: %s", path.string().c_str(), SDL_GetError());
+	}
+	else
+	{
+		WOVEN_LOG_ERROR("Failed to submit frame readback");
+	}
+
+	m_MemoryStats.Untrack(readbackAllocation);
+	vmaDestroyBuffer(m_VmaAllocator, readbackBuffer, readbackAllocation);
+	return saved;
 }
 
 // --- Rendering Implementation ---
@@ -2169,7 +3446,7 @@ bool GraphicsSystem::CreateShaders()
 	ZoneScopedN("CreateShaders");
 	if (!m_SupportsMeshShaders)
 	{
-		Logger::Error("Mesh shaders not supported on this device");
+		WOVEN_LOG_ERROR("Mesh shaders not supported on this device");
 		return false;
 	}
 
@@ -2187,6 +3464,11 @@ bool GraphicsSystem::CreateShaders()
 	psDesc.filePath = "shaders/triangle.slang";
 	psDesc.entryPoint = "psMain";
 	psDesc.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	// May run under a shading rate attachment (VariableRateShading)
+	if (m_SupportsFragmentShadingRate)
+	{
+		psDesc.flags = VK_SHADER_CREATE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_EXT;
+	}
 
 	if (!m_ShaderSystem->CreateShaderObject(taskDesc, m_TaskShader))
 	{
@@ -2211,18 +3493,229 @@ bool GraphicsSystem::CreateShaders()
 void GraphicsSystem::DestroyShaders()
 {
 	ZoneScopedN("DestroyShaders");
-	if (m_ShaderSystem)
-	{
-		m_ShaderSystem->DestroyShader(m_TaskShader);
-		m_ShaderSystem->DestroyShader(m_MeshShader);
-		m_ShaderSystem->DestroyShader(m_FragmentShader);
-	}
+	// Queued rather than destroyed: frames still in flight may have bound them. At shutdown the queue is
+	// flushed by CleanupVulkan.
+	m_DeferredDestruction.DestroyShader(m_TaskShader);
+	m_DeferredDestruction.DestroyShader(m_MeshShader);
+	m_DeferredDestruction.DestroyShader(m_FragmentShader);
 
 	m_TaskShader = VK_NULL_HANDLE;
 	m_MeshShader = VK_NULL_HANDLE;
 	m_FragmentShader = VK_NULL_HANDLE;
 }
 
+bool GraphicsSystem::CreateDemoInstances()
+{
+	ZoneScopedN("CreateDemoInstances");
+
+	const uint32_t count = std::max(m_DemoInstanceCount, 1u);
+	m_DemoInstanceCount = count;
+
+	if (!m_Geometry.Initialize(m_MemoryPools))
+		return false;
+
+	// Sized to fit the grid spacing (GetDemoInstancePosition)
+	const MeshSource sources[] = {
+		ProceduralMeshes::CreateTorus(0.9f, 0.35f, 96, 48),
+		ProceduralMeshes::CreateSphere(1.0f, 64, 32),
+	};
+	const char* names[] = { "Demo Torus", "Demo Sphere" };
+	uint32_t meshes[std::size(sources)] = {};
+	for (size_t i = 0; i < std::size(sources); ++i)
+	{
+		BakedMesh baked;
+		if (!MeshBaker::Bake(sources[i], QuantizationBudget{}, names[i], baked))
+			return false;
+		meshes[i] = m_Geometry.AddMesh(baked);
+		if (meshes[i] == INVALID_MESH)
+			return false;
+	}
+
+	if (!m_Scene.Initialize(m_VkbDevice.device, m_VmaAllocator, m_MemoryStats, m_DeferredDestruction, count))
+		return false;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const glm::mat4 transform = glm::translate(glm::mat4(1.0f), GetDemoInstancePosition(i, count));
+		const uint32_t mesh = meshes[i % std::size(meshes)];
+		if (m_Scene.AddInstance(transform, m_Geometry.GetBounds(mesh), i % MATERIAL_BUCKET_COUNT, mesh) == INVALID_SCENE_INSTANCE)
+			return false;
+	}
+
+	WOVEN_LOG_INFO("Created %u demo instances", count);
+	return true;
+}
+
+void GraphicsSystem::UpdateDemoInstances(float timeSeconds)
+{
+	ZoneScopedN("UpdateDemoInstances");
+
+	if (m_FrameReplay)
+		return;
+
+	// Spins the first N instances; everything else stays untouched and is never re-uploaded
+	const uint32_t animated = static_cast<uint32_t>(m_DebugState.animatedInstanceFraction * static_cast<float>(m_DemoInstanceCount));
+	for (uint32_t i = 0; i < animated; ++i)
+	{
+		const glm::mat4 translation = glm::translate(glm::mat4(1.0f), GetDemoInstancePosition(i, m_DemoInstanceCount));
+		m_Scene.SetTransform(i, glm::rotate(translation, timeSeconds, glm::vec3(0.0f, 1.0f, 0.0f)));
+	}
+}
+
+glm::vec3 GraphicsSystem::GetDemoInstancePosition(uint32_t index, uint32_t count)
+{
+	// Square grid of meshes receding from the camera; a single instance stays at the origin
+	if (count <= 1)
+		return glm::vec3(0.0f);
+
+	const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+	constexpr float spacing = 3.0f;
+	const float x = (static_cast<float>(index % columns) - static_cast<float>(columns - 1) * 0.5f) * spacing;
+	const float z = -static_cast<float>(index / columns) * spacing;
+	return glm::vec3(x, 0.0f, z);
+}
+
+void GraphicsSystem::UpdateDemoLights(float timeSeconds)
+{
+	ZoneScopedN("UpdateDemoLights");
+
+	if (m_FrameReplay)
+		return;
+
+	// Lights orbit over the instance grid; a hash per light keeps placement and color stable across frames
+	const uint32_t count = static_cast<uint32_t>(std::max(m_DebugState.demoLightCount, 0));
+	const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(std::max(m_DemoInstanceCount, 1u)))));
+	const float gridSize = static_cast<float>(columns) * 3.0f;
+	m_DemoLights.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t hash = i * 0x9E3779B9u;
+		auto next = [&hash]() {
+			hash ^= hash >> 16;
+			hash *= 0x7FEB352Du;
+			hash ^= hash >> 15;
+			return static_cast<float>(hash & 0xFFFF) / 65535.0f;
+		};
+
+		GpuLight& light = m_DemoLights[i];
+		const glm::vec3 center((next() - 0.5f) * gridSize, 0.5f + next() * 2.0f, -next() * gridSize);
+		const float radius = 0.5f + next() * 1.5f;
+		const float phase = timeSeconds * (0.3f + next() * 0.7f) + next() * 6.2831853f;
+		light.position = center + glm::vec3(std::cos(phase) * radius, 0.0f, std::sin(phase) * radius);
+		light.range = 2.0f + next() * 4.0f;
+		light.color = glm::vec3(0.3f + next() * 0.7f, 0.3f + next() * 0.7f, 0.3f + next() * 0.7f) * 4.0f;
+		light.type = i % 3;
+		light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+		light.spotCosOuter = std::cos(glm::radians(35.0f));
+		light.spotCosInner = std::cos(glm::radians(25.0f));
+		light.areaRight = glm::vec3(0.4f, 0.0f, 0.0f);
+		light.areaUp = glm::vec3(0.0f, 0.0f, 0.4f);
+	}
+}
+
+void GraphicsSystem::WriteFrameCapture(float timeSeconds)
+{
+	ZoneScopedN("WriteFrameCapture");
+
+	FrameCapture capture;
+	FrameCaptureHeader& header = capture.header;
+	header.width = m_SwapchainExtent.width;
+	header.height = m_SwapchainExtent.height;
+	header.frameNumber = m_FrameNumber;
+	header.time = timeSeconds;
+	header.flags = (m_DebugState.enableWireframe ? FrameCaptureWireframe : 0) | (m_DebugState.enableCullFaceBackFace ? FrameCaptureCullBackFace : 0) | (m_DebugState.enableVisibilityBuffer ? FrameCaptureVisibilityBuffer : 0) | (m_DebugState.enableSoftwareRaster ? FrameCaptureSoftwareRaster : 0) | (m_DebugState.enableShadows ? FrameCaptureShadows : 0) | (m_DebugState.cacheShadowCascades ? FrameCaptureCacheShadowCascades : 0) | (m_DebugState.enableVariableRateShading ? FrameCaptureVariableRateShading : 0) | (m_DebugState.enableAsyncCompute ? FrameCaptureAsyncCompute : 0);
+	header.cameraPosition = m_Camera.GetPosition();
+	header.cameraTarget = m_Camera.GetTarget();
+	header.cameraUp = m_Camera.GetUp();
+	header.fovDegrees = m_Camera.GetFov();
+	header.nearPlane = m_Camera.GetNearPlane();
+	header.farPlane = m_Camera.GetFarPlane();
+	header.clearColor = glm::vec4(m_DebugState.clearColorR, m_DebugState.clearColorG, m_DebugState.clearColorB, m_DebugState.clearColorA);
+	header.lodErrorPixels = m_DebugState.lodErrorPixels;
+	header.softwareRasterPixels = m_DebugState.softwareRasterPixels;
+	header.shadingRateThreshold = m_DebugState.shadingRateThreshold;
+	header.meshCount = m_Geometry.GetStats().meshCount;
+	header.slotCount = m_Scene.GetSlotCount();
+	header.lightCount = m_Lighting.IsInitialized() ? static_cast<uint32_t>(m_DemoLights.size()) : 0;
+
+	capture.transforms.reserve(header.slotCount);
+	capture.bounds.reserve(header.slotCount);
+	capture.materials.reserve(header.slotCount);
+	capture.meshes.reserve(header.slotCount);
+	for (uint32_t i = 0; i < header.slotCount; ++i)
+	{
+		capture.transforms.push_back(m_Scene.GetTransform(i));
+		capture.bounds.push_back(m_Scene.GetBounds(i));
+		capture.materials.push_back(m_Scene.GetMaterial(i));
+		capture.meshes.push_back(m_Scene.GetMesh(i));
+	}
+	if (header.lightCount > 0)
+	{
+		capture.lights = m_DemoLights;
+	}
+
+	capture.SaveToFile(m_FrameCapturePath);
+	m_FrameCapturePath.clear();
+}
+
+bool GraphicsSystem::ApplyFrameCapture(const FrameCapture& capture)
+{
+	ZoneScopedN("ApplyFrameCapture");
+
+	const FrameCaptureHeader& header = capture.header;
+	if (!m_Headless || header.width != m_SwapchainExtent.width || header.height != m_SwapchainExtent.height)
+	{
+		WOVEN_LOG_ERROR("Frame captures replay headless at their own extent (%ux%u)", header.width, header.height);
+		return false;
+	}
+	if (header.meshCount > m_Geometry.GetStats().meshCount || header.slotCount > m_Scene.GetSlotCount())
+	{
+		WOVEN_LOG_ERROR("Frame capture needs %u meshes and %u scene slots, this build has %u and %u", header.meshCount, header.slotCount, m_Geometry.GetStats().meshCount, m_Scene.GetSlotCount());
+		return false;
+	}
+
+	// Demo instances occupy slots 0..n-1 in order, so slot indices line up with the capture's
+	for (uint32_t i = 0; i < header.slotCount; ++i)
+	{
+		if (capture.bounds[i].w < 0.0f)
+		{
+			m_Scene.RemoveInstance(i);
+			continue;
+		}
+		m_Scene.SetTransform(i, capture.transforms[i]);
+		m_Scene.SetBounds(i, capture.bounds[i]);
+		m_Scene.SetMaterial(i, capture.materials[i]);
+		m_Scene.SetMesh(i, capture.meshes[i]);
+	}
+	m_DemoLights = capture.lights;
+
+	m_Camera.SetPosition(header.cameraPosition);
+	m_Camera.SetTarget(header.cameraTarget);
+	m_Camera.SetUp(header.cameraUp);
+	m_Camera.SetPerspective(header.fovDegrees, static_cast<float>(header.width) / static_cast<float>(header.height), header.nearPlane, header.farPlane);
+
+	m_DebugState.enableWireframe = (header.flags & FrameCaptureWireframe) != 0;
+	m_DebugState.enableCullFaceBackFace = (header.flags & FrameCaptureCullBackFace) != 0;
+	m_DebugState.enableVisibilityBuffer = (header.flags & FrameCaptureVisibilityBuffer) != 0;
+	m_DebugState.enableSoftwareRaster = (header.flags & FrameCaptureSoftwareRaster) != 0;
+	m_DebugState.enableShadows = (header.flags & FrameCaptureShadows) != 0;
+	m_DebugState.cacheShadowCascades = (header.flags & FrameCaptureCacheShadowCascades) != 0;
+	m_DebugState.enableVariableRateShading = (header.flags & FrameCaptureVariableRateShading) != 0;
+	m_DebugState.enableAsyncCompute = (header.flags & FrameCaptureAsyncCompute) != 0;
+	m_DebugState.clearColorR = header.clearColor.r;
+	m_DebugState.clearColorG = header.clearColor.g;
+	m_DebugState.clearColorB = header.clearColor.b;
+	m_DebugState.clearColorA = header.clearColor.a;
+	m_DebugState.lodErrorPixels = header.lodErrorPixels;
+	m_DebugState.softwareRasterPixels = header.softwareRasterPixels;
+	m_DebugState.shadingRateThreshold = header.shadingRateThreshold;
+	m_DebugState.demoLightCount = static_cast<int>(header.lightCount);
+
+	m_FrameReplay = true;
+	WOVEN_LOG_INFO("Replaying frame %llu of a capture (%u scene slots, %u lights)", static_cast<unsigned long long>(header.frameNumber), header.slotCount, header.lightCount);
+	return true;
+}
+
 void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float timeSeconds)
 {
 	ZoneScopedN("RecordFrame");
@@ -2237,6 +3730,176 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 		.depthStencil = { 1.0f, 0 }
 	};
 
+	// Keep the projection in sync with the render target (resize, headless resolution)
+	const float aspectRatio = static_cast<float>(extent.width) / static_cast<float>(std::max(extent.height, 1u));
+	if (m_Camera.GetAspectRatio() != aspectRatio)
+	{
+		m_Camera.SetPerspective(m_Camera.GetFov(), aspectRatio, m_Camera.GetNearPlane(), m_Camera.GetFarPlane());
+	}
+
+	// Async compute frames record into four command buffers (SubmitAsyncComputeFrame): cmd up to the culling,
+	// computeCmd for the compute queue, overlapCmd for the graphics work running alongside it, and the final
+	// one from the main pass on. Single-queue frames record everything into cmd.
+	const FrameData& frame = GetCurrentFrame();
+	const bool asyncCompute = frame.computeCommandBuffer != VK_NULL_HANDLE;
+	const VkCommandBuffer computeCmd = asyncCompute ? frame.computeCommandBuffer : cmd;
+	const VkCommandBuffer overlapCmd = asyncCompute ? frame.overlapCommandBuffer : cmd;
+	const QueueTransfer computeTransfer = asyncCompute ? m_AsyncCompute.GetTransfer() : QueueTransfer{};
+
+	PushConstants push{};
+	push.viewProjection = m_Camera.GetViewProjectionMatrix();
+	push.resolution = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+	push.time = timeSeconds;
+	push.frameIndex = static_cast<uint32_t>(m_FrameNumber);
+
+	// Only instances changed since last frame are copied
+	UpdateDemoInstances(timeSeconds);
+	BeginGpuPass(cmd, "Scene Upload");
+	m_Scene.RecordUpload(cmd, m_MemoryPools);
+	m_Geometry.RecordUpload(cmd);
+	EndGpuPass(cmd);
+
+	// The scene doubles its buffers when it fills up; the draw lists follow it (a no-op when it did not grow)
+	m_Culling.Reserve(m_Scene.GetCapacity());
+	m_Shadows.Reserve(m_Scene.GetCapacity());
+
+	// Finished transcodes and evictions land before anything samples; also fills push.streaming
+	BeginGpuPass(cmd, "Texture Streaming");
+	m_TextureStreamer.RecordStreaming(cmd, m_CurrentFrameIndex, m_FrameNumber, push);
+	EndGpuPass(cmd);
+
+	// Compute may not run inside dynamic rendering, so culling gets its own pass up front
+	BeginGpuPass(cmd, "Cull");
+	GpuCulling::View view;
+	view.cameraPosition = m_Camera.GetPosition();
+	view.lodScale = GpuCulling::GetLodScale(m_Camera.GetProjectionMatrix(), static_cast<float>(extent.height), m_DebugState.lodErrorPixels);
+	// The compute rasterizer only draws filled, back-face culled triangles, so the debug render modes keep everything on the mesh shaders
+	const bool softwareRaster = m_DebugState.enableSoftwareRaster && !m_DebugState.enableWireframe && m_DebugState.enableCullFaceBackFace;
+	const float softwareScale = softwareRaster ? GpuCulling::GetLodScale(m_Camera.GetProjectionMatrix(), static_cast<float>(extent.height), m_DebugState.softwareRasterPixels) : 0.0f;
+	const GpuCulling::Raster raster = m_SoftwareRaster.RecordClear(cmd, extent, softwareScale);
+	// Visibility buffer mode: the raster pass writes ids, a compute material pass shades them afterwards
+	const glm::vec4 backgroundColor(debugClearColor.float32[0], debugClearColor.float32[1], debugClearColor.float32[2], debugClearColor.float32[3]);
+	const GpuCulling::MaterialPass materialPass = m_DebugState.enableVisibilityBuffer ? m_VisibilityBuffer.RecordPrepare(cmd, extent, GetHDRRenderTargetView(), backgroundColor) : GpuCulling::MaterialPass{};
+	const bool visibilityBuffer = materialPass.dispatch != 0;
+	m_Culling.RecordCull(cmd, m_MemoryPools, m_CurrentFrameIndex, m_Scene.GetInstances(), m_Geometry.GetGeometry(), view, raster, materialPass, GetGlobalPipelineLayout(), push);
+	EndGpuPass(cmd);
+
+	// Bins the lights into the froxel grid every shading path reads; fills push.lighting
+	bool lighting = false;
+	if (m_Lighting.IsInitialized())
+	{
+		BeginGpuPass(computeCmd, "Light Culling");
+		UpdateDemoLights(timeSeconds);
+		ClusteredLighting::View lightView;
+		lightView.view = m_Camera.GetViewMatrix();
+		lightView.projection = m_Camera.GetProjectionMatrix();
+		lightView.nearPlane = m_Camera.GetNearPlane();
+		lightView.farPlane = m_Camera.GetFarPlane();
+		m_Lighting.RecordCull(computeCmd, m_MemoryPools, m_CurrentFrameIndex, m_DemoLights, lightView, GetGlobalPipelineLayout(), push, computeTransfer);
+		lighting = push.lighting != 0;
+		EndGpuPass(computeCmd);
+	}
+
+	// Scene, lights and view are final for this frame here; everything below derives from them
+	if (!m_FrameCapturePath.empty())
+	{
+		WriteFrameCapture(timeSeconds);
+	}
+
+	// Rates for the forward draws from last frame's image, read before this frame overwrites it. The visibility
+	// buffer mode shades in compute, where a shading rate attachment has no effect.
+	VkRenderingFragmentShadingRateAttachmentInfoKHR shadingRateAttachment{};
+	bool shadingRate = false;
+	if (m_ShadingRate.IsInitialized() && m_DebugState.enableVariableRateShading && !visibilityBuffer)
+	{
+		BeginGpuPass(computeCmd, "Shading Rate");
+		// Left by last frame's blit; anything else (first frame, resize) has no usable contents
+		const bool hasHistory = GetHDRImageLayout() == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && m_HDRHistoryValid;
+		if (hasHistory && asyncCompute)
+		{
+			// The compute queue takes the image over; the main pass clears it, so it is not handed back
+			const QueueTransfer toCompute = computeTransfer.Reversed();
+			AsyncCompute::RecordImageRelease(cmd, GetHDRRenderTarget(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, toCompute);
+			AsyncCompute::RecordImageAcquire(computeCmd, GetHDRRenderTarget(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, toCompute);
+			SetHDRImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+		}
+		else if (hasHistory)
+		{
+			TransitionImage(cmd, GetHDRRenderTarget(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+			SetHDRImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+		}
+		shadingRate = m_ShadingRate.RecordAnalysis(computeCmd, m_MemoryPools, m_CurrentFrameIndex, extent, GetHDRRenderTargetView(), hasHistory, m_DebugState.shadingRateThreshold, GetGlobalPipelineLayout(), push, computeTransfer);
+		if (shadingRate)
+		{
+			shadingRateAttachment = m_ShadingRate.GetAttachmentInfo();
+		}
+		EndGpuPass(computeCmd);
+	}
+
+	// Depth-only cascades of the key light through the same task/mesh shaders, each culled against its own
+	// frustum; cached far cascades are skipped unless they moved or a caster inside them changed. With async
+	// compute they run alongside the passes above: raster-bound depth work leaves the shader cores to them.
+	if (m_Shadows.IsInitialized() && m_DebugState.enableShadows)
+	{
+		BeginGpuPass(overlapCmd, "Shadows");
+		m_Shadows.Update(m_Camera, m_Scene.GetChangedBounds(), m_DebugState.cacheShadowCascades);
+		for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+		{
+			if (!m_Shadows.NeedsRender(cascade))
+				continue;
+
+			PushConstants shadowPush = push;
+			m_Shadows.RecordCull(overlapCmd, m_MemoryPools, m_CurrentFrameIndex, cascade, m_Scene.GetInstances(), m_Geometry.GetGeometry(), view, GetGlobalPipelineLayout(), shadowPush);
+
+			const VkRenderingAttachmentInfo shadowAttachment = m_Shadows.GetAttachment(cascade);
+			VkRenderingInfo shadowInfo{};
+			shadowInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+			shadowInfo.renderArea = {
+				{ 0, 0 },
+				m_Shadows.GetExtent()
+			};
+			shadowInfo.layerCount = 1;
+			shadowInfo.pDepthAttachment = &shadowAttachment;
+			vkCmdBeginRendering(overlapCmd, &shadowInfo);
+
+			// Both faces cast and are always filled; slope-scaled bias on top of the normal offset when sampling
+			SetDynamicState(overlapCmd, m_Shadows.GetExtent());
+			vkCmdSetCullMode(overlapCmd, VK_CULL_MODE_NONE);
+			vkCmdSetPolygonModeEXT(overlapCmd, VK_POLYGON_MODE_FILL);
+			vkCmdSetDepthBiasEnable(overlapCmd, VK_TRUE);
+			vkCmdSetDepthBias(overlapCmd, 1.25f, 0.0f, 1.75f);
+
+			const VkShaderStageFlagBits shadowStages[] = { VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT };
+			const VkShaderEXT shadowShaders[] = { m_TaskShader, m_MeshShader, VK_NULL_HANDLE };
+			vkCmdBindShadersEXT(overlapCmd, 3, shadowStages, shadowShaders);
+			BindBindless(overlapCmd, VK_PIPELINE_BIND_POINT_GRAPHICS);
+			m_Shadows.RecordDraws(overlapCmd, cascade, GetGlobalPipelineLayout(), shadowPush);
+			vkCmdEndRendering(overlapCmd);
+		}
+		m_Shadows.RecordFinish(overlapCmd, m_MemoryPools, push);
+		EndGpuPass(overlapCmd);
+	}
+	else if (m_Shadows.IsInitialized())
+	{
+		m_Shadows.Invalidate();
+	}
+
+	// The main pass and everything after it read the compute results: take over what the compute queue released
+	if (asyncCompute)
+	{
+		cmd = frame.finalCommandBuffer;
+		if (lighting)
+		{
+			m_Lighting.RecordAcquire(cmd, computeTransfer);
+		}
+		if (shadingRate)
+		{
+			m_ShadingRate.RecordAcquire(cmd, computeTransfer);
+		}
+	}
+
+	BeginGpuPass(cmd, "Main");
+
 	const VkImageLayout hdrOldLayout = GetHDRImageLayout();
 	VkPipelineStageFlags2 hdrSrcStage = VK_PIPELINE_STAGE_2_NONE;
 	VkAccessFlags2 hdrSrcAccess = 0;
@@ -2250,8 +3913,18 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 		hdrSrcStage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
 		hdrSrcAccess = VK_ACCESS_2_TRANSFER_READ_BIT;
 	}
-	TransitionImage(cmd, GetHDRRenderTarget(), hdrOldLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, hdrSrcStage, hdrSrcAccess, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-	SetHDRImageLayout(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	else if (hdrOldLayout == VK_IMAGE_LAYOUT_GENERAL)
+	{
+		// Read by the shading rate analysis
+		hdrSrcStage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		hdrSrcAccess = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+	}
+	// In visibility buffer mode the material pass writes the HDR target from compute, not as an attachment
+	const VkImageLayout hdrLayout = visibilityBuffer ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	const VkPipelineStageFlags2 hdrDstStage = visibilityBuffer ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	const VkAccessFlags2 hdrDstAccess = visibilityBuffer ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	TransitionImage(cmd, GetHDRRenderTarget(), hdrOldLayout, hdrLayout, hdrSrcStage, hdrSrcAccess, hdrDstStage, hdrDstAccess, VK_IMAGE_ASPECT_COLOR_BIT);
+	SetHDRImageLayout(hdrLayout);
 
 	const VkImageLayout depthOldLayout = GetDepthImageLayout();
 	VkPipelineStageFlags2 depthSrcStage = VK_PIPELINE_STAGE_2_NONE;
@@ -2271,6 +3944,10 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	colorAttachment.clearValue = colorClear;
+	if (visibilityBuffer)
+	{
+		colorAttachment = m_VisibilityBuffer.GetAttachment();
+	}
 
 	VkRenderingAttachmentInfo depthAttachment{};
 	depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -2290,38 +3967,110 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 	renderingInfo.colorAttachmentCount = 1;
 	renderingInfo.pColorAttachments = &colorAttachment;
 	renderingInfo.pDepthAttachment = &depthAttachment;
+	if (shadingRate)
+	{
+		renderingInfo.pNext = &shadingRateAttachment;
+	}
 
 	vkCmdBeginRendering(cmd, &renderingInfo);
 
 	SetDynamicState(cmd, extent);
+	if (shadingRate)
+	{
+		// The attachment's rate replaces the 1x1 pipeline rate SetDynamicState leaves
+		const VkExtent2D fragmentSize = { 1, 1 };
+		const VkFragmentShadingRateCombinerOpKHR combinerOps[2] = { VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR, VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR };
+		vkCmdSetFragmentShadingRateKHR(cmd, &fragmentSize, combinerOps);
+	}
 	if (m_TaskShader == VK_NULL_HANDLE || m_MeshShader == VK_NULL_HANDLE || m_FragmentShader == VK_NULL_HANDLE)
 	{
-		Logger::Error("Shader objects not initialized");
+		WOVEN_LOG_ERROR("Shader objects not initialized");
 		vkCmdEndRendering(cmd);
 		return;
 	}
 
 	const VkShaderStageFlagBits stages[] = { VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT };
-	const VkShaderEXT shaders[] = { m_TaskShader, m_MeshShader, m_FragmentShader };
+	const VkShaderEXT shaders[] = { m_TaskShader, m_MeshShader, visibilityBuffer ? m_VisibilityBuffer.GetFragmentShader() : m_FragmentShader };
 	vkCmdBindShadersEXT(cmd, 3, stages, shaders);
 
-	VkDescriptorSet bindlessSet = GetBindlessDescriptorSet();
-	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, GetGlobalPipelineLayout(), 0, 1, &bindlessSet, 0, nullptr);
+	BindBindless(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
-	PushConstants push{};
-	push.time = timeSeconds;
-	push.resolution = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
-	vkCmdPushConstants(cmd, GetGlobalPipelineLayout(), VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+	// One indirect-count draw per bucket, one task workgroup per visible instance (fragment shaders read push.streaming)
+	if (push.streaming != 0)
+	{
+		m_Culling.RecordDraws(cmd, GetGlobalPipelineLayout(), push);
+	}
+
+	// Clusters the task shaders handed to the compute rasterizer: compute may not run inside rendering, so the
+	// pass is split and the resolve continues on the same attachments, depth-tested against the mesh shader output
+	if (raster.visibility != 0)
+	{
+		vkCmdEndRendering(cmd);
+		EndGpuPass(cmd);
+
+		BeginGpuPass(cmd, "Software Raster");
+		m_SoftwareRaster.RecordRaster(cmd, GetGlobalPipelineLayout(), push);
+		EndGpuPass(cmd);
+
+		BeginGpuPass(cmd, "Resolve");
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		// Writes one rasterized sample per pixel, so it stays at full rate
+		renderingInfo.pNext = nullptr;
+		vkCmdBeginRendering(cmd, &renderingInfo);
+		SetDynamicState(cmd, extent);
+		BindBindless(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS);
+		m_SoftwareRaster.RecordResolve(cmd, GetGlobalPipelineLayout(), push, visibilityBuffer);
+	}
+
+	// Shades each covered pixel once, then the UI goes on top of the HDR target as an attachment again
+	if (visibilityBuffer)
+	{
+		vkCmdEndRendering(cmd);
+		EndGpuPass(cmd);
+
+		BeginGpuPass(cmd, "Material");
+		m_VisibilityBuffer.RecordMaterialPass(cmd, GetGlobalPipelineLayout(), push);
+		TransitionImage(cmd, GetHDRRenderTarget(), VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+		SetHDRImageLayout(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		EndGpuPass(cmd);
+
+		BeginGpuPass(cmd, "UI");
+		colorAttachment = {};
+		colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		colorAttachment.imageView = GetHDRRenderTargetView();
+		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		vkCmdBeginRendering(cmd, &renderingInfo);
+	}
+	// ImGui's pipeline was not created for a shading rate attachment, so the UI continues without it
+	else if (renderingInfo.pNext != nullptr)
+	{
+		vkCmdEndRendering(cmd);
+		EndGpuPass(cmd);
 
-	// Dispatch mesh tasks: 1 task workgroup to generate 1 mesh workgroup
-	vkCmdDrawMeshTasksEXT(cmd, 1, 1, 1);
+		BeginGpuPass(cmd, "UI");
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		renderingInfo.pNext = nullptr;
+		vkCmdBeginRendering(cmd, &renderingInfo);
+	}
 
 	RenderImGui(cmd);
 
 	vkCmdEndRendering(cmd);
+	EndGpuPass(cmd);
+
+	// Mips sampled this frame decide what streams in once this slot comes around again
+	m_TextureStreamer.RecordFeedbackReadback(cmd, m_CurrentFrameIndex);
+
+	BeginGpuPass(cmd, "Blit");
 
 	TransitionImage(cmd, GetHDRRenderTarget(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
 	SetHDRImageLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	m_HDRHistoryValid = true;
 
 	const VkImageLayout swapchainOldLayout = GetSwapchainImageLayout(imageIndex);
 	VkPipelineStageFlags2 swapchainSrcStage = VK_PIPELINE_STAGE_2_NONE;
@@ -2331,7 +4080,7 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 		swapchainSrcStage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
 		swapchainSrcAccess = VK_ACCESS_2_TRANSFER_WRITE_BIT;
 	}
-	else if (swapchainOldLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR)
+	else if (swapchainOldLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR || swapchainOldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
 	{
 		swapchainSrcStage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT;
 		swapchainSrcAccess = 0;
@@ -2365,8 +4114,10 @@ void GraphicsSystem::RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float
 
 	vkCmdBlitImage2(cmd, &blitInfo);
 
-	TransitionImage(cmd, GetSwapchainImage(imageIndex), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, 0, VK_IMAGE_ASPECT_COLOR_BIT);
-	SetSwapchainImageLayout(imageIndex, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	TransitionImage(cmd, GetSwapchainImage(imageIndex), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_PresentLayout, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, 0, VK_IMAGE_ASPECT_COLOR_BIT);
+	SetSwapchainImageLayout(imageIndex, m_PresentLayout);
+
+	EndGpuPass(cmd);
 }
 
 void GraphicsSystem::TransitionImage(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageAspectFlags aspectMask)
@@ -2424,11 +4175,20 @@ void GraphicsSystem::SetDynamicState(VkCommandBuffer cmd, VkExtent2D extent)
 
 	vkCmdSetFrontFace(cmd, VK_FRONT_FACE_COUNTER_CLOCKWISE);
 	vkCmdSetPrimitiveTopology(cmd, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-	vkCmdSetDepthTestEnable(cmd, VK_FALSE);
-	vkCmdSetDepthWriteEnable(cmd, VK_FALSE);
+	// The software raster resolve merges with the mesh shader output through the depth test
+	vkCmdSetDepthTestEnable(cmd, VK_TRUE);
+	vkCmdSetDepthWriteEnable(cmd, VK_TRUE);
 	vkCmdSetDepthCompareOp(cmd, VK_COMPARE_OP_LESS_OR_EQUAL);
 	vkCmdSetDepthBiasEnable(cmd, VK_FALSE);
 	vkCmdSetStencilTestEnable(cmd, VK_FALSE);
+
+	// Shader objects need the rate set whenever the feature is enabled; passes opt into the attachment rate
+	if (m_SupportsFragmentShadingRate)
+	{
+		const VkExtent2D fragmentSize = { 1, 1 };
+		const VkFragmentShadingRateCombinerOpKHR combinerOps[2] = { VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR, VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR };
+		vkCmdSetFragmentShadingRateKHR(cmd, &fragmentSize, combinerOps);
+	}
 	vkCmdSetLineWidth(cmd, 1.0f);
 
 	// Apply polygon mode based on debug state (wireframe vs solid)
@@ -2465,6 +4225,9 @@ void GraphicsSystem::CleanupVulkan()
 	{
 		vkDeviceWaitIdle(m_VkbDevice.device);
 
+		// Before the timeline and the allocator it needs go
+		m_DeferredDestruction.Shutdown();
+
 		// Destroy pipeline infrastructure
 		if (m_PipelineCache != VK_NULL_HANDLE)
 		{
@@ -2479,6 +4242,15 @@ void GraphicsSystem::CleanupVulkan()
 		}
 
 		// Destroy bindless descriptors
+		m_BindlessRegistry.Shutdown();
+		m_BindlessDescriptorBuffer.Shutdown();
+		if (m_DefaultSampler != VK_NULL_HANDLE)
+		{
+			vkDestroySampler(m_VkbDevice.device, m_DefaultSampler, nullptr);
+			m_DefaultSampler = VK_NULL_HANDLE;
+			m_DefaultSamplerIndex = INVALID_BINDLESS_INDEX;
+		}
+
 		if (m_BindlessDescriptorPool != VK_NULL_HANDLE)
 		{
 			vkDestroyDescriptorPool(m_VkbDevice.device, m_BindlessDescriptorPool, nullptr);
@@ -2492,6 +4264,7 @@ void GraphicsSystem::CleanupVulkan()
 		}
 
 		// Destroy sync primitives
+		m_AsyncCompute.Shutdown();
 		if (m_TimelineSemaphore != VK_NULL_HANDLE)
 		{
 			vkDestroySemaphore(m_VkbDevice.device, m_TimelineSemaphore, nullptr);
@@ -2522,12 +4295,26 @@ void GraphicsSystem::CleanupVulkan()
 			}
 		}
 
-		// Destroy swapchain and render targets
-		CleanupSwapchain();
+		for (auto& frame: m_Frames)
+		{
+			if (frame.timestampQueryPool != VK_NULL_HANDLE)
+			{
+				vkDestroyQueryPool(m_VkbDevice.device, frame.timestampQueryPool, nullptr);
+				frame.timestampQueryPool = VK_NULL_HANDLE;
+			}
+		}
+
+		// Destroy swapchain (or offscreen targets) and render targets
+		if (m_Headless)
+			CleanupOffscreenTargets();
+		else
+			CleanupSwapchain();
 		CleanupDepthResources();
 		CleanupHDRRenderTarget();
 
 		// Destroy VMA allocator
+		m_MemoryPools.Shutdown();
+		m_MemoryStats.Shutdown();
 		if (m_VmaAllocator != VK_NULL_HANDLE)
 		{
 			vmaDestroyAllocator(m_VmaAllocator);
@@ -2,33 +2,108 @@
 
 #include "pch.hpp"
 
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
 #include <vk_mem_alloc.h>
 #include <VkBootstrap.h>
 
+#include "graphics/AsyncCompute.hpp"
+#include "graphics/BindlessDescriptorBuffer.hpp"
+#include "graphics/BindlessRegistry.hpp"
+#include "graphics/Camera.hpp"
+#include "graphics/ClusteredLighting.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuCulling.hpp"
+#include "graphics/GpuGeometry.hpp"
+#include "graphics/GpuScene.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+#include "graphics/ShadowCascades.hpp"
+#include "graphics/SoftwareRaster.hpp"
+#include "graphics/TextureStreamer.hpp"
+#include "graphics/VariableRateShading.hpp"
+#include "graphics/VisibilityBuffer.hpp"
+
 // Forward declare Tracy context
 namespace tracy
 {
 	class VkCtx;
 }
 
+struct FrameCapture;
+
 // Constants for frame-in-flight management
 constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
 
+// Upper bound of GPU-timed passes per frame (each pass takes two timestamp queries)
+constexpr uint32_t MAX_GPU_PASSES = 16;
+
 // Per-frame resources
 struct FrameData
 {
 	VkCommandPool commandPool = VK_NULL_HANDLE;
 	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 
+	// Async compute frames split the graphics work around the compute submission (see EndFrame):
+	// commandBuffer runs before it, overlapCommandBuffer alongside it and finalCommandBuffer after it
+	VkCommandBuffer overlapCommandBuffer = VK_NULL_HANDLE;
+	VkCommandBuffer finalCommandBuffer = VK_NULL_HANDLE;
+	VkCommandBuffer computeCommandBuffer = VK_NULL_HANDLE; // From AsyncCompute, null on single-queue frames
+
 	// Modern sync primitives
 	VkSemaphore swapchainAcquireSemaphore = VK_NULL_HANDLE;
 	VkSemaphore renderCompleteSemaphore = VK_NULL_HANDLE;
 	VkFence renderFence = VK_NULL_HANDLE; // Optional: used if not using timeline semaphores
 
-	// Timeline semaphore value for this frame (Vulkan 1.2+)
+	// Graphics timeline value the frame's last submission signals
 	uint64_t timelineValue = 0;
+
+	// GPU timestamps: [0,1] bracket the whole frame, then one begin/end pair per pass
+	VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+	uint64_t frameNumber = 0;
+	bool timestampsWritten = false;
+	uint32_t passCount = 0;
+	bool passOpen = false;
+	std::array<const char*, MAX_GPU_PASSES> passNames = {};
 };
 
+struct GpuPassTiming
+{
+	const char* name = nullptr; // Static string passed to BeginGpuPass
+	double gpuMs = 0.0;
+};
+
+// GPU time of a completed frame, resolved once its fence has signaled
+struct GpuFrameTiming
+{
+	uint64_t frameNumber = 0;
+	double gpuMs = 0.0;
+	std::vector<GpuPassTiming> passes;
+};
+
+// Display-to-photon latency of a presented frame, measured with VK_KHR_present_wait
+struct PresentTiming
+{
+	uint64_t frameNumber = 0;
+	double presentMs = 0.0; // vkQueuePresentKHR to on screen
+	double frameMs = 0.0;   // Start of the frame's CPU work to on screen
+};
+
+// How frames are paced against the display; each mode maps to a present mode
+enum class LatencyMode : uint8_t
+{
+	Vsync,      // FIFO: every frame is shown, queued frames absorb CPU spikes
+	LowLatency, // MAILBOX (else FIFO), and each frame starts only once the previous one is on screen
+	Uncapped,   // IMMEDIATE (else MAILBOX, else FIFO): may tear, never waits for a vblank
+	Count
+};
+
+const char* GetLatencyModeName(LatencyMode mode);
+// Command line names: vsync, low-latency, uncapped
+bool ParseLatencyMode(const char* name, LatencyMode& outMode);
+
 class GraphicsSystem
 {
 public:
@@ -36,8 +111,16 @@ public:
 	~GraphicsSystem();
 
 	bool Initialize(SDL_Window* window);
+	bool InitializeHeadless(uint32_t width, uint32_t height);
 	void Shutdown();
 
+	bool IsHeadless() const
+	{
+		return m_Headless;
+	}
+
+	void WaitIdle();
+
 	// Accessors
 	VkInstance GetInstance() const
 	{
@@ -74,6 +157,17 @@ public:
 		return m_VmaAllocator;
 	}
 
+	GpuMemoryStats& GetMemoryStats()
+	{
+		return m_MemoryStats;
+	}
+
+	// Transient ring + defragmentable streaming pools
+	GpuMemoryPools& GetMemoryPools()
+	{
+		return m_MemoryPools;
+	}
+
 	tracy::VkCtx* GetTracyContext() const
 	{
 		return m_TracyContext;
@@ -90,6 +184,71 @@ public:
 	// Rendering
 	bool RenderFrame(float timeSeconds);
 
+	// Number of frames submitted so far (the next frame gets this number)
+	uint64_t GetFrameNumber() const
+	{
+		return m_FrameNumber;
+	}
+
+	// GPU timing
+	double GetLastGpuFrameTimeMs() const
+	{
+		return m_LastGpuFrameTimeMs;
+	}
+
+	// When enabled, every resolved frame timing is kept until consumed
+	void SetGpuTimingCapture(bool enabled)
+	{
+		m_CaptureGpuTimings = enabled;
+	}
+
+	std::vector<GpuFrameTiming> ConsumeGpuTimings();
+
+	// Switching modes recreates the swapchain at the start of the next frame
+	void SetLatencyMode(LatencyMode mode);
+
+	LatencyMode GetLatencyMode() const
+	{
+		return m_LatencyMode;
+	}
+
+	// False when VK_KHR_present_wait is missing (or headless): no latency metric, low latency falls back to MAILBOX alone
+	bool SupportsPresentWait() const
+	{
+		return m_SupportsPresentWait;
+	}
+
+	// Shares the GPU timing capture switch; timings arrive once the frame has been displayed
+	std::vector<PresentTiming> ConsumePresentTimings();
+
+	// Brackets a pass with GPU timestamps; passes are sequential, name must outlive the frame
+	void BeginGpuPass(VkCommandBuffer cmd, const char* name);
+	void EndGpuPass(VkCommandBuffer cmd);
+
+	Camera& GetCamera()
+	{
+		return m_Camera;
+	}
+
+	// Headless only: writes the last rendered offscreen image as a BMP
+	bool SaveLastFrameImage(const std::filesystem::path& path);
+
+	// Writes the render inputs of the next recorded frame to path (see FrameCapture)
+	void RequestFrameCapture(const std::filesystem::path& path)
+	{
+		m_FrameCapturePath = path;
+	}
+
+	// Replay: after InitializeHeadless at the capture's extent with SetDemoInstanceCount(header.slotCount).
+	// Replaces the scene, lights, camera and render toggles with the capture's and freezes the demo animation,
+	// so every following frame renders the captured one.
+	bool ApplyFrameCapture(const FrameCapture& capture);
+
+	const char* GetDeviceName() const
+	{
+		return m_VkbPhysicalDevice.properties.deviceName;
+	}
+
 	// ImGui
 	bool InitializeImGui(SDL_Window* window);
 	void ShutdownImGui();
@@ -165,23 +324,89 @@ public:
 		return m_HDRFormat;
 	}
 
-	// Bindless descriptor set
+	// Bindless descriptor set (VK_NULL_HANDLE when the descriptor buffer backend is active)
 	VkDescriptorSet GetBindlessDescriptorSet() const
 	{
 		return m_BindlessDescriptorSet;
 	}
 
+	// Binds set 0 through whichever backend is active
+	void BindBindless(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint) const;
+
+	// Must be called before Initialize; false forces the descriptor set path even when descriptor buffers are supported
+	void SetPreferDescriptorBuffer(bool prefer)
+	{
+		m_PreferDescriptorBuffer = prefer;
+	}
+
+	bool UsesDescriptorBuffer() const
+	{
+		return m_UseDescriptorBuffer;
+	}
+
+	// Must be called before Initialize; number of demo instances fed to GPU culling
+	void SetDemoInstanceCount(uint32_t count)
+	{
+		m_DemoInstanceCount = count;
+	}
+
+	uint32_t GetDemoInstanceCount() const
+	{
+		return m_DemoInstanceCount;
+	}
+
+	const GpuCulling& GetCulling() const
+	{
+		return m_Culling;
+	}
+
+	// Persistent per-instance data on the GPU (edits upload as deltas)
+	GpuScene& GetScene()
+	{
+		return m_Scene;
+	}
+
+	// Baked meshlet geometry the instances reference
+	GpuGeometry& GetGeometry()
+	{
+		return m_Geometry;
+	}
+
+	// Must be called before Initialize; texture transcodes run on these workers (inline when null)
+	void SetTaskScheduler(enki::TaskScheduler* scheduler)
+	{
+		m_TaskScheduler = scheduler;
+	}
+
+	// KTX2 textures streamed mip by mip under a VRAM budget
+	TextureStreamer& GetTextureStreamer()
+	{
+		return m_TextureStreamer;
+	}
+
 	VkPipelineLayout GetGlobalPipelineLayout() const
 	{
 		return m_GlobalPipelineLayout;
 	}
 
+	// Slot allocation for the bindless set (indices are pushed to shaders)
+	BindlessRegistry& GetBindlessRegistry()
+	{
+		return m_BindlessRegistry;
+	}
+
+	// Linear/repeat sampler registered at startup
+	uint32_t GetDefaultSamplerIndex() const
+	{
+		return m_DefaultSamplerIndex;
+	}
+
 	// Frame presentation
 	bool BeginFrame(uint32_t& outImageIndex);
 	bool EndFrame(uint32_t imageIndex);
 	bool RecordSwapchainClear(VkCommandBuffer cmd, uint32_t imageIndex, const VkClearColorValue& clearColor);
 
-	// Window resize handling
+	// Window resize handling: flags the swapchain for recreation, or pauses rendering while the window has no area
 	void HandleResize(SDL_Window* window);
 
 	bool IsSwapchainOutOfDate() const
@@ -240,11 +465,13 @@ public:
 
 private:
 	// Initialization helpers
+	bool InitializeDevice(SDL_Window* window);
 	bool CreateVulkanInstance(SDL_Window* window);
 	bool CreateSurface(SDL_Window* window);
 	bool SelectPhysicalDevice();
 	bool CreateLogicalDevice();
 	bool GetQueues();
+	std::vector<uint32_t> GetQueueFamilies() const; // Families that share host-written buffers
 	bool InitializeVulkanMemoryAllocator();
 	bool CreateTracyContext();
 
@@ -252,6 +479,8 @@ private:
 	bool CreateSwapchain(SDL_Window* window);
 	bool RecreateSwapchain(SDL_Window* window);
 	void CleanupSwapchain();
+	bool CreateOffscreenTargets();
+	void CleanupOffscreenTargets();
 	bool CreateDepthResources();
 	void CleanupDepthResources();
 	bool CreateHDRRenderTarget();
@@ -259,12 +488,24 @@ private:
 	VkFormat FindDepthFormat();
 	bool CreateCommandPools();
 	bool CreateSyncPrimitives();
+	bool CreateTimestampQueries();
+	void ResolveFrameTimestamps(FrameData& frame);
+	// Records the latency of every displayed frame; waitForLatest blocks (bounded) until the newest is on screen
+	void ResolvePresents(bool waitForLatest);
+	bool SubmitFrame(FrameData& frame);
+	// Graphics before compute, the compute queue, then graphics alongside and after it (timeline semaphores between)
+	bool SubmitAsyncComputeFrame(FrameData& frame);
 	bool CreateBindlessDescriptors();
 	bool CreatePipelineInfrastructure();
 
 	// Rendering helpers
 	bool CreateShaders();
 	void DestroyShaders();
+	bool CreateDemoInstances();
+	void UpdateDemoInstances(float timeSeconds);
+	static glm::vec3 GetDemoInstancePosition(uint32_t index, uint32_t count);
+	void UpdateDemoLights(float timeSeconds);
+	void WriteFrameCapture(float timeSeconds);
 	void RecordFrame(VkCommandBuffer cmd, uint32_t imageIndex, float timeSeconds);
 	void TransitionImage(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageAspectFlags aspectMask);
 	void SetDynamicState(VkCommandBuffer cmd, VkExtent2D extent);
@@ -280,10 +521,17 @@ private:
 
 	// Vulkan Memory Allocator
 	VmaAllocator m_VmaAllocator = VK_NULL_HANDLE;
+	GpuMemoryStats m_MemoryStats;
+	GpuMemoryPools m_MemoryPools;
+	DeferredDestruction m_DeferredDestruction;
 
 	VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
 	VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
 	VkQueue m_PresentQueue = VK_NULL_HANDLE;
+	VkQueue m_ComputeQueue = VK_NULL_HANDLE; // Compute-only family, null when the device has none
+	uint32_t m_GraphicsQueueFamily = 0;
+	uint32_t m_ComputeQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+	AsyncCompute m_AsyncCompute;
 
 	// Tracy GPU Profiling
 	tracy::VkCtx* m_TracyContext = nullptr;
@@ -297,6 +545,16 @@ private:
 	std::vector<VkImageLayout> m_SwapchainImageLayouts;
 	VkFormat m_SwapchainImageFormat = VK_FORMAT_UNDEFINED;
 	VkExtent2D m_SwapchainExtent = {};
+	VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+	LatencyMode m_LatencyMode = LatencyMode::LowLatency;
+
+	// Layout the final image is left in at the end of a frame
+	VkImageLayout m_PresentLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	// Headless offscreen targets (stand in for swapchain images, one per frame in flight)
+	bool m_Headless = false;
+	std::vector<VmaAllocation> m_OffscreenAllocations;
+	uint32_t m_LastRenderedImageIndex = UINT32_MAX;
 
 	// Depth buffer (required for forward+ and all 3D rendering)
 	VkImage m_DepthImage = VK_NULL_HANDLE;
@@ -310,22 +568,56 @@ private:
 	VmaAllocation m_HDRRenderTargetAllocation = VK_NULL_HANDLE;
 	VkFormat m_HDRFormat = VK_FORMAT_R16G16B16A16_SFLOAT; // HDR format
 	VkImageLayout m_HDRImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	bool m_HDRHistoryValid = false; // Last frame's blit left an image of the current extent
 
 	// Depth layout tracking
 	VkImageLayout m_DepthImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
+	// Allocated size of the depth and HDR targets. They only grow: a smaller swapchain renders into the
+	// top-left of the current images.
+	VkExtent2D m_RenderTargetExtent = {};
+
 	// Frame-in-flight management
 	FrameData m_Frames[MAX_FRAMES_IN_FLIGHT];
 	uint32_t m_CurrentFrameIndex = 0;
 
-	// Timeline semaphore for modern sync
+	// Graphics timeline: advanced by every frame's last submission (and mid-frame for async compute)
 	VkSemaphore m_TimelineSemaphore = VK_NULL_HANDLE;
 	uint64_t m_TimelineValue = 0;
 
+	// Frame counting and GPU timestamp results
+	uint64_t m_FrameNumber = 0;
+	bool m_SupportsTimestamps = false;
+	double m_TimestampPeriodNs = 1.0;
+	uint64_t m_TimestampMask = ~0ull;
+	double m_LastGpuFrameTimeMs = 0.0;
+	bool m_CaptureGpuTimings = false;
+	std::vector<GpuFrameTiming> m_GpuTimings;
+
+	// Presents not yet seen on screen, oldest first. Present ids only need to increase per swapchain, so one
+	// counter serves every swapchain and the list is dropped on recreation.
+	struct PendingPresent
+	{
+		uint64_t presentId = 0;
+		uint64_t frameNumber = 0;
+		std::chrono::steady_clock::time_point frameStart;
+		std::chrono::steady_clock::time_point presented;
+	};
+	std::deque<PendingPresent> m_PendingPresents;
+	uint64_t m_PresentId = 0;
+	std::chrono::steady_clock::time_point m_FrameStartTime;
+	double m_LastPresentLatencyMs = 0.0;
+	double m_LastFrameLatencyMs = 0.0;
+	std::vector<PresentTiming> m_PresentTimings;
+
 	// Bindless descriptors
 	VkDescriptorPool m_BindlessDescriptorPool = VK_NULL_HANDLE;
 	VkDescriptorSetLayout m_BindlessDescriptorSetLayout = VK_NULL_HANDLE;
 	VkDescriptorSet m_BindlessDescriptorSet = VK_NULL_HANDLE;
+	BindlessDescriptorBuffer m_BindlessDescriptorBuffer;
+	BindlessRegistry m_BindlessRegistry;
+	VkSampler m_DefaultSampler = VK_NULL_HANDLE;
+	uint32_t m_DefaultSamplerIndex = INVALID_BINDLESS_INDEX;
 
 	// ImGui
 	VkDescriptorPool m_ImGuiDescriptorPool = VK_NULL_HANDLE;
@@ -338,13 +630,23 @@ private:
 		// Rendering controls
 		bool enableWireframe = false;
 		bool enableCullFaceBackFace = true;
+		bool enableVisibilityBuffer = false; // Ids in the raster pass, shading in a compute material pass
 		float clearColorR = 0.1f;
 		float clearColorG = 0.1f;
 		float clearColorB = 0.1f;
 		float clearColorA = 1.0f;
-
-		// Frame pacing and vsync
-		bool enableVsync = true;
+		float animatedInstanceFraction = 0.0f; // Share of demo instances re-uploaded every frame
+		float lodErrorPixels = 1.0f;           // Screen-space error the LOD cut may introduce
+		bool enableSoftwareRaster = true;
+		float softwareRasterPixels = 12.0f;    // Clusters at most this wide on screen go to the compute rasterizer
+		int demoLightCount = 256;              // Animated point, spot and area lights over the instance grid
+		bool enableShadows = true;
+		bool cacheShadowCascades = true;       // Far cascades are only redrawn when they move or a caster changes
+		bool enableVariableRateShading = false;
+		float shadingRateThreshold = 0.01f;    // Mean luminance step per pixel under which an axis is shaded at half rate
+		bool enableAsyncCompute = true;        // Light culling and shading rate analysis on the compute queue, overlapping the shadows
+
+		// Frame pacing (a sleep limiter on top of the latency mode)
 		bool enableFpsCap = true;
 		float targetFps = 60.0f;
 		float vSyncModifier = 1.0f;
@@ -363,9 +665,32 @@ private:
 	VkPipelineLayout m_GlobalPipelineLayout = VK_NULL_HANDLE;
 	VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
 
+	// Main view
+	Camera m_Camera;
+
 	// Shader system
 	std::unique_ptr<class ShaderSystem> m_ShaderSystem;
 
+	// Scene (a grid of demo instances for now) and GPU-driven culling over it
+	GpuGeometry m_Geometry;
+	GpuScene m_Scene;
+	uint32_t m_DemoInstanceCount = 1;
+	GpuCulling m_Culling;
+	SoftwareRaster m_SoftwareRaster;
+	VisibilityBuffer m_VisibilityBuffer;
+	ClusteredLighting m_Lighting;
+	std::vector<GpuLight> m_DemoLights; // Rebuilt every frame by UpdateDemoLights
+
+	// Frame capture and replay
+	std::filesystem::path m_FrameCapturePath; // Pending capture, cleared once written
+	bool m_FrameReplay = false;               // Scene and lights come from a capture and stay frozen
+	ShadowCascades m_Shadows;
+	VariableRateShading m_ShadingRate;
+
+	// Streamed textures, transcoded on the task scheduler's workers
+	enki::TaskScheduler* m_TaskScheduler = nullptr;
+	TextureStreamer m_TextureStreamer;
+
 	// Shader objects for rendering
 	VkShaderEXT m_TaskShader = VK_NULL_HANDLE;
 	VkShaderEXT m_MeshShader = VK_NULL_HANDLE;
@@ -374,12 +699,19 @@ private:
 	// Feature support flags
 	bool m_SupportsMeshShaders = false;
 	bool m_SupportsDescriptorBuffer = false;
+	bool m_PreferDescriptorBuffer = true;
+	bool m_UseDescriptorBuffer = false;
 	bool m_SupportsFragmentShadingRate = false;
 	bool m_SupportsPushDescriptor = false;
 	bool m_SupportsShaderObjects = false;
+	bool m_SupportsMemoryBudget = false;
+	bool m_SupportsTextureCompressionBC = false;
+	bool m_SupportsInt64Atomics = false;
+	bool m_SupportsPresentWait = false; // VK_KHR_present_id + VK_KHR_present_wait
 
 	// Window state
 	bool m_SwapchainOutOfDate = false;
 	bool m_FramebufferResized = false;
+	bool m_WindowMinimized = false; // No drawable area: frames are skipped until a resize brings it back
 	SDL_Window* m_Window = nullptr;
 };
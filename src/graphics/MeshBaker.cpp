@@ -0,0 +1,509 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+#include <utility>
+#include <meshoptimizer.h>
+
+#include "core/Logger.hpp"
+#include "graphics/MeshBaker.hpp"
+
+namespace
+{
+	constexpr float kUnorm16 = 65535.0f;
+	constexpr float kUnorm15 = 32767.0f;
+	constexpr float kUnorm8 = 255.0f;
+
+	glm::vec2 OctahedralEncode(glm::vec3 n)
+	{
+		n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		glm::vec2 e(n.x, n.y);
+		if (n.z < 0.0f)
+		{
+			const glm::vec2 signs(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+			e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * signs;
+		}
+		return e;
+	}
+
+	// Same math as OctahedralDecode in shaders/geometry.slang
+	glm::vec3 OctahedralDecode(glm::vec2 e)
+	{
+		glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+		const float t = std::max(-n.z, 0.0f);
+		n.x += (n.x >= 0.0f) ? -t : t;
+		n.y += (n.y >= 0.0f) ? -t : t;
+		return glm::normalize(n);
+	}
+
+	uint32_t QuantizeUnorm(float value, float max)
+	{
+		return static_cast<uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * max));
+	}
+
+	// [-1, 1] octahedral coordinate to unorm and back
+	uint32_t QuantizeSnorm(float value, float max)
+	{
+		return QuantizeUnorm(value * 0.5f + 0.5f, max);
+	}
+
+	float DequantizeSnorm(uint32_t value, float max)
+	{
+		return static_cast<float>(value) / max * 2.0f - 1.0f;
+	}
+
+	float AngleDegrees(const glm::vec3& a, const glm::vec3& b)
+	{
+		return glm::degrees(std::acos(std::clamp(glm::dot(a, b), -1.0f, 1.0f)));
+	}
+
+	glm::vec3 SafeNormalize(const glm::vec3& v, const glm::vec3& fallback)
+	{
+		const float length = glm::length(v);
+		return (length > 1e-12f) ? v / length : fallback;
+	}
+
+	glm::vec3 AnyPerpendicular(const glm::vec3& n)
+	{
+		const glm::vec3 axis = (std::abs(n.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		return glm::normalize(glm::cross(n, axis));
+	}
+
+	// Area-weighted; front faces wind so that cross(b - a, c - a) points into the surface
+	std::vector<glm::vec3> GenerateNormals(const MeshSource& source)
+	{
+		std::vector<glm::vec3> normals(source.positions.size(), glm::vec3(0.0f));
+		for (size_t i = 0; i < source.indices.size(); i += 3)
+		{
+			const uint32_t a = source.indices[i];
+			const uint32_t b = source.indices[i + 1];
+			const uint32_t c = source.indices[i + 2];
+			const glm::vec3 faceNormal = -glm::cross(source.positions[b] - source.positions[a], source.positions[c] - source.positions[a]);
+			normals[a] += faceNormal;
+			normals[b] += faceNormal;
+			normals[c] += faceNormal;
+		}
+		for (glm::vec3& normal: normals)
+		{
+			normal = SafeNormalize(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+		return normals;
+	}
+
+	uint32_t QuantizeAxis(float value, float min, float extent)
+	{
+		return (extent > 0.0f) ? QuantizeUnorm((value - min) / extent, kUnorm16) : 0;
+	}
+
+	constexpr uint32_t kGroupSize = 4;      // Clusters merged and simplified together
+	constexpr uint32_t kMaxLodLevels = 16;
+	constexpr float kMinReduction = 0.85f;  // A group that keeps more of its triangles stops refining
+
+	// One node of the cluster DAG, before quantization
+	struct Cluster
+	{
+		std::vector<uint32_t> vertices; // Source vertex indices
+		std::vector<uint8_t> triangles; // Local indices, 3 per triangle
+		glm::vec4 lodBounds = {};
+		float lodError = 0.0f;
+		glm::vec4 parentBounds = {};
+		float parentError = FLT_MAX; // Root until a group simplifies it
+	};
+
+	// Sphere around the box center: not minimal, but cheap and good enough for culling and LOD
+	glm::vec4 ComputeSphere(const std::vector<glm::vec3>& positions, const uint32_t* vertices, size_t count)
+	{
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		for (size_t i = 0; i < count; ++i)
+		{
+			boundsMin = glm::min(boundsMin, positions[vertices[i]]);
+			boundsMax = glm::max(boundsMax, positions[vertices[i]]);
+		}
+		const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radius = 0.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			radius = std::max(radius, glm::length(positions[vertices[i]] - center));
+		}
+		return glm::vec4(center, radius);
+	}
+
+	// Encloses every input sphere, so a parent's projected error is never below its children's
+	glm::vec4 MergeSpheres(const std::vector<glm::vec4>& spheres)
+	{
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		for (const glm::vec4& sphere: spheres)
+		{
+			boundsMin = glm::min(boundsMin, glm::vec3(sphere) - sphere.w);
+			boundsMax = glm::max(boundsMax, glm::vec3(sphere) + sphere.w);
+		}
+		const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+		float radius = 0.0f;
+		for (const glm::vec4& sphere: spheres)
+		{
+			radius = std::max(radius, glm::length(glm::vec3(sphere) - center) + sphere.w);
+		}
+		return glm::vec4(center, radius);
+	}
+
+	// Appends the meshlets of a triangle list; each starts with its own sphere and zero error
+	void SplitIntoClusters(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, std::vector<Cluster>& outClusters)
+	{
+		const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+		std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+		std::vector<uint32_t> meshletVertices(maxMeshlets * MESHLET_MAX_VERTICES);
+		std::vector<uint8_t> meshletTriangles(maxMeshlets * MESHLET_MAX_TRIANGLES * 3);
+		const size_t meshletCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(), indices.data(), indices.size(), &positions[0].x, positions.size(), sizeof(glm::vec3), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, 0.0f);
+
+		for (size_t i = 0; i < meshletCount; ++i)
+		{
+			const meshopt_Meshlet& meshlet = meshlets[i];
+			Cluster cluster;
+			cluster.vertices.assign(meshletVertices.begin() + meshlet.vertex_offset, meshletVertices.begin() + meshlet.vertex_offset + meshlet.vertex_count);
+			cluster.triangles.assign(meshletTriangles.begin() + meshlet.triangle_offset, meshletTriangles.begin() + meshlet.triangle_offset + meshlet.triangle_count * 3);
+			cluster.lodBounds = ComputeSphere(positions, cluster.vertices.data(), cluster.vertices.size());
+			outClusters.push_back(std::move(cluster));
+		}
+	}
+
+	// Greedy: grow each group from its first ungrouped cluster by the neighbour sharing the most
+	// vertices, so groups stay connected and their locked borders stay short
+	std::vector<std::vector<uint32_t>> GroupClusters(const std::vector<Cluster>& clusters, const std::vector<uint32_t>& pending, const std::vector<uint32_t>& positionRemap)
+	{
+		// Welded vertex -> pending clusters touching it (pending is in meshlet order, so spatially coherent)
+		std::vector<std::vector<uint32_t>> clustersByVertex(positionRemap.size());
+		for (uint32_t i = 0; i < pending.size(); ++i)
+		{
+			for (uint32_t vertex: clusters[pending[i]].vertices)
+			{
+				std::vector<uint32_t>& touching = clustersByVertex[positionRemap[vertex]];
+				if (touching.empty() || touching.back() != i)
+				{
+					touching.push_back(i);
+				}
+			}
+		}
+
+		std::vector<uint32_t> shared(pending.size(), 0);
+		std::vector<std::vector<std::pair<uint32_t, uint32_t>>> adjacency(pending.size()); // (neighbour, shared vertices)
+		for (uint32_t i = 0; i < pending.size(); ++i)
+		{
+			std::vector<uint32_t> neighbours;
+			for (uint32_t vertex: clusters[pending[i]].vertices)
+			{
+				for (uint32_t other: clustersByVertex[positionRemap[vertex]])
+				{
+					if (other != i && shared[other]++ == 0)
+					{
+						neighbours.push_back(other);
+					}
+				}
+			}
+			for (uint32_t other: neighbours)
+			{
+				adjacency[i].emplace_back(other, shared[other]);
+				shared[other] = 0;
+			}
+		}
+
+		std::vector<std::vector<uint32_t>> groups;
+		std::vector<bool> grouped(pending.size(), false);
+		for (uint32_t seed = 0; seed < pending.size(); ++seed)
+		{
+			if (grouped[seed])
+			{
+				continue;
+			}
+
+			std::vector<uint32_t> group = { seed };
+			grouped[seed] = true;
+			while (group.size() < kGroupSize)
+			{
+				uint32_t best = UINT32_MAX;
+				uint32_t bestShared = 0;
+				for (uint32_t member: group)
+				{
+					for (const auto& [other, count]: adjacency[member])
+					{
+						if (!grouped[other] && count > bestShared)
+						{
+							best = other;
+							bestShared = count;
+						}
+					}
+				}
+				if (best == UINT32_MAX)
+				{
+					break;
+				}
+				group.push_back(best);
+				grouped[best] = true;
+			}
+
+			for (uint32_t& member: group)
+			{
+				member = pending[member];
+			}
+			groups.push_back(std::move(group));
+		}
+		return groups;
+	}
+
+	// Level 0 is the source split into meshlets. Each further level groups the previous one's clusters,
+	// halves each group with its border locked (so neighbouring groups still meet whatever LOD they
+	// pick) and splits the result again. Errors accumulate up the DAG so a parent never reports less
+	// error than its children. Returns the number of levels.
+	uint32_t BuildClusterDag(const MeshSource& source, std::vector<Cluster>& outClusters)
+	{
+		ZoneScopedN("MeshBaker::BuildClusterDag");
+
+		const std::vector<glm::vec3>& positions = source.positions;
+		SplitIntoClusters(source.indices, positions, outClusters);
+
+		// UV and normal seams duplicate vertices; grouping has to see through them to find neighbours
+		std::vector<uint32_t> shadowIndices(source.indices.size());
+		meshopt_generateShadowIndexBuffer(shadowIndices.data(), source.indices.data(), source.indices.size(), &positions[0].x, positions.size(), sizeof(glm::vec3), sizeof(glm::vec3));
+		std::vector<uint32_t> positionRemap(positions.size());
+		for (uint32_t i = 0; i < positionRemap.size(); ++i)
+		{
+			positionRemap[i] = i;
+		}
+		for (size_t i = 0; i < source.indices.size(); ++i)
+		{
+			positionRemap[source.indices[i]] = shadowIndices[i];
+		}
+
+		// Each group is simplified on its own compact vertex array: meshopt_simplify does work proportional
+		// to the vertex count it is given, so passing the whole mesh made every group cost O(mesh).
+		// localIndex maps mesh vertices into the current group and is reset after each one.
+		std::vector<uint32_t> localIndex(positions.size(), UINT32_MAX);
+		std::vector<uint32_t> groupVertices;
+		std::vector<glm::vec3> groupPositions;
+
+		std::vector<uint32_t> pending(outClusters.size());
+		for (uint32_t i = 0; i < pending.size(); ++i)
+		{
+			pending[i] = i;
+		}
+
+		uint32_t levels = 1;
+		while (pending.size() > 1 && levels < kMaxLodLevels)
+		{
+			std::vector<uint32_t> next;
+			for (const std::vector<uint32_t>& group: GroupClusters(outClusters, pending, positionRemap))
+			{
+				std::vector<uint32_t> merged;
+				std::vector<glm::vec4> spheres;
+				float childError = 0.0f;
+				for (uint32_t id: group)
+				{
+					const Cluster& cluster = outClusters[id];
+					for (uint8_t local: cluster.triangles)
+					{
+						merged.push_back(cluster.vertices[local]);
+					}
+					spheres.push_back(cluster.lodBounds);
+					childError = std::max(childError, cluster.lodError);
+				}
+
+				groupVertices.clear();
+				groupPositions.clear();
+				for (uint32_t& index: merged)
+				{
+					if (localIndex[index] == UINT32_MAX)
+					{
+						localIndex[index] = static_cast<uint32_t>(groupVertices.size());
+						groupVertices.push_back(index);
+						groupPositions.push_back(positions[index]);
+					}
+					index = localIndex[index];
+				}
+				for (uint32_t vertex: groupVertices)
+				{
+					localIndex[vertex] = UINT32_MAX;
+				}
+
+				// A relative error would be scaled by the group extent; ask for object units directly
+				const size_t targetIndexCount = (merged.size() / 6) * 3;
+				std::vector<uint32_t> simplified(merged.size());
+				float error = 0.0f;
+				simplified.resize(meshopt_simplify(simplified.data(), merged.data(), merged.size(), &groupPositions[0].x, groupPositions.size(), sizeof(glm::vec3), targetIndexCount, FLT_MAX, meshopt_SimplifyLockBorder | meshopt_SimplifyErrorAbsolute, &error));
+				if (simplified.empty() || static_cast<float>(simplified.size()) > static_cast<float>(merged.size()) * kMinReduction)
+				{
+					continue; // Mostly border; these clusters stay roots
+				}
+
+				const glm::vec4 groupBounds = MergeSpheres(spheres);
+				const float groupError = childError + error;
+				for (uint32_t id: group)
+				{
+					outClusters[id].parentBounds = groupBounds;
+					outClusters[id].parentError = groupError;
+				}
+
+				for (uint32_t& index: simplified)
+				{
+					index = groupVertices[index];
+				}
+
+				const size_t first = outClusters.size();
+				SplitIntoClusters(simplified, positions, outClusters);
+				for (size_t id = first; id < outClusters.size(); ++id)
+				{
+					outClusters[id].lodBounds = groupBounds;
+					outClusters[id].lodError = groupError;
+					next.push_back(static_cast<uint32_t>(id));
+				}
+			}
+
+			if (next.empty())
+			{
+				break;
+			}
+			pending.swap(next);
+			++levels;
+		}
+		return levels;
+	}
+} // namespace
+
+namespace MeshBaker
+{
+	bool Bake(const MeshSource& source, const QuantizationBudget& budget, const char* name, BakedMesh& outMesh)
+	{
+		ZoneScopedN("MeshBaker::Bake");
+
+		outMesh = {};
+		const size_t vertexCount = source.positions.size();
+		if (vertexCount == 0 || source.indices.empty() || source.indices.size() % 3 != 0)
+		{
+			WOVEN_LOG_ERROR("Mesh '%s': needs positions and a triangle list", name);
+			return false;
+		}
+		if ((!source.normals.empty() && source.normals.size() != vertexCount) || (!source.tangents.empty() && source.tangents.size() != vertexCount) || (!source.uvs.empty() && source.uvs.size() != vertexCount))
+		{
+			WOVEN_LOG_ERROR("Mesh '%s': attribute counts do not match the %zu positions", name, vertexCount);
+			return false;
+		}
+		if (*std::max_element(source.indices.begin(), source.indices.end()) >= vertexCount)
+		{
+			WOVEN_LOG_ERROR("Mesh '%s': index out of range", name);
+			return false;
+		}
+
+		const std::vector<glm::vec3> generatedNormals = source.normals.empty() ? GenerateNormals(source) : std::vector<glm::vec3>();
+		const std::vector<glm::vec3>& normals = source.normals.empty() ? generatedNormals : source.normals;
+
+		outMesh.bounds = ComputeSphere(source.positions, source.indices.data(), source.indices.size());
+		const float radius = outMesh.bounds.w;
+
+		std::vector<Cluster> clusters;
+		outMesh.lodLevelCount = BuildClusterDag(source, clusters);
+
+		outMesh.meshlets.reserve(clusters.size());
+		for (const Cluster& cluster: clusters)
+		{
+			GpuMeshlet baked;
+			glm::vec3 meshletMax(-FLT_MAX);
+			baked.boundsMin = glm::vec3(FLT_MAX);
+			for (uint32_t index: cluster.vertices)
+			{
+				baked.boundsMin = glm::min(baked.boundsMin, source.positions[index]);
+				meshletMax = glm::max(meshletMax, source.positions[index]);
+			}
+			baked.boundsExtent = meshletMax - baked.boundsMin;
+			baked.vertexOffset = static_cast<uint32_t>(outMesh.vertices.size());
+			baked.triangleOffset = static_cast<uint32_t>(outMesh.triangles.size());
+			baked.vertexCount = static_cast<uint32_t>(cluster.vertices.size());
+			baked.triangleCount = static_cast<uint32_t>(cluster.triangles.size() / 3);
+			baked.lodError = cluster.lodError;
+			baked.parentError = cluster.parentError;
+			baked.lodBounds = cluster.lodBounds;
+			baked.parentBounds = cluster.parentBounds;
+			outMesh.meshlets.push_back(baked);
+			if (cluster.parentError == FLT_MAX)
+			{
+				outMesh.rootTriangleCount += baked.triangleCount;
+			}
+
+			for (uint32_t index: cluster.vertices)
+			{
+				const glm::vec3& position = source.positions[index];
+				const glm::vec3 normal = SafeNormalize(normals[index], glm::vec3(0.0f, 1.0f, 0.0f));
+				const glm::vec4 tangent = source.tangents.empty() ? glm::vec4(AnyPerpendicular(normal), 1.0f) : source.tangents[index];
+				const glm::vec3 tangentDirection = SafeNormalize(glm::vec3(tangent), AnyPerpendicular(normal));
+				const glm::vec2 uv = source.uvs.empty() ? glm::vec2(0.0f) : source.uvs[index];
+
+				const glm::uvec3 q(QuantizeAxis(position.x, baked.boundsMin.x, baked.boundsExtent.x), QuantizeAxis(position.y, baked.boundsMin.y, baked.boundsExtent.y), QuantizeAxis(position.z, baked.boundsMin.z, baked.boundsExtent.z));
+				const glm::vec2 normalOct = OctahedralEncode(normal);
+				const glm::uvec2 qNormal(QuantizeSnorm(normalOct.x, kUnorm16), QuantizeSnorm(normalOct.y, kUnorm15));
+				const glm::vec2 tangentOct = OctahedralEncode(tangentDirection);
+				const glm::uvec2 qTangent(QuantizeSnorm(tangentOct.x, kUnorm8), QuantizeSnorm(tangentOct.y, kUnorm8));
+				const uint32_t u = glm::packHalf1x16(uv.x);
+				const uint32_t w = glm::packHalf1x16(uv.y);
+
+				GpuQuantizedVertex vertex;
+				vertex.positionXY = q.x | (q.y << 16);
+				vertex.positionZ = q.z | (qTangent.x << 16) | (qTangent.y << 24);
+				vertex.normal = qNormal.x | (qNormal.y << 16) | ((tangent.w < 0.0f) ? 1u << 31 : 0u);
+				vertex.uv = u | (w << 16);
+				outMesh.vertices.push_back(vertex);
+
+				// Decode exactly like the mesh shader and measure what was lost
+				const glm::vec3 decodedPosition = baked.boundsMin + glm::vec3(q) / kUnorm16 * baked.boundsExtent;
+				const glm::vec3 decodedNormal = OctahedralDecode(glm::vec2(DequantizeSnorm(qNormal.x, kUnorm16), DequantizeSnorm(qNormal.y, kUnorm15)));
+				const glm::vec3 decodedTangent = OctahedralDecode(glm::vec2(DequantizeSnorm(qTangent.x, kUnorm8), DequantizeSnorm(qTangent.y, kUnorm8)));
+				const glm::vec2 decodedUv(glm::unpackHalf1x16(static_cast<uint16_t>(u)), glm::unpackHalf1x16(static_cast<uint16_t>(w)));
+
+				const glm::vec3 positionError = glm::abs(decodedPosition - position);
+				outMesh.maxPositionError = std::max(outMesh.maxPositionError, std::max(positionError.x, std::max(positionError.y, positionError.z)));
+				outMesh.maxNormalErrorDegrees = std::max(outMesh.maxNormalErrorDegrees, AngleDegrees(decodedNormal, normal));
+				if (!source.tangents.empty())
+				{
+					outMesh.maxTangentErrorDegrees = std::max(outMesh.maxTangentErrorDegrees, AngleDegrees(decodedTangent, tangentDirection));
+				}
+				if (!source.uvs.empty())
+				{
+					const glm::vec2 uvError = glm::abs(decodedUv - uv);
+					outMesh.maxUvError = std::max(outMesh.maxUvError, std::max(uvError.x, uvError.y));
+				}
+			}
+
+			const std::vector<uint8_t>& triangles = cluster.triangles;
+			for (size_t t = 0; t < triangles.size(); t += 3)
+			{
+				outMesh.triangles.push_back(triangles[t] | (triangles[t + 1] << 8) | (triangles[t + 2] << 16));
+			}
+		}
+
+		const float positionBudget = budget.positionError * std::max(radius, 1e-6f);
+		const struct
+		{
+			const char* attribute;
+			float error;
+			float limit;
+		} checks[] = {
+			{ "position", outMesh.maxPositionError, positionBudget },
+			{ "normal (degrees)", outMesh.maxNormalErrorDegrees, budget.normalErrorDegrees },
+			{ "tangent (degrees)", outMesh.maxTangentErrorDegrees, budget.tangentErrorDegrees },
+			{ "UV", outMesh.maxUvError, budget.uvError },
+		};
+		for (const auto& check: checks)
+		{
+			if (check.error > check.limit)
+			{
+				WOVEN_LOG_ERROR("Mesh '%s': %s quantization error %g exceeds the budget %g", name, check.attribute, check.error, check.limit);
+				return false;
+			}
+		}
+
+		outMesh.sourceBytes = vertexCount * (sizeof(glm::vec3) * 2 + sizeof(glm::vec4) + sizeof(glm::vec2)) + source.indices.size() * sizeof(uint32_t);
+		outMesh.bakedBytes = outMesh.meshlets.size() * sizeof(GpuMeshlet) + outMesh.vertices.size() * sizeof(GpuQuantizedVertex) + outMesh.triangles.size() * sizeof(uint32_t);
+		WOVEN_LOG_INFO("Baked mesh '%s': %zu clusters in %u LOD levels (%zu -> %u triangles), %.1f KiB -> %.1f KiB (%.0f%%), max position error %g", name, outMesh.meshlets.size(), outMesh.lodLevelCount, source.indices.size() / 3, outMesh.rootTriangleCount, outMesh.sourceBytes / 1024.0, outMesh.bakedBytes / 1024.0, 100.0 * outMesh.bakedBytes / outMesh.sourceBytes, outMesh.maxPositionError);
+		return true;
+	}
+} // namespace MeshBaker
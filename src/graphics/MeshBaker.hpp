@@ -0,0 +1,55 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vector>
+
+#include "graphics/RenderConstants.hpp"
+
+// Float vertex data as it comes from an importer or generator. Empty attribute arrays are allowed:
+// missing normals are generated, missing tangents/UVs are left at defaults and not error-checked.
+struct MeshSource
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec4> tangents; // w = bitangent sign
+	std::vector<glm::vec2> uvs;
+	std::vector<uint32_t> indices; // Triangle list
+};
+
+// Largest decode error a bake may introduce; exceeding any of them fails the bake
+struct QuantizationBudget
+{
+	float positionError = 1e-4f; // Fraction of the mesh's bounding radius
+	float normalErrorDegrees = 0.5f;
+	float tangentErrorDegrees = 2.0f;
+	float uvError = 1.0f / 2048.0f; // Half a texel of a 1K texture
+};
+
+// Meshlets with quantized vertices, ready for GpuGeometry. Offsets are relative to this mesh.
+struct BakedMesh
+{
+	std::vector<GpuMeshlet> meshlets; // Every LOD level's clusters; the task shader picks the cut
+	std::vector<GpuQuantizedVertex> vertices; // Owned per meshlet, so shared vertices are duplicated
+	std::vector<uint32_t> triangles;
+	glm::vec4 bounds = {}; // Object-space sphere
+	uint32_t lodLevelCount = 0;
+	uint32_t rootTriangleCount = 0; // The coarsest cut, drawn from far away
+
+	// Measured at bake time
+	float maxPositionError = 0.0f; // Object units
+	float maxNormalErrorDegrees = 0.0f;
+	float maxTangentErrorDegrees = 0.0f;
+	float maxUvError = 0.0f;
+	size_t sourceBytes = 0; // Float attributes + 32-bit indices
+	size_t bakedBytes = 0;
+};
+
+// Splits a mesh into meshlets (MESHLET_MAX_VERTICES / MESHLET_MAX_TRIANGLES), builds the LOD cluster
+// DAG over them (group, simplify, re-split; see GpuMeshlet for the per-cluster errors) and quantizes
+// the vertices: 16-bit positions relative to the meshlet bounds, octahedral normals and tangents,
+// half-float UVs. shaders/geometry.slang decodes them and selects the cut.
+namespace MeshBaker
+{
+	bool Bake(const MeshSource& source, const QuantizationBudget& budget, const char* name, BakedMesh& outMesh);
+} // namespace MeshBaker
@@ -0,0 +1,111 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "graphics/ProceduralMeshes.hpp"
+
+namespace
+{
+	constexpr float kPi = 3.14159265358979f;
+
+	struct SurfacePoint
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec3 tangent;   // Direction of increasing u
+		glm::vec3 bitangent; // Direction of increasing v
+	};
+
+	// Drops degenerate triangles (sphere poles) and flips any that would face the wrong way
+	void EmitTriangle(MeshSource& mesh, uint32_t a, uint32_t b, uint32_t c)
+	{
+		const glm::vec3 cross = glm::cross(mesh.positions[b] - mesh.positions[a], mesh.positions[c] - mesh.positions[a]);
+		if (glm::dot(cross, cross) < 1e-12f)
+		{
+			return;
+		}
+		if (glm::dot(cross, mesh.normals[a] + mesh.normals[b] + mesh.normals[c]) > 0.0f)
+		{
+			std::swap(b, c);
+		}
+		mesh.indices.insert(mesh.indices.end(), { a, b, c });
+	}
+
+	// (columns + 1) x (rows + 1) vertices, so the UV seam gets a column of its own
+	template<typename Surface>
+	MeshSource BuildGrid(uint32_t columns, uint32_t rows, Surface surface)
+	{
+		MeshSource mesh;
+		const size_t vertexCount = static_cast<size_t>(columns + 1) * (rows + 1);
+		mesh.positions.reserve(vertexCount);
+		mesh.normals.reserve(vertexCount);
+		mesh.tangents.reserve(vertexCount);
+		mesh.uvs.reserve(vertexCount);
+
+		for (uint32_t row = 0; row <= rows; ++row)
+		{
+			for (uint32_t column = 0; column <= columns; ++column)
+			{
+				const glm::vec2 uv(static_cast<float>(column) / static_cast<float>(columns), static_cast<float>(row) / static_cast<float>(rows));
+				const SurfacePoint point = surface(uv.x, uv.y);
+				const float handedness = (glm::dot(glm::cross(point.normal, point.tangent), point.bitangent) < 0.0f) ? -1.0f : 1.0f;
+				mesh.positions.push_back(point.position);
+				mesh.normals.push_back(point.normal);
+				mesh.tangents.push_back(glm::vec4(point.tangent, handedness));
+				mesh.uvs.push_back(uv);
+			}
+		}
+
+		for (uint32_t row = 0; row < rows; ++row)
+		{
+			for (uint32_t column = 0; column < columns; ++column)
+			{
+				const uint32_t a = row * (columns + 1) + column;
+				const uint32_t b = a + 1;
+				const uint32_t d = a + columns + 1;
+				const uint32_t c = d + 1;
+				EmitTriangle(mesh, a, b, d);
+				EmitTriangle(mesh, b, c, d);
+			}
+		}
+		return mesh;
+	}
+} // namespace
+
+namespace ProceduralMeshes
+{
+	MeshSource CreateTorus(float majorRadius, float minorRadius, uint32_t ringSegments, uint32_t tubeSegments)
+	{
+		return BuildGrid(std::max(ringSegments, 3u), std::max(tubeSegments, 3u), [=](float u, float v)
+		{
+			const float ring = u * 2.0f * kPi;
+			const float tube = v * 2.0f * kPi;
+			const glm::vec3 radial(std::cos(ring), std::sin(ring), 0.0f);
+
+			SurfacePoint point;
+			point.normal = radial * std::cos(tube) + glm::vec3(0.0f, 0.0f, std::sin(tube));
+			point.position = radial * majorRadius + point.normal * minorRadius;
+			point.tangent = glm::vec3(-std::sin(ring), std::cos(ring), 0.0f);
+			point.bitangent = -radial * std::sin(tube) + glm::vec3(0.0f, 0.0f, std::cos(tube));
+			return point;
+		});
+	}
+
+	MeshSource CreateSphere(float radius, uint32_t segments, uint32_t rings)
+	{
+		return BuildGrid(std::max(segments, 3u), std::max(rings, 2u), [=](float u, float v)
+		{
+			const float phi = u * 2.0f * kPi;
+			const float theta = v * kPi;
+
+			SurfacePoint point;
+			point.normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			point.position = point.normal * radius;
+			point.tangent = glm::vec3(-std::sin(phi), 0.0f, std::cos(phi));
+			point.bitangent = glm::vec3(std::cos(theta) * std::cos(phi), -std::sin(theta), std::cos(theta) * std::sin(phi));
+			return point;
+		});
+	}
+} // namespace ProceduralMeshes
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "graphics/MeshBaker.hpp"
+
+// Generated test geometry with full attributes (normals, tangents, UVs), for the demo scene and tools.
+// Front faces follow the engine convention: cross(b - a, c - a) points into the surface.
+namespace ProceduralMeshes
+{
+	// Ring in the XY plane (facing the default camera); UV u runs along the ring, v around the tube
+	MeshSource CreateTorus(float majorRadius, float minorRadius, uint32_t ringSegments, uint32_t tubeSegments);
+
+	// UV sphere; u runs around Y, v from pole to pole
+	MeshSource CreateSphere(float radius, uint32_t segments, uint32_t rings);
+} // namespace ProceduralMeshes
@@ -2,10 +2,221 @@
 
 #include "pch.hpp"
 
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
+// Draw buckets of the GPU-driven path (one indirect-count draw each)
+constexpr uint32_t MATERIAL_BUCKET_COUNT = 4;
+
+// Meshlet limits shared by the baker and the mesh shader's output declaration
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// drawCounts holds one count per bucket, then what the task shaders selected (for stats).
+// The software counters are the part of the cut sent to the compute rasterizer.
+constexpr uint32_t DRAW_COUNTER_CLUSTERS = MATERIAL_BUCKET_COUNT;
+constexpr uint32_t DRAW_COUNTER_TRIANGLES = MATERIAL_BUCKET_COUNT + 1;
+constexpr uint32_t DRAW_COUNTER_SOFTWARE_CLUSTERS = MATERIAL_BUCKET_COUNT + 2;
+constexpr uint32_t DRAW_COUNTER_SOFTWARE_TRIANGLES = MATERIAL_BUCKET_COUNT + 3;
+constexpr uint32_t DRAW_COUNTER_COUNT = MATERIAL_BUCKET_COUNT + 4;
+
+// One compute workgroup per software-rasterized cluster, so the list stays within the guaranteed
+// maxComputeWorkGroupCount[0]. The visibility payload packs slot << 7 | triangle (MESHLET_MAX_TRIANGLES < 128).
+constexpr uint32_t SOFTWARE_RASTER_MAX_CLUSTERS = 65535;
+
+// Visibility buffer mode: each pixel holds (instance, meshlet << 7 | triangle), cleared to VISIBILITY_ID_EMPTY.
+// The material pass classifies and shades the screen in MATERIAL_TILE_SIZE squared tiles.
+constexpr uint32_t VISIBILITY_ID_EMPTY = UINT32_MAX;
+constexpr uint32_t MATERIAL_TILE_SIZE = 8;
+
+// Clustered light culling (ClusteredLighting): a froxel grid of screen tiles by exponential depth slices.
+// Each cluster lists at most LIGHT_CLUSTER_MAX_LIGHTS lights; all lists share LIGHT_INDEX_CAPACITY indices.
+constexpr uint32_t LIGHT_CLUSTER_X = 16;
+constexpr uint32_t LIGHT_CLUSTER_Y = 9;
+constexpr uint32_t LIGHT_CLUSTER_Z = 24;
+constexpr uint32_t LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z;
+constexpr uint32_t LIGHT_CLUSTER_MAX_LIGHTS = 256;
+constexpr uint32_t LIGHT_INDEX_CAPACITY = LIGHT_CLUSTER_COUNT * 64;
+constexpr uint32_t MAX_LIGHTS = 4096;
+
+constexpr uint32_t LIGHT_TYPE_POINT = 0;
+constexpr uint32_t LIGHT_TYPE_SPOT = 1;
+constexpr uint32_t LIGHT_TYPE_AREA = 2; // One-sided rectangle
+
+// Directional shadow cascades of the key light (ShadowCascades), nearest first
+constexpr uint32_t SHADOW_CASCADE_COUNT = 4;
+
+// Variable rate shading (VariableRateShading). Rate texels hold the VK_KHR_fragment_shading_rate encoding
+// (log2 width << 2 | log2 height); the analysis counts them in classes 1x1, 1x2, 2x1, 2x2.
+constexpr uint32_t SHADING_RATE_CLASS_COUNT = 4;
+
+// Mirrors Mesh in shaders/common.slang
+struct GpuMesh
+{
+	uint32_t meshletOffset = 0;
+	uint32_t meshletCount = 0;
+	uint32_t padding[2] = {};
+};
+
+// Mirrors Meshlet in shaders/common.slang. Vertex positions are unorm16 within [boundsMin, boundsMin + boundsExtent].
+struct GpuMeshlet
+{
+	glm::vec3 boundsMin = {};
+	uint32_t vertexOffset = 0; // Into the quantized vertices; meshlets own their vertices
+	glm::vec3 boundsExtent = {};
+	uint32_t triangleOffset = 0; // Into the packed triangles (local indices x | y << 8 | z << 16)
+	uint32_t vertexCount = 0;
+	uint32_t triangleCount = 0;
+
+	// LOD cut (MeshBaker builds the cluster DAG): drawn when its own error is small enough on screen
+	// and its parent's is not. Errors are object-space distances; roots have parentError = FLT_MAX.
+	float lodError = 0.0f;
+	float parentError = 0.0f;
+	glm::vec4 lodBounds = {};    // Sphere of the group this cluster was simplified from (its own sphere at level 0)
+	glm::vec4 parentBounds = {}; // Sphere of the group it was merged into, shared by its siblings
+};
+
+// Mirrors QuantizedVertex in shaders/common.slang (16 bytes instead of 48 for float attributes)
+struct GpuQuantizedVertex
+{
+	uint32_t positionXY = 0; // unorm16 x | y << 16, relative to the meshlet bounds
+	uint32_t positionZ = 0;  // unorm16 z | tangent octahedral unorm8x2 << 16
+	uint32_t normal = 0;     // Octahedral unorm16 x | unorm15 y << 16 | tangent sign << 31
+	uint32_t uv = 0;         // half2
+};
+
+static_assert(sizeof(GpuMeshlet) == 80 && sizeof(GpuQuantizedVertex) == 16, "Must match shaders/common.slang");
+
+// Mirrors DrawData in shaders/common.slang; every member is a buffer device address
+struct GpuDrawData
+{
+	VkDeviceAddress transforms = 0;       // glm::mat4 per instance
+	VkDeviceAddress bounds = 0;           // glm::vec4 per instance (object-space sphere)
+	VkDeviceAddress materials = 0;        // uint32_t per instance
+	VkDeviceAddress meshes = 0;           // uint32_t per instance, index into meshTable
+	VkDeviceAddress visibleInstances = 0; // uint32_t per draw, MATERIAL_BUCKET_COUNT * bucketCapacity
+	VkDeviceAddress drawCommands = 0;     // VkDrawMeshTasksIndirectCommandEXT, same layout
+	VkDeviceAddress drawCounts = 0;       // uint32_t per bucket, then DRAW_COUNTER_*
+	VkDeviceAddress meshTable = 0;        // GpuMesh per mesh
+	VkDeviceAddress meshlets = 0;         // GpuMeshlet
+	VkDeviceAddress vertices = 0;         // GpuQuantizedVertex
+	VkDeviceAddress triangles = 0;        // uint32_t per triangle
+	uint32_t instanceCount = 0;
+	uint32_t bucketCapacity = 0;
+	glm::vec3 cameraPosition = {}; // World space, for the LOD cut
+	float lodScale = 0.0f;         // Pixels per unit of error at distance 1, divided by the error threshold
+
+	// Software rasterizer (SoftwareRaster); softwareScale = 0 sends everything to the mesh shaders
+	VkDeviceAddress visibility = 0;       // uint64_t per pixel: depth bits << 32 | payload, cleared to ~0
+	VkDeviceAddress softwareDispatch = 0; // VkDispatchIndirectCommand (x = clusters in the list), then the slot counter
+	VkDeviceAddress softwareClusters = 0; // glm::uvec2 (instance, meshlet) per appended cluster
+	uint32_t softwareCapacity = 0;
+	float softwareScale = 0.0f; // Like lodScale, over the largest cluster diameter in pixels to rasterize in compute
+
+	// Visibility buffer mode (VisibilityBuffer); unused by the forward path
+	VkDeviceAddress materialDispatch = 0; // Per bucket VkDispatchIndirectCommand + tile count
+	VkDeviceAddress materialTiles = 0;    // Per bucket tileCapacity tiles, x | y << 16
+	uint32_t visibilityImage = 0;         // Bindless storage image, VK_FORMAT_R32G32_UINT
+	uint32_t colorImage = 0;              // Bindless storage image (the HDR target)
+	uint32_t tileCapacity = 0;
+	uint32_t padding = 0;
+	glm::vec4 backgroundColor = {};
+};
+
+// Mirrors StreamedTexture in shaders/streaming.slang
+struct GpuStreamedTexture
+{
+	uint32_t bindlessIndex = 0; // Image holding mips [residentMip, mipCount), or the fallback
+	uint32_t residentMip = 0;
+	uint32_t width = 0; // Full resolution, for the feedback mip estimate
+	uint32_t height = 0;
+};
+
+// Mirrors StreamingData in shaders/streaming.slang
+struct GpuStreamingData
+{
+	VkDeviceAddress textures = 0; // GpuStreamedTexture per texture
+	VkDeviceAddress feedback = 0; // uint32_t per texture: finest mip sampled this frame
+	uint32_t textureCount = 0;
+	uint32_t samplerIndex = 0;
+	uint32_t feedbackMask = 0; // A pixel reports when (hash & mask) == 0
+	uint32_t padding = 0;
+};
+
+// Mirrors Light in shaders/common.slang
+struct GpuLight
+{
+	glm::vec3 position = {}; // World space; the rectangle's center for area lights
+	float range = 0.0f;      // No contribution beyond this distance
+	glm::vec3 color = {};    // Premultiplied by intensity
+	uint32_t type = LIGHT_TYPE_POINT;
+	glm::vec3 direction = {}; // Spot axis, or the side an area light emits from
+	float spotCosOuter = 0.0f;
+	glm::vec3 areaRight = {}; // Half extents of the rectangle
+	float spotCosInner = 0.0f;
+	glm::vec3 areaUp = {};
+	uint32_t padding = 0;
+	glm::vec4 cullSphere = {}; // World-space sphere bounding everything the light reaches
+};
+
+// Mirrors LightingData in shaders/common.slang
+struct GpuLightingData
+{
+	glm::mat4 view = glm::mat4(1.0f);
+	VkDeviceAddress lights = 0;       // GpuLight per light
+	VkDeviceAddress clusters = 0;     // uvec2 (first index, count) per cluster, x fastest, then y (down), then depth
+	VkDeviceAddress lightIndices = 0; // [0] allocation counter, then the clusters' index lists
+	uint32_t lightCount = 0;
+	uint32_t indexCapacity = 0;
+	glm::vec2 projectionScale = {}; // projection[0][0], projection[1][1]: view xy = ndc * depth / scale
+	float nearPlane = 0.0f;
+	float sliceScale = 0.0f; // Slice of a view depth: log(depth / nearPlane) * sliceScale
+};
+
+static_assert(sizeof(GpuLight) == 96 && sizeof(GpuLightingData) == 112, "Must match shaders/common.slang");
+
+// Mirrors ShadowData in shaders/common.slang
+struct GpuShadowData
+{
+	glm::mat4 viewProjection[SHADOW_CASCADE_COUNT] = {}; // World to cascade clip space
+	glm::vec4 texelWorldSize = {};                      // Per cascade, for the normal offset
+	uint32_t images[SHADOW_CASCADE_COUNT] = {};         // Bindless sampled depth images
+	float resolution = 0.0f;
+	uint32_t samplerIndex = 0;
+	uint32_t padding[2] = {};
+};
+
+static_assert(sizeof(GpuShadowData) == 304, "Must match shaders/common.slang");
+
+// Mirrors ShadingRateData in shaders/common.slang
+struct GpuShadingRateData
+{
+	VkDeviceAddress rateCounts = 0; // uint per shading rate class, rate texels written this frame
+	uint32_t colorImage = 0;        // Last frame's HDR target (bindless storage image)
+	uint32_t rateImage = 0;         // Bindless storage image, one texel per texelSize pixels
+	glm::uvec2 texelSize = {};
+	glm::uvec2 rateExtent = {};
+	float threshold = 0.0f;         // Largest perceptual luminance step per pixel a coarser rate may smooth over
+	uint32_t padding = 0;
+};
+
+static_assert(sizeof(GpuShadingRateData) == 40, "Must match shaders/common.slang");
+
+// Mirrors PushConstants in shaders/common.slang (column-major, 128 bytes)
 struct PushConstants
 {
-	float time = 0.0f;
+	glm::mat4 viewProjection = glm::mat4(1.0f);
 	glm::vec2 resolution = {};
+	float time = 0.0f;
+	uint32_t frameIndex = 0;
+	VkDeviceAddress drawData = 0;
+	uint32_t drawBucket = 0;
+	uint32_t padding = 0;
+	VkDeviceAddress streaming = 0; // GpuStreamingData
+	VkDeviceAddress lighting = 0;  // GpuLightingData
+	VkDeviceAddress shadows = 0;   // GpuShadowData
+	VkDeviceAddress shadingRate = 0; // GpuShadingRateData, only read by the shading rate analysis
 };
+
+static_assert(sizeof(PushConstants) <= 128, "Push constants must fit the guaranteed 128-byte minimum");
@@ -61,28 +61,28 @@ bool ShaderSystem::Initialize(VkDevice device, VkDescriptorSetLayout bindlessLay
 	globalDesc.apiVersion = SLANG_API_VERSION;
 	if (SLANG_FAILED(slang::createGlobalSession(&globalDesc, m_Slang->globalSession.writeRef())))
 	{
-		Logger::Error("Failed to create Slang global session");
+		WOVEN_LOG_ERROR("Failed to create Slang global session");
 		return false;
 	}
 
 	const SlangProfileID hlslProfile = m_Slang->globalSession->findProfile("sm_6_6");
 	if (hlslProfile == SLANG_PROFILE_UNKNOWN)
 	{
-		Logger::Error("Failed to find Slang profile sm_6_6");
+		WOVEN_LOG_ERROR("Failed to find Slang profile sm_6_6");
 		return false;
 	}
 
 	m_Slang->profile = m_Slang->globalSession->findProfile("spirv_1_5");
 	if (m_Slang->profile == SLANG_PROFILE_UNKNOWN)
 	{
-		Logger::Error("Failed to find Slang profile spirv_1_5");
+		WOVEN_LOG_ERROR("Failed to find Slang profile spirv_1_5");
 		return false;
 	}
 
 	const std::filesystem::path shaderDir = FileSystem::GetShadersDir();
 	if (!std::filesystem::exists(shaderDir))
 	{
-		Logger::Warning("Shader directory not found: %s", shaderDir.string().c_str());
+		WOVEN_LOG_WARNING("Shader directory not found: %s", shaderDir.string().c_str());
 	}
 
 	m_SearchPaths.clear();
@@ -109,11 +109,11 @@ bool ShaderSystem::Initialize(VkDevice device, VkDescriptorSetLayout bindlessLay
 
 	if (SLANG_FAILED(m_Slang->globalSession->createSession(sessionDesc, m_Slang->session.writeRef())))
 	{
-		Logger::Error("Failed to create Slang session");
+		WOVEN_LOG_ERROR("Failed to create Slang session");
 		return false;
 	}
 
-	Logger::Info("Slang initialized (shader dir: %s, target: spirv_1_5)", shaderDir.string().c_str());
+	WOVEN_LOG_INFO("Slang initialized (shader dir: %s, target: spirv_1_5)", shaderDir.string().c_str());
 	return true;
 }
 
@@ -136,6 +136,7 @@ bool ShaderSystem::CreateShaderObject(const ShaderCompileDesc& desc, VkShaderEXT
 	const char* spirvEntryPoint = "main";
 	VkShaderCreateInfoEXT createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+	createInfo.flags = desc.flags;
 	createInfo.stage = desc.stage;
 	createInfo.nextStage = 0;
 	createInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
@@ -149,11 +150,11 @@ bool ShaderSystem::CreateShaderObject(const ShaderCompileDesc& desc, VkShaderEXT
 
 	if (vkCreateShadersEXT(m_Device, 1, &createInfo, nullptr, &outShader) != VK_SUCCESS)
 	{
-		Logger::Error("Failed to create shader object: %s", desc.filePath.c_str());
+		WOVEN_LOG_ERROR("Failed to create shader object: %s", desc.filePath.c_str());
 		return false;
 	}
 
-	Logger::Info("Shader object created: %s (%s -> %s)", desc.filePath.c_str(), desc.entryPoint.c_str(), spirvEntryPoint);
+	WOVEN_LOG_INFO("Shader object created: %s (%s -> %s)", desc.filePath.c_str(), desc.entryPoint.c_str(), spirvEntryPoint);
 	return true;
 }
 
@@ -169,14 +170,14 @@ bool ShaderSystem::CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uin
 {
 	if (!m_Slang || !m_Slang->session)
 	{
-		Logger::Error("Slang session not initialized");
+		WOVEN_LOG_ERROR("Slang session not initialized");
 		return false;
 	}
 
 	const std::string moduleName = GetModuleName(desc.filePath);
 	if (moduleName.empty())
 	{
-		Logger::Error("Invalid shader file path: %s", desc.filePath.c_str());
+		WOVEN_LOG_ERROR("Invalid shader file path: %s", desc.filePath.c_str());
 		return false;
 	}
 
@@ -184,18 +185,18 @@ bool ShaderSystem::CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uin
 	Slang::ComPtr<slang::IModule> module(m_Slang->session->loadModule(moduleName.c_str(), diagnostics.writeRef()));
 	if (!module)
 	{
-		Logger::Error("Slang failed to load module %s: %s", moduleName.c_str(), GetDiagnosticsString(diagnostics.get()).c_str());
+		WOVEN_LOG_ERROR("Slang failed to load module %s: %s", moduleName.c_str(), GetDiagnosticsString(diagnostics.get()).c_str());
 		return false;
 	}
 	if (diagnostics && diagnostics->getBufferSize() > 0)
 	{
-		Logger::Warning("Slang module diagnostics (%s): %s", moduleName.c_str(), GetDiagnosticsString(diagnostics.get()).c_str());
+		WOVEN_LOG_WARNING("Slang module diagnostics (%s): %s", moduleName.c_str(), GetDiagnosticsString(diagnostics.get()).c_str());
 	}
 
 	Slang::ComPtr<slang::IEntryPoint> entryPoint;
 	if (SLANG_FAILED(module->findEntryPointByName(desc.entryPoint.c_str(), entryPoint.writeRef())))
 	{
-		Logger::Error("Slang failed to find entry point %s in %s", desc.entryPoint.c_str(), moduleName.c_str());
+		WOVEN_LOG_ERROR("Slang failed to find entry point %s in %s", desc.entryPoint.c_str(), moduleName.c_str());
 		return false;
 	}
 
@@ -203,7 +204,7 @@ bool ShaderSystem::CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uin
 	slang::IComponentType* components[] = { module.get(), entryPoint.get() };
 	if (SLANG_FAILED(m_Slang->session->createCompositeComponentType(components, 2, composedProgram.writeRef())))
 	{
-		Logger::Error("Slang failed to compose program for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
+		WOVEN_LOG_ERROR("Slang failed to compose program for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
 		return false;
 	}
 
@@ -211,35 +212,35 @@ bool ShaderSystem::CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uin
 	Slang::ComPtr<slang::IBlob> linkDiagnostics;
 	if (SLANG_FAILED(composedProgram->link(linkedProgram.writeRef(), linkDiagnostics.writeRef())))
 	{
-		Logger::Error("Slang link failed for %s:%s: %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(linkDiagnostics.get()).c_str());
+		WOVEN_LOG_ERROR("Slang link failed for %s:%s: %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(linkDiagnostics.get()).c_str());
 		return false;
 	}
 	if (linkDiagnostics && linkDiagnostics->getBufferSize() > 0)
 	{
-		Logger::Warning("Slang link diagnostics (%s:%s): %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(linkDiagnostics.get()).c_str());
+		WOVEN_LOG_WARNING("Slang link diagnostics (%s:%s): %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(linkDiagnostics.get()).c_str());
 	}
 
 	Slang::ComPtr<slang::IBlob> spirvBlob;
 	Slang::ComPtr<slang::IBlob> spirvDiagnostics;
 	if (SLANG_FAILED(linkedProgram->getEntryPointCode(0, 0, spirvBlob.writeRef(), spirvDiagnostics.writeRef())))
 	{
-		Logger::Error("Slang SPIR-V emission failed for %s:%s: %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(spirvDiagnostics.get()).c_str());
+		WOVEN_LOG_ERROR("Slang SPIR-V emission failed for %s:%s: %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(spirvDiagnostics.get()).c_str());
 		return false;
 	}
 	if (spirvDiagnostics && spirvDiagnostics->getBufferSize() > 0)
 	{
-		Logger::Warning("Slang SPIR-V diagnostics (%s:%s): %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(spirvDiagnostics.get()).c_str());
+		WOVEN_LOG_WARNING("Slang SPIR-V diagnostics (%s:%s): %s", moduleName.c_str(), desc.entryPoint.c_str(), GetDiagnosticsString(spirvDiagnostics.get()).c_str());
 	}
 
 	const size_t byteSize = spirvBlob->getBufferSize();
 	if (byteSize == 0)
 	{
-		Logger::Error("Slang produced empty SPIR-V for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
+		WOVEN_LOG_ERROR("Slang produced empty SPIR-V for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
 		return false;
 	}
 	if (byteSize % sizeof(uint32_t) != 0)
 	{
-		Logger::Warning("SPIR-V byte size is not 4-byte aligned for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
+		WOVEN_LOG_WARNING("SPIR-V byte size is not 4-byte aligned for %s:%s", moduleName.c_str(), desc.entryPoint.c_str());
 	}
 
 	outSpirv.resize((byteSize + sizeof(uint32_t) - 1) / sizeof(uint32_t));
@@ -247,21 +248,21 @@ bool ShaderSystem::CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uin
 
 	if (outSpirv.size() < 5)
 	{
-		Logger::Error("SPIR-V too small for %s:%s (words: %zu)", moduleName.c_str(), desc.entryPoint.c_str(), outSpirv.size());
+		WOVEN_LOG_ERROR("SPIR-V too small for %s:%s (words: %zu)", moduleName.c_str(), desc.entryPoint.c_str(), outSpirv.size());
 		return false;
 	}
 
 	if (outSpirv[0] != kSpirvMagic)
 	{
-		Logger::Error("Invalid SPIR-V magic for %s:%s (magic: %s)", moduleName.c_str(), desc.entryPoint.c_str(), ToHex(outSpirv[0]).c_str());
+		WOVEN_LOG_ERROR("Invalid SPIR-V magic for %s:%s (magic: %s)", moduleName.c_str(), desc.entryPoint.c_str(), ToHex(outSpirv[0]).c_str());
 	}
 
-	Logger::Info("SPIR-V header %s:%s (magic %s, version %s, words %zu)", moduleName.c_str(), desc.entryPoint.c_str(), ToHex(outSpirv[0]).c_str(), ToHex(outSpirv[1]).c_str(), outSpirv.size());
+	WOVEN_LOG_INFO("SPIR-V header %s:%s (magic %s, version %s, words %zu)", moduleName.c_str(), desc.entryPoint.c_str(), ToHex(outSpirv[0]).c_str(), ToHex(outSpirv[1]).c_str(), outSpirv.size());
 
 	const std::filesystem::path cacheDir = std::filesystem::current_path() / "shader_cache";
 	const std::filesystem::path dumpPath = cacheDir / (moduleName + "_" + desc.entryPoint + ".spv");
 	DumpSpirvToFile(dumpPath, outSpirv);
-	Logger::Info("Wrote SPIR-V to %s", dumpPath.string().c_str());
+	WOVEN_LOG_INFO("Wrote SPIR-V to %s", dumpPath.string().c_str());
 	return true;
 }
 
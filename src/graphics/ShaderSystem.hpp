@@ -9,6 +9,7 @@ struct ShaderCompileDesc
 	std::string filePath;
 	std::string entryPoint;
 	VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+	VkShaderCreateFlagsEXT flags = 0; // e.g. VK_SHADER_CREATE_NO_TASK_SHADER_BIT_EXT for a mesh shader used alone
 };
 
 class ShaderSystem
@@ -21,10 +22,13 @@ public:
 	void Shutdown();
 
 	bool CreateShaderObject(const ShaderCompileDesc& desc, VkShaderEXT& outShader);
+	// Immediate: only for shaders no submitted work uses. Replacements go through DeferredDestruction.
 	void DestroyShader(VkShaderEXT shader);
 
-private:
+	// Slang -> SPIR-V only, no Vulkan objects are touched
 	bool CompileToSpirv(const ShaderCompileDesc& desc, std::vector<uint32_t>& outSpirv);
+
+private:
 	std::string GetModuleName(const std::string& filePath) const;
 	std::string GetDiagnosticsString(void* diagnosticsBlob) const;
 
@@ -0,0 +1,300 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/Camera.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+#include "graphics/ShadowCascades.hpp"
+
+namespace
+{
+	// Stages that sample the maps: the forward and resolve fragment shaders and the material pass
+	constexpr VkPipelineStageFlags2 kSampleStages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	constexpr VkPipelineStageFlags2 kDepthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+	// Share of each split placed logarithmically; the rest is linear so the nearest cascade is not tiny
+	constexpr float kSplitLogWeight = 0.75f;
+
+	// Cached cascades snap to this fraction of their radius: the distance the camera may travel before a redraw
+	constexpr float kCachedSnapFraction = 0.25f;
+
+	void RecordImageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.imageMemoryBarrierCount = 1;
+		depInfo.pImageMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(cmd, &depInfo);
+	}
+} // namespace
+
+glm::vec3 ShadowCascades::GetLightDirection()
+{
+	return glm::normalize(glm::vec3(0.4f, 0.8f, -0.5f));
+}
+
+bool ShadowCascades::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction, uint32_t samplerIndex, uint32_t framesInFlight, uint32_t maxInstances)
+{
+	ZoneScopedN("ShadowCascades::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+	m_Bindless = &bindless;
+	m_Destruction = &destruction;
+	m_SamplerIndex = samplerIndex;
+
+	for (uint32_t index = 0; index < SHADOW_CASCADE_COUNT; ++index)
+	{
+		if (!CreateCascade(m_Cascades[index], index, framesInFlight, maxInstances))
+		{
+			Shutdown();
+			return false;
+		}
+	}
+
+	WOVEN_LOG_INFO("Shadow cascades initialized: %u x %ux%u, %u cached", SHADOW_CASCADE_COUNT, kResolution, kResolution, SHADOW_CASCADE_COUNT - kFirstCachedCascade);
+	return true;
+}
+
+void ShadowCascades::Shutdown()
+{
+	for (Cascade& cascade: m_Cascades)
+	{
+		DestroyCascade(cascade);
+	}
+	m_ShaderSystem = nullptr;
+	m_Bindless = nullptr;
+	m_Destruction = nullptr;
+}
+
+bool ShadowCascades::Reserve(uint32_t capacity)
+{
+	if (!IsInitialized())
+	{
+		return true;
+	}
+
+	bool reserved = true;
+	for (Cascade& cascade: m_Cascades)
+	{
+		reserved = cascade.culling.Reserve(capacity) && reserved;
+	}
+	return reserved;
+}
+
+bool ShadowCascades::CreateCascade(Cascade& cascade, uint32_t index, uint32_t framesInFlight, uint32_t maxInstances)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent = { kResolution, kResolution, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = kFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+	if (vmaCreateImage(m_Allocator, &imageInfo, &allocInfo, &cascade.image, &cascade.allocation, nullptr) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create shadow cascade %u (%ux%u)", index, kResolution, kResolution);
+		cascade.image = VK_NULL_HANDLE;
+		cascade.allocation = VK_NULL_HANDLE;
+		return false;
+	}
+	m_MemoryStats->Track(cascade.allocation, GpuMemoryCategory::RenderTarget, "Shadow Cascade");
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = cascade.image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = kFormat;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &cascade.view) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create shadow cascade %u view", index);
+		return false;
+	}
+
+	cascade.bindlessIndex = m_Bindless->RegisterSampledImage(cascade.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	if (cascade.bindlessIndex == INVALID_BINDLESS_INDEX)
+		return false;
+
+	return cascade.culling.Initialize(m_Device, m_Allocator, *m_MemoryStats, *m_ShaderSystem, *m_Destruction, framesInFlight, maxInstances);
+}
+
+void ShadowCascades::DestroyCascade(Cascade& cascade)
+{
+	cascade.culling.Shutdown();
+	if (cascade.bindlessIndex != INVALID_BINDLESS_INDEX && m_Bindless)
+	{
+		m_Bindless->Release(BindlessType::SampledImage, cascade.bindlessIndex);
+	}
+	if (cascade.view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(m_Device, cascade.view, nullptr);
+	}
+	if (cascade.image != VK_NULL_HANDLE)
+	{
+		m_MemoryStats->Untrack(cascade.allocation);
+		vmaDestroyImage(m_Allocator, cascade.image, cascade.allocation);
+	}
+	cascade = {};
+}
+
+void ShadowCascades::Update(const Camera& camera, const std::vector<glm::vec4>& changedCasters, bool cacheFarCascades)
+{
+	ZoneScopedN("ShadowCascades::Update");
+
+	// Light space never rotates, so cached cascades only ever move by whole snap steps
+	const glm::vec3 lightDirection = GetLightDirection();
+	const glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), -lightDirection, up);
+
+	const float nearPlane = camera.GetNearPlane();
+	const float farPlane = std::min(camera.GetFarPlane(), kShadowDistance);
+	const float tanHalfY = std::tan(glm::radians(camera.GetFov()) * 0.5f);
+	const float tanHalfX = tanHalfY * camera.GetAspectRatio();
+	const float cornerSlope = tanHalfX * tanHalfX + tanHalfY * tanHalfY; // Squared corner distance from the axis per squared depth
+	const glm::vec3 forward = glm::normalize(camera.GetTarget() - camera.GetPosition());
+
+	float sliceNear = nearPlane;
+	for (uint32_t index = 0; index < SHADOW_CASCADE_COUNT; ++index)
+	{
+		Cascade& cascade = m_Cascades[index];
+		const float t = static_cast<float>(index + 1) / static_cast<float>(SHADOW_CASCADE_COUNT);
+		const float split = glm::mix(nearPlane + (farPlane - nearPlane) * t, nearPlane * std::pow(farPlane / nearPlane, t), kSplitLogWeight);
+
+		// Smallest sphere centered on the view axis around the slice's corners: it does not change while the camera turns
+		const float center = std::min((sliceNear + split) * (1.0f + cornerSlope) * 0.5f, split);
+		const float radius = std::ceil(std::sqrt((split - center) * (split - center) + split * split * cornerSlope) * 16.0f) / 16.0f;
+
+		// Dynamic cascades snap to texels against shimmering, cached ones to a coarse step; either grows by its
+		// step so the snapped box still holds the sphere
+		const bool cached = cacheFarCascades && index >= kFirstCachedCascade;
+		const float step = cached ? radius * kCachedSnapFraction : 2.0f * radius / static_cast<float>(kResolution);
+		const float extent = radius + step;
+		glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(camera.GetPosition() + forward * center, 1.0f));
+		lightCenter = glm::floor(lightCenter / step) * step;
+
+		// Casters up to kShadowDistance toward the light still reach the slice
+		const float depthMin = lightCenter.z - extent - kShadowDistance;
+		const float depthMax = lightCenter.z + extent;
+		const glm::mat4 projection = glm::ortho(lightCenter.x - extent, lightCenter.x + extent, lightCenter.y - extent, lightCenter.y + extent, depthMin, depthMax);
+		const glm::vec4 placement(lightCenter, extent);
+
+		bool needsRender = !cached || !cascade.hasContents || placement != cascade.placement;
+		for (size_t i = 0; i < changedCasters.size() && !needsRender; ++i)
+		{
+			const glm::vec4& caster = changedCasters[i];
+			const glm::vec3 position = glm::vec3(lightView * glm::vec4(glm::vec3(caster), 1.0f));
+			needsRender = std::abs(position.x - lightCenter.x) <= extent + caster.w && std::abs(position.y - lightCenter.y) <= extent + caster.w && position.z + caster.w >= depthMin && position.z - caster.w <= depthMax;
+		}
+
+		cascade.viewProjection = projection * lightView;
+		cascade.placement = placement;
+		cascade.texelWorldSize = 2.0f * extent / static_cast<float>(kResolution);
+		cascade.split = split;
+		cascade.needsRender = needsRender;
+		sliceNear = split;
+	}
+}
+
+void ShadowCascades::RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, uint32_t cascade, const GpuCulling::Instances& instances, const GpuCulling::Geometry& geometry, const GpuCulling::View& view, VkPipelineLayout layout, PushConstants& push)
+{
+	ZoneScopedN("ShadowCascades::RecordCull");
+
+	// The frustum tests in the cull and task shaders run against the cascade; no software raster or material pass
+	Cascade& target = m_Cascades[cascade];
+	push.viewProjection = target.viewProjection;
+	target.culling.RecordCull(cmd, pools, frameIndex, instances, geometry, view, GpuCulling::Raster{}, GpuCulling::MaterialPass{}, layout, push);
+
+	// Earlier frames are done sampling before the map is cleared and drawn again
+	RecordImageBarrier(cmd, target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, kSampleStages, VK_ACCESS_2_NONE, kDepthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+}
+
+VkRenderingAttachmentInfo ShadowCascades::GetAttachment(uint32_t cascade) const
+{
+	VkRenderingAttachmentInfo attachment{};
+	attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	attachment.imageView = m_Cascades[cascade].view;
+	attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+	attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachment.clearValue.depthStencil = { 1.0f, 0 };
+	return attachment;
+}
+
+void ShadowCascades::RecordDraws(VkCommandBuffer cmd, uint32_t cascade, VkPipelineLayout layout, const PushConstants& push) const
+{
+	m_Cascades[cascade].culling.RecordDraws(cmd, layout, push);
+}
+
+void ShadowCascades::RecordFinish(VkCommandBuffer cmd, GpuMemoryPools& pools, PushConstants& push)
+{
+	ZoneScopedN("ShadowCascades::RecordFinish");
+
+	push.shadows = 0;
+	GpuShadowData data{};
+	bool complete = true;
+	for (uint32_t index = 0; index < SHADOW_CASCADE_COUNT; ++index)
+	{
+		Cascade& cascade = m_Cascades[index];
+		if (cascade.needsRender)
+		{
+			RecordImageBarrier(cmd, cascade.image, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, kDepthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, kSampleStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+			cascade.hasContents = true;
+			++cascade.renderCount;
+		}
+		complete = complete && cascade.hasContents;
+
+		data.viewProjection[index] = cascade.viewProjection;
+		data.texelWorldSize[static_cast<glm::length_t>(index)] = cascade.texelWorldSize;
+		data.images[index] = cascade.bindlessIndex;
+	}
+	data.resolution = static_cast<float>(kResolution);
+	data.samplerIndex = m_SamplerIndex;
+
+	// A map that was never drawn is still in UNDEFINED layout and must not be sampled
+	if (!complete)
+		return;
+
+	const TransientBuffer shadowBuffer = pools.AllocateTransient(sizeof(GpuShadowData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	if (shadowBuffer.buffer == VK_NULL_HANDLE)
+		return;
+
+	std::memcpy(shadowBuffer.mapped, &data, sizeof(data));
+	push.shadows = shadowBuffer.deviceAddress;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <array>
+#include <vk_mem_alloc.h>
+
+#include "graphics/BindlessRegistry.hpp"
+#include "graphics/GpuCulling.hpp"
+
+class Camera;
+class DeferredDestruction;
+class GpuMemoryPools;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// Cascaded shadow maps for the key light (shaders/shadows.slang).
+// Each cascade is a depth-only view drawn through the regular task/mesh shaders, with its own GpuCulling
+// lists, so instances and clusters are culled against the cascade and not the camera. Cascades bound a
+// sphere around their slice of the view frustum, which keeps their size fixed while the camera turns.
+// The far cascades are cached: they snap to a coarse grid and are drawn again only when the camera
+// crosses it or a changed caster (GpuScene::GetChangedBounds) overlaps them, so steady-state shadow
+// cost follows the near cascades and the moving content.
+class ShadowCascades
+{
+public:
+	static constexpr VkFormat kFormat = VK_FORMAT_D32_SFLOAT;
+	static constexpr uint32_t kResolution = 2048;
+	static constexpr uint32_t kFirstCachedCascade = 2;
+	static constexpr float kShadowDistance = 150.0f; // Cascades cover the view up to here
+
+	// Normalized direction toward the key light; matches ShadeSurface in shaders/shading.slang
+	static glm::vec3 GetLightDirection();
+
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction, uint32_t samplerIndex, uint32_t framesInFlight, uint32_t maxInstances);
+	void Shutdown();
+
+	bool IsInitialized() const
+	{
+		return m_Cascades[0].bindlessIndex != INVALID_BINDLESS_INDEX;
+	}
+
+	// Grows every cascade's cull lists with the scene (GpuCulling::Reserve)
+	bool Reserve(uint32_t capacity);
+
+	// Before recording: places the cascades for this camera and decides which are drawn this frame.
+	// changedCasters are world-space spheres (GpuScene::GetChangedBounds); cacheFarCascades off redraws everything.
+	void Update(const Camera& camera, const std::vector<glm::vec4>& changedCasters, bool cacheFarCascades);
+
+	// Drops the cached maps, e.g. while shadows are off and caster changes go unseen
+	void Invalidate()
+	{
+		for (Cascade& cascade: m_Cascades)
+		{
+			cascade.hasContents = false;
+		}
+	}
+
+	bool NeedsRender(uint32_t cascade) const
+	{
+		return m_Cascades[cascade].needsRender;
+	}
+
+	// Outside rendering: culls the cascade's instances into its own lists, fills push.viewProjection and
+	// push.drawData, and moves its map to DEPTH_ATTACHMENT_OPTIMAL
+	void RecordCull(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, uint32_t cascade, const GpuCulling::Instances& instances, const GpuCulling::Geometry& geometry, const GpuCulling::View& view, VkPipelineLayout layout, PushConstants& push);
+
+	// Depth attachment of the cascade, cleared to far
+	VkRenderingAttachmentInfo GetAttachment(uint32_t cascade) const;
+
+	VkExtent2D GetExtent() const
+	{
+		return { kResolution, kResolution };
+	}
+
+	// Inside rendering with the task and mesh shaders bound and no fragment shader
+	void RecordDraws(VkCommandBuffer cmd, uint32_t cascade, VkPipelineLayout layout, const PushConstants& push) const;
+
+	// Outside rendering, after the cascades drawn this frame: makes them sampleable and fills push.shadows
+	void RecordFinish(VkCommandBuffer cmd, GpuMemoryPools& pools, PushConstants& push);
+
+	// Far edge of each cascade in view depth
+	float GetSplit(uint32_t cascade) const
+	{
+		return m_Cascades[cascade].split;
+	}
+
+	// Times the cascade was drawn since startup; cached cascades should stay put while the camera rests
+	uint64_t GetRenderCount(uint32_t cascade) const
+	{
+		return m_Cascades[cascade].renderCount;
+	}
+
+private:
+	struct Cascade
+	{
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		uint32_t bindlessIndex = INVALID_BINDLESS_INDEX;
+		GpuCulling culling;
+
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+		glm::vec4 placement = {}; // Snapped light-space center and half extent; a change means a redraw
+		float texelWorldSize = 0.0f;
+		float split = 0.0f;
+		bool hasContents = false;
+		bool needsRender = false;
+		uint64_t renderCount = 0;
+	};
+
+	bool CreateCascade(Cascade& cascade, uint32_t index, uint32_t framesInFlight, uint32_t maxInstances);
+	void DestroyCascade(Cascade& cascade);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	BindlessRegistry* m_Bindless = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+	uint32_t m_SamplerIndex = INVALID_BINDLESS_INDEX;
+
+	std::array<Cascade, SHADOW_CASCADE_COUNT> m_Cascades;
+};
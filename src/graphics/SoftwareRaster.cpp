@@ -0,0 +1,184 @@
+#include "pch.hpp"
+
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/ShaderSystem.hpp"
+#include "graphics/SoftwareRaster.hpp"
+
+namespace
+{
+	// Indirect dispatch args, then the slot counter the task shaders append with
+	constexpr VkDeviceSize kListHeaderSize = 4 * sizeof(uint32_t);
+} // namespace
+
+bool SoftwareRaster::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, DeferredDestruction& destruction)
+{
+	ZoneScopedN("SoftwareRaster::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+	m_Destruction = &destruction;
+
+	ShaderCompileDesc rasterDesc{};
+	rasterDesc.filePath = "shaders/swraster.slang";
+	rasterDesc.entryPoint = "rasterMain";
+	rasterDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	ShaderCompileDesc meshDesc{};
+	meshDesc.filePath = "shaders/swraster.slang";
+	meshDesc.entryPoint = "resolveMesh";
+	meshDesc.stage = VK_SHADER_STAGE_MESH_BIT_EXT;
+	meshDesc.flags = VK_SHADER_CREATE_NO_TASK_SHADER_BIT_EXT;
+
+	ShaderCompileDesc fragmentDesc{};
+	fragmentDesc.filePath = "shaders/swraster.slang";
+	fragmentDesc.entryPoint = "resolveFragment";
+	fragmentDesc.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	ShaderCompileDesc visibilityDesc{};
+	visibilityDesc.filePath = "shaders/swraster.slang";
+	visibilityDesc.entryPoint = "resolveVisibility";
+	visibilityDesc.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkShaderEXT rasterShader = VK_NULL_HANDLE;
+	if (!m_ShaderSystem->CreateShaderObject(meshDesc, m_ResolveMeshShader) || !m_ShaderSystem->CreateShaderObject(fragmentDesc, m_ResolveFragmentShader) || !m_ShaderSystem->CreateShaderObject(visibilityDesc, m_ResolveVisibilityShader) || !m_ShaderSystem->CreateShaderObject(rasterDesc, rasterShader))
+	{
+		Shutdown();
+		return false;
+	}
+
+	const VkDeviceSize listSize = kListHeaderSize + SOFTWARE_RASTER_MAX_CLUSTERS * 2 * sizeof(uint32_t);
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, listSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Software Raster Clusters", m_ClusterList))
+	{
+		m_ShaderSystem->DestroyShader(rasterShader);
+		Shutdown();
+		return false;
+	}
+
+	// Only now: a non-null raster shader is what IsInitialized() tests
+	m_RasterShader = rasterShader;
+	WOVEN_LOG_INFO("Software raster initialized: up to %u clusters per frame", SOFTWARE_RASTER_MAX_CLUSTERS);
+	return true;
+}
+
+void SoftwareRaster::Shutdown()
+{
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_Visibility);
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_ClusterList);
+	m_Extent = {};
+	m_Active = false;
+
+	if (m_ShaderSystem)
+	{
+		m_ShaderSystem->DestroyShader(m_RasterShader);
+		m_ShaderSystem->DestroyShader(m_ResolveMeshShader);
+		m_ShaderSystem->DestroyShader(m_ResolveFragmentShader);
+		m_ShaderSystem->DestroyShader(m_ResolveVisibilityShader);
+	}
+	m_RasterShader = VK_NULL_HANDLE;
+	m_ResolveMeshShader = VK_NULL_HANDLE;
+	m_ResolveFragmentShader = VK_NULL_HANDLE;
+	m_ResolveVisibilityShader = VK_NULL_HANDLE;
+	m_ShaderSystem = nullptr;
+}
+
+GpuCulling::Raster SoftwareRaster::RecordClear(VkCommandBuffer cmd, VkExtent2D extent, float softwareScale)
+{
+	m_Active = false;
+	if (!IsInitialized() || softwareScale <= 0.0f || extent.width == 0 || extent.height == 0)
+	{
+		return {};
+	}
+
+	ZoneScopedN("SoftwareRaster::RecordClear");
+
+	if (extent.width != m_Extent.width || extent.height != m_Extent.height)
+	{
+		// Frames in flight may still rasterize into the old buffer
+		m_Destruction->DestroyBuffer(m_Visibility.buffer, m_Visibility.allocation);
+		m_Visibility = {};
+		m_Extent = {};
+
+		const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * sizeof(uint64_t);
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Visibility Buffer", m_Visibility))
+		{
+			return {};
+		}
+		m_Extent = extent;
+	}
+
+	// Last frame's raster and resolve are done with both buffers before they are reset
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	vkCmdFillBuffer(cmd, m_Visibility.buffer, 0, VK_WHOLE_SIZE, 0xFFFFFFFFu);
+	const uint32_t header[4] = { 0, 1, 1, 0 };
+	vkCmdUpdateBuffer(cmd, m_ClusterList.buffer, 0, sizeof(header), header);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+	m_Active = true;
+	GpuCulling::Raster raster;
+	raster.visibility = m_Visibility.address;
+	raster.dispatch = m_ClusterList.address;
+	raster.clusters = m_ClusterList.address + kListHeaderSize;
+	raster.capacity = SOFTWARE_RASTER_MAX_CLUSTERS;
+	raster.scale = softwareScale;
+	return raster;
+}
+
+void SoftwareRaster::RecordRaster(VkCommandBuffer cmd, VkPipelineLayout layout, const PushConstants& push)
+{
+	if (!m_Active || push.drawData == 0)
+	{
+		return;
+	}
+
+	ZoneScopedN("SoftwareRaster::RecordRaster");
+
+	// The list and its dispatch args come from the task shaders; the attachments are loaded again by the resolve
+	VkMemoryBarrier2 barriers[2] = {};
+	barriers[0].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	barriers[0].srcStageMask = VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT;
+	barriers[0].srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	barriers[0].dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+	barriers[1].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	barriers[1].srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+	barriers[1].srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	barriers[1].dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+	barriers[1].dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	VkDependencyInfo depInfo{};
+	depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	depInfo.memoryBarrierCount = 2;
+	depInfo.pMemoryBarriers = barriers;
+	vkCmdPipelineBarrier2(cmd, &depInfo);
+
+	const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &m_RasterShader);
+	vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+	vkCmdDispatchIndirect(cmd, m_ClusterList.buffer, 0);
+
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+void SoftwareRaster::RecordResolve(VkCommandBuffer cmd, VkPipelineLayout layout, const PushConstants& push, bool visibilityIds)
+{
+	if (!m_Active || push.drawData == 0 || push.streaming == 0)
+	{
+		return;
+	}
+
+	ZoneScopedN("SoftwareRaster::RecordResolve");
+
+	// The full-screen triangle's winding does not matter; every pixel without a software sample discards
+	const VkShaderStageFlagBits stages[] = { VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT };
+	const VkShaderEXT shaders[] = { VK_NULL_HANDLE, m_ResolveMeshShader, visibilityIds ? m_ResolveVisibilityShader : m_ResolveFragmentShader };
+	vkCmdBindShadersEXT(cmd, 3, stages, shaders);
+	vkCmdSetCullMode(cmd, VK_CULL_MODE_NONE);
+	vkCmdSetPolygonModeEXT(cmd, VK_POLYGON_MODE_FILL);
+	vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+	vkCmdDrawMeshTasksEXT(cmd, 1, 1, 1);
+}
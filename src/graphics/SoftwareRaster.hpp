@@ -0,0 +1,58 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/GpuCulling.hpp"
+
+class DeferredDestruction;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// Compute rasterizer for clusters only a few pixels across (shaders/swraster.slang).
+// The task shaders append such clusters to a list instead of launching mesh workgroups. A compute
+// pass then writes depth << 32 | triangle id per pixel with 64-bit atomic min, and a full-screen
+// resolve shades those pixels and writes their depth, so the depth test merges both paths.
+// Needs shaderBufferInt64Atomics; without it every cluster stays on the mesh shader path.
+class SoftwareRaster
+{
+public:
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, DeferredDestruction& destruction);
+	void Shutdown();
+
+	bool IsInitialized() const
+	{
+		return m_RasterShader != VK_NULL_HANDLE;
+	}
+
+	// Outside rendering, before the cull: sizes the visibility buffer to the target and clears it and the
+	// cluster list. Returns what the cull passes on to the task shaders (empty when disabled or failed).
+	GpuCulling::Raster RecordClear(VkCommandBuffer cmd, VkExtent2D extent, float softwareScale);
+
+	// Outside rendering, after the mesh shader draws have filled the list. Also orders those draws'
+	// attachment writes before the resolve, which continues the same attachments.
+	void RecordRaster(VkCommandBuffer cmd, VkPipelineLayout layout, const PushConstants& push);
+
+	// Inside rendering, with depth test and write enabled. Writes shaded color, or visibility ids
+	// (VisibilityBuffer) when visibilityIds is set.
+	void RecordResolve(VkCommandBuffer cmd, VkPipelineLayout layout, const PushConstants& push, bool visibilityIds);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+
+	VkShaderEXT m_RasterShader = VK_NULL_HANDLE;
+	VkShaderEXT m_ResolveMeshShader = VK_NULL_HANDLE;
+	VkShaderEXT m_ResolveFragmentShader = VK_NULL_HANDLE;
+	VkShaderEXT m_ResolveVisibilityShader = VK_NULL_HANDLE;
+
+	GpuBuffer m_Visibility;   // uint64_t per pixel of m_Extent
+	GpuBuffer m_ClusterList;  // VkDispatchIndirectCommand + slot counter, then (instance, meshlet) pairs
+	VkExtent2D m_Extent = {};
+	bool m_Active = false; // RecordClear set this frame up for the software path
+};
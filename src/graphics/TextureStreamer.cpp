@@ -0,0 +1,843 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <basisu_transcoder.h>
+#include <volk.h>
+
+#include "core/FileSystem.hpp"
+#include "core/Logger.hpp"
+#include "graphics/CookedTexture.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+#include "graphics/TextureStreamer.hpp"
+
+namespace
+{
+	// Mips at or below this size stay resident for every texture (a 64x64 BC7 tail is ~5.4 KiB)
+	constexpr uint32_t kTailSize = 64;
+
+	// One level per job keeps uploads small and lets the finest mips of the most starved textures go first
+	constexpr uint32_t kMaxJobsInFlight = 8;
+	constexpr VkDeviceSize kMaxUploadBytesPerFrame = 16ull * 1024 * 1024;
+	constexpr uint32_t kMaxEvictionsPerFrame = 16;
+
+	// A requested mip holds for this many frames before a coarser request may replace it
+	constexpr uint64_t kRequestWindow = 60;
+	// Textures not sampled for this long fall back to their tail
+	constexpr uint64_t kIdleFrames = 300;
+
+	// Streamed textures are sampled, and feedback written, by fragment shaders and the visibility buffer's material pass
+	constexpr VkPipelineStageFlags2 kSampleStages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+	// One pixel in four writes feedback; the pattern shifts with the frame so all pixels report over time
+	constexpr uint32_t kFeedbackMask = 3;
+
+	constexpr uint32_t kFallbackSize = 4;
+	constexpr uint32_t kFallbackTexel = 0xFF808080; // Mid grey, opaque (RGBA8)
+
+	double ToMiB(VkDeviceSize bytes)
+	{
+		return static_cast<double>(bytes) / (1024.0 * 1024.0);
+	}
+
+	uint32_t MipExtent(uint32_t size, uint32_t mip)
+	{
+		return std::max(1u, size >> mip);
+	}
+
+	VkImageMemoryBarrier2 ImageBarrier(VkImage image, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+		return barrier;
+	}
+
+	void RecordImageBarriers(VkCommandBuffer cmd, const VkImageMemoryBarrier2* barriers, uint32_t count)
+	{
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.imageMemoryBarrierCount = count;
+		depInfo.pImageMemoryBarriers = barriers;
+		vkCmdPipelineBarrier2(cmd, &depInfo);
+	}
+} // namespace
+
+struct TextureStreamer::Texture
+{
+	enum class State : uint8_t
+	{
+		Loading,
+		Ready,
+		Failed
+	};
+
+	std::filesystem::path path;
+	std::string name;
+	State state = State::Loading;
+
+	// Filled by the first job. The compressed file stays in memory so evicted mips can be transcoded again.
+	std::vector<uint8_t> file;
+	basist::ktx2_transcoder transcoder;
+	const CookedTextureMip* cookedMips = nullptr; // .wtex from WovenCook: mips are copied, not transcoded
+	basist::transcoder_texture_format target = basist::transcoder_texture_format::cTFBC7_RGBA;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	uint32_t width = 1;
+	uint32_t height = 1;
+	uint32_t mipCount = 0;
+	uint32_t tailMip = 0; // First level of the always-resident tail
+
+	// Residency: image holds mips [residentMip, mipCount); residentMip == mipCount means nothing resident
+	StreamingResource* image = nullptr;
+	uint32_t bindlessIndex = INVALID_BINDLESS_INDEX;
+	uint32_t residentMip = 0;
+	bool busy = false; // A job owns the transcoder
+
+	// Feedback
+	uint32_t requestedMip = UINT32_MAX;
+	uint64_t requestFrame = 0;
+	uint64_t lastSeenFrame = 0;
+
+	uint32_t GetWantedMip(uint64_t frameNumber) const
+	{
+		if (requestedMip == UINT32_MAX || lastSeenFrame + kIdleFrames <= frameNumber)
+		{
+			return tailMip;
+		}
+		return std::min(requestedMip, tailMip);
+	}
+};
+
+// Transcodes mips [firstMip, lastMip) on a worker; a header job first reads the file and picks the tail itself.
+// Cooked files skip the transcode and point straight into the file bytes.
+struct TextureStreamer::Job : enki::ITaskSet
+{
+	Texture* texture = nullptr;
+	bool loadHeader = false;
+	bool supportsBC = false;
+	uint32_t firstMip = 0;
+	uint32_t lastMip = 0;
+	VkDeviceSize growth = 0; // Reserved against the budget until the job completes
+
+	bool succeeded = false;
+	std::vector<std::vector<uint8_t>> transcoded;
+	std::vector<std::span<const uint8_t>> levels; // levels[i] holds mip firstMip + i
+
+	bool LoadHeader()
+	{
+		Texture& t = *texture;
+		t.file = FileSystem::LoadFile(t.path);
+		if (t.file.empty())
+		{
+			WOVEN_LOG_ERROR("Failed to read texture '%s'", t.path.string().c_str());
+			return false;
+		}
+
+		if (CookedTexture::IsCooked(t.file.data(), t.file.size()))
+		{
+			return LoadCookedHeader();
+		}
+
+		if (!t.transcoder.init(t.file.data(), static_cast<uint32_t>(t.file.size())))
+		{
+			WOVEN_LOG_ERROR("'%s' is not a valid KTX2 file", t.name.c_str());
+			return false;
+		}
+		if (t.transcoder.get_layers() > 1 || t.transcoder.get_faces() > 1)
+		{
+			WOVEN_LOG_ERROR("'%s': texture arrays and cube maps are not streamed", t.name.c_str());
+			return false;
+		}
+		if (!t.transcoder.start_transcoding())
+		{
+			WOVEN_LOG_ERROR("'%s': failed to start transcoding", t.name.c_str());
+			return false;
+		}
+
+		const bool srgb = t.transcoder.get_dfd_transfer_func() == basist::KTX2_KHR_DF_TRANSFER_SRGB;
+		if (supportsBC)
+		{
+			t.target = basist::transcoder_texture_format::cTFBC7_RGBA;
+			t.format = srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		}
+		else
+		{
+			t.target = basist::transcoder_texture_format::cTFRGBA32;
+			t.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		}
+
+		t.width = t.transcoder.get_width();
+		t.height = t.transcoder.get_height();
+		t.mipCount = std::max(1u, t.transcoder.get_levels());
+		SelectTail();
+		return true;
+	}
+
+	bool LoadCookedHeader()
+	{
+		Texture& t = *texture;
+		CookedTextureHeader header;
+		if (!CookedTexture::Parse(t.file.data(), t.file.size(), header, t.cookedMips))
+		{
+			WOVEN_LOG_ERROR("'%s' is not a valid cooked texture", t.name.c_str());
+			return false;
+		}
+		if (!supportsBC)
+		{
+			WOVEN_LOG_ERROR("'%s': cooked textures are BC compressed, which this device cannot sample", t.name.c_str());
+			return false;
+		}
+
+		t.format = static_cast<VkFormat>(header.format);
+		t.width = header.width;
+		t.height = header.height;
+		t.mipCount = header.mipCount;
+		SelectTail();
+		return true;
+	}
+
+	void SelectTail()
+	{
+		Texture& t = *texture;
+		t.tailMip = 0;
+		while (t.tailMip + 1 < t.mipCount && std::max(MipExtent(t.width, t.tailMip), MipExtent(t.height, t.tailMip)) > kTailSize)
+		{
+			++t.tailMip;
+		}
+
+		firstMip = t.tailMip;
+		lastMip = t.mipCount;
+	}
+
+	void ExecuteRange(enki::TaskSetPartition, uint32_t) override
+	{
+		ZoneScopedN("TextureStreamer::Transcode");
+
+		if (loadHeader && !LoadHeader())
+		{
+			return;
+		}
+
+		Texture& t = *texture;
+		if (t.cookedMips)
+		{
+			for (uint32_t mip = firstMip; mip < lastMip; ++mip)
+			{
+				levels.emplace_back(t.file.data() + t.cookedMips[mip].offset, t.cookedMips[mip].size);
+			}
+			succeeded = true;
+			return;
+		}
+
+		const bool blocks = CookedTexture::GetBlockBytes(t.format) != 0;
+		const uint32_t unitBytes = basist::basis_get_bytes_per_block_or_pixel(t.target);
+
+		transcoded.resize(lastMip - firstMip);
+		for (uint32_t mip = firstMip; mip < lastMip; ++mip)
+		{
+			basist::ktx2_image_level_info info;
+			if (!t.transcoder.get_image_level_info(info, mip, 0, 0))
+			{
+				WOVEN_LOG_ERROR("'%s': missing mip %u", t.name.c_str(), mip);
+				return;
+			}
+
+			const uint32_t units = blocks ? info.m_total_blocks : info.m_orig_width * info.m_orig_height;
+			std::vector<uint8_t>& level = transcoded[mip - firstMip];
+			level.resize(static_cast<size_t>(units) * unitBytes);
+			if (!t.transcoder.transcode_image_level(mip, 0, 0, level.data(), units, t.target))
+			{
+				WOVEN_LOG_ERROR("'%s': failed to transcode mip %u", t.name.c_str(), mip);
+				return;
+			}
+			levels.emplace_back(level);
+		}
+
+		succeeded = true;
+	}
+};
+
+TextureStreamer::TextureStreamer()
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+}
+
+bool TextureStreamer::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, GpuMemoryPools& pools, BindlessRegistry& bindless, enki::TaskScheduler* scheduler, uint32_t framesInFlight, uint32_t samplerIndex, bool supportsBC)
+{
+	ZoneScopedN("TextureStreamer::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_Pools = &pools;
+	m_Bindless = &bindless;
+	m_Scheduler = scheduler;
+	m_SamplerIndex = samplerIndex;
+	m_SupportsBC = supportsBC;
+
+	basist::basisu_transcoder_init();
+
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, MAX_STREAMED_TEXTURES * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Texture Feedback", m_Feedback))
+		return false;
+
+	m_FeedbackReadback.resize(framesInFlight);
+	m_FeedbackCounts.assign(framesInFlight, 0);
+	for (GpuBuffer& readback: m_FeedbackReadback)
+	{
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, MAX_STREAMED_TEXTURES * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::HostReadback, "Texture Feedback Readback", readback))
+			return false;
+	}
+
+	// Defragmentation replaces image views, so the bindless slots have to follow
+	m_Pools->SetMoveCallback([this](const StreamingResource& resource) { OnImageMoved(resource); });
+
+	WOVEN_LOG_INFO("Texture streaming initialized (%s, %.0f MiB budget)", supportsBC ? "BC7" : "RGBA8", ToMiB(m_Budget));
+	return true;
+}
+
+void TextureStreamer::Shutdown()
+{
+	ZoneScopedN("TextureStreamer::Shutdown");
+
+	// Workers may still be writing into textures
+	for (const std::unique_ptr<Job>& job: m_Jobs)
+	{
+		if (m_Scheduler)
+		{
+			m_Scheduler->WaitforTask(job.get());
+		}
+	}
+	m_Jobs.clear();
+
+	if (m_Pools)
+	{
+		m_Pools->SetMoveCallback(nullptr);
+		for (const std::unique_ptr<Texture>& texture: m_Textures)
+		{
+			if (texture->image)
+			{
+				m_Bindless->Release(BindlessType::SampledImage, texture->bindlessIndex);
+				m_Pools->ReleaseStreaming(texture->image);
+			}
+		}
+		if (m_Fallback)
+		{
+			m_Bindless->Release(BindlessType::SampledImage, m_FallbackIndex);
+			m_Pools->ReleaseStreaming(m_Fallback);
+		}
+	}
+	m_Textures.clear();
+	m_Fallback = nullptr;
+	m_FallbackIndex = INVALID_BINDLESS_INDEX;
+
+	for (GpuBuffer& readback: m_FeedbackReadback)
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, readback);
+	}
+	m_FeedbackReadback.clear();
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_Feedback);
+
+	m_Pools = nullptr;
+	m_Stats = {};
+	m_InFlightBytes = 0;
+}
+
+uint32_t TextureStreamer::Load(const std::filesystem::path& path)
+{
+	ZoneScopedN("TextureStreamer::Load");
+
+	if (m_Textures.size() >= MAX_STREAMED_TEXTURES)
+	{
+		WOVEN_LOG_ERROR("Cannot stream '%s': %u texture limit reached", path.string().c_str(), MAX_STREAMED_TEXTURES);
+		return INVALID_TEXTURE;
+	}
+
+	auto texture = std::make_unique<Texture>();
+	texture->path = path;
+	texture->name = path.filename().string();
+	texture->busy = true;
+
+	auto job = std::make_unique<Job>();
+	job->texture = texture.get();
+	job->loadHeader = true;
+	job->supportsBC = m_SupportsBC;
+
+	const uint32_t id = static_cast<uint32_t>(m_Textures.size());
+	m_Textures.push_back(std::move(texture));
+	Submit(std::move(job));
+	return id;
+}
+
+void TextureStreamer::Submit(std::unique_ptr<Job> job)
+{
+	if (m_Scheduler)
+	{
+		m_Scheduler->AddTaskSetToPipe(job.get());
+	}
+	else
+	{
+		job->ExecuteRange({ 0, 1 }, 0);
+	}
+	m_Jobs.push_back(std::move(job));
+}
+
+bool TextureStreamer::CreateFallback(VkCommandBuffer cmd)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+	imageInfo.extent = { kFallbackSize, kFallbackSize, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	const TransientBuffer staging = m_Pools->AllocateTransient(kFallbackSize * kFallbackSize * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (staging.buffer == VK_NULL_HANDLE)
+		return false;
+
+	m_Fallback = m_Pools->CreateStreamingImage(imageInfo, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, "Texture Fallback");
+	if (!m_Fallback)
+		return false;
+
+	std::fill_n(static_cast<uint32_t*>(staging.mapped), kFallbackSize * kFallbackSize, kFallbackTexel);
+
+	const VkImageMemoryBarrier2 toCopy = ImageBarrier(m_Fallback->image, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	RecordImageBarriers(cmd, &toCopy, 1);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { kFallbackSize, kFallbackSize, 1 };
+	vkCmdCopyBufferToImage(cmd, staging.buffer, m_Fallback->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	const VkImageMemoryBarrier2 toRead = ImageBarrier(m_Fallback->image, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, kSampleStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+	RecordImageBarriers(cmd, &toRead, 1);
+	m_Fallback->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	m_FallbackIndex = m_Bindless->RegisterSampledImage(m_Fallback->view);
+	return m_FallbackIndex != INVALID_BINDLESS_INDEX;
+}
+
+void TextureStreamer::RecordStreaming(VkCommandBuffer cmd, uint32_t frameIndex, uint64_t frameNumber, PushConstants& push)
+{
+	ZoneScopedN("TextureStreamer::RecordStreaming");
+
+	push.streaming = 0;
+
+	// Without the fallback the table stays empty and shaders skip streamed textures
+	const bool ready = m_Fallback || CreateFallback(cmd);
+	if (ready)
+	{
+		ReadFeedback(frameIndex, frameNumber);
+		CompleteJobs(cmd);
+		Evict(cmd, frameNumber);
+		LaunchJobs(frameNumber);
+	}
+
+	m_Stats.textureCount = static_cast<uint32_t>(m_Textures.size());
+	m_Stats.jobsInFlight = static_cast<uint32_t>(m_Jobs.size());
+	m_Stats.budgetBytes = m_Budget;
+	TracyPlot("Texture Resident (MiB)", ToMiB(m_Stats.residentBytes));
+
+	// Per-frame table: the residency the passes below sample with
+	m_FrameTextureCount = ready ? static_cast<uint32_t>(m_Textures.size()) : 0;
+	const VkDeviceSize tableSize = sizeof(GpuStreamingData) + static_cast<VkDeviceSize>(m_FrameTextureCount) * sizeof(GpuStreamedTexture);
+	const TransientBuffer table = m_Pools->AllocateTransient(tableSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	if (table.buffer == VK_NULL_HANDLE)
+	{
+		m_FrameTextureCount = 0;
+		return;
+	}
+
+	GpuStreamingData header{};
+	header.textures = table.deviceAddress + sizeof(GpuStreamingData);
+	header.feedback = m_Feedback.address;
+	header.textureCount = m_FrameTextureCount;
+	header.samplerIndex = m_SamplerIndex;
+	header.feedbackMask = kFeedbackMask;
+	std::memcpy(table.mapped, &header, sizeof(header));
+
+	GpuStreamedTexture* entries = reinterpret_cast<GpuStreamedTexture*>(static_cast<uint8_t*>(table.mapped) + sizeof(GpuStreamingData));
+	for (uint32_t i = 0; i < m_FrameTextureCount; ++i)
+	{
+		const Texture& texture = *m_Textures[i];
+		GpuStreamedTexture entry{};
+		entry.bindlessIndex = texture.image ? texture.bindlessIndex : m_FallbackIndex;
+		entry.residentMip = texture.image ? texture.residentMip : 0;
+		// Header fields belong to the loading job until it completes
+		const bool ready = texture.state == Texture::State::Ready;
+		entry.width = ready ? texture.width : 1;
+		entry.height = ready ? texture.height : 1;
+		entries[i] = entry;
+	}
+	push.streaming = table.deviceAddress;
+
+	// Last frame's shaders and readback copy are done with the feedback before it is cleared
+	if (m_FrameTextureCount > 0)
+	{
+		RecordMemoryBarrier(cmd, kSampleStages | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+		vkCmdFillBuffer(cmd, m_Feedback.buffer, 0, m_FrameTextureCount * sizeof(uint32_t), UINT32_MAX);
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, kSampleStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	}
+}
+
+void TextureStreamer::RecordFeedbackReadback(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+	m_FeedbackCounts[frameIndex] = m_FrameTextureCount;
+	if (m_FrameTextureCount == 0)
+	{
+		return;
+	}
+
+	ZoneScopedN("TextureStreamer::RecordFeedbackReadback");
+
+	RecordMemoryBarrier(cmd, kSampleStages, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+	const VkBufferCopy region{ 0, 0, m_FrameTextureCount * sizeof(uint32_t) };
+	vkCmdCopyBuffer(cmd, m_Feedback.buffer, m_FeedbackReadback[frameIndex].buffer, 1, &region);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+}
+
+void TextureStreamer::ReadFeedback(uint32_t frameIndex, uint64_t frameNumber)
+{
+	// Requests copied out the last time this slot ran; the slot's fence covers that copy
+	const GpuBuffer& readback = m_FeedbackReadback[frameIndex];
+	const uint32_t count = m_FeedbackCounts[frameIndex];
+	if (count == 0)
+	{
+		return;
+	}
+
+	vmaInvalidateAllocation(m_Allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+	const uint32_t* requested = static_cast<const uint32_t*>(readback.mapped);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t mip = requested[i];
+		if (mip == UINT32_MAX)
+		{
+			continue;
+		}
+
+		// Finer requests win at once; coarser ones only after the window, so camera jitter does not thrash mips
+		Texture& texture = *m_Textures[i];
+		texture.lastSeenFrame = frameNumber;
+		if (mip <= texture.requestedMip || texture.requestFrame + kRequestWindow <= frameNumber)
+		{
+			texture.requestedMip = mip;
+			texture.requestFrame = frameNumber;
+		}
+	}
+}
+
+void TextureStreamer::CompleteJobs(VkCommandBuffer cmd)
+{
+	ZoneScopedN("TextureStreamer::CompleteJobs");
+
+	m_Stats.uploadedBytes = 0;
+	for (size_t i = 0; i < m_Jobs.size();)
+	{
+		Job& job = *m_Jobs[i];
+		if (!job.GetIsComplete())
+		{
+			++i;
+			continue;
+		}
+
+		// Leave the rest for later frames once this frame has uploaded enough (always at least one job)
+		VkDeviceSize jobBytes = 0;
+		for (const std::span<const uint8_t>& level: job.levels)
+		{
+			jobBytes += level.size();
+		}
+		if (m_Stats.uploadedBytes > 0 && m_Stats.uploadedBytes + jobBytes > kMaxUploadBytesPerFrame)
+		{
+			break;
+		}
+
+		Texture& texture = *job.texture;
+		m_InFlightBytes -= job.growth;
+		texture.busy = false;
+
+		if (job.loadHeader)
+		{
+			texture.state = job.succeeded ? Texture::State::Ready : Texture::State::Failed;
+			texture.residentMip = texture.mipCount;
+		}
+
+		if (job.succeeded && Rebuild(cmd, texture, job.firstMip, &job))
+		{
+			m_Stats.uploadedBytes += jobBytes;
+			m_Stats.mipsStreamedIn += job.lastMip - job.firstMip;
+			if (job.loadHeader)
+			{
+				WOVEN_LOG_DEBUG("Streaming '%s' (%ux%u, %u mips, tail from mip %u)", texture.name.c_str(), texture.width, texture.height, texture.mipCount, texture.tailMip);
+			}
+		}
+
+		// Order does not matter, jobs are independent
+		m_Jobs[i] = std::move(m_Jobs.back());
+		m_Jobs.pop_back();
+	}
+}
+
+void TextureStreamer::Evict(VkCommandBuffer cmd, uint64_t frameNumber)
+{
+	ZoneScopedN("TextureStreamer::Evict");
+
+	// Only mips above the tail can go
+	m_Candidates.clear();
+	for (const std::unique_ptr<Texture>& texture: m_Textures)
+	{
+		if (texture->image && !texture->busy && texture->residentMip < texture->tailMip)
+		{
+			m_Candidates.push_back(texture.get());
+		}
+	}
+
+	// Least recently sampled first
+	std::sort(m_Candidates.begin(), m_Candidates.end(), [](const Texture* a, const Texture* b) { return a->lastSeenFrame < b->lastSeenFrame; });
+
+	uint32_t evictions = 0;
+	for (Texture* texture: m_Candidates)
+	{
+		if (evictions == kMaxEvictionsPerFrame)
+		{
+			break;
+		}
+
+		// Mips nobody asks for any more go regardless of the budget; over budget, the stalest textures give up a level
+		const uint32_t wanted = texture->GetWantedMip(frameNumber);
+		uint32_t baseMip = texture->residentMip;
+		if (wanted > baseMip)
+		{
+			baseMip = wanted;
+		}
+		else if (m_Stats.residentBytes + m_InFlightBytes > m_Budget)
+		{
+			baseMip = texture->residentMip + 1;
+		}
+		else
+		{
+			continue;
+		}
+
+		const uint32_t dropped = baseMip - texture->residentMip;
+		if (Rebuild(cmd, *texture, baseMip, nullptr))
+		{
+			m_Stats.mipsEvicted += dropped;
+			++evictions;
+		}
+	}
+}
+
+void TextureStreamer::LaunchJobs(uint64_t frameNumber)
+{
+	ZoneScopedN("TextureStreamer::LaunchJobs");
+
+	if (m_Jobs.size() >= kMaxJobsInFlight)
+	{
+		return;
+	}
+
+	m_Candidates.clear();
+	for (const std::unique_ptr<Texture>& texture: m_Textures)
+	{
+		if (texture->state == Texture::State::Ready && !texture->busy && texture->GetWantedMip(frameNumber) < texture->residentMip)
+		{
+			m_Candidates.push_back(texture.get());
+		}
+	}
+
+	// Largest shortfall first, then the most recently sampled
+	std::sort(m_Candidates.begin(), m_Candidates.end(), [frameNumber](const Texture* a, const Texture* b) {
+		const uint32_t shortfallA = a->residentMip - a->GetWantedMip(frameNumber);
+		const uint32_t shortfallB = b->residentMip - b->GetWantedMip(frameNumber);
+		if (shortfallA != shortfallB)
+			return shortfallA > shortfallB;
+		return a->lastSeenFrame > b->lastSeenFrame;
+	});
+
+	// Growth stops at the budget (or earlier when the device heap is nearly full)
+	const VkDeviceSize budget = m_MemoryStats->IsNearBudget() ? std::min(m_Budget, m_Stats.residentBytes) : m_Budget;
+	for (Texture* texture: m_Candidates)
+	{
+		if (m_Jobs.size() >= kMaxJobsInFlight)
+		{
+			break;
+		}
+
+		const uint32_t mip = texture->residentMip - 1;
+		const VkDeviceSize growth = CookedTexture::GetMipBytes(texture->format, texture->width, texture->height, mip);
+		if (m_Stats.residentBytes + m_InFlightBytes + growth > budget)
+		{
+			break;
+		}
+
+		auto job = std::make_unique<Job>();
+		job->texture = texture;
+		job->supportsBC = m_SupportsBC;
+		job->firstMip = mip;
+		job->lastMip = texture->residentMip;
+		job->growth = growth;
+
+		texture->busy = true;
+		m_InFlightBytes += growth;
+		Submit(std::move(job));
+	}
+}
+
+VkDeviceSize TextureStreamer::GetResidentBytes(const Texture& texture, uint32_t baseMip) const
+{
+	VkDeviceSize bytes = 0;
+	for (uint32_t mip = baseMip; mip < texture.mipCount; ++mip)
+	{
+		bytes += CookedTexture::GetMipBytes(texture.format, texture.width, texture.height, mip);
+	}
+	return bytes;
+}
+
+bool TextureStreamer::Rebuild(VkCommandBuffer cmd, Texture& texture, uint32_t baseMip, const Job* job)
+{
+	ZoneScopedN("TextureStreamer::Rebuild");
+
+	const uint32_t levelCount = texture.mipCount - baseMip;
+	const uint32_t oldBase = texture.residentMip;
+	StreamingResource* oldImage = texture.image;
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = texture.format;
+	imageInfo.extent = { MipExtent(texture.width, baseMip), MipExtent(texture.height, baseMip), 1 };
+	imageInfo.mipLevels = levelCount;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	// Staging first: nothing is recorded if either allocation fails
+	TransientBuffer staging{};
+	std::vector<VkBufferImageCopy> uploads;
+	if (job)
+	{
+		VkDeviceSize stagingSize = 0;
+		for (const std::span<const uint8_t>& level: job->levels)
+		{
+			stagingSize += (level.size() + 15) & ~VkDeviceSize(15); // Offsets must be block aligned
+		}
+
+		staging = m_Pools->AllocateTransient(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+		if (staging.buffer == VK_NULL_HANDLE)
+			return false;
+
+		VkDeviceSize offset = 0;
+		for (uint32_t mip = job->firstMip; mip < job->lastMip; ++mip)
+		{
+			const std::span<const uint8_t>& level = job->levels[mip - job->firstMip];
+			std::memcpy(static_cast<uint8_t*>(staging.mapped) + offset, level.data(), level.size());
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = offset;
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - baseMip, 0, 1 };
+			region.imageExtent = { MipExtent(texture.width, mip), MipExtent(texture.height, mip), 1 };
+			uploads.push_back(region);
+			offset += (level.size() + 15) & ~VkDeviceSize(15);
+		}
+	}
+
+	StreamingResource* image = m_Pools->CreateStreamingImage(imageInfo, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, texture.name.c_str());
+	if (!image)
+		return false;
+
+	const uint32_t bindlessIndex = m_Bindless->RegisterSampledImage(image->view);
+	if (bindlessIndex == INVALID_BINDLESS_INDEX)
+	{
+		m_Pools->ReleaseStreaming(image);
+		return false;
+	}
+
+	// Earlier frames may still be sampling the old image; the copy waits for them
+	VkImageMemoryBarrier2 toCopy[2];
+	uint32_t toCopyCount = 0;
+	toCopy[toCopyCount++] = ImageBarrier(image->image, levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	if (oldImage)
+	{
+		toCopy[toCopyCount++] = ImageBarrier(oldImage->image, texture.mipCount - oldBase, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, kSampleStages, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+	}
+	RecordImageBarriers(cmd, toCopy, toCopyCount);
+
+	// Levels both images hold move GPU-side, no transcode or upload
+	if (oldImage)
+	{
+		std::vector<VkImageCopy> copies;
+		for (uint32_t mip = std::max(baseMip, oldBase); mip < texture.mipCount; ++mip)
+		{
+			VkImageCopy region{};
+			region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - oldBase, 0, 1 };
+			region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - baseMip, 0, 1 };
+			region.extent = { MipExtent(texture.width, mip), MipExtent(texture.height, mip), 1 };
+			copies.push_back(region);
+		}
+		vkCmdCopyImage(cmd, oldImage->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+	}
+
+	if (!uploads.empty())
+	{
+		vkCmdCopyBufferToImage(cmd, staging.buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(uploads.size()), uploads.data());
+	}
+
+	const VkImageMemoryBarrier2 toRead = ImageBarrier(image->image, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, kSampleStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+	RecordImageBarriers(cmd, &toRead, 1);
+	image->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	// Both stay valid for the frames still in flight
+	if (oldImage)
+	{
+		m_Bindless->Release(BindlessType::SampledImage, texture.bindlessIndex);
+		m_Pools->ReleaseStreaming(oldImage);
+	}
+
+	m_Stats.residentBytes -= GetResidentBytes(texture, oldBase);
+	m_Stats.residentBytes += GetResidentBytes(texture, baseMip);
+	texture.image = image;
+	texture.bindlessIndex = bindlessIndex;
+	texture.residentMip = baseMip;
+	return true;
+}
+
+void TextureStreamer::OnImageMoved(const StreamingResource& resource)
+{
+	if (&resource == m_Fallback)
+	{
+		m_Bindless->Release(BindlessType::SampledImage, m_FallbackIndex);
+		m_FallbackIndex = m_Bindless->RegisterSampledImage(resource.view);
+		return;
+	}
+
+	for (const std::unique_ptr<Texture>& texture: m_Textures)
+	{
+		if (texture->image == &resource)
+		{
+			m_Bindless->Release(BindlessType::SampledImage, texture->bindlessIndex);
+			texture->bindlessIndex = m_Bindless->RegisterSampledImage(resource.view);
+			return;
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <vk_mem_alloc.h>
+
+#include "graphics/BindlessRegistry.hpp"
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/RenderConstants.hpp"
+
+class GpuMemoryPools;
+class GpuMemoryStats;
+struct StreamingResource;
+
+constexpr uint32_t INVALID_TEXTURE = UINT32_MAX;
+constexpr uint32_t MAX_STREAMED_TEXTURES = 4096;
+
+// Mip-by-mip texture streaming from KTX2 (Basis Universal) files and .wtex files cooked by WovenCook.
+// Files are read and transcoded to BCn on enkiTS workers (cooked mips are already BCn and are copied as-is);
+// the render thread only records copies.
+// Every texture keeps its small mip tail resident. Finer mips are requested by a GPU feedback buffer
+// (finest mip each texture was sampled at, see shaders/streaming.slang) and dropped again once unused
+// or when the resident total would exceed the budget, so any number of textures fits a fixed amount of VRAM.
+// Not thread-safe: call from the render thread only.
+class TextureStreamer
+{
+public:
+	TextureStreamer();
+	~TextureStreamer();
+
+	struct Stats
+	{
+		uint32_t textureCount = 0;
+		uint32_t jobsInFlight = 0;
+		VkDeviceSize residentBytes = 0;
+		VkDeviceSize budgetBytes = 0;
+		VkDeviceSize uploadedBytes = 0; // Last frame
+		uint32_t mipsStreamedIn = 0;    // Totals since startup
+		uint32_t mipsEvicted = 0;
+	};
+
+	// supportsBC = textureCompressionBC; without it KTX2 textures are transcoded to RGBA8 and .wtex files fail to load
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, GpuMemoryPools& pools, BindlessRegistry& bindless, enki::TaskScheduler* scheduler, uint32_t framesInFlight, uint32_t samplerIndex, bool supportsBC);
+	void Shutdown();
+
+	// Returns at once; the texture samples as a flat fallback until its mip tail has been transcoded
+	uint32_t Load(const std::filesystem::path& path);
+
+	// Outside rendering, before anything samples textures this frame. Reads back this slot's feedback,
+	// applies finished transcodes and evictions, and fills push.streaming.
+	void RecordStreaming(VkCommandBuffer cmd, uint32_t frameIndex, uint64_t frameNumber, PushConstants& push);
+
+	// After the last pass that samples streamed textures: copies the feedback into this slot's readback
+	void RecordFeedbackReadback(VkCommandBuffer cmd, uint32_t frameIndex);
+
+	void SetBudget(VkDeviceSize bytes)
+	{
+		m_Budget = bytes;
+	}
+
+	const Stats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+private:
+	struct Texture;
+	struct Job;
+
+	bool CreateFallback(VkCommandBuffer cmd);
+
+	void ReadFeedback(uint32_t frameIndex, uint64_t frameNumber);
+	void CompleteJobs(VkCommandBuffer cmd);
+	void Evict(VkCommandBuffer cmd, uint64_t frameNumber);
+	void LaunchJobs(uint64_t frameNumber);
+	void Submit(std::unique_ptr<Job> job);
+
+	// Replaces the texture's image with one holding mips [baseMip, mipCount): kept levels are copied
+	// on the GPU, levels the job produced are uploaded from a transient staging buffer
+	bool Rebuild(VkCommandBuffer cmd, Texture& texture, uint32_t baseMip, const Job* job);
+	void OnImageMoved(const StreamingResource& resource);
+
+	VkDeviceSize GetResidentBytes(const Texture& texture, uint32_t baseMip) const;
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	GpuMemoryPools* m_Pools = nullptr;
+	BindlessRegistry* m_Bindless = nullptr;
+	enki::TaskScheduler* m_Scheduler = nullptr;
+	uint32_t m_SamplerIndex = 0;
+	bool m_SupportsBC = false;
+
+	std::vector<std::unique_ptr<Texture>> m_Textures;
+	std::vector<std::unique_ptr<Job>> m_Jobs;
+
+	// Shown while a texture has nothing resident
+	StreamingResource* m_Fallback = nullptr;
+	uint32_t m_FallbackIndex = INVALID_BINDLESS_INDEX;
+
+	// Finest requested mip per texture, cleared every frame; one readback per frame slot
+	GpuBuffer m_Feedback;
+	std::vector<GpuBuffer> m_FeedbackReadback;
+	std::vector<uint32_t> m_FeedbackCounts; // Textures covered by each slot's readback
+	uint32_t m_FrameTextureCount = 0;       // Textures in this frame's table
+
+	VkDeviceSize m_Budget = 256ull * 1024 * 1024;
+	VkDeviceSize m_InFlightBytes = 0; // Resident growth the running jobs will add
+	Stats m_Stats;
+
+	// Scratch, kept to avoid per-frame allocations
+	std::vector<Texture*> m_Candidates;
+};
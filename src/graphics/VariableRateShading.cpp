@@ -0,0 +1,362 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuMemoryPools.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+#include "graphics/ShaderSystem.hpp"
+#include "graphics/VariableRateShading.hpp"
+
+namespace
+{
+
+	void RecordImageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.imageMemoryBarrierCount = 1;
+		depInfo.pImageMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(cmd, &depInfo);
+	}
+} // namespace
+
+bool VariableRateShading::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction, uint32_t framesInFlight)
+{
+	ZoneScopedN("VariableRateShading::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+	m_Bindless = &bindless;
+	m_Destruction = &destruction;
+
+	// R8_UINT is a required shading rate attachment format, but storage use of it is optional
+	VkFormatProperties formatProperties{};
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, kFormat, &formatProperties);
+	const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+	{
+		WOVEN_LOG_WARNING("R8_UINT cannot be written as a storage image and read as a shading rate attachment");
+		return false;
+	}
+
+	VkPhysicalDeviceFragmentShadingRatePropertiesKHR rateProperties{};
+	rateProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR;
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &rateProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	const VkExtent2D minTexel = rateProperties.minFragmentShadingRateAttachmentTexelSize;
+	const VkExtent2D maxTexel = rateProperties.maxFragmentShadingRateAttachmentTexelSize;
+	if (maxTexel.width == 0 || maxTexel.height == 0)
+	{
+		WOVEN_LOG_WARNING("Device reports no shading rate attachment texel sizes");
+		return false;
+	}
+	m_TexelSize = { std::clamp(kPreferredTexelSize, minTexel.width, maxTexel.width), std::clamp(kPreferredTexelSize, minTexel.height, maxTexel.height) };
+
+	ShaderCompileDesc analyzeDesc{};
+	analyzeDesc.filePath = "shaders/vrs.slang";
+	analyzeDesc.entryPoint = "analyzeMain";
+	analyzeDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	VkShaderEXT analyzeShader = VK_NULL_HANDLE;
+	if (!m_ShaderSystem->CreateShaderObject(analyzeDesc, analyzeShader))
+	{
+		Shutdown();
+		return false;
+	}
+
+	if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, SHADING_RATE_CLASS_COUNT * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::Device, "Shading Rate Counts", m_Counts))
+	{
+		m_ShaderSystem->DestroyShader(analyzeShader);
+		Shutdown();
+		return false;
+	}
+
+	m_CountReadback.resize(framesInFlight);
+	for (GpuBuffer& readback: m_CountReadback)
+	{
+		if (!CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, SHADING_RATE_CLASS_COUNT * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, GpuBufferAccess::HostReadback, "Shading Rate Readback", readback))
+		{
+			m_ShaderSystem->DestroyShader(analyzeShader);
+			Shutdown();
+			return false;
+		}
+		std::memset(readback.mapped, 0, SHADING_RATE_CLASS_COUNT * sizeof(uint32_t));
+	}
+
+	// A partial Initialize must not look initialized, and IsInitialized() only checks this shader
+	m_AnalyzeShader = analyzeShader;
+	WOVEN_LOG_INFO("Variable rate shading initialized: %ux%u pixels per rate texel", m_TexelSize.width, m_TexelSize.height);
+	return true;
+}
+
+void VariableRateShading::Shutdown()
+{
+	DestroyTarget(m_Target);
+	m_Extent = {};
+	m_RateExtent = {};
+
+	for (GpuBuffer& readback: m_CountReadback)
+	{
+		DestroyGpuBuffer(m_Allocator, m_MemoryStats, readback);
+	}
+	m_CountReadback.clear();
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_Counts);
+	m_RateCounts = {};
+
+	if (m_Bindless && m_ColorIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, m_ColorIndex);
+	}
+	m_ColorIndex = INVALID_BINDLESS_INDEX;
+	m_ColorView = VK_NULL_HANDLE;
+
+	if (m_ShaderSystem)
+	{
+		m_ShaderSystem->DestroyShader(m_AnalyzeShader);
+	}
+	m_AnalyzeShader = VK_NULL_HANDLE;
+	m_ShaderSystem = nullptr;
+}
+
+bool VariableRateShading::CreateTarget(VkExtent2D rateExtent)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent = { rateExtent.width, rateExtent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = kFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+	if (vmaCreateImage(m_Allocator, &imageInfo, &allocInfo, &m_Target.image, &m_Target.allocation, nullptr) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create shading rate image (%ux%u)", rateExtent.width, rateExtent.height);
+		m_Target = {};
+		return false;
+	}
+	m_MemoryStats->Track(m_Target.allocation, GpuMemoryCategory::RenderTarget, "Shading Rate Image");
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = m_Target.image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = kFormat;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &m_Target.view) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create shading rate image view");
+		DestroyTarget(m_Target);
+		return false;
+	}
+
+	m_Target.bindlessIndex = m_Bindless->RegisterStorageImage(m_Target.view);
+	if (m_Target.bindlessIndex == INVALID_BINDLESS_INDEX)
+	{
+		DestroyTarget(m_Target);
+		return false;
+	}
+	return true;
+}
+
+void VariableRateShading::DestroyTarget(Target& target)
+{
+	if (target.bindlessIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, target.bindlessIndex);
+	}
+	if (target.view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(m_Device, target.view, nullptr);
+	}
+	if (target.image != VK_NULL_HANDLE)
+	{
+		m_MemoryStats->Untrack(target.allocation);
+		vmaDestroyImage(m_Allocator, target.image, target.allocation);
+	}
+	target = {};
+}
+
+void VariableRateShading::RetireTarget(Target& target)
+{
+	if (target.bindlessIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, target.bindlessIndex);
+	}
+	m_Destruction->DestroyImageView(target.view);
+	m_Destruction->DestroyImage(target.image, target.allocation);
+	target = {};
+}
+
+bool VariableRateShading::RecordAnalysis(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, VkExtent2D extent, VkImageView colorView, bool hasHistory, float threshold, VkPipelineLayout layout, PushConstants push, const QueueTransfer& transfer)
+{
+	if (!IsInitialized() || extent.width == 0 || extent.height == 0)
+	{
+		return false;
+	}
+
+	ZoneScopedN("VariableRateShading::RecordAnalysis");
+
+	// Rate histogram of this slot's previous frame (GetRateCounts is that old)
+	GpuBuffer& readback = m_CountReadback[frameIndex];
+	vmaInvalidateAllocation(m_Allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+	std::memcpy(m_RateCounts.data(), readback.mapped, sizeof(m_RateCounts));
+
+	if (extent.width != m_Extent.width || extent.height != m_Extent.height)
+	{
+		// Frames in flight may still read the old rate image
+		RetireTarget(m_Target);
+		m_Extent = {};
+
+		const VkExtent2D rateExtent = { (extent.width + m_TexelSize.width - 1) / m_TexelSize.width, (extent.height + m_TexelSize.height - 1) / m_TexelSize.height };
+		if (!CreateTarget(rateExtent))
+		{
+			return false;
+		}
+		m_Extent = extent;
+		m_RateExtent = rateExtent;
+	}
+
+	// The HDR target's view changes when a swapchain recreation outgrows it; the registry keeps the old slot
+	// alive until the frames still reading it have retired
+	if (colorView != m_ColorView)
+	{
+		if (m_ColorIndex != INVALID_BINDLESS_INDEX)
+		{
+			m_Bindless->Release(BindlessType::StorageImage, m_ColorIndex);
+		}
+		m_ColorIndex = m_Bindless->RegisterStorageImage(colorView);
+		m_ColorView = (m_ColorIndex != INVALID_BINDLESS_INDEX) ? colorView : VK_NULL_HANDLE;
+	}
+
+	const TransientBuffer dataBuffer = pools.AllocateTransient(sizeof(GpuShadingRateData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	const bool analyze = hasHistory && m_ColorIndex != INVALID_BINDLESS_INDEX && dataBuffer.buffer != VK_NULL_HANDLE;
+
+	// Last frame's main pass and count copy are done with the rate image and the counts before they are rewritten.
+	// On the compute queue the wait on the graphics timeline already covers the main pass, and the shading rate
+	// stage does not exist there; the finished image is released to graphics instead of transitioned.
+	const bool asyncCompute = transfer.IsTransfer();
+	const VkPipelineStageFlags2 rateReadStage = asyncCompute ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	VkPipelineStageFlags2 rateWriteStage = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+	VkAccessFlags2 rateWriteAccess = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	VkImageLayout rateLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	if (!analyze)
+	{
+		// Nothing to measure (first frame, resize): everything at full rate
+		const uint32_t counts[SHADING_RATE_CLASS_COUNT] = { m_RateExtent.width * m_RateExtent.height, 0, 0, 0 };
+		vkCmdUpdateBuffer(cmd, m_Counts.buffer, 0, sizeof(counts), counts);
+		RecordImageBarrier(cmd, m_Target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, rateReadStage, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+		VkClearColorValue fullRate{};
+		VkImageSubresourceRange range{};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.levelCount = 1;
+		range.layerCount = 1;
+		vkCmdClearColorImage(cmd, m_Target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &fullRate, 1, &range);
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+	}
+	else
+	{
+		GpuShadingRateData data{};
+		data.rateCounts = m_Counts.address;
+		data.colorImage = m_ColorIndex;
+		data.rateImage = m_Target.bindlessIndex;
+		data.texelSize = glm::uvec2(m_TexelSize.width, m_TexelSize.height);
+		data.rateExtent = glm::uvec2(m_RateExtent.width, m_RateExtent.height);
+		data.threshold = threshold;
+		std::memcpy(dataBuffer.mapped, &data, sizeof(data));
+		push.shadingRate = dataBuffer.deviceAddress;
+
+		vkCmdFillBuffer(cmd, m_Counts.buffer, 0, VK_WHOLE_SIZE, 0);
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+		// Every rate texel is written, so the old contents can be discarded
+		RecordImageBarrier(cmd, m_Target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, rateReadStage, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+		const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		vkCmdBindShadersEXT(cmd, 1, &stage, &m_AnalyzeShader);
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+		vkCmdDispatch(cmd, m_RateExtent.width, m_RateExtent.height, 1);
+
+		RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+		rateWriteStage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		rateWriteAccess = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		rateLayout = VK_IMAGE_LAYOUT_GENERAL;
+	}
+
+	if (asyncCompute)
+	{
+		AsyncCompute::RecordImageRelease(cmd, m_Target.image, rateLayout, VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR, rateWriteStage, rateWriteAccess, transfer);
+		m_ReleasedLayout = rateLayout;
+	}
+	else
+	{
+		RecordImageBarrier(cmd, m_Target.image, rateLayout, VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR, rateWriteStage, rateWriteAccess, VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR, VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR);
+	}
+
+	const VkBufferCopy region{ 0, 0, sizeof(uint32_t) * SHADING_RATE_CLASS_COUNT };
+	vkCmdCopyBuffer(cmd, m_Counts.buffer, readback.buffer, 1, &region);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+	return true;
+}
+
+void VariableRateShading::RecordAcquire(VkCommandBuffer cmd, const QueueTransfer& transfer) const
+{
+	// Same layout transition as the release recorded on the compute queue
+	AsyncCompute::RecordImageAcquire(cmd, m_Target.image, m_ReleasedLayout, VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR, VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR, VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR, transfer);
+}
+
+VkRenderingFragmentShadingRateAttachmentInfoKHR VariableRateShading::GetAttachmentInfo() const
+{
+	VkRenderingFragmentShadingRateAttachmentInfoKHR info{};
+	info.sType = VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR;
+	info.imageView = m_Target.view;
+	info.imageLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+	info.shadingRateAttachmentTexelSize = m_TexelSize;
+	return info;
+}
+
+float VariableRateShading::GetShadedFraction() const
+{
+	// Classes 1x1, 1x2, 2x1, 2x2 shade 1, 1/2, 1/2 and 1/4 of their pixels
+	const uint32_t total = m_RateCounts[0] + m_RateCounts[1] + m_RateCounts[2] + m_RateCounts[3];
+	if (total == 0)
+	{
+		return 1.0f;
+	}
+	const float shaded = static_cast<float>(m_RateCounts[0]) + 0.5f * static_cast<float>(m_RateCounts[1] + m_RateCounts[2]) + 0.25f * static_cast<float>(m_RateCounts[3]);
+	return shaded / static_cast<float>(total);
+}
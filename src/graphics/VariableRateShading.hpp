@@ -0,0 +1,102 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <array>
+#include <vk_mem_alloc.h>
+
+#include "graphics/AsyncCompute.hpp"
+#include "graphics/BindlessRegistry.hpp"
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/RenderConstants.hpp"
+
+class DeferredDestruction;
+class GpuMemoryPools;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// Content-adaptive variable rate shading (shaders/vrs.slang).
+// Before the main pass, a compute pass measures last frame's luminance steps in the HDR target per rate
+// texel and writes a VK_KHR_fragment_shading_rate attachment: flat regions are shaded at 2x2, 2x1 or 1x2,
+// edges and texture detail stay at 1x1. The forward draws use the attachment rate; the software raster
+// resolve and the UI stay at full rate.
+class VariableRateShading
+{
+public:
+	static constexpr VkFormat kFormat = VK_FORMAT_R8_UINT;
+	static constexpr uint32_t kPreferredTexelSize = 16; // Clamped to the device's attachment texel size range
+
+	// Fails when the device cannot use kFormat as both a storage image and a shading rate attachment
+	bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction, uint32_t framesInFlight);
+	void Shutdown();
+
+	bool IsInitialized() const
+	{
+		return m_AnalyzeShader != VK_NULL_HANDLE;
+	}
+
+	// Outside rendering, before the main pass. Sizes the rate image to the frame and fills it from last frame's
+	// HDR target (colorView, in VK_IMAGE_LAYOUT_GENERAL), or with 1x1 when there is no history; leaves it in
+	// FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL. Also reads back the rate counts this frame slot copied last time.
+	// Returns false when there is no rate image to render with. On the async compute queue (transfer.IsTransfer())
+	// the image is released to the graphics queue, which calls RecordAcquire before the main pass.
+	bool RecordAnalysis(VkCommandBuffer cmd, GpuMemoryPools& pools, uint32_t frameIndex, VkExtent2D extent, VkImageView colorView, bool hasHistory, float threshold, VkPipelineLayout layout, PushConstants push, const QueueTransfer& transfer);
+	void RecordAcquire(VkCommandBuffer cmd, const QueueTransfer& transfer) const;
+
+	// Chained into the VkRenderingInfo of the pass drawing at the analysed rates
+	VkRenderingFragmentShadingRateAttachmentInfoKHR GetAttachmentInfo() const;
+
+	VkExtent2D GetTexelSize() const
+	{
+		return m_TexelSize;
+	}
+
+	// Rate texels per class (1x1, 1x2, 2x1, 2x2), framesInFlight frames old
+	const std::array<uint32_t, SHADING_RATE_CLASS_COUNT>& GetRateCounts() const
+	{
+		return m_RateCounts;
+	}
+
+	// Share of the pixels that got their own fragment shader invocation in the counted frame
+	float GetShadedFraction() const;
+
+private:
+	struct Target
+	{
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		uint32_t bindlessIndex = INVALID_BINDLESS_INDEX;
+	};
+
+	bool CreateTarget(VkExtent2D rateExtent);
+	void DestroyTarget(Target& target);
+	// For a rate image in-flight frames may still use: the slot goes back through the registry, the rest
+	// through deferred destruction
+	void RetireTarget(Target& target);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	BindlessRegistry* m_Bindless = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+
+	VkShaderEXT m_AnalyzeShader = VK_NULL_HANDLE;
+	VkExtent2D m_TexelSize = {};
+
+	Target m_Target;
+	VkExtent2D m_Extent = {};     // Frame size the rate image covers
+	VkExtent2D m_RateExtent = {}; // Rate texels
+	VkImageLayout m_ReleasedLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Layout the last queue family release started from
+
+	// The HDR target's storage image slot, re-registered when a swapchain recreation replaces its view
+	VkImageView m_ColorView = VK_NULL_HANDLE;
+	uint32_t m_ColorIndex = INVALID_BINDLESS_INDEX;
+
+	// Rate texels per class, reset every frame and copied to this frame slot's readback
+	GpuBuffer m_Counts;
+	std::vector<GpuBuffer> m_CountReadback;
+	std::array<uint32_t, SHADING_RATE_CLASS_COUNT> m_RateCounts = {};
+};
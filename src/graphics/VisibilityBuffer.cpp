@@ -0,0 +1,292 @@
+#include "pch.hpp"
+
+#include <volk.h>
+
+#include "core/Logger.hpp"
+#include "graphics/DeferredDestruction.hpp"
+#include "graphics/GpuMemoryStats.hpp"
+#include "graphics/ShaderSystem.hpp"
+#include "graphics/VisibilityBuffer.hpp"
+
+namespace
+{
+	// Per bucket: VkDispatchIndirectCommand, then the tile count the classify pass appends with
+	constexpr VkDeviceSize kBucketHeaderSize = 4 * sizeof(uint32_t);
+	constexpr VkDeviceSize kHeaderSize = MATERIAL_BUCKET_COUNT * kBucketHeaderSize;
+	constexpr VkBufferUsageFlags kTileUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+	void RecordImageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+
+		VkDependencyInfo depInfo{};
+		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		depInfo.imageMemoryBarrierCount = 1;
+		depInfo.pImageMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(cmd, &depInfo);
+	}
+} // namespace
+
+bool VisibilityBuffer::Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction)
+{
+	ZoneScopedN("VisibilityBuffer::Initialize");
+
+	m_Device = device;
+	m_Allocator = allocator;
+	m_MemoryStats = &memoryStats;
+	m_ShaderSystem = &shaderSystem;
+	m_Bindless = &bindless;
+	m_Destruction = &destruction;
+
+	ShaderCompileDesc fragmentDesc{};
+	fragmentDesc.filePath = "shaders/triangle.slang";
+	fragmentDesc.entryPoint = "visibilityMain";
+	fragmentDesc.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	ShaderCompileDesc classifyDesc{};
+	classifyDesc.filePath = "shaders/material.slang";
+	classifyDesc.entryPoint = "classifyMain";
+	classifyDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	ShaderCompileDesc shadeDesc{};
+	shadeDesc.filePath = "shaders/material.slang";
+	shadeDesc.entryPoint = "shadeMain";
+	shadeDesc.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	VkShaderEXT shadeShader = VK_NULL_HANDLE;
+	if (!m_ShaderSystem->CreateShaderObject(fragmentDesc, m_FragmentShader) || !m_ShaderSystem->CreateShaderObject(classifyDesc, m_ClassifyShader) || !m_ShaderSystem->CreateShaderObject(shadeDesc, shadeShader))
+	{
+		Shutdown();
+		return false;
+	}
+
+	// The shade shader doubles as the initialized flag, so it is stored once nothing else can fail
+	m_ShadeShader = shadeShader;
+	WOVEN_LOG_INFO("Visibility buffer initialized");
+	return true;
+}
+
+void VisibilityBuffer::Shutdown()
+{
+	DestroyTarget(m_Target);
+	DestroyGpuBuffer(m_Allocator, m_MemoryStats, m_Tiles);
+	m_Extent = {};
+	m_TileCapacity = 0;
+
+	if (m_Bindless && m_ColorIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, m_ColorIndex);
+	}
+	m_ColorIndex = INVALID_BINDLESS_INDEX;
+	m_ColorView = VK_NULL_HANDLE;
+
+	if (m_ShaderSystem)
+	{
+		m_ShaderSystem->DestroyShader(m_FragmentShader);
+		m_ShaderSystem->DestroyShader(m_ClassifyShader);
+		m_ShaderSystem->DestroyShader(m_ShadeShader);
+	}
+	m_FragmentShader = VK_NULL_HANDLE;
+	m_ClassifyShader = VK_NULL_HANDLE;
+	m_ShadeShader = VK_NULL_HANDLE;
+	m_ShaderSystem = nullptr;
+}
+
+bool VisibilityBuffer::CreateTarget(VkExtent2D extent)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent = { extent.width, extent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = kFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+	if (vmaCreateImage(m_Allocator, &imageInfo, &allocInfo, &m_Target.image, &m_Target.allocation, nullptr) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create visibility buffer (%ux%u)", extent.width, extent.height);
+		m_Target = {};
+		return false;
+	}
+	m_MemoryStats->Track(m_Target.allocation, GpuMemoryCategory::RenderTarget, "Visibility Buffer");
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = m_Target.image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = kFormat;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &m_Target.view) != VK_SUCCESS)
+	{
+		WOVEN_LOG_ERROR("Failed to create visibility buffer view");
+		DestroyTarget(m_Target);
+		return false;
+	}
+
+	m_Target.bindlessIndex = m_Bindless->RegisterStorageImage(m_Target.view);
+	if (m_Target.bindlessIndex == INVALID_BINDLESS_INDEX)
+	{
+		DestroyTarget(m_Target);
+		return false;
+	}
+	return true;
+}
+
+void VisibilityBuffer::DestroyTarget(Target& target)
+{
+	if (target.bindlessIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, target.bindlessIndex);
+	}
+	if (target.view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(m_Device, target.view, nullptr);
+	}
+	if (target.image != VK_NULL_HANDLE)
+	{
+		m_MemoryStats->Untrack(target.allocation);
+		vmaDestroyImage(m_Allocator, target.image, target.allocation);
+	}
+	target = {};
+}
+
+void VisibilityBuffer::RetireTarget(Target& target)
+{
+	if (target.bindlessIndex != INVALID_BINDLESS_INDEX)
+	{
+		m_Bindless->Release(BindlessType::StorageImage, target.bindlessIndex);
+	}
+	m_Destruction->DestroyImageView(target.view);
+	m_Destruction->DestroyImage(target.image, target.allocation);
+	target = {};
+}
+
+GpuCulling::MaterialPass VisibilityBuffer::RecordPrepare(VkCommandBuffer cmd, VkExtent2D extent, VkImageView colorView, const glm::vec4& backgroundColor)
+{
+	if (!IsInitialized() || extent.width == 0 || extent.height == 0)
+	{
+		return {};
+	}
+
+	ZoneScopedN("VisibilityBuffer::RecordPrepare");
+
+	if (extent.width != m_Extent.width || extent.height != m_Extent.height)
+	{
+		// Frames in flight may still use the old target and tiles
+		RetireTarget(m_Target);
+		m_Destruction->DestroyBuffer(m_Tiles.buffer, m_Tiles.allocation);
+		m_Tiles = {};
+		m_Extent = {};
+
+		const uint32_t tilesX = (extent.width + MATERIAL_TILE_SIZE - 1) / MATERIAL_TILE_SIZE;
+		const uint32_t tilesY = (extent.height + MATERIAL_TILE_SIZE - 1) / MATERIAL_TILE_SIZE;
+		m_TileCapacity = tilesX * tilesY;
+		if (!CreateTarget(extent) || !CreateGpuBuffer(m_Device, m_Allocator, m_MemoryStats, kHeaderSize + static_cast<VkDeviceSize>(MATERIAL_BUCKET_COUNT) * m_TileCapacity * sizeof(uint32_t), kTileUsage, GpuBufferAccess::Device, "Material Tiles", m_Tiles))
+		{
+			// Whichever was created is retired with the next successful resize, or destroyed in Shutdown
+			return {};
+		}
+		m_Extent = extent;
+	}
+
+	// Image views of the HDR target only change across a swapchain recreation (device idle), so the old slot can go now
+	if (colorView != m_ColorView)
+	{
+		if (m_ColorIndex != INVALID_BINDLESS_INDEX)
+		{
+			m_Bindless->Release(BindlessType::StorageImage, m_ColorIndex);
+		}
+		m_ColorIndex = m_Bindless->RegisterStorageImage(colorView);
+		m_ColorView = (m_ColorIndex != INVALID_BINDLESS_INDEX) ? colorView : VK_NULL_HANDLE;
+		if (m_ColorIndex == INVALID_BINDLESS_INDEX)
+		{
+			return {};
+		}
+	}
+
+	// Last frame's classify and shade are done with the lists and the ids before they are reset
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+	uint32_t headers[MATERIAL_BUCKET_COUNT * 4] = {};
+	for (uint32_t bucket = 0; bucket < MATERIAL_BUCKET_COUNT; ++bucket)
+	{
+		headers[bucket * 4 + 1] = 1;
+		headers[bucket * 4 + 2] = 1;
+	}
+	vkCmdUpdateBuffer(cmd, m_Tiles.buffer, 0, sizeof(headers), headers);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	RecordImageBarrier(cmd, m_Target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+
+	GpuCulling::MaterialPass materialPass;
+	materialPass.dispatch = m_Tiles.address;
+	materialPass.tiles = m_Tiles.address + kHeaderSize;
+	materialPass.visibilityImage = m_Target.bindlessIndex;
+	materialPass.colorImage = m_ColorIndex;
+	materialPass.tileCapacity = m_TileCapacity;
+	materialPass.backgroundColor = backgroundColor;
+	return materialPass;
+}
+
+VkRenderingAttachmentInfo VisibilityBuffer::GetAttachment() const
+{
+	VkRenderingAttachmentInfo attachment{};
+	attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	attachment.imageView = m_Target.view;
+	attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachment.clearValue.color.uint32[0] = VISIBILITY_ID_EMPTY;
+	attachment.clearValue.color.uint32[1] = VISIBILITY_ID_EMPTY;
+	return attachment;
+}
+
+void VisibilityBuffer::RecordMaterialPass(VkCommandBuffer cmd, VkPipelineLayout layout, PushConstants push)
+{
+	if (m_Extent.width == 0 || push.drawData == 0 || push.streaming == 0)
+	{
+		return;
+	}
+
+	ZoneScopedN("VisibilityBuffer::RecordMaterialPass");
+
+	RecordImageBarrier(cmd, m_Target.image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+	const VkShaderStageFlagBits stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	vkCmdBindShadersEXT(cmd, 1, &stage, &m_ClassifyShader);
+	vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+	vkCmdDispatch(cmd, (m_Extent.width + MATERIAL_TILE_SIZE - 1) / MATERIAL_TILE_SIZE, (m_Extent.height + MATERIAL_TILE_SIZE - 1) / MATERIAL_TILE_SIZE, 1);
+	RecordMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+	// One dispatch per bucket over only the tiles that contain it, so each could get its own shader later
+	vkCmdBindShadersEXT(cmd, 1, &stage, &m_ShadeShader);
+	for (uint32_t bucket = 0; bucket < MATERIAL_BUCKET_COUNT; ++bucket)
+	{
+		push.drawBucket = bucket;
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push);
+		vkCmdDispatchIndirect(cmd, m_Tiles.buffer, bucket * kBucketHeaderSize);
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vk_mem_alloc.h>
+
+#include "graphics/BindlessRegistry.hpp"
+#include "graphics/GpuBuffer.hpp"
+#include "graphics/GpuCulling.hpp"
+
+class DeferredDestruction;
+class GpuMemoryStats;
+class ShaderSystem;
+
+// Visibility buffer rendering mode (shaders/material.slang).
+// The raster pass writes only (instance, meshlet << 7 | triangle) per pixel into an R32G32_UINT target.
+// A compute pass then bins 8x8 tiles by the material buckets they contain, and one indirect dispatch
+// per bucket rebuilds each pixel's triangle and shades it into the HDR target. Shading cost follows
+// the pixel count instead of overdraw and triangle density.
+class VisibilityBuffer
+{
+public:
+	static constexpr VkFormat kFormat = VK_FORMAT_R32G32_UINT;
+
+	bool Initialize(VkDevice device, VmaAllocator allocator, GpuMemoryStats& memoryStats, ShaderSystem& shaderSystem, BindlessRegistry& bindless, DeferredDestruction& destruction);
+	void Shutdown();
+
+	bool IsInitialized() const
+	{
+		return m_ShadeShader != VK_NULL_HANDLE;
+	}
+
+	// Outside rendering, before the cull: sizes the id target and tile lists to the frame, resets the lists and
+	// moves the id target to COLOR_ATTACHMENT_OPTIMAL (contents discarded, the raster pass clears it).
+	// colorView is the HDR target the material pass shades into. Returns what the cull passes on to the shaders.
+	GpuCulling::MaterialPass RecordPrepare(VkCommandBuffer cmd, VkExtent2D extent, VkImageView colorView, const glm::vec4& backgroundColor);
+
+	// Attachment for the raster pass, cleared to VISIBILITY_ID_EMPTY
+	VkRenderingAttachmentInfo GetAttachment() const;
+
+	// Fragment shader writing the ids (triangle.slang visibilityMain)
+	VkShaderEXT GetFragmentShader() const
+	{
+		return m_FragmentShader;
+	}
+
+	// Outside rendering, after the raster pass. The color target must be in VK_IMAGE_LAYOUT_GENERAL.
+	void RecordMaterialPass(VkCommandBuffer cmd, VkPipelineLayout layout, PushConstants push);
+
+private:
+	struct Target
+	{
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		uint32_t bindlessIndex = INVALID_BINDLESS_INDEX;
+	};
+
+	bool CreateTarget(VkExtent2D extent);
+	void DestroyTarget(Target& target);
+	// For targets in-flight frames may still use: the slot goes back through the registry, the rest through
+	// deferred destruction
+	void RetireTarget(Target& target);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VmaAllocator m_Allocator = VK_NULL_HANDLE;
+	GpuMemoryStats* m_MemoryStats = nullptr;
+	ShaderSystem* m_ShaderSystem = nullptr;
+	BindlessRegistry* m_Bindless = nullptr;
+	DeferredDestruction* m_Destruction = nullptr;
+
+	VkShaderEXT m_FragmentShader = VK_NULL_HANDLE;
+	VkShaderEXT m_ClassifyShader = VK_NULL_HANDLE;
+	VkShaderEXT m_ShadeShader = VK_NULL_HANDLE;
+
+	Target m_Target;
+	GpuBuffer m_Tiles; // Per bucket VkDispatchIndirectCommand + tile count, then per bucket m_TileCapacity tiles
+	VkExtent2D m_Extent = {};
+	uint32_t m_TileCapacity = 0;
+
+	// The HDR target's storage image slot, re-registered when a resize replaces its view
+	VkImageView m_ColorView = VK_NULL_HANDLE;
+	uint32_t m_ColorIndex = INVALID_BINDLESS_INDEX;
+};
@@ -5,6 +5,7 @@
 #include <SDL3/SDL_main.h>
 
 #include "core/Application.hpp"
+#include "core/LaunchOptions.hpp"
 
 // SDL3 Callback: Init
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[])
@@ -12,7 +13,7 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[])
 	auto* app = new Application();
 	*appstate = app;
 
-	if (!app->Init())
+	if (!app->Init(LaunchOptions::Parse(argc, argv)))
 	{
 		SDL_Log("Failed to initialize application");
 		delete app;
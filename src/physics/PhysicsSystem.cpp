@@ -16,7 +16,7 @@ bool PhysicsSystem::Initialize()
 	ZoneScopedN("PhysicsSystem::Initialize");
 
 	JPH::RegisterDefaultAllocator();
-	Logger::Debug("Jolt Physics initialized");
+	WOVEN_LOG_DEBUG("Jolt Physics initialized");
 	return true;
 }
 
@@ -19,7 +19,7 @@ bool TaskSchedulingSystem::Initialize()
 	m_TaskScheduler.Initialize(config);
 
 	uint32_t numThreads = m_TaskScheduler.GetNumTaskThreads();
-	Logger::Info("Task Scheduler initialized with %u worker threads", numThreads);
+	WOVEN_LOG_INFO("Task Scheduler initialized with %u worker threads", numThreads);
 	return true;
 }
 
@@ -20,18 +20,32 @@ bool WindowSystem::Initialize()
 
 	if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMEPAD))
 	{
-		Logger::Error("Failed to initialize SDL: %s", SDL_GetError());
+		WOVEN_LOG_ERROR("Failed to initialize SDL: %s", SDL_GetError());
 		return false;
 	}
 
 	m_Window = SDL_CreateWindow("Woven Core", 1920, 1080, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 	if (!m_Window)
 	{
-		Logger::Error("Failed to create window: %s", SDL_GetError());
+		WOVEN_LOG_ERROR("Failed to create window: %s", SDL_GetError());
 		return false;
 	}
 
-	Logger::Info("SDL initialized (1920x1080, Vulkan)");
+	WOVEN_LOG_INFO("SDL initialized (1920x1080, Vulkan)");
+	return true;
+}
+
+bool WindowSystem::InitializeHeadless()
+{
+	ZoneScopedN("WindowSystem::InitializeHeadless");
+
+	if (!SDL_Init(SDL_INIT_EVENTS))
+	{
+		WOVEN_LOG_ERROR("Failed to initialize SDL: %s", SDL_GetError());
+		return false;
+	}
+
+	WOVEN_LOG_INFO("SDL initialized (headless)");
 	return true;
 }
 
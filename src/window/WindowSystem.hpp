@@ -9,6 +9,8 @@ public:
 	~WindowSystem();
 
 	bool Initialize();
+	// Event loop only; no window is created
+	bool InitializeHeadless();
 	void Shutdown();
 	void ProcessEvent(const SDL_Event& event);
 
@@ -0,0 +1,498 @@
+#include "pch.hpp"
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#	define NOMINMAX
+#	include <Windows.h>
+#	include <Psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+#include "core/FileSystem.hpp"
+#include "core/FrameStatistics.hpp"
+#include "core/JsonWriter.hpp"
+#include "core/LaunchOptions.hpp"
+#include "core/Logger.hpp"
+#include "graphics/CameraPath.hpp"
+#include "graphics/FrameCapture.hpp"
+#include "graphics/GraphicsSystem.hpp"
+#include "window/WindowSystem.hpp"
+
+// WovenBench: deterministic frame benchmark.
+// Renders headless with a fixed timestep along a scripted camera path, then writes a JSON report
+// (CPU/GPU percentiles, per-pass GPU timings, memory high-water marks) for build-to-build comparison.
+// With --replay it renders one captured frame (FrameCapture) over and over instead.
+
+namespace
+{
+	struct BenchOptions
+	{
+		std::filesystem::path cameraPath;
+		std::filesystem::path replayPath;
+		std::filesystem::path outputPath = "bench_report.json";
+		std::filesystem::path capturePath;
+		std::string label;
+		uint32_t warmupFrames = 60;
+		uint32_t measuredFrames = 600;
+		uint32_t width = 1920;
+		uint32_t height = 1080;
+		double timestep = 1.0 / 60.0;
+		bool descriptorSets = false;
+		uint32_t instanceCount = 1;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: WovenBench [options]\n"
+		            "  --path <file>      Camera path to replay (default: assets/camera_paths/flythrough.campath)\n"
+		            "  --replay <file>    Re-render a .wcap frame capture every frame; its extent and scene replace\n"
+		            "                     --width, --height and --instances\n"
+		            "  --warmup <n>       Frames rendered before measuring (default: 60)\n"
+		            "  --frames <n>       Measured frames (default: 600)\n"
+		            "  --width <px>       Render width (default: 1920)\n"
+		            "  --height <px>      Render height (default: 1080)\n"
+		            "  --dt <seconds>     Fixed timestep per frame (default: 1/60)\n"
+		            "  --output <file>    JSON report path (default: bench_report.json)\n"
+		            "  --label <text>     Free-form build label stored in the report\n"
+		            "  --capture <file>   Save the last frame as BMP\n"
+		            "  --descriptors <m>  Bindless backend: buffer (default when supported) or sets\n"
+		            "  --instances <n>    Demo instances fed through GPU culling (default: 1)\n");
+	}
+
+	bool ParseOptions(int argc, char* argv[], BenchOptions& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* arg = argv[i];
+			const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+			bool valid = true;
+
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				return false;
+			}
+			else if (!next)
+			{
+				WOVEN_LOG_ERROR("Missing value for %s", arg);
+				return false;
+			}
+			else if (std::strcmp(arg, "--path") == 0)
+				options.cameraPath = next;
+			else if (std::strcmp(arg, "--replay") == 0)
+				options.replayPath = next;
+			else if (std::strcmp(arg, "--output") == 0)
+				options.outputPath = next;
+			else if (std::strcmp(arg, "--capture") == 0)
+				options.capturePath = next;
+			else if (std::strcmp(arg, "--label") == 0)
+				options.label = next;
+			else if (std::strcmp(arg, "--warmup") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.warmupFrames);
+			else if (std::strcmp(arg, "--frames") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.measuredFrames) && options.measuredFrames > 0;
+			else if (std::strcmp(arg, "--width") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.width) && options.width > 0;
+			else if (std::strcmp(arg, "--height") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.height) && options.height > 0;
+			else if (std::strcmp(arg, "--instances") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.instanceCount) && options.instanceCount > 0;
+			else if (std::strcmp(arg, "--descriptors") == 0)
+			{
+				options.descriptorSets = std::strcmp(next, "sets") == 0;
+				valid = options.descriptorSets || std::strcmp(next, "buffer") == 0;
+			}
+			else if (std::strcmp(arg, "--dt") == 0)
+			{
+				char* end = nullptr;
+				options.timestep = std::strtod(next, &end);
+				valid = end != next && *end == '\0' && options.timestep > 0.0;
+			}
+			else
+			{
+				WOVEN_LOG_ERROR("Unknown argument: %s", arg);
+				PrintUsage();
+				return false;
+			}
+
+			if (!valid)
+			{
+				WOVEN_LOG_ERROR("Invalid value for %s: %s", arg, next);
+				return false;
+			}
+			++i;
+		}
+		return true;
+	}
+
+	// Peak resident set size of the process (0 if unavailable)
+	uint64_t GetPeakProcessMemory()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+		}
+		return 0;
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+		{
+			return 0;
+		}
+#	if defined(__APPLE__)
+		return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+#	else
+		return static_cast<uint64_t>(usage.ru_maxrss) * 1024ull; // kilobytes
+#	endif
+#endif
+	}
+
+	// Tracks the highest VMA usage seen per memory heap
+	class GpuMemoryHighWater
+	{
+	public:
+		void Sample(VmaAllocator allocator)
+		{
+			const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+			vmaGetMemoryProperties(allocator, &memoryProperties);
+			const uint32_t heapCount = memoryProperties->memoryHeapCount;
+
+			VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+			vmaGetHeapBudgets(allocator, budgets);
+
+			m_Heaps.resize(heapCount);
+			uint64_t totalUsage = 0;
+			for (uint32_t heap = 0; heap < heapCount; ++heap)
+			{
+				HeapPeak& peak = m_Heaps[heap];
+				peak.size = memoryProperties->memoryHeaps[heap].size;
+				peak.deviceLocal = (memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+				peak.usage = std::max<uint64_t>(peak.usage, budgets[heap].usage);
+				peak.allocationBytes = std::max<uint64_t>(peak.allocationBytes, budgets[heap].statistics.allocationBytes);
+				peak.budget = budgets[heap].budget;
+				totalUsage += budgets[heap].usage;
+			}
+			m_TotalUsage = std::max(m_TotalUsage, totalUsage);
+		}
+
+		void WriteJson(JsonWriter& writer) const
+		{
+			writer.Field("gpuPeakUsageBytes", m_TotalUsage);
+			writer.Key("gpuHeaps");
+			writer.BeginArray();
+			for (const HeapPeak& peak: m_Heaps)
+			{
+				writer.BeginObject();
+				writer.Field("deviceLocal", peak.deviceLocal);
+				writer.Field("sizeBytes", peak.size);
+				writer.Field("budgetBytes", peak.budget);
+				writer.Field("peakUsageBytes", peak.usage);
+				writer.Field("peakAllocationBytes", peak.allocationBytes);
+				writer.EndObject();
+			}
+			writer.EndArray();
+		}
+
+		uint64_t GetTotalUsage() const
+		{
+			return m_TotalUsage;
+		}
+
+	private:
+		struct HeapPeak
+		{
+			bool deviceLocal = false;
+			uint64_t size = 0;
+			uint64_t budget = 0;
+			uint64_t usage = 0;
+			uint64_t allocationBytes = 0;
+		};
+
+		std::vector<HeapPeak> m_Heaps;
+		uint64_t m_TotalUsage = 0;
+	};
+
+	// Per-pass GPU samples in first-seen order
+	class PassTimings
+	{
+	public:
+		void Record(const GpuFrameTiming& timing)
+		{
+			for (const GpuPassTiming& pass: timing.passes)
+			{
+				auto it = std::find_if(m_Passes.begin(), m_Passes.end(), [&](const auto& entry) { return entry.first == pass.name; });
+				if (it == m_Passes.end())
+				{
+					m_Passes.emplace_back(pass.name, std::vector<double>());
+					it = m_Passes.end() - 1;
+				}
+				it->second.push_back(pass.gpuMs);
+			}
+		}
+
+		void WriteJson(JsonWriter& writer) const
+		{
+			writer.BeginObject();
+			for (const auto& [name, samples]: m_Passes)
+			{
+				writer.Key(name);
+				FrameStatistics::WriteSummaryJson(writer, FrameStatistics::Summarize(samples));
+			}
+			writer.EndObject();
+		}
+
+		void LogSummary() const
+		{
+			for (const auto& [name, samples]: m_Passes)
+			{
+				const FrameStatistics::Summary summary = FrameStatistics::Summarize(samples);
+				WOVEN_LOG_INFO("Pass %-12s mean %.3f | p50 %.3f | p95 %.3f | p99 %.3f ms", name.c_str(), summary.mean, summary.p50, summary.p95, summary.p99);
+			}
+		}
+
+	private:
+		std::vector<std::pair<std::string, std::vector<double>>> m_Passes;
+	};
+
+	class Benchmark
+	{
+	public:
+		explicit Benchmark(const BenchOptions& options)
+		      : m_Options(options), m_Replay(!options.replayPath.empty())
+		{
+		}
+
+		bool Run()
+		{
+			ZoneScopedN("Benchmark::Run");
+
+			if (m_Replay ? !LoadCapture() : !LoadCameraPath())
+				return false;
+
+			if (!m_Window.InitializeHeadless())
+				return false;
+
+			m_Graphics.SetPreferDescriptorBuffer(!m_Options.descriptorSets);
+			m_Graphics.SetDemoInstanceCount(m_Options.instanceCount);
+			if (!m_Graphics.InitializeHeadless(m_Options.width, m_Options.height))
+				return false;
+
+			if (m_Replay && !m_Graphics.ApplyFrameCapture(m_Capture))
+				return false;
+
+			m_Graphics.SetGpuTimingCapture(true);
+
+			WOVEN_LOG_INFO("Benchmark: %u warmup + %u measured frames at %ux%u, dt %.4f s", m_Options.warmupFrames, m_Options.measuredFrames, m_Options.width, m_Options.height, m_Options.timestep);
+
+			const uint32_t totalFrames = m_Options.warmupFrames + m_Options.measuredFrames;
+			for (uint32_t frame = 0; frame < totalFrames; ++frame)
+			{
+				if (frame == m_Options.warmupFrames)
+				{
+					BeginMeasurement();
+				}
+
+				if (!RenderFrame(frame))
+				{
+					WOVEN_LOG_ERROR("Benchmark aborted at frame %u", frame);
+					return false;
+				}
+			}
+
+			// Drain the GPU so the last frames' timestamps resolve
+			m_Graphics.WaitIdle();
+			CollectGpuTimings();
+			m_GpuMemory.Sample(m_Graphics.GetAllocator());
+
+			Report();
+			return true;
+		}
+
+		void Shutdown()
+		{
+			m_Graphics.Shutdown();
+			m_Window.Shutdown();
+		}
+
+	private:
+		bool LoadCapture()
+		{
+			if (!m_Capture.LoadFromFile(m_Options.replayPath))
+				return false;
+
+			// The capture's scene slots map onto demo instances, and it is rendered at the extent it was captured at
+			m_Options.width = m_Capture.header.width;
+			m_Options.height = m_Capture.header.height;
+			m_Options.instanceCount = std::max(m_Capture.header.slotCount, 1u);
+			m_CameraPathName = m_Options.replayPath.filename().string();
+			return true;
+		}
+
+		bool LoadCameraPath()
+		{
+			std::filesystem::path path = m_Options.cameraPath;
+			if (path.empty())
+			{
+				path = FileSystem::GetAssetsDir() / "camera_paths" / "flythrough.campath";
+				if (!std::filesystem::exists(path))
+				{
+					WOVEN_LOG_WARNING("Default camera path not found, using a generated orbit");
+					m_CameraPath = CameraPath::CreateOrbit(6.0f, 1.0f, 10.0f);
+					m_CameraPathName = "orbit";
+					return true;
+				}
+			}
+
+			m_CameraPathName = path.filename().string();
+			return m_CameraPath.LoadFromFile(path);
+		}
+
+		void BeginMeasurement()
+		{
+			// Warmup timings that resolve late must not leak into the measured set
+			m_FirstMeasuredFrame = m_Graphics.GetFrameNumber();
+			m_Stats.Reset(m_FirstMeasuredFrame);
+			m_Measuring = true;
+		}
+
+		bool RenderFrame(uint32_t frame)
+		{
+			ZoneScopedN("Benchmark::RenderFrame");
+
+			// Fixed timestep: animation and camera depend only on the frame index. A replay keeps the captured
+			// time and camera, so every frame is the same frame.
+			const double time = m_Replay ? static_cast<double>(m_Capture.header.time) : static_cast<double>(frame) * m_Options.timestep;
+			if (!m_Replay)
+			{
+				m_CameraPath.Apply(m_Graphics.GetCamera(), static_cast<float>(time));
+			}
+
+			SDL_PumpEvents();
+			m_Graphics.UpdateProfiler();
+
+			const uint64_t frameNumber = m_Graphics.GetFrameNumber();
+			const uint64_t cpuStart = SDL_GetPerformanceCounter();
+			const bool rendered = m_Graphics.RenderFrame(static_cast<float>(time));
+			const uint64_t cpuEnd = SDL_GetPerformanceCounter();
+
+			if (m_Measuring)
+			{
+				const double cpuMs = static_cast<double>(cpuEnd - cpuStart) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+				m_Stats.RecordCpuTime(frameNumber, cpuMs);
+			}
+
+			CollectGpuTimings();
+			m_GpuMemory.Sample(m_Graphics.GetAllocator());
+			return rendered;
+		}
+
+		void CollectGpuTimings()
+		{
+			for (const GpuFrameTiming& timing: m_Graphics.ConsumeGpuTimings())
+			{
+				if (!m_Measuring || timing.frameNumber < m_FirstMeasuredFrame)
+				{
+					continue;
+				}
+				m_Stats.RecordGpuTime(timing.frameNumber, timing.gpuMs);
+				m_PassTimings.Record(timing);
+			}
+		}
+
+		void Report()
+		{
+			m_Stats.LogSummary();
+			m_PassTimings.LogSummary();
+
+			const uint64_t processPeak = GetPeakProcessMemory();
+			WOVEN_LOG_INFO("Memory peak: GPU %.1f MiB | process %.1f MiB", static_cast<double>(m_GpuMemory.GetTotalUsage()) / (1024.0 * 1024.0), static_cast<double>(processPeak) / (1024.0 * 1024.0));
+
+			JsonWriter writer;
+			writer.BeginObject();
+			writer.Field("label", m_Options.label);
+			writer.Field("device", m_Graphics.GetDeviceName());
+			writer.Field("descriptorBackend", m_Graphics.UsesDescriptorBuffer() ? "buffer" : "sets");
+			writer.Field("instances", m_Graphics.GetDemoInstanceCount());
+			writer.Field("width", m_Options.width);
+			writer.Field("height", m_Options.height);
+			writer.Field(m_Replay ? "replay" : "cameraPath", m_CameraPathName);
+			if (m_Replay)
+			{
+				writer.Field("capturedFrame", m_Capture.header.frameNumber);
+			}
+			writer.Field("timestep", m_Options.timestep);
+			writer.Field("warmupFrames", m_Options.warmupFrames);
+			writer.Field("measuredFrames", m_Options.measuredFrames);
+
+			m_Stats.WriteJson(writer);
+
+			writer.Key("passes");
+			m_PassTimings.WriteJson(writer);
+
+			writer.Key("memory");
+			writer.BeginObject();
+			writer.Field("processPeakBytes", processPeak);
+			m_GpuMemory.WriteJson(writer);
+			writer.Key("final");
+			m_Graphics.GetMemoryStats().WriteJson(writer);
+			writer.EndObject();
+
+			writer.EndObject();
+
+			if (writer.WriteToFile(m_Options.outputPath))
+				WOVEN_LOG_INFO("Wrote benchmark report to %s", m_Options.outputPath.string().c_str());
+			else
+				WOVEN_LOG_ERROR("Failed to write benchmark report %s", m_Options.outputPath.string().c_str());
+
+			if (!m_Options.capturePath.empty())
+			{
+				m_Graphics.SaveLastFrameImage(m_Options.capturePath);
+			}
+		}
+
+	private:
+		BenchOptions m_Options;
+		WindowSystem m_Window;
+		GraphicsSystem m_Graphics;
+		CameraPath m_CameraPath;
+		std::string m_CameraPathName;
+		bool m_Replay = false;
+		FrameCapture m_Capture;
+
+		FrameStatistics m_Stats;
+		PassTimings m_PassTimings;
+		GpuMemoryHighWater m_GpuMemory;
+		uint64_t m_FirstMeasuredFrame = 0;
+		bool m_Measuring = false;
+	};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Logger::Init();
+
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	Benchmark benchmark(options);
+	const bool success = benchmark.Run();
+	benchmark.Shutdown();
+
+	Logger::Shutdown();
+	return success ? 0 : 1;
+}
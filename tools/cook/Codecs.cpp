@@ -0,0 +1,9 @@
+// Third-party codec implementations used only by WovenCook - each must be in exactly one translation unit
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#include <stb_image.h>
+
+#define RGBCX_IMPLEMENTATION
+#include <rgbcx.h>
@@ -0,0 +1,319 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bc7enc.h>
+#include <cmath>
+#include <cstring>
+#include <rgbcx.h>
+#include <stb_image.h>
+
+#include "core/Logger.hpp"
+#include "TextureCooker.hpp"
+
+namespace
+{
+	constexpr uint32_t kMinBlocksPerTask = 256;
+
+	struct Mip
+	{
+		std::vector<uint8_t> rgba; // Quantized input for the encoder
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t blocksX = 0;
+		uint32_t firstBlock = 0; // Index of this mip's first block across the whole chain
+		uint64_t offset = 0;     // Into the output file
+	};
+
+	float SrgbToLinear(float c)
+	{
+		return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float c)
+	{
+		return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+	}
+
+	uint8_t ToUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	// Filtering happens in linear space: sRGB colours are linearized, normals are unpacked to [-1, 1]
+	std::vector<glm::vec4> Unpack(const uint8_t* rgba, uint32_t width, uint32_t height, TextureCooker::Usage usage)
+	{
+		std::array<float, 256> table;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			const float unorm = static_cast<float>(i) / 255.0f;
+			table[i] = (usage == TextureCooker::Usage::Color) ? SrgbToLinear(unorm) : unorm;
+		}
+
+		std::vector<glm::vec4> pixels(static_cast<size_t>(width) * height);
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			const uint8_t* p = rgba + i * 4;
+			glm::vec4 pixel(table[p[0]], table[p[1]], table[p[2]], static_cast<float>(p[3]) / 255.0f);
+			if (usage == TextureCooker::Usage::Normal)
+			{
+				pixel = glm::vec4(glm::vec3(pixel) * 2.0f - 1.0f, 1.0f);
+			}
+			pixels[i] = pixel;
+		}
+		return pixels;
+	}
+
+	void Pack(const std::vector<glm::vec4>& pixels, TextureCooker::Usage usage, std::vector<uint8_t>& outRgba)
+	{
+		outRgba.resize(pixels.size() * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			glm::vec4 pixel = pixels[i];
+			if (usage == TextureCooker::Usage::Color)
+			{
+				pixel = glm::vec4(LinearToSrgb(pixel.r), LinearToSrgb(pixel.g), LinearToSrgb(pixel.b), pixel.a);
+			}
+			else if (usage == TextureCooker::Usage::Normal)
+			{
+				pixel = glm::vec4(glm::vec3(pixel) * 0.5f + 0.5f, 1.0f);
+			}
+
+			uint8_t* p = outRgba.data() + i * 4;
+			p[0] = ToUnorm8(pixel.r);
+			p[1] = ToUnorm8(pixel.g);
+			p[2] = ToUnorm8(pixel.b);
+			p[3] = ToUnorm8(pixel.a);
+		}
+	}
+
+	// 2x2 box filter; odd edges reuse the last row/column. Normals are renormalized so lower mips don't flatten.
+	std::vector<glm::vec4> Downsample(const std::vector<glm::vec4>& src, uint32_t width, uint32_t height, TextureCooker::Usage usage)
+	{
+		const uint32_t dstWidth = std::max(1u, width / 2);
+		const uint32_t dstHeight = std::max(1u, height / 2);
+		std::vector<glm::vec4> dst(static_cast<size_t>(dstWidth) * dstHeight);
+		for (uint32_t y = 0; y < dstHeight; ++y)
+		{
+			const uint32_t y0 = std::min(y * 2, height - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < dstWidth; ++x)
+			{
+				const uint32_t x0 = std::min(x * 2, width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				glm::vec4 sum = src[y0 * width + x0] + src[y0 * width + x1] + src[y1 * width + x0] + src[y1 * width + x1];
+				sum *= 0.25f;
+
+				if (usage == TextureCooker::Usage::Normal)
+				{
+					const glm::vec3 normal(sum);
+					const float length = glm::length(normal);
+					sum = glm::vec4((length > 1e-6f) ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f), 1.0f);
+				}
+				dst[static_cast<size_t>(y) * dstWidth + x] = sum;
+			}
+		}
+		return dst;
+	}
+
+	// One task set covers every block of every mip, so small mips don't serialize behind large ones
+	struct EncodeTask: enki::ITaskSet
+	{
+		const std::vector<Mip>* mips = nullptr;
+		TextureCooker::Usage usage = TextureCooker::Usage::Color;
+		const bc7enc_compress_block_params* bc7Params = nullptr;
+		uint32_t bc1Level = 0;
+		uint32_t blockBytes = 0;
+		uint8_t* output = nullptr;
+
+		void ExecuteRange(enki::TaskSetPartition range, uint32_t) override
+		{
+			ZoneScopedN("Encode Blocks");
+
+			uint8_t block[16 * 4];
+			for (uint32_t index = range.start; index < range.end; ++index)
+			{
+				const auto next = std::upper_bound(mips->begin(), mips->end(), index, [](uint32_t value, const Mip& mip) { return value < mip.firstBlock; });
+				const Mip& mip = *(next - 1);
+				const uint32_t local = index - mip.firstBlock;
+				const uint32_t blockX = (local % mip.blocksX) * 4;
+				const uint32_t blockY = (local / mip.blocksX) * 4;
+
+				// Blocks hanging over the edge of small or odd mips repeat the edge texels
+				for (uint32_t y = 0; y < 4; ++y)
+				{
+					const uint32_t sy = std::min(blockY + y, mip.height - 1);
+					for (uint32_t x = 0; x < 4; ++x)
+					{
+						const uint32_t sx = std::min(blockX + x, mip.width - 1);
+						std::memcpy(block + (y * 4 + x) * 4, mip.rgba.data() + (static_cast<size_t>(sy) * mip.width + sx) * 4, 4);
+					}
+				}
+
+				uint8_t* dst = output + mip.offset + static_cast<uint64_t>(local) * blockBytes;
+				switch (usage)
+				{
+					case TextureCooker::Usage::Color:
+						bc7enc_compress_block(dst, block, bc7Params);
+						break;
+					case TextureCooker::Usage::Normal:
+						rgbcx::encode_bc5(dst, block, 0, 1, 4);
+						break;
+					case TextureCooker::Usage::Data:
+						rgbcx::encode_bc1(bc1Level, dst, block, false, false);
+						break;
+				}
+			}
+		}
+	};
+
+	VkFormat GetFormat(TextureCooker::Usage usage)
+	{
+		switch (usage)
+		{
+			case TextureCooker::Usage::Color:
+				return VK_FORMAT_BC7_SRGB_BLOCK;
+			case TextureCooker::Usage::Normal:
+				return VK_FORMAT_BC5_UNORM_BLOCK;
+			case TextureCooker::Usage::Data:
+				return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		}
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+} // namespace
+
+namespace TextureCooker
+{
+	const char* GetUsageName(Usage usage)
+	{
+		switch (usage)
+		{
+			case Usage::Color:
+				return "color";
+			case Usage::Normal:
+				return "normal";
+			case Usage::Data:
+				return "data";
+		}
+		return "unknown";
+	}
+
+	uint32_t GetSettings(Usage usage, uint32_t quality)
+	{
+		return 1u | (static_cast<uint32_t>(usage) << 8) | (quality << 16);
+	}
+
+	void InitEncoders()
+	{
+		bc7enc_compress_block_init();
+		rgbcx::init();
+	}
+
+	bool Cook(const uint8_t* encoded, size_t size, Usage usage, uint32_t quality, enki::TaskScheduler& scheduler, std::vector<uint8_t>& outFile, Result& outResult)
+	{
+		ZoneScopedN("Cook Texture");
+
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		stbi_uc* decoded = stbi_load_from_memory(encoded, static_cast<int>(size), &width, &height, &channels, 4);
+		if (!decoded)
+		{
+			WOVEN_LOG_ERROR("Failed to decode image: %s", stbi_failure_reason());
+			return false;
+		}
+
+		const uint32_t maxExtent = 1u << (COOKED_TEXTURE_MAX_MIPS - 1);
+		if (static_cast<uint32_t>(std::max(width, height)) > maxExtent)
+		{
+			WOVEN_LOG_ERROR("Image is %dx%d, the limit is %u", width, height, maxExtent);
+			stbi_image_free(decoded);
+			return false;
+		}
+
+		const VkFormat format = GetFormat(usage);
+		const uint32_t blockBytes = CookedTexture::GetBlockBytes(format);
+		const uint32_t mipCount = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+		// Build the chain in float, keeping only the previous level, and quantize each level for the encoder
+		std::vector<Mip> mips(mipCount);
+		{
+			ZoneScopedN("Generate Mips");
+			std::vector<glm::vec4> level = Unpack(decoded, width, height, usage);
+			stbi_image_free(decoded);
+
+			for (uint32_t mipIndex = 0; mipIndex < mipCount; ++mipIndex)
+			{
+				Mip& mip = mips[mipIndex];
+				mip.width = std::max(1u, static_cast<uint32_t>(width) >> mipIndex);
+				mip.height = std::max(1u, static_cast<uint32_t>(height) >> mipIndex);
+				if (mipIndex > 0)
+				{
+					level = Downsample(level, mips[mipIndex - 1].width, mips[mipIndex - 1].height, usage);
+				}
+				Pack(level, usage, mip.rgba);
+			}
+		}
+
+		// Header, mip table, then every mip at an aligned offset, encoded straight into the file image
+		uint64_t offset = AlignUp(sizeof(CookedTextureHeader) + mipCount * sizeof(CookedTextureMip), COOKED_TEXTURE_ALIGNMENT);
+		uint32_t blockCount = 0;
+		for (uint32_t mipIndex = 0; mipIndex < mipCount; ++mipIndex)
+		{
+			Mip& mip = mips[mipIndex];
+			mip.blocksX = (mip.width + 3) / 4;
+			mip.firstBlock = blockCount;
+			mip.offset = offset;
+			blockCount += mip.blocksX * ((mip.height + 3) / 4);
+			offset = AlignUp(offset + CookedTexture::GetMipBytes(format, width, height, mipIndex), COOKED_TEXTURE_ALIGNMENT);
+		}
+
+		outFile.assign(offset, 0);
+
+		CookedTextureHeader header;
+		header.format = static_cast<uint32_t>(format);
+		header.width = static_cast<uint32_t>(width);
+		header.height = static_cast<uint32_t>(height);
+		header.mipCount = mipCount;
+		header.cookSettings = GetSettings(usage, quality);
+		std::memcpy(outFile.data(), &header, sizeof(header));
+
+		for (uint32_t mipIndex = 0; mipIndex < mipCount; ++mipIndex)
+		{
+			CookedTextureMip entry;
+			entry.offset = mips[mipIndex].offset;
+			entry.size = CookedTexture::GetMipBytes(format, width, height, mipIndex);
+			std::memcpy(outFile.data() + sizeof(header) + mipIndex * sizeof(entry), &entry, sizeof(entry));
+		}
+
+		bc7enc_compress_block_params bc7Params;
+		bc7enc_compress_block_params_init(&bc7Params);
+		bc7Params.m_uber_level = std::min(quality, static_cast<uint32_t>(BC7ENC_MAX_UBER_LEVEL));
+
+		EncodeTask task;
+		task.mips = &mips;
+		task.usage = usage;
+		task.bc7Params = &bc7Params;
+		task.bc1Level = std::min(2 + quality * 4, static_cast<uint32_t>(rgbcx::MAX_LEVEL));
+		task.blockBytes = blockBytes;
+		task.output = outFile.data();
+		task.m_SetSize = blockCount;
+		task.m_MinRange = kMinBlocksPerTask;
+		{
+			ZoneScopedN("Encode");
+			scheduler.AddTaskSetToPipe(&task);
+			scheduler.WaitforTask(&task);
+		}
+
+		outResult.format = format;
+		outResult.width = static_cast<uint32_t>(width);
+		outResult.height = static_cast<uint32_t>(height);
+		outResult.mipCount = mipCount;
+		return true;
+	}
+} // namespace TextureCooker
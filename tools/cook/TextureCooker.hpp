@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <vector>
+
+#include "graphics/CookedTexture.hpp"
+
+// Turns one PNG/JPEG into a .wtex file: decode, full mip chain, BCn encode of every mip.
+namespace TextureCooker
+{
+	enum class Usage
+	{
+		Color,  // Base color / emissive: sRGB, BC7
+		Normal, // Tangent-space normal: X/Y in BC5, Z rebuilt in the shader
+		Data    // Occlusion / metallic-roughness: linear, BC1
+	};
+
+	struct Result
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipCount = 0;
+	};
+
+	const char* GetUsageName(Usage usage);
+
+	// Stored as CookedTextureHeader::cookSettings; a file cooked with other settings is out of date. Never 0.
+	uint32_t GetSettings(Usage usage, uint32_t quality);
+
+	// Builds the encoder lookup tables; once, before the first Cook
+	void InitEncoders();
+
+	// Blocks of every mip are encoded in parallel on the scheduler. quality: 0 (fastest) .. 4 (best).
+	bool Cook(const uint8_t* encoded, size_t size, Usage usage, uint32_t quality, enki::TaskScheduler& scheduler, std::vector<uint8_t>& outFile, Result& outResult);
+} // namespace TextureCooker
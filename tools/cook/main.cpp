@@ -0,0 +1,359 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fastgltf/core.hpp>
+#include <fastgltf/types.hpp>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <unordered_set>
+
+#include "core/FileSystem.hpp"
+#include "core/Logger.hpp"
+#include "scheduling/TaskSchedulingSystem.hpp"
+#include "TextureCooker.hpp"
+
+// WovenCook: cooks the images referenced by a glTF scene's materials into .wtex files
+// (full mip chain, BCn compressed) that TextureStreamer uploads with one copy per mip.
+
+namespace
+{
+	struct Options
+	{
+		std::filesystem::path scenePath;
+		std::filesystem::path outputDir;
+		uint32_t quality = 2;
+		bool force = false;
+	};
+
+	struct Stats
+	{
+		uint32_t cooked = 0;
+		uint32_t upToDate = 0;
+		uint32_t failed = 0;
+		uint64_t inputBytes = 0;
+		uint64_t outputBytes = 0;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: WovenCook <scene.gltf|scene.glb> --output <dir> [options]\n"
+		            "  --output <dir>   Where the .wtex files are written\n"
+		            "  --quality <n>    Encoder effort, 0 (fastest) to 4 (best) (default: 2)\n"
+		            "  --force          Re-cook textures that are already up to date\n");
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* arg = argv[i];
+			const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+			if (std::strcmp(arg, "--force") == 0)
+			{
+				options.force = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				return false;
+			}
+			if (arg[0] != '-')
+			{
+				options.scenePath = arg;
+				continue;
+			}
+			if (!next)
+			{
+				WOVEN_LOG_ERROR("Missing value for %s", arg);
+				return false;
+			}
+
+			if (std::strcmp(arg, "--output") == 0)
+				options.outputDir = next;
+			else if (std::strcmp(arg, "--quality") == 0)
+			{
+				char* end = nullptr;
+				const long quality = std::strtol(next, &end, 10);
+				if (end == next || *end != '\0' || quality < 0 || quality > 4)
+				{
+					WOVEN_LOG_ERROR("Invalid value for %s: %s", arg, next);
+					return false;
+				}
+				options.quality = static_cast<uint32_t>(quality);
+			}
+			else
+			{
+				WOVEN_LOG_ERROR("Unknown argument: %s", arg);
+				PrintUsage();
+				return false;
+			}
+			++i;
+		}
+
+		if (options.scenePath.empty() || options.outputDir.empty())
+		{
+			PrintUsage();
+			return false;
+		}
+		return true;
+	}
+
+	// The strongest requirement wins when materials disagree: a normal map must stay BC5 even if
+	// another material also samples it as colour
+	void AssignUsage(const fastgltf::Asset& asset, size_t textureIndex, TextureCooker::Usage usage, std::vector<std::optional<TextureCooker::Usage>>& imageUsage)
+	{
+		if (textureIndex >= asset.textures.size() || !asset.textures[textureIndex].imageIndex.has_value())
+		{
+			return;
+		}
+
+		const size_t imageIndex = asset.textures[textureIndex].imageIndex.value();
+		std::optional<TextureCooker::Usage>& current = imageUsage[imageIndex];
+		if (current && *current != usage)
+		{
+			const TextureCooker::Usage chosen = (usage == TextureCooker::Usage::Normal) ? usage : *current;
+			WOVEN_LOG_WARNING("Image %zu is used as both %s and %s; cooking as %s", imageIndex, TextureCooker::GetUsageName(*current), TextureCooker::GetUsageName(usage), TextureCooker::GetUsageName(chosen));
+			current = chosen;
+			return;
+		}
+		current = usage;
+	}
+
+	std::vector<std::optional<TextureCooker::Usage>> CollectImageUsage(const fastgltf::Asset& asset)
+	{
+		std::vector<std::optional<TextureCooker::Usage>> imageUsage(asset.images.size());
+		for (const fastgltf::Material& material: asset.materials)
+		{
+			if (material.pbrData.baseColorTexture)
+				AssignUsage(asset, material.pbrData.baseColorTexture->textureIndex, TextureCooker::Usage::Color, imageUsage);
+			if (material.emissiveTexture)
+				AssignUsage(asset, material.emissiveTexture->textureIndex, TextureCooker::Usage::Color, imageUsage);
+			if (material.normalTexture)
+				AssignUsage(asset, material.normalTexture->textureIndex, TextureCooker::Usage::Normal, imageUsage);
+			if (material.pbrData.metallicRoughnessTexture)
+				AssignUsage(asset, material.pbrData.metallicRoughnessTexture->textureIndex, TextureCooker::Usage::Data, imageUsage);
+			if (material.occlusionTexture)
+				AssignUsage(asset, material.occlusionTexture->textureIndex, TextureCooker::Usage::Data, imageUsage);
+		}
+		return imageUsage;
+	}
+
+	// Bytes already in memory: loaded buffers, GLB chunks and decoded data URIs
+	std::span<const std::byte> GetLoadedBytes(const fastgltf::DataSource& source)
+	{
+		if (const auto* array = std::get_if<fastgltf::sources::Array>(&source))
+			return { array->bytes.data(), array->bytes.size() };
+		if (const auto* vector = std::get_if<fastgltf::sources::Vector>(&source))
+			return { vector->bytes.data(), vector->bytes.size() };
+		return {};
+	}
+
+	bool CopyBytes(std::span<const std::byte> bytes, size_t offset, size_t length, std::vector<uint8_t>& outBytes)
+	{
+		if (bytes.empty() || offset + length > bytes.size())
+		{
+			return false;
+		}
+		outBytes.resize(length);
+		std::memcpy(outBytes.data(), bytes.data() + offset, length);
+		return true;
+	}
+
+	// The file whose timestamp decides whether the image is up to date: embedded images change with the scene itself
+	std::filesystem::path GetSourcePath(const fastgltf::Image& image, const std::filesystem::path& scenePath)
+	{
+		if (const auto* uri = std::get_if<fastgltf::sources::URI>(&image.data); uri && uri->uri.isLocalPath())
+		{
+			return scenePath.parent_path() / uri->uri.fspath();
+		}
+		return scenePath;
+	}
+
+	// Reads the encoded image; source is GetSourcePath for URI images
+	bool LoadImageBytes(const fastgltf::Asset& asset, const fastgltf::Image& image, const std::filesystem::path& source, std::vector<uint8_t>& outBytes)
+	{
+		if (const auto* uri = std::get_if<fastgltf::sources::URI>(&image.data))
+		{
+			if (!uri->uri.isLocalPath())
+			{
+				return false;
+			}
+			outBytes = FileSystem::LoadFile(source);
+			return !outBytes.empty();
+		}
+
+		if (const auto* view = std::get_if<fastgltf::sources::BufferView>(&image.data))
+		{
+			const fastgltf::BufferView& bufferView = asset.bufferViews[view->bufferViewIndex];
+			return CopyBytes(GetLoadedBytes(asset.buffers[bufferView.bufferIndex].data), bufferView.byteOffset, bufferView.byteLength, outBytes);
+		}
+
+		const std::span<const std::byte> bytes = GetLoadedBytes(image.data);
+		return CopyBytes(bytes, 0, bytes.size(), outBytes);
+	}
+
+	std::string GetOutputName(const fastgltf::Image& image, size_t imageIndex, std::unordered_set<std::string>& usedNames)
+	{
+		std::string name;
+		if (const auto* uri = std::get_if<fastgltf::sources::URI>(&image.data); uri && uri->uri.isLocalPath())
+			name = uri->uri.fspath().stem().string();
+		else if (!image.name.empty())
+			name = std::string(image.name);
+		else
+			name = "image" + std::to_string(imageIndex);
+
+		if (!usedNames.insert(name).second)
+		{
+			name += "_" + std::to_string(imageIndex);
+			usedNames.insert(name);
+		}
+		return name;
+	}
+
+	// Newer than its source and cooked with the same settings; only the header of the output is read
+	bool IsUpToDate(const std::filesystem::path& output, const std::filesystem::path& source, uint32_t settings)
+	{
+		std::error_code ec;
+		const std::filesystem::file_time_type outputTime = std::filesystem::last_write_time(output, ec);
+		if (ec)
+		{
+			return false;
+		}
+		const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(source, ec);
+		if (ec || outputTime < sourceTime)
+		{
+			return false;
+		}
+
+		CookedTextureHeader header;
+		std::ifstream file(output, std::ios::binary);
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		{
+			return false;
+		}
+		return header.magic == COOKED_TEXTURE_MAGIC && header.version == COOKED_TEXTURE_VERSION && header.cookSettings == settings;
+	}
+
+	// Written next to the target and renamed, so an interrupted cook never leaves a truncated .wtex
+	bool WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+	{
+		std::filesystem::path temp = path;
+		temp += ".tmp";
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			if (!file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size())))
+			{
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(temp, path, ec);
+		return !ec;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Logger::Init();
+
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(options.scenePath);
+	if (data.error() != fastgltf::Error::None)
+	{
+		WOVEN_LOG_ERROR("Failed to read %s: %s", options.scenePath.string().c_str(), std::string(fastgltf::getErrorMessage(data.error())).c_str());
+		return 1;
+	}
+
+	fastgltf::Parser parser;
+	const std::filesystem::path sceneDir = options.scenePath.parent_path();
+	fastgltf::Expected<fastgltf::Asset> asset = parser.loadGltf(data.get(), sceneDir, fastgltf::Options::LoadExternalBuffers);
+	if (asset.error() != fastgltf::Error::None)
+	{
+		WOVEN_LOG_ERROR("Failed to parse %s: %s", options.scenePath.string().c_str(), std::string(fastgltf::getErrorMessage(asset.error())).c_str());
+		return 1;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(options.outputDir, ec);
+	if (ec)
+	{
+		WOVEN_LOG_ERROR("Failed to create %s: %s", options.outputDir.string().c_str(), ec.message().c_str());
+		return 1;
+	}
+
+	TaskSchedulingSystem tasks;
+	tasks.Initialize();
+	TextureCooker::InitEncoders();
+
+	const std::vector<std::optional<TextureCooker::Usage>> imageUsage = CollectImageUsage(asset.get());
+	std::unordered_set<std::string> usedNames;
+	Stats stats;
+	std::vector<uint8_t> encoded;
+	std::vector<uint8_t> cooked;
+
+	for (size_t imageIndex = 0; imageIndex < asset->images.size(); ++imageIndex)
+	{
+		if (!imageUsage[imageIndex])
+		{
+			continue;
+		}
+
+		const fastgltf::Image& image = asset->images[imageIndex];
+		const std::filesystem::path output = options.outputDir / (GetOutputName(image, imageIndex, usedNames) + ".wtex");
+
+		const TextureCooker::Usage usage = *imageUsage[imageIndex];
+		const std::filesystem::path source = GetSourcePath(image, options.scenePath);
+		if (!options.force && IsUpToDate(output, source, TextureCooker::GetSettings(usage, options.quality)))
+		{
+			++stats.upToDate;
+			continue;
+		}
+
+		if (!LoadImageBytes(asset.get(), image, source, encoded))
+		{
+			WOVEN_LOG_ERROR("Image %zu: could not read its data", imageIndex);
+			++stats.failed;
+			continue;
+		}
+
+		TextureCooker::Result result;
+		if (!TextureCooker::Cook(encoded.data(), encoded.size(), usage, options.quality, *tasks.GetScheduler(), cooked, result))
+		{
+			WOVEN_LOG_ERROR("Image %zu: cook failed", imageIndex);
+			++stats.failed;
+			continue;
+		}
+		if (!WriteFile(output, cooked))
+		{
+			WOVEN_LOG_ERROR("Failed to write %s", output.string().c_str());
+			++stats.failed;
+			continue;
+		}
+
+		WOVEN_LOG_INFO("%s: %ux%u %s, %u mips, %.1f KiB -> %.1f KiB", output.filename().string().c_str(), result.width, result.height, TextureCooker::GetUsageName(usage), result.mipCount, encoded.size() / 1024.0, cooked.size() / 1024.0);
+		++stats.cooked;
+		stats.inputBytes += encoded.size();
+		stats.outputBytes += cooked.size();
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	WOVEN_LOG_INFO("Cooked %u, up to date %u, failed %u in %.2f s (%.1f MiB -> %.1f MiB)", stats.cooked, stats.upToDate, stats.failed, seconds, stats.inputBytes / (1024.0 * 1024.0), stats.outputBytes / (1024.0 * 1024.0));
+
+	tasks.Shutdown();
+	Logger::Shutdown();
+	return stats.failed > 0 ? 1 : 0;
+}
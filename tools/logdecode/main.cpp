@@ -0,0 +1,255 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <unordered_map>
+
+#include "core/BinaryLog.hpp"
+#include "core/FileSystem.hpp"
+#include "core/LogFormat.hpp"
+#include "core/Logger.hpp"
+
+// WovenLogDecode: turns binary log segments (.wlog, written by Logger::SetBinaryLog) back into text lines,
+// using the format strings interned in each segment.
+
+namespace
+{
+	struct Options
+	{
+		std::vector<std::filesystem::path> inputs;
+		std::filesystem::path outputPath;
+		LogLevel minLevel = LogLevel::Debug;
+	};
+
+	struct Segment
+	{
+		std::filesystem::path path;
+		std::vector<uint8_t> data;
+		BinaryLogHeader header;
+	};
+
+	struct Stats
+	{
+		uint64_t messages = 0;
+		uint64_t formats = 0;
+		uint64_t bytes = 0;
+		uint32_t corrupt = 0;
+	};
+
+	constexpr const char* kLevelPrefixes[] = { "[DEBUG]", "[INFO] ", "[WARN] ", "[ERROR]" };
+
+	void PrintUsage()
+	{
+		std::printf("Usage: WovenLogDecode <segment.wlog>... [options]\n"
+		            "  --output <file>   Write the text here instead of stdout\n"
+		            "  --level <name>    Skip messages below debug, info, warning or error (default: debug)\n"
+		            "Segments are decoded in the order they were written, whatever order they are given in.\n");
+	}
+
+	bool ParseLevel(const char* name, LogLevel& outLevel)
+	{
+		static constexpr const char* kNames[] = { "debug", "info", "warning", "error" };
+		for (size_t i = 0; i < std::size(kNames); ++i)
+		{
+			if (std::strcmp(name, kNames[i]) == 0)
+			{
+				outLevel = static_cast<LogLevel>(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* arg = argv[i];
+			const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				return false;
+			}
+			if (arg[0] != '-')
+			{
+				options.inputs.emplace_back(arg);
+				continue;
+			}
+			if (!next)
+			{
+				WOVEN_LOG_ERROR("Missing value for %s", arg);
+				return false;
+			}
+
+			if (std::strcmp(arg, "--output") == 0)
+				options.outputPath = next;
+			else if (std::strcmp(arg, "--level") == 0)
+			{
+				if (!ParseLevel(next, options.minLevel))
+				{
+					WOVEN_LOG_ERROR("Invalid value for --level: %s", next);
+					return false;
+				}
+			}
+			else
+			{
+				WOVEN_LOG_ERROR("Unknown argument: %s", arg);
+				PrintUsage();
+				return false;
+			}
+			++i;
+		}
+
+		if (options.inputs.empty())
+		{
+			PrintUsage();
+			return false;
+		}
+		return true;
+	}
+
+	bool LoadSegment(const std::filesystem::path& path, Segment& outSegment)
+	{
+		outSegment.path = path;
+		outSegment.data = FileSystem::LoadFile(path);
+		if (outSegment.data.size() < sizeof(BinaryLogHeader))
+		{
+			WOVEN_LOG_ERROR("Failed to read %s", path.string().c_str());
+			return false;
+		}
+
+		std::memcpy(&outSegment.header, outSegment.data.data(), sizeof(BinaryLogHeader));
+		if (outSegment.header.magic != BINARY_LOG_MAGIC || outSegment.header.version != BINARY_LOG_VERSION)
+		{
+			WOVEN_LOG_ERROR("%s is not a binary log (magic 0x%08x, version %u)", path.string().c_str(), outSegment.header.magic, outSegment.header.version);
+			return false;
+		}
+
+		// A segment still mapped when the process died has its full size on disk; usedBytes marks the end
+		if (outSegment.header.usedBytes < sizeof(BinaryLogHeader) || outSegment.header.usedBytes > outSegment.data.size())
+		{
+			WOVEN_LOG_WARNING("%s: used size %llu is out of range, reading the whole file", path.string().c_str(), static_cast<unsigned long long>(outSegment.header.usedBytes));
+			outSegment.header.usedBytes = outSegment.data.size();
+		}
+		return true;
+	}
+
+	// Local wall-clock time with microseconds
+	void FormatTime(int64_t unixNs, char* outText, size_t capacity)
+	{
+		const std::time_t seconds = static_cast<std::time_t>(unixNs / 1'000'000'000);
+		const int64_t micros = (unixNs % 1'000'000'000) / 1000;
+		std::tm local{};
+#ifdef _WIN32
+		localtime_s(&local, &seconds);
+#else
+		localtime_r(&seconds, &local);
+#endif
+		const size_t length = std::strftime(outText, capacity, "%Y-%m-%d %H:%M:%S", &local);
+		std::snprintf(outText + length, capacity - length, ".%06lld", static_cast<long long>(micros));
+	}
+
+	void DecodeSegment(const Segment& segment, LogLevel minLevel, FILE* output, Stats& stats)
+	{
+		std::unordered_map<uint32_t, std::string> formats;
+		std::string text;
+		char timeText[48];
+
+		const uint8_t* data = segment.data.data();
+		size_t offset = sizeof(BinaryLogHeader);
+		while (offset + sizeof(BinaryLogRecord) <= segment.header.usedBytes)
+		{
+			BinaryLogRecord record;
+			std::memcpy(&record, data + offset, sizeof(record));
+			if (record.size < sizeof(record) || record.payloadBytes > record.size - sizeof(record) || offset + record.size > segment.header.usedBytes)
+			{
+				WOVEN_LOG_ERROR("%s: corrupt record at byte %zu, skipping the rest of the segment", segment.path.string().c_str(), offset);
+				++stats.corrupt;
+				return;
+			}
+
+			const uint8_t* payload = data + offset + sizeof(record);
+			offset += record.size;
+
+			if (record.type == BinaryLogRecordType::Format)
+			{
+				formats[record.formatId].assign(reinterpret_cast<const char*>(payload), record.payloadBytes);
+				++stats.formats;
+				continue;
+			}
+			if (record.type != BinaryLogRecordType::Message || record.level >= std::size(kLevelPrefixes))
+				continue;
+			if (static_cast<LogLevel>(record.level) < minLevel)
+				continue;
+
+			const auto format = formats.find(record.formatId);
+			text.clear();
+			if (format == formats.end())
+				text = "[unknown format]";
+			else if (!LogFormat::FormatArgs(format->second.c_str(), payload, record.payloadBytes, text))
+				text += " [bad log arguments]";
+
+			const int64_t unixNs = segment.header.startUnixNs + static_cast<int64_t>(record.timestampNs - segment.header.startTimestampNs);
+			FormatTime(unixNs, timeText, sizeof(timeText));
+			std::fprintf(output, "%s %s %s\n", timeText, kLevelPrefixes[record.level], text.c_str());
+			++stats.messages;
+		}
+		stats.bytes += segment.header.usedBytes;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	// Decoded text may go to stdout, so the tool's own messages go to stderr
+	Logger::SetOutputStream(stderr);
+	Logger::Init();
+
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		Logger::Shutdown();
+		return 1;
+	}
+
+	std::vector<Segment> segments(options.inputs.size());
+	for (size_t i = 0; i < options.inputs.size(); ++i)
+	{
+		if (!LoadSegment(options.inputs[i], segments[i]))
+		{
+			Logger::Shutdown();
+			return 1;
+		}
+	}
+	std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) { return a.header.segmentIndex < b.header.segmentIndex; });
+
+	FILE* output = stdout;
+	if (!options.outputPath.empty())
+	{
+		output = std::fopen(options.outputPath.string().c_str(), "w");
+		if (!output)
+		{
+			WOVEN_LOG_ERROR("Failed to open %s", options.outputPath.string().c_str());
+			Logger::Shutdown();
+			return 1;
+		}
+	}
+
+	Stats stats;
+	for (const Segment& segment: segments)
+	{
+		DecodeSegment(segment, options.minLevel, output, stats);
+	}
+
+	if (output != stdout)
+	{
+		std::fclose(output);
+		WOVEN_LOG_INFO("Decoded %llu messages (%llu formats) from %zu segments, %.1f KiB -> %s", static_cast<unsigned long long>(stats.messages), static_cast<unsigned long long>(stats.formats), segments.size(), stats.bytes / 1024.0, options.outputPath.string().c_str());
+	}
+
+	Logger::Shutdown();
+	return stats.corrupt > 0 ? 1 : 0;
+}
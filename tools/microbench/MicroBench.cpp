@@ -0,0 +1,191 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "core/FrameStatistics.hpp"
+#include "core/JsonWriter.hpp"
+#include "core/Logger.hpp"
+#include "MicroBench.hpp"
+
+namespace MicroBench
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		double TimeIterationsMs(const CaseFunction& function, uint64_t iterations)
+		{
+			const Clock::time_point start = Clock::now();
+			function(iterations);
+			const Clock::time_point end = Clock::now();
+			return std::chrono::duration<double, std::milli>(end - start).count();
+		}
+
+		double Median(std::vector<double> values)
+		{
+			if (values.empty())
+			{
+				return 0.0;
+			}
+			std::sort(values.begin(), values.end());
+			const size_t middle = values.size() / 2;
+			return (values.size() % 2 == 0) ? 0.5 * (values[middle - 1] + values[middle]) : values[middle];
+		}
+	} // namespace
+
+	Runner::Runner(const Config& config)
+	      : m_Config(config)
+	{
+	}
+
+	void Runner::Add(std::string name, CaseFunction function)
+	{
+		m_Cases.push_back({ std::move(name), std::move(function), {}, {} });
+	}
+
+	void Runner::Add(std::string name, CaseFunction function, FixtureFunction setUp, FixtureFunction tearDown)
+	{
+		m_Cases.push_back({ std::move(name), std::move(function), std::move(setUp), std::move(tearDown) });
+	}
+
+	void Runner::ListCases() const
+	{
+		for (const Case& benchCase: m_Cases)
+		{
+			std::printf("%s\n", benchCase.name.c_str());
+		}
+	}
+
+	bool Runner::RunAll()
+	{
+		m_Results.clear();
+		for (const Case& benchCase: m_Cases)
+		{
+			if (!m_Config.filter.empty() && benchCase.name.find(m_Config.filter) == std::string::npos)
+			{
+				continue;
+			}
+
+			if (benchCase.setUp)
+			{
+				benchCase.setUp();
+			}
+			const Result result = RunCase(benchCase);
+			if (benchCase.tearDown)
+			{
+				benchCase.tearDown();
+			}
+			WOVEN_LOG_INFO("%-44s median %12.1f ns  mad %10.1f  mean %12.1f +- %.1f  (%llu it x %u)", result.name.c_str(), result.medianNs, result.madNs, result.meanNs, result.ci95Ns, static_cast<unsigned long long>(result.iterations), result.samples);
+			m_Results.push_back(result);
+		}
+		return !m_Results.empty();
+	}
+
+	uint64_t Runner::Calibrate(const Case& benchCase) const
+	{
+		// Double the iteration count until one sample is long enough to swamp timer resolution
+		uint64_t iterations = 1;
+		constexpr uint64_t maxIterations = 1ull << 32;
+		while (iterations < maxIterations)
+		{
+			const double elapsedMs = TimeIterationsMs(benchCase.function, iterations);
+			if (elapsedMs >= m_Config.minSampleMs)
+			{
+				break;
+			}
+
+			// Jump close to the target once the measurement is meaningful
+			if (elapsedMs > 0.5)
+			{
+				const double scale = m_Config.minSampleMs / elapsedMs;
+				iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(std::ceil(static_cast<double>(iterations) * scale * 1.1)));
+				break;
+			}
+			iterations *= 2;
+		}
+		return std::min(iterations, maxIterations);
+	}
+
+	Result Runner::RunCase(const Case& benchCase) const
+	{
+		ZoneScopedN("MicroBench::RunCase");
+
+		const uint64_t iterations = Calibrate(benchCase);
+
+		for (uint32_t i = 0; i < m_Config.warmupSamples; ++i)
+		{
+			TimeIterationsMs(benchCase.function, iterations);
+		}
+
+		std::vector<double> perOpNs;
+		perOpNs.reserve(m_Config.samples);
+		for (uint32_t i = 0; i < m_Config.samples; ++i)
+		{
+			const double elapsedMs = TimeIterationsMs(benchCase.function, iterations);
+			perOpNs.push_back(elapsedMs * 1.0e6 / static_cast<double>(iterations));
+		}
+
+		const FrameStatistics::Summary summary = FrameStatistics::Summarize(perOpNs);
+
+		Result result;
+		result.name = benchCase.name;
+		result.iterations = iterations;
+		result.samples = static_cast<uint32_t>(perOpNs.size());
+		result.medianNs = Median(perOpNs);
+		result.meanNs = summary.mean;
+		result.stdDevNs = summary.stdDev;
+		result.minNs = summary.min;
+		result.maxNs = summary.max;
+		result.p95Ns = summary.p95;
+		result.ci95Ns = perOpNs.size() > 1 ? 1.96 * summary.stdDev / std::sqrt(static_cast<double>(perOpNs.size())) : 0.0;
+
+		std::vector<double> deviations;
+		deviations.reserve(perOpNs.size());
+		for (double value: perOpNs)
+		{
+			deviations.push_back(std::abs(value - result.medianNs));
+		}
+		result.madNs = Median(std::move(deviations));
+		return result;
+	}
+
+	void Runner::WriteJson(JsonWriter& writer) const
+	{
+		writer.BeginObject();
+
+		writer.Key("config");
+		writer.BeginObject();
+		writer.Field("samples", m_Config.samples);
+		writer.Field("warmupSamples", m_Config.warmupSamples);
+		writer.Field("minSampleMs", m_Config.minSampleMs);
+		writer.Field("filter", m_Config.filter);
+		writer.EndObject();
+
+		writer.Key("results");
+		writer.BeginArray();
+		for (const Result& result: m_Results)
+		{
+			writer.BeginObject();
+			writer.Field("name", result.name);
+			writer.Field("iterations", result.iterations);
+			writer.Field("samples", result.samples);
+			writer.Key("nsPerOp");
+			writer.BeginObject();
+			writer.Field("median", result.medianNs);
+			writer.Field("mad", result.madNs);
+			writer.Field("mean", result.meanNs);
+			writer.Field("stdDev", result.stdDevNs);
+			writer.Field("min", result.minNs);
+			writer.Field("max", result.maxNs);
+			writer.Field("p95", result.p95Ns);
+			writer.Field("ci95", result.ci95Ns);
+			writer.EndObject();
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.EndObject();
+	}
+} // namespace MicroBench
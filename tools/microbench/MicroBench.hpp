@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include <functional>
+#include <string>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+class JsonWriter;
+
+namespace MicroBench
+{
+	// Keeps the compiler from discarding a computed value
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static const void* volatile s_Sink = nullptr;
+		s_Sink = &value;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	// Body runs the measured operation `iterations` times
+	using CaseFunction = std::function<void(uint64_t iterations)>;
+	// Untimed state change around a whole case (calibration, warmup and samples)
+	using FixtureFunction = std::function<void()>;
+
+	struct Config
+	{
+		uint32_t samples = 30;      // Timed samples per case
+		uint32_t warmupSamples = 3; // Untimed samples before measuring
+		double minSampleMs = 10.0;  // Iterations are calibrated so one sample lasts at least this long
+		std::string filter;         // Substring match on case names (empty = all)
+	};
+
+	// Per-operation statistics in nanoseconds, computed across samples
+	struct Result
+	{
+		std::string name;
+		uint64_t iterations = 0;
+		uint32_t samples = 0;
+		double medianNs = 0.0;
+		double madNs = 0.0; // Median absolute deviation (robust spread)
+		double meanNs = 0.0;
+		double stdDevNs = 0.0;
+		double minNs = 0.0;
+		double maxNs = 0.0;
+		double p95Ns = 0.0;
+		double ci95Ns = 0.0; // Half-width of the 95% confidence interval of the mean
+	};
+
+	class Runner
+	{
+	public:
+		explicit Runner(const Config& config);
+
+		void Add(std::string name, CaseFunction function);
+		void Add(std::string name, CaseFunction function, FixtureFunction setUp, FixtureFunction tearDown);
+		void ListCases() const;
+
+		// Returns false if no case matched the filter
+		bool RunAll();
+
+		void WriteJson(JsonWriter& writer) const;
+
+	private:
+		struct Case
+		{
+			std::string name;
+			CaseFunction function;
+			FixtureFunction setUp;
+			FixtureFunction tearDown;
+		};
+
+		Result RunCase(const Case& benchCase) const;
+		uint64_t Calibrate(const Case& benchCase) const;
+
+	private:
+		Config m_Config;
+		std::vector<Case> m_Cases;
+		std::vector<Result> m_Results;
+	};
+} // namespace MicroBench
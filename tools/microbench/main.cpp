@@ -0,0 +1,375 @@
+#include "pch.hpp"
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <volk.h>
+
+#include "core/FileSystem.hpp"
+#include "core/JsonWriter.hpp"
+#include "core/LaunchOptions.hpp"
+#include "core/Logger.hpp"
+#include "graphics/Camera.hpp"
+#include "graphics/MeshBaker.hpp"
+#include "graphics/ProceduralMeshes.hpp"
+#include "graphics/ShaderSystem.hpp"
+#include "MicroBench.hpp"
+#include "scheduling/TaskSchedulingSystem.hpp"
+
+// WovenMicroBench: repeatable timings for the engine's hot building blocks.
+// Run with --json <file> to get machine-readable results for regression tracking.
+
+namespace
+{
+	struct Options
+	{
+		MicroBench::Config config;
+		std::filesystem::path jsonPath;
+		bool listOnly = false;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: WovenMicroBench [options]\n"
+		            "  --filter <text>      Only run cases whose name contains text\n"
+		            "  --samples <n>        Timed samples per case, at least 2 (default: 30)\n"
+		            "  --min-sample-ms <x>  Minimum duration of one sample, at least 0.1 (default: 10)\n"
+		            "  --json <file>        Write results as JSON\n"
+		            "  --list               List case names and exit\n");
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* arg = argv[i];
+			const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+			if (std::strcmp(arg, "--list") == 0)
+			{
+				options.listOnly = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				return false;
+			}
+			if (!next)
+			{
+				WOVEN_LOG_ERROR("Missing value for %s", arg);
+				return false;
+			}
+
+			bool valid = true;
+			if (std::strcmp(arg, "--filter") == 0)
+				options.config.filter = next;
+			else if (std::strcmp(arg, "--json") == 0)
+				options.jsonPath = next;
+			else if (std::strcmp(arg, "--samples") == 0)
+				valid = LaunchOptions::ParseUInt(next, options.config.samples) && options.config.samples >= 2;
+			else if (std::strcmp(arg, "--min-sample-ms") == 0)
+			{
+				char* end = nullptr;
+				options.config.minSampleMs = std::strtod(next, &end);
+				valid = end != next && *end == '\0' && options.config.minSampleMs >= 0.1;
+			}
+			else
+			{
+				WOVEN_LOG_ERROR("Unknown argument: %s", arg);
+				PrintUsage();
+				return false;
+			}
+
+			if (!valid)
+			{
+				WOVEN_LOG_ERROR("Invalid value for %s: %s", arg, next);
+				return false;
+			}
+			++i;
+		}
+		return true;
+	}
+
+	FILE* OpenNullStream()
+	{
+#if defined(_WIN32)
+		return std::fopen("NUL", "w");
+#else
+		return std::fopen("/dev/null", "w");
+#endif
+	}
+
+	// Logger output goes to the null device while a case runs so console I/O is not measured
+	class ScopedQuietLogger
+	{
+	public:
+		explicit ScopedQuietLogger(FILE* sink)
+		{
+			Logger::SetOutputStream(sink);
+		}
+
+		~ScopedQuietLogger()
+		{
+			Logger::SetOutputStream(stdout);
+		}
+	};
+
+	struct EmptyTask: enki::ITaskSet
+	{
+		void ExecuteRange(enki::TaskSetPartition, uint32_t) override
+		{
+		}
+	};
+
+	struct SumTask: enki::ITaskSet
+	{
+		std::atomic<uint64_t> sum{ 0 };
+
+		void ExecuteRange(enki::TaskSetPartition range, uint32_t) override
+		{
+			uint64_t local = 0;
+			for (uint32_t i = range.start; i < range.end; ++i)
+			{
+				local += i;
+			}
+			sum.fetch_add(local, std::memory_order_relaxed);
+		}
+	};
+
+	void AddFileSystemCases(MicroBench::Runner& runner, const std::filesystem::path& tempDir)
+	{
+		for (const uint32_t sizeKiB: { 64u, 4096u })
+		{
+			const std::filesystem::path path = tempDir / ("load_" + std::to_string(sizeKiB) + "k.bin");
+			{
+				std::ofstream file(path, std::ios::binary);
+				const std::vector<char> data(static_cast<size_t>(sizeKiB) * 1024, 'w');
+				file.write(data.data(), static_cast<std::streamsize>(data.size()));
+			}
+
+			runner.Add("FileSystem::LoadFile/" + std::to_string(sizeKiB) + "KiB", [path](uint64_t iterations)
+			{
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					std::vector<uint8_t> data = FileSystem::LoadFile(path);
+					MicroBench::DoNotOptimize(data.data());
+				}
+			});
+		}
+	}
+
+	void AddLoggerCases(MicroBench::Runner& runner, FILE* nullStream, const std::filesystem::path& tempDir)
+	{
+		// Redirecting the console flushes the logger, so it happens once per case, outside the timing
+		const auto quiet = [nullStream]()
+		{
+			Logger::SetOutputStream(nullStream);
+		};
+		const auto restore = []()
+		{
+			Logger::SetOutputStream(stdout);
+		};
+
+		runner.Add("Logger::Info/plain", [](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				WOVEN_LOG_INFO("Swapchain recreated");
+			}
+		}, quiet, restore);
+
+		runner.Add("Logger::Info/format", [](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				WOVEN_LOG_INFO("Frame %llu: %.3f ms on %s (%u draws)", static_cast<unsigned long long>(i), 16.667, "Main", 42u);
+			}
+		}, quiet, restore);
+
+		// Same message in binary mode: the drain copies arguments into the mapped segment instead of formatting.
+		// The segment stays open for the whole case, so only the log calls are timed, as in text mode.
+		runner.Add("Logger::Info/binary", [](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				WOVEN_LOG_INFO("Frame %llu: %.3f ms on %s (%u draws)", static_cast<unsigned long long>(i), 16.667, "Main", 42u);
+			}
+		}, [quiet, tempDir]()
+		{
+			quiet();
+			Logger::SetBinaryLog(tempDir / "microbench.wlog");
+		}, [restore]()
+		{
+			Logger::SetBinaryLog({});
+			restore();
+		});
+	}
+
+	void AddCameraCases(MicroBench::Runner& runner)
+	{
+		runner.Add("Camera/SetPosition+ViewProjection", [](uint64_t iterations)
+		{
+			Camera camera;
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				const float offset = static_cast<float>(i & 1023) * 0.001f;
+				camera.SetPosition(glm::vec3(offset, 1.0f, -3.0f));
+				const glm::mat4 viewProjection = camera.GetViewProjectionMatrix();
+				MicroBench::DoNotOptimize(viewProjection);
+			}
+		});
+
+		runner.Add("Camera/SetPerspective", [](uint64_t iterations)
+		{
+			Camera camera;
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				const float aspect = 1.0f + static_cast<float>(i & 255) * 0.001f;
+				camera.SetPerspective(60.0f, aspect, 0.1f, 1000.0f);
+				MicroBench::DoNotOptimize(camera.GetProjectionMatrix());
+			}
+		});
+	}
+
+	void AddMeshCases(MicroBench::Runner& runner, FILE* nullStream)
+	{
+		// The demo torus: meshlet split, LOD cluster DAG and quantization of ~9k triangles
+		const MeshSource torus = ProceduralMeshes::CreateTorus(0.9f, 0.35f, 96, 48);
+		runner.Add("MeshBaker::Bake/torus", [torus, nullStream](uint64_t iterations)
+		{
+			ScopedQuietLogger quiet(nullStream);
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				BakedMesh baked;
+				MeshBaker::Bake(torus, QuantizationBudget{}, "Torus", baked);
+				MicroBench::DoNotOptimize(baked.meshlets.data());
+			}
+		});
+	}
+
+	void AddShaderCases(MicroBench::Runner& runner, ShaderSystem& shaderSystem, FILE* nullStream)
+	{
+		// The session keeps loaded modules, so this measures link + SPIR-V emission of a warm module
+		runner.Add("ShaderSystem::CompileToSpirv/triangle.meshMain", [&shaderSystem, nullStream](uint64_t iterations)
+		{
+			ScopedQuietLogger quiet(nullStream);
+			ShaderCompileDesc desc{};
+			desc.filePath = "shaders/triangle.slang";
+			desc.entryPoint = "meshMain";
+			desc.stage = VK_SHADER_STAGE_MESH_BIT_EXT;
+
+			std::vector<uint32_t> spirv;
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				shaderSystem.CompileToSpirv(desc, spirv);
+				MicroBench::DoNotOptimize(spirv.data());
+			}
+		});
+	}
+
+	void AddTaskCases(MicroBench::Runner& runner, TaskSchedulingSystem& tasks)
+	{
+		runner.Add("enki/AddTaskSet+Wait (empty)", [&tasks](uint64_t iterations)
+		{
+			enki::TaskScheduler* scheduler = tasks.GetScheduler();
+			EmptyTask task;
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				scheduler->AddTaskSetToPipe(&task);
+				scheduler->WaitforTask(&task);
+			}
+		});
+
+		runner.Add("enki/ParallelFor 64k (sum)", [&tasks](uint64_t iterations)
+		{
+			enki::TaskScheduler* scheduler = tasks.GetScheduler();
+			SumTask task;
+			task.m_SetSize = 64 * 1024;
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				scheduler->AddTaskSetToPipe(&task);
+				scheduler->WaitforTask(&task);
+			}
+			MicroBench::DoNotOptimize(task.sum);
+		});
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Logger::Init();
+
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	FILE* nullStream = OpenNullStream();
+	if (!nullStream)
+	{
+		WOVEN_LOG_ERROR("Failed to open null device");
+		return 1;
+	}
+
+	std::error_code ec;
+	const std::filesystem::path tempDir = std::filesystem::temp_directory_path(ec) / "woven_microbench";
+	std::filesystem::create_directories(tempDir, ec);
+
+	// CompileToSpirv never touches the device, so no Vulkan objects are needed
+	ShaderSystem shaderSystem;
+	const bool hasShaders = shaderSystem.Initialize(VK_NULL_HANDLE, VK_NULL_HANDLE, VkPushConstantRange{});
+
+	TaskSchedulingSystem tasks;
+	tasks.Initialize();
+
+	MicroBench::Runner runner(options.config);
+	AddFileSystemCases(runner, tempDir);
+	AddLoggerCases(runner, nullStream, tempDir);
+	AddCameraCases(runner);
+	AddMeshCases(runner, nullStream);
+	if (hasShaders)
+		AddShaderCases(runner, shaderSystem, nullStream);
+	else
+		WOVEN_LOG_WARNING("Slang unavailable, skipping shader compile cases");
+	AddTaskCases(runner, tasks);
+
+	int exitCode = 0;
+	if (options.listOnly)
+	{
+		runner.ListCases();
+	}
+	else if (!runner.RunAll())
+	{
+		WOVEN_LOG_ERROR("No benchmark case matched filter '%s'", options.config.filter.c_str());
+		exitCode = 1;
+	}
+	else if (!options.jsonPath.empty())
+	{
+		JsonWriter writer;
+		runner.WriteJson(writer);
+		if (writer.WriteToFile(options.jsonPath))
+			WOVEN_LOG_INFO("Wrote results to %s", options.jsonPath.string().c_str());
+		else
+		{
+			WOVEN_LOG_ERROR("Failed to write %s", options.jsonPath.string().c_str());
+			exitCode = 1;
+		}
+	}
+
+	tasks.WaitAll();
+	tasks.Shutdown();
+	shaderSystem.Shutdown();
+	std::filesystem::remove_all(tempDir, ec);
+	std::fclose(nullStream);
+
+	Logger::Shutdown();
+	return exitCode;
+}